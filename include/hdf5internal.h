@@ -27,6 +27,10 @@
 #define NC_HDF5_CHUNKSIZE_FACTOR (10)
 #define NC_HDF5_MIN_CHUNK_SIZE (2)
 
+/* Reads and writes needing type conversion are done in strips of
+ * the leading dimension using a buffer of about this many bytes. */
+#define NC_HDF5_CONVERT_STRIP_SIZE (1048576)
+
 #define NC_EMPTY_SCALE "NC_EMPTY_SCALE"
 
 /* This is an attribute I had to add to handle multidimensional
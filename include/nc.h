@@ -7,6 +7,7 @@
 
 #include "config.h"
 #include "netcdf.h"
+#include "ncthreadsafe.h"
 
    /* There's an external ncid (ext_ncid) and an internal ncid
     * (int_ncid). The ext_ncid is the ncid returned to the user. If
@@ -27,6 +28,8 @@ typedef struct NC {
 	void* dispatchdata; /*per-'file' data; points to e.g. NC3_INFO data*/
 	char* path;
 	int   mode; /* as provided to nc_open/nc_create */
+	int   concurrency; /* NC_CONCURRENT_XXX, set by the dispatcher; see ncthreadsafe.h */
+	struct NClock* lock; /* used only with NETCDF_ENABLE_THREADSAFE */
 } NC;
 
 /*
@@ -172,6 +172,18 @@ extern "C" {
                  const size_t *start, const size_t *count,
                  void *value, nc_type);
 
+    extern int
+    NC3_put_vars(int ncid, int varid,
+                 const size_t *start, const size_t *count,
+                 const ptrdiff_t *stride,
+                 const void *value, nc_type);
+
+    extern int
+    NC3_get_vars(int ncid, int varid,
+                 const size_t *start, const size_t *count,
+                 const ptrdiff_t *stride,
+                 void *value, nc_type);
+
 /* End _var */
 
     extern int NC3_initialize(void);
@@ -120,6 +120,11 @@ typedef struct NC_attrarray {
     size_t nelems;          /* length of the array */
     NC_attr **value;
     /* end xdr */
+    /* if not NULL, the array as read from the header and not yet
+       decoded into value; see NC_loadattrs() */
+    const void *xattrs;
+    size_t xlen;            /* external size of the array at xattrs */
+    int version;            /* format of the header it came from */
 } NC_attrarray;
 
 /* Begin defined in attr.c */
@@ -231,6 +236,7 @@ struct NC3_INFO {
 #	define NC_HSYNC 0x8      /* synchronise whole header on change */
 #	define NC_NDIRTY 0x10  /* numrecs has changed */
 #	define NC_HDIRTY 0x20  /* header info has changed */
+#	define NC_PREAD 0x40   /* read data with ncio_read(), see NC_getregion() */
 /* NC_NOFILL defined in netcdf.h, historical interface */
 #if 0
 #	define NC_NOFILL 0x100   /**< Argument to nc_set_fill() to turn off filling of data. */
@@ -251,6 +257,7 @@ struct NC3_INFO {
     NC_dimarray dims;
     NC_attrarray attrs;
     NC_vararray vars;
+    void *xhdr;     /* header as read, holds the attributes not yet decoded */
 };
 
 #define NC_readonly(ncp)                        \
@@ -333,6 +340,9 @@ ncx_put_NC(const NC3_INFO* ncp, void **xpp, off_t offset, size_t extent);
 extern int
 nc_get_NC(NC3_INFO* ncp);
 
+extern int
+NC_loadattrs(NC_attrarray *ncap);
+
 /* End defined in v1hpg.c */
 /* Begin defined in putget.c */
 
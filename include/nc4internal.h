@@ -254,6 +254,7 @@ typedef struct NC_GRP_INFO
     struct NC_FILE_INFO *nc4_info; /**< Pointer containing NC_FILE_INFO_T. */
     struct NC_GRP_INFO *parent;  /**< Pointer tp parent group. */
     int atts_read;               /**< True if atts have been read for this group. */
+    nc_bool_t meta_deferred;     /**< True if dims, vars, types and children are yet to be read. */
     NCindex* children;           /**< NCindex<struct NC_GRP_INFO*> */
     NCindex* dim;                /**< NCindex<NC_DIM_INFO_T> * */
     NCindex* att;                /**< NCindex<NC_ATT_INFO_T> * */
@@ -296,6 +297,7 @@ typedef struct NC_FILE_INFO
     NClist *alltypes;  /**< List of all types. */
     NClist *allgroups; /**< List of all groups, including root group. */
     void *format_file_info; /**< Pointer to binary format info for file. */
+    int (*read_grp)(struct NC_GRP_INFO *); /**< Reads a deferred group; NULL unless groups are read lazily. */
     NC4_Provenance provenance; /**< File provenence info. */
     struct NC4_Memio
     {
@@ -327,6 +329,19 @@ extern int nc4_convert_type(const void *src, void *dest, const nc_type src_type,
 			    const void *fill_value, int strict_nc3, int quantize_mode,
 			    int nsd);
 
+/* Vectorized conversion and quantization kernels, in nc4convert.c. A
+ * conversion kernel returns non-zero if there was a range error. */
+typedef int (*NC4convertkernel)(const void *src, void *dest, size_t len);
+extern NC4convertkernel nc4_find_convert_kernel(nc_type src_type, nc_type dest_type);
+extern void nc4_bitgroom_float(unsigned int *u, size_t len, unsigned int fill,
+			       unsigned int zro, unsigned int one);
+extern void nc4_bitgroom_double(unsigned long long *u, size_t len, unsigned long long fill,
+				unsigned long long zro, unsigned long long one);
+extern void nc4_bitround_float(unsigned int *u, size_t len, unsigned int fill,
+			       unsigned int zro, unsigned int hshv);
+extern void nc4_bitround_double(unsigned long long *u, size_t len, unsigned long long fill,
+				unsigned long long zro, unsigned long long hshv);
+
 /* These functions do netcdf-4 things. */
 extern int nc4_reopen_dataset(NC_GRP_INFO_T *grp, NC_VAR_INFO_T *var);
 extern int nc4_read_atts(NC_GRP_INFO_T *grp, NC_VAR_INFO_T *var);
@@ -335,6 +350,7 @@ extern int nc4_read_atts(NC_GRP_INFO_T *grp, NC_VAR_INFO_T *var);
 extern int nc4_find_nc_grp_h5(int ncid, NC **nc, NC_GRP_INFO_T **grp,
                        NC_FILE_INFO_T **h5);
 extern int nc4_find_grp_h5(int ncid, NC_GRP_INFO_T **grp, NC_FILE_INFO_T **h5);
+extern int nc4_read_deferred_grp(NC_GRP_INFO_T *grp);
 extern int nc4_find_nc4_grp(int ncid, NC_GRP_INFO_T **grp);
 extern int nc4_find_dim(NC_GRP_INFO_T *grp, int dimid, NC_DIM_INFO_T **dim,
                  NC_GRP_INFO_T **dim_grp);
@@ -40,6 +40,7 @@ typedef unsigned int NCFLAGS;
 #define NCF_ENCODE_PATH     (0x2000) 
 #define NCF_ENCODE_QUERY    (0x4000)
 #define NCF_FILLMISMATCH_FAIL (0x8000) 
+#define NCF_STREAM          (0x10000) /* cause oc to decode data as it arrives */
 /* Put these at top bits for now */
 /*COLUMBIA_HACK*/
 #define NCF_COLUMBIA        (0x80000000) /* Hack for columbia server */
@@ -49,7 +50,7 @@ typedef unsigned int NCFLAGS;
 /* Define all the default on flags */
 #define DFALT_ON_FLAGS (NCF_CACHE|NCF_PREFETCH|NCF_FILLMISMATCH)
 
-#define ALL_NCF_FLAGS (0xffff|NCF_COLUMBIA|NCF_HYRAX)
+#define ALL_NCF_FLAGS (0xffff|NCF_STREAM|NCF_COLUMBIA|NCF_HYRAX)
 
 typedef struct NCCONTROLS {
     NCFLAGS  flags;
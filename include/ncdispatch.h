@@ -183,6 +183,14 @@ EXTERNL int NCDEFAULT_put_varm(int, int, const size_t*,
                const size_t*, const ptrdiff_t*, const ptrdiff_t*,
                const void*, nc_type);
 
+/* varm entries for dispatchers with an efficient get_vars/put_vars */
+EXTERNL int NCBUFFERED_get_varm(int, int, const size_t*,
+               const size_t*, const ptrdiff_t*, const ptrdiff_t*,
+               void*, nc_type);
+EXTERNL int NCBUFFERED_put_varm(int, int, const size_t*,
+               const size_t*, const ptrdiff_t*, const ptrdiff_t*,
+               const void*, nc_type);
+
 /**************************************************/
 /* Forward */
 struct NCHDR;
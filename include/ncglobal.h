@@ -38,6 +38,9 @@ typedef struct NCglobalstate {
 	   equivalent since very sparse */
 	struct NCZ_Plugin** loaded_plugins; /*[H5Z_FILTER_MAX+1]*/
 	size_t loaded_plugins_max; /* plugin filter id index. 0<loaded_plugins_max<=H5Z_FILTER_MAX */
+	size_t nthreads; /* worker threads for chunk transfers; <= 1 => serial */
+	struct NCthreadpool* pool; /* created on first use */
+	size_t maxinflight; /* cap on bytes queued for write-behind per variable; 0 => quarter of the cache size */
     } zarr;
     struct GlobalAWS { /* AWS S3 specific parameters/defaults */
 	char* default_region;
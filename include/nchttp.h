@@ -50,6 +50,16 @@ typedef struct NC_HTTP_STATE {
     } curl;
 } NC_HTTP_STATE;
 
+/* Counters of a block cache, see dhttpcache.c */
+typedef struct NC_HTTP_STATS {
+    unsigned long long requests; /* range requests made */
+    unsigned long long bytes; /* bytes received */
+    unsigned long long hits; /* reads served without a request */
+    unsigned long long misses; /* reads that needed a request */
+} NC_HTTP_STATS;
+
+typedef struct NC_HTTP_CACHE NC_HTTP_CACHE;
+
 /* External API */
 extern int nc_http_open(const char* url, NC_HTTP_STATE** statep);
 extern int nc_http_open_verbose(const char* url, int verbose, NC_HTTP_STATE** statep);
@@ -59,4 +69,12 @@ extern int nc_http_write(NC_HTTP_STATE* state, NCbytes* payload);
 extern int nc_http_close(NC_HTTP_STATE* state);
 extern int nc_http_reset(NC_HTTP_STATE* state);
 
+/* Block cache API */
+extern int nc_http_cache_open(NC_HTTP_STATE* state, long long size, NC_HTTP_STATS* totals, NC_HTTP_CACHE** cachep);
+extern int nc_http_cache_read(NC_HTTP_CACHE* cache, size64_t start, size64_t count, void* buf);
+extern int nc_http_cache_readv(NC_HTTP_CACHE* cache, size_t n, const size64_t* starts, const size64_t* counts, void** bufs);
+extern int nc_http_cache_prefetch(NC_HTTP_CACHE* cache, size64_t start, size64_t count);
+extern void nc_http_cache_stats(NC_HTTP_CACHE* cache, NC_HTTP_STATS* stats);
+extern void nc_http_cache_close(NC_HTTP_CACHE* cache);
+
 #endif /*NCHTTP_H*/
@@ -45,6 +45,10 @@
 #define AWS_FRAG_REGION AWS_RC_REGION
 #define AWS_FRAG_DEFAULT_REGION AWS_RC_DEFAULT_REGION
 
+/* Maximum number of requests kept in flight, each on its own
+   connection, by NC_s3sdkreadobjects and NC_s3sdkwriteobjects */
+#define NC_S3_MAXCONNECTIONS 16
+
 /* Track the server type, if known */
 typedef enum NCS3SVC {NCS3UNK=0, /* unknown */
 	NCS3=1,     /* s3.amazon.aws */
@@ -64,6 +68,7 @@ typedef struct NCS3INFO {
     char* rootkey;
     char* profile;
     NCS3SVC svc;
+    int http; /* 1 => plain http, as for a local S3-compatible server */
 } NCS3INFO;
 
 struct AWSentry {
@@ -105,7 +110,10 @@ DECLSPEC int NC_s3sdkbucketcreate(void* s3client, const char* region, const char
 DECLSPEC int NC_s3sdkbucketdelete(void* s3client, NCS3INFO* info, char** errmsgp);
 DECLSPEC int NC_s3sdkinfo(void* client0, const char* bucket, const char* pathkey, unsigned long long* lenp, char** errmsgp);
 DECLSPEC int NC_s3sdkread(void* client0, const char* bucket, const char* pathkey, unsigned long long start, unsigned long long count, void* content, char** errmsgp);
+DECLSPEC int NC_s3sdkreadobject(void* client0, const char* bucket, const char* pathkey, unsigned long long* lenp, void** contentp, char** errmsgp);
+DECLSPEC int NC_s3sdkreadobjects(void* client0, const char* bucket, size_t n, const char** pathkeys, unsigned long long* lens, void** contents, int* stats, char** errmsgp);
 DECLSPEC int NC_s3sdkwriteobject(void* client0, const char* bucket, const char* pathkey, unsigned long long count, const void* content, char** errmsgp);
+DECLSPEC int NC_s3sdkwriteobjects(void* client0, const char* bucket, size_t n, const char** pathkeys, const unsigned long long* counts, const void** contents, int* stats, char** errmsgp);
 DECLSPEC int NC_s3sdkclose(void* s3client0, char** errmsgp);
 DECLSPEC int NC_s3sdktruncate(void* s3client0, const char* bucket, const char* prefix, char** errmsgp);
 DECLSPEC int NC_s3sdklist(void* s3client0, const char* bucket, const char* prefix, size_t* nkeysp, char*** keysp, char** errmsgp);
@@ -0,0 +1,39 @@
+/*********************************************************************
+ *   Copyright 2018, UCAR/Unidata
+ *   See netcdf/COPYRIGHT file for copying and redistribution conditions.
+ *********************************************************************/
+
+#ifndef NCSIMD_H
+#define NCSIMD_H
+
+/*
+Helpers for loops the compiler should vectorize.
+
+NC_SIMD_CLONES marks a function to be compiled for several
+instruction sets (SSE2, AVX2 and AVX-512); the best version for the
+running processor is selected when the library is loaded.
+
+NC_SIMD_LOOP asserts that the following loop has no dependencies
+between iterations, and NC_SIMD_LOOP_ERR additionally that the loop
+or-reduces into a local int named err. Both need the source file to
+be compiled with -fopenmp-simd (see HAVE_OPENMP_SIMD) and are empty
+otherwise.
+*/
+
+#include "config.h"
+
+#ifdef HAVE_ATTRIBUTE_TARGET_CLONES
+#define NC_SIMD_CLONES __attribute__((target_clones("default","avx2","avx512f")))
+#else
+#define NC_SIMD_CLONES
+#endif
+
+#ifdef HAVE_OPENMP_SIMD
+#define NC_SIMD_LOOP _Pragma("omp simd")
+#define NC_SIMD_LOOP_ERR _Pragma("omp simd reduction(|:err)")
+#else
+#define NC_SIMD_LOOP
+#define NC_SIMD_LOOP_ERR
+#endif
+
+#endif /*NCSIMD_H*/
@@ -0,0 +1,58 @@
+/*
+Copyright (c) 1998-2018 University Corporation for Atmospheric Research/Unidata
+See COPYRIGHT for license information.
+*/
+
+#ifndef NCTHREADPOOL_H
+#define NCTHREADPOOL_H
+
+#include "ncexternl.h"
+
+/*
+A simple fixed size pool of worker threads executing queued
+tasks.  Tasks are submitted as part of a task group so that
+independent users of one pool can each wait for just their own
+tasks.  If the library was built without thread support, or the
+pool has fewer than two threads, tasks are executed immediately
+by ncthreadpoolsubmit in the calling thread.
+*/
+
+/* A task returns an NC_EXXX error code */
+typedef int (*NCtask)(void* arg);
+
+typedef struct NCtaskgroup {
+    size_t pending; /* submitted but not yet completed */
+    int stat;       /* first error returned by any task */
+} NCtaskgroup;
+
+typedef struct NCthreadpool NCthreadpool;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* Create a pool with nthreads workers */
+EXTERNL int ncthreadpoolnew(size_t nthreads, NCthreadpool** poolp);
+
+/* Wait for all queued tasks, then stop the workers and reclaim */
+EXTERNL void ncthreadpoolfree(NCthreadpool* pool);
+
+/* Number of worker threads; 0 => tasks run inline */
+EXTERNL size_t ncthreadpoolsize(NCthreadpool* pool);
+
+/* Initialize a task group */
+EXTERNL void nctaskgroupinit(NCtaskgroup* group);
+
+/* Queue task(arg) as part of group */
+EXTERNL int ncthreadpoolsubmit(NCthreadpool* pool, NCtaskgroup* group, NCtask task, void* arg);
+
+/* Wait until no more than maxpending tasks of group are outstanding.
+   Returns the first error reported by any task of the group
+   and resets it. */
+EXTERNL int ncthreadpoolwait(NCthreadpool* pool, NCtaskgroup* group, size_t maxpending);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /*NCTHREADPOOL_H*/
@@ -0,0 +1,55 @@
+/*
+Copyright (c) 1998-2018 University Corporation for Atmospheric Research/Unidata
+See COPYRIGHT for license information.
+*/
+
+#ifndef NCTHREADSAFE_H
+#define NCTHREADSAFE_H
+
+/*
+With NETCDF_ENABLE_THREADSAFE, the dispatch table of every open
+file is replaced by a table of wrappers (libdispatch/dthreadsafe.c)
+that lock the file around each call into the real table. Opening,
+creating and closing files, and so changing the list of open files,
+hold a global lock.
+
+How calls on one file may overlap is set by the dispatcher in its
+open or create function, in NC.concurrency. A dispatcher that says
+nothing gets NC_CONCURRENT_NONE, which holds the global lock for
+every call; this is what libraries with process wide state, such
+as HDF5, need. Only calls made from outside the library lock
+anything: a call made while the thread already holds a lock, for
+example from the DAP layers into their substrate, is not locked
+again.
+*/
+
+/* Values of NC.concurrency */
+#define NC_CONCURRENT_NONE  0 /* every call holds the global lock */
+#define NC_CONCURRENT_FILES 1 /* calls on one file are serialized */
+#define NC_CONCURRENT_READS 2 /* as _FILES, but reads may overlap */
+#define NC_CONCURRENT_VARS  3 /* as _READS, but reads of one variable are serialized */
+
+struct NC;
+
+#ifdef NETCDF_ENABLE_THREADSAFE
+
+/* The global lock; it is recursive */
+extern void NC_lock_global(void);
+extern void NC_unlock_global(void);
+
+/* Interpose the locking wrappers on the dispatch table of an NC */
+extern int NC_threadsafe_attach(struct NC* ncp);
+/* Undo NC_threadsafe_attach; called by free_NC */
+extern void NC_threadsafe_detach(struct NC* ncp);
+
+#define NC_LOCK_GLOBAL() NC_lock_global()
+#define NC_UNLOCK_GLOBAL() NC_unlock_global()
+
+#else /*!NETCDF_ENABLE_THREADSAFE*/
+
+#define NC_LOCK_GLOBAL()
+#define NC_UNLOCK_GLOBAL()
+
+#endif /*NETCDF_ENABLE_THREADSAFE*/
+
+#endif /*NCTHREADSAFE_H*/
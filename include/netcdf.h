@@ -126,8 +126,10 @@ extern "C" {
    Currently unused in lower 16 bits:
         0x0002
    All upper 16 bits are unused except
+        0x10000, 0x80000-0x2000000 (NC_UDF2-NC_UDF9)
         0x20000
         0x40000
+        0x4000000
 */
 
 /* Lower 16 bits */
@@ -191,6 +193,7 @@ Use this in mode flags for both nc_create() and nc_open(). */
 /* Upper 16 bits */
 #define NC_NOATTCREORD  0x20000 /**< Disable the netcdf-4 (hdf5) attribute creation order tracking */
 #define NC_NODIMSCALE_ATTACH 0x40000 /**< Disable the netcdf-4 (hdf5) attaching of dimscales to variables (#2128) */
+#define NC_LAZY_GROUPS  0x4000000 /**< Read the metadata of a netcdf-4 (hdf5) group when it is first used. Mode flag for nc_open(); ignored with NC_WRITE. */
 
 #define NC_MAX_MAGIC_NUMBER_LEN 8 /**< Max len of user-defined format magic number. */
 /** Maximum number of user-defined format slots (UDF0-UDF9).
@@ -25,8 +25,9 @@
 /**************************************************/
 /* Build To a NumCodecs-style C-API for Filters */
 
-/* Version of the NCZ_codec_t structure */
-#define NCZ_CODEC_CLASS_VER 1
+/* Version of the NCZ_codec_t structure.
+   Version 2 added NCZ_filter_into; version 1 codecs are still accepted. */
+#define NCZ_CODEC_CLASS_VER 2
 
 /* List of the kinds of NCZ_codec_t formats */
 #define NCZ_CODEC_HDF5 1 /* HDF5 <-> Codec converter */
@@ -134,6 +135,24 @@ int (*NCZ_hdf5_to_codec)(size_t nparams, const unsigned* params, char** codecp);
 @param codecp -- (out) store the string representation of the codec; caller must free.
 @return -- a netcdf-c error code.
 
+* Apply the filter from one caller supplied buffer into another (optional; version 2).
+This lets NCZarr run a filter chain in buffers it reuses from chunk to chunk,
+and decode straight into the buffer of a cache entry, instead of having the
+HDF5 filter function allocate a new buffer at every stage.
+
+size_t (*NCZ_filter_into)(unsigned flags, size_t nparams, const unsigned* params, size_t nbytes, const void* src, size_t dstsize, void* dst);
+
+@param flags -- (in) H5Z_FLAG_REVERSE to decode, 0 to encode
+@param nparams -- (in) the number of working parameters
+@param params -- (in) the working parameters, as given to the HDF5 filter function
+@param nbytes -- (in) the number of bytes in src
+@param src -- (in) the data to filter; not modified
+@param dstsize -- (in) the size of dst
+@param dst -- (out) where to store the result; never overlaps src
+@return -- the number of bytes stored in dst, or 0 if the result does not
+           fit or cannot be computed this way; the HDF5 filter function is
+           then applied instead, so it will report any real error.
+
 */
 
 /*
@@ -152,6 +171,8 @@ typedef struct NCZ_codec_t {
     int (*NCZ_codec_to_hdf5)(const char* codec, size_t* nparamsp, unsigned** paramsp);
     int (*NCZ_hdf5_to_codec)(size_t nparams, const unsigned* params, char** codecp);
     int (*NCZ_modify_parameters)(int ncid, int varid, size_t* vnparamsp, unsigned** vparamsp, size_t* wnparamsp, unsigned** wparamsp);
+    /* Version 2 */
+    size_t (*NCZ_filter_into)(unsigned flags, size_t nparams, const unsigned* params, size_t nbytes, const void* src, size_t dstsize, void* dst);
 } NCZ_codec_t;
 
 #ifndef NC_UNUSED
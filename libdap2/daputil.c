@@ -831,6 +831,8 @@ dap_fetch(NCDAPCOMMON* nccomm, OClink conn, const char* ce,
 	ce = NULL;
     if(FLAGSET(nccomm->controls,NCF_ONDISK))
 	ocflags |= OCONDISK;
+    if(FLAGSET(nccomm->controls,NCF_STREAM))
+	ocflags |= OCSTREAM;
     if(FLAGSET(nccomm->controls,NCF_ENCODE_PATH))
 	ocflags |= OCENCODEPATH;
     if(FLAGSET(nccomm->controls,NCF_ENCODE_QUERY))
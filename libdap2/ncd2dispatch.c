@@ -1375,6 +1375,10 @@ applyclientparams(NCDAPCOMMON* nccomm)
 	if(value[0] == 'd' || value[0] == 'D') {
             SETFLAG(nccomm->controls,NCF_ONDISK);
 	}
+	/* e.g. fetch=stream or fetch=disk,stream */
+	if(strstr(value,"stream") != NULL) {
+            SETFLAG(nccomm->controls,NCF_STREAM);
+	}
     }
 
     /* test for the force-whole-var flag */
@@ -644,6 +644,18 @@ nc__create_mp(const char *path, int cmode, size_t initialsz,
  * will read the whole file into memory on nc_open. Thus, MMAP will
  * provide some performance improvement in this case.
  *
+ * The NC_LAZY_GROUPS flag applies to netCDF-4 files opened read-only
+ * (and not for parallel I/O); otherwise it is ignored. With it,
+ * nc_open() reads only the root group's metadata. The dimensions,
+ * variables and types of any other group are read when the group is
+ * first used, for example by nc_inq_varid() with the group's ncid.
+ * Opening a file with very many groups, to read a few variables, is
+ * much faster this way. Finding the length of an unlimited dimension,
+ * or looking up a type by name outside its group, may read the groups
+ * below. Dimension and type IDs from an object in a group not yet
+ * read are not known to the library, so they are not valid until the
+ * group is read.
+ *
  * It is not necessary to pass any information about the format of the
  * file being opened. The file type will be detected automatically by
  * the netCDF library.
@@ -1277,12 +1289,15 @@ int
 nc_abort(int ncid)
 {
     NC* ncp;
-    int stat = NC_check_id(ncid, &ncp);
-    if(stat != NC_NOERR) return stat;
+    int stat;
 
-    stat = ncp->dispatch->abort(ncid);
-    del_from_NCList(ncp);
-    free_NC(ncp);
+    NC_LOCK_GLOBAL();
+    if((stat = NC_check_id(ncid, &ncp)) == NC_NOERR) {
+        stat = ncp->dispatch->abort(ncid);
+        del_from_NCList(ncp);
+        free_NC(ncp);
+    }
+    NC_UNLOCK_GLOBAL();
     return stat;
 }
 
@@ -1330,16 +1345,18 @@ int
 nc_close(int ncid)
 {
     NC* ncp;
-    int stat = NC_check_id(ncid, &ncp);
-    if(stat != NC_NOERR) return stat;
+    int stat;
 
-    stat = ncp->dispatch->close(ncid,NULL);
+    NC_LOCK_GLOBAL();
+    if((stat = NC_check_id(ncid, &ncp)) == NC_NOERR)
+        stat = ncp->dispatch->close(ncid,NULL);
     /* Remove from the nc list */
     if (!stat)
     {
         del_from_NCList(ncp);
         free_NC(ncp);
     }
+    NC_UNLOCK_GLOBAL();
     return stat;
 }
 
@@ -1389,16 +1406,18 @@ int
 nc_close_memio(int ncid, NC_memio* memio)
 {
     NC* ncp;
-    int stat = NC_check_id(ncid, &ncp);
-    if(stat != NC_NOERR) return stat;
+    int stat;
 
-    stat = ncp->dispatch->close(ncid,memio);
+    NC_LOCK_GLOBAL();
+    if((stat = NC_check_id(ncid, &ncp)) == NC_NOERR)
+        stat = ncp->dispatch->close(ncid,memio);
     /* Remove from the nc list */
     if (!stat)
     {
         del_from_NCList(ncp);
         free_NC(ncp);
     }
+    NC_UNLOCK_GLOBAL();
     return stat;
 }
 
@@ -1879,6 +1898,7 @@ NC_create(const char *path0, int cmode, size_t initialsz,
     char* newpath = NULL;
 
     TRACE(nc_create);
+    NC_LOCK_GLOBAL();
     if(path0 == NULL)
         {stat = NC_EINVAL; goto done;}
 
@@ -1978,6 +1998,9 @@ NC_create(const char *path0, int cmode, size_t initialsz,
 
     /* Create the NC* instance and insert its dispatcher and model */
     if((stat = new_NC(dispatcher,path,cmode,&ncp))) goto done;
+#ifdef NETCDF_ENABLE_THREADSAFE
+    if((stat = NC_threadsafe_attach(ncp))) {free_NC(ncp); goto done;}
+#endif
 
     /* Add to list of known open files and define ext_ncid */
     add_to_NCList(ncp);
@@ -1991,6 +2014,7 @@ NC_create(const char *path0, int cmode, size_t initialsz,
         if(ncidp)*ncidp = ncp->ext_ncid;
     }
 done:
+    NC_UNLOCK_GLOBAL();
     nullfree(path);
     nullfree(newpath);
     return stat;
@@ -2034,6 +2058,7 @@ NC_open(const char *path0, int omode, int basepe, size_t *chunksizehintp,
     char* newpath = NULL;
 
     TRACE(nc_open);
+    NC_LOCK_GLOBAL();
     if(!NC_initialized) {
         stat = nc_initialize();
         if(stat) goto done;
@@ -2250,6 +2275,9 @@ NC_open(const char *path0, int omode, int basepe, size_t *chunksizehintp,
 
     /* Create the NC* instance and insert its dispatcher */
     if((stat = new_NC(dispatcher,path,omode,&ncp))) goto done;
+#ifdef NETCDF_ENABLE_THREADSAFE
+    if((stat = NC_threadsafe_attach(ncp))) {free_NC(ncp); goto done;}
+#endif
 
     /* Add to list of known open files. This assigns an ext_ncid. */
     add_to_NCList(ncp);
@@ -2265,6 +2293,7 @@ NC_open(const char *path0, int omode, int basepe, size_t *chunksizehintp,
     }
 
 done:
+    NC_UNLOCK_GLOBAL();
     nullfree(path);
     nullfree(newpath);
     return stat;
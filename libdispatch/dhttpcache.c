@@ -0,0 +1,463 @@
+/**
+ * @file
+ *
+ * Block cache for byte-range reads of a remote object.
+ *
+ * The object is read in blocks, and the most recently used blocks
+ * are kept in memory. The blocks of a read that are not cached are
+ * fetched with a single range request running from the first missing
+ * block to the last; when a read starts where the previous one ended,
+ * that request is extended by a few blocks of read-ahead. Reads larger
+ * than half of the cache bypass it.
+ *
+ * Copyright 2018 University Corporation for Atmospheric
+ * Research/Unidata. See COPYRIGHT file for more info.
+*/
+
+#include "config.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "netcdf.h"
+#include "ncbytes.h"
+#include "nclist.h"
+#include "ncuri.h"
+#include "ncrc.h"
+#include "ncxcache.h"
+#include "nchttp.h"
+
+/* Each setting is taken from the environment variable or, failing
+   that, the .rc key (which may be specific to the host) when the
+   cache is opened. The size of the cache is in blocks, 0 turns it
+   off; read-ahead is in blocks too. */
+#define BLOCKSIZE_ENV "NETCDF_HTTP_BLOCKSIZE"
+#define BLOCKSIZE_RC "NETCDF.HTTP.BLOCKSIZE"
+#define BLOCKSIZE_DEFAULT 65536
+#define BLOCKSIZE_MIN 512
+#define BLOCKSIZE_MAX (64*1024*1024)
+#define BLOCKCACHE_ENV "NETCDF_HTTP_BLOCKCACHE"
+#define BLOCKCACHE_RC "NETCDF.HTTP.BLOCKCACHE"
+#define BLOCKCACHE_DEFAULT 64 /* blocks */
+#define BLOCKCACHE_MAX 65536 /* blocks */
+#define READAHEAD_ENV "NETCDF_HTTP_READAHEAD"
+#define READAHEAD_RC "NETCDF.HTTP.READAHEAD"
+#define READAHEAD_DEFAULT 4 /* blocks */
+
+/* Uncached reads of a vector less than this many bytes apart are
+   merged into one request */
+#define MERGEGAP 4096
+
+/* A block of the object; the NCxnode must come first, see ncxcache.h. */
+typedef struct NCHTTPblock {
+    NCxnode xnode;
+    long long index; /* block number */
+    size_t len; /* short for the last block of the object */
+    char* data;
+} NCHTTPblock;
+
+struct NC_HTTP_CACHE {
+    NC_HTTP_STATE* state; /* not owned */
+    long long size; /* of the object */
+    NCxcache* blocks; /* NULL => no cache */
+    size_t blocksize;
+    size_t maxblocks;
+    size_t readahead; /* blocks */
+    long long next; /* offset just past the previous read */
+    NCbytes* range; /* response of the last range request */
+    NC_HTTP_STATS stats;
+    NC_HTTP_STATS* totals; /* also counted here if not NULL */
+};
+
+#define COUNT(cache,field,n) do{(cache)->stats.field += (n); \
+    if((cache)->totals != NULL) (cache)->totals->field += (n);}while(0)
+
+/* Forward */
+static size_t getparam(NCURI* uri, const char* envkey, const char* rckey, size_t dfalt, size_t max);
+static int rangeread(NC_HTTP_CACHE* cache, long long start, long long count);
+static int fetch(NC_HTTP_CACHE* cache, long long lo, long long hi);
+static int missing(NC_HTTP_CACHE* cache, long long first, long long last, long long* lop, long long* hip);
+static NCHTTPblock* findblock(NC_HTTP_CACHE* cache, long long index, int touch);
+static void dropblock(NC_HTTP_CACHE* cache, NCHTTPblock* block);
+static int copyout(NC_HTTP_CACHE* cache, long long start, long long count, char* buf);
+static long long clip(NC_HTTP_CACHE* cache, size64_t start, size64_t count, void* buf);
+static int cmplonglong(const void* a, const void* b);
+
+/**************************************************/
+
+/**
+Set up a block cache for reads of an open object.
+@param state of the open object; must outlive the cache
+@param size of the object
+@param totals if not NULL, also count requests and hits here
+@param cachep return the cache
+@return NC_NOERR | NC_ENOMEM
+*/
+int
+nc_http_cache_open(NC_HTTP_STATE* state, long long size, NC_HTTP_STATS* totals, NC_HTTP_CACHE** cachep)
+{
+    int stat = NC_NOERR;
+    NC_HTTP_CACHE* cache = NULL;
+
+    if((cache = (NC_HTTP_CACHE*)calloc(1,sizeof(NC_HTTP_CACHE))) == NULL)
+        {stat = NC_ENOMEM; goto done;}
+    cache->state = state;
+    cache->size = size;
+    cache->totals = totals;
+    if((cache->range = ncbytesnew()) == NULL) {stat = NC_ENOMEM; goto done;}
+    cache->blocksize = getparam(state->url,BLOCKSIZE_ENV,BLOCKSIZE_RC,BLOCKSIZE_DEFAULT,BLOCKSIZE_MAX);
+    if(cache->blocksize < BLOCKSIZE_MIN) cache->blocksize = BLOCKSIZE_MIN;
+    cache->maxblocks = getparam(state->url,BLOCKCACHE_ENV,BLOCKCACHE_RC,BLOCKCACHE_DEFAULT,BLOCKCACHE_MAX);
+    cache->readahead = getparam(state->url,READAHEAD_ENV,READAHEAD_RC,READAHEAD_DEFAULT,BLOCKCACHE_MAX);
+    if(cache->maxblocks > 0) {
+        if((stat = ncxcachenew(0,&cache->blocks))) goto done;
+    }
+    if(cachep) {*cachep = cache; cache = NULL;}
+done:
+    nc_http_cache_close(cache);
+    return stat;
+}
+
+/**
+Read count bytes from start into buf. Bytes past the end of the
+object read as zeros.
+@return NC_NOERR | NC_EIO | NC_ECURL | NC_ENOMEM
+*/
+int
+nc_http_cache_read(NC_HTTP_CACHE* cache, size64_t start, size64_t count, void* buf)
+{
+    int stat = NC_NOERR;
+    long long bs, first, last, lo, hi, n;
+    int sequential;
+
+    if((n = clip(cache,start,count,buf)) == 0) goto done;
+    bs = (long long)cache->blocksize;
+    first = (long long)start / bs;
+    last = ((long long)start + n - 1) / bs;
+    sequential = ((long long)start >= cache->next && (long long)start < cache->next + bs);
+    cache->next = (long long)start + n;
+
+    if(cache->blocks == NULL || (size_t)(last - first + 1) > cache->maxblocks / 2) {
+        /* Read directly */
+        COUNT(cache,misses,1);
+        if((stat = rangeread(cache,(long long)start,n))) goto done;
+        memcpy(buf,ncbytescontents(cache->range),(size_t)n);
+        goto done;
+    }
+    if((stat = missing(cache,first,last,&lo,&hi))) goto done;
+    if(lo < 0) {
+        COUNT(cache,hits,1);
+    } else {
+        COUNT(cache,misses,1);
+        if(sequential && cache->readahead > 0) {
+            /* Read ahead, as long as this read's blocks still fit */
+            long long lastblock = (cache->size + bs - 1) / bs - 1;
+            hi = last + (long long)cache->readahead;
+            if(hi > first + (long long)cache->maxblocks - 1)
+                hi = first + (long long)cache->maxblocks - 1;
+            if(hi > lastblock) hi = lastblock;
+        }
+        if((stat = fetch(cache,lo,hi))) goto done;
+    }
+    stat = copyout(cache,(long long)start,n,(char*)buf);
+done:
+    return stat;
+}
+
+/**
+Read several pieces of the object at once. The missing blocks of all
+the pieces are fetched together, with blocks that are next to each
+other in one request; pieces too large for the cache are read
+directly, with pieces close to each other in one request.
+@param n number of pieces
+@param starts offset of each piece
+@param counts length of each piece
+@param bufs where to put each piece
+@return NC_NOERR | NC_EIO | NC_ECURL | NC_ENOMEM
+*/
+int
+nc_http_cache_readv(NC_HTTP_CACHE* cache, size_t n, const size64_t* starts, const size64_t* counts, void** bufs)
+{
+    int stat = NC_NOERR;
+    long long bs = (long long)cache->blocksize;
+    long long* lens = NULL;
+    long long* need = NULL;
+    size_t* order = NULL;
+    size_t i, j, nneed = 0, span = 0;
+
+    if(n == 0) goto done;
+    if((lens = (long long*)calloc(n,sizeof(long long))) == NULL) {stat = NC_ENOMEM; goto done;}
+    for(i=0;i<n;i++) {
+        lens[i] = clip(cache,starts[i],counts[i],bufs[i]);
+        if(lens[i] > 0)
+            span += (size_t)(((long long)starts[i] + lens[i] - 1) / bs - (long long)starts[i] / bs + 1);
+    }
+    if(cache->blocks != NULL && span <= cache->maxblocks / 2) {
+        /* Gather the missing blocks, keeping the cached ones from eviction */
+        if((need = (long long*)malloc(span*sizeof(long long))) == NULL) {stat = NC_ENOMEM; goto done;}
+        for(i=0;i<n;i++) {
+            long long b, first, last;
+            int hit = 1;
+            if(lens[i] == 0) continue;
+            first = (long long)starts[i] / bs;
+            last = ((long long)starts[i] + lens[i] - 1) / bs;
+            for(b=first;b<=last;b++) {
+                if(findblock(cache,b,1) == NULL) {need[nneed++] = b; hit = 0;}
+            }
+            if(hit) COUNT(cache,hits,1); else COUNT(cache,misses,1);
+        }
+        qsort(need,nneed,sizeof(long long),cmplonglong);
+        for(i=0;i<nneed;i=j) {
+            for(j=i+1;j<nneed && need[j] <= need[j-1] + 1;j++);
+            if((stat = fetch(cache,need[i],need[j-1]))) goto done;
+        }
+        for(i=0;i<n;i++) {
+            if(lens[i] > 0 && (stat = copyout(cache,(long long)starts[i],lens[i],(char*)bufs[i])))
+                goto done;
+        }
+    } else {
+        /* Read directly, merging pieces that are close together */
+        if((order = (size_t*)malloc(n*sizeof(size_t))) == NULL) {stat = NC_ENOMEM; goto done;}
+        for(i=0;i<n;i++) order[i] = i;
+        for(i=1;i<n;i++) { /* insertion sort by start; vectors are short */
+            size_t o = order[i];
+            for(j=i;j>0 && starts[order[j-1]] > starts[o];j--) order[j] = order[j-1];
+            order[j] = o;
+        }
+        for(i=0;i<n;i=j) {
+            long long lo = (long long)starts[order[i]];
+            long long hi = lo + lens[order[i]];
+            for(j=i+1;j<n && (long long)starts[order[j]] <= hi + MERGEGAP;j++) {
+                long long end = (long long)starts[order[j]] + lens[order[j]];
+                if(end > hi) hi = end;
+            }
+            if(hi == lo) continue; /* all empty */
+            COUNT(cache,misses,(unsigned long long)(j - i));
+            if((stat = rangeread(cache,lo,hi - lo))) goto done;
+            for(;i<j;i++) {
+                size_t k = order[i];
+                if(lens[k] > 0)
+                    memcpy(bufs[k],ncbytescontents(cache->range) + ((long long)starts[k] - lo),(size_t)lens[k]);
+            }
+        }
+    }
+done:
+    if(lens) free(lens);
+    if(need) free(need);
+    if(order) free(order);
+    return stat;
+}
+
+/**
+Bring a range of the object into the cache with one request, without
+reading it; limited to half of the cache.
+@return NC_NOERR | NC_EIO | NC_ECURL | NC_ENOMEM
+*/
+int
+nc_http_cache_prefetch(NC_HTTP_CACHE* cache, size64_t start, size64_t count)
+{
+    int stat = NC_NOERR;
+    long long bs, first, last, lastblock, lo, hi;
+
+    if(cache->blocks == NULL || count == 0 || (long long)start >= cache->size) goto done;
+    bs = (long long)cache->blocksize;
+    lastblock = (cache->size + bs - 1) / bs - 1;
+    first = (long long)start / bs;
+    last = ((long long)(start + count) - 1) / bs;
+    if(last > lastblock) last = lastblock;
+    if(last > first + (long long)(cache->maxblocks / 2) - 1)
+        last = first + (long long)(cache->maxblocks / 2) - 1;
+    if(last < first) goto done;
+    if((stat = missing(cache,first,last,&lo,&hi))) goto done;
+    if(lo >= 0)
+        stat = fetch(cache,lo,hi);
+done:
+    return stat;
+}
+
+/** Get the counters of a cache */
+void
+nc_http_cache_stats(NC_HTTP_CACHE* cache, NC_HTTP_STATS* stats)
+{
+    if(cache != NULL && stats != NULL)
+        *stats = cache->stats;
+}
+
+/** Free a cache and its blocks */
+void
+nc_http_cache_close(NC_HTTP_CACHE* cache)
+{
+    NCHTTPblock* block;
+    if(cache == NULL) return;
+    if(cache->blocks != NULL) {
+        while((block = (NCHTTPblock*)ncxcachelast(cache->blocks)) != NULL)
+            dropblock(cache,block);
+        ncxcachefree(cache->blocks);
+    }
+    ncbytesfree(cache->range);
+    free(cache);
+}
+
+/**************************************************/
+
+/* Get a non-negative size_t setting from the environment or the .rc file */
+static size_t
+getparam(NCURI* uri, const char* envkey, const char* rckey, size_t dfalt, size_t max)
+{
+    const char* value = getenv(envkey);
+    if(value == NULL)
+        value = (uri != NULL ? NC_rclookupx(uri,rckey) : NC_rclookup(rckey,NULL,NULL));
+    if(value != NULL) {
+        long long n = strtoll(value,NULL,10);
+        if(n >= 0)
+            dfalt = ((unsigned long long)n > max ? max : (size_t)n);
+    }
+    return dfalt;
+}
+
+/* Read a range of the object into cache->range */
+static int
+rangeread(NC_HTTP_CACHE* cache, long long start, long long count)
+{
+    int stat = NC_NOERR;
+    ncbytesclear(cache->range);
+    ncbytessetalloc(cache->range,(unsigned long)count);
+    COUNT(cache,requests,1);
+    if((stat = nc_http_read(cache->state,(size64_t)start,(size64_t)count,cache->range)))
+        goto done;
+    COUNT(cache,bytes,ncbyteslength(cache->range));
+    if(ncbyteslength(cache->range) != (size_t)count) stat = NC_EIO;
+done:
+    return stat;
+}
+
+/* Read blocks lo through hi with one range request and cache them */
+static int
+fetch(NC_HTTP_CACHE* cache, long long lo, long long hi)
+{
+    int stat = NC_NOERR;
+    long long bs = (long long)cache->blocksize;
+    long long start = lo * bs;
+    long long stop = (hi + 1) * bs;
+    long long b;
+
+    if(stop > cache->size) stop = cache->size;
+    if((stat = rangeread(cache,start,stop - start))) goto done;
+    for(b=lo;b<=hi;b++) {
+        NCHTTPblock* block = NULL;
+        size_t len = (size_t)((b + 1) * bs > stop ? stop - b * bs : bs);
+        if(findblock(cache,b,1) != NULL)
+            continue; /* already cached */
+        /* Make room by evicting the least recently used block */
+        while(ncxcachecount(cache->blocks) >= cache->maxblocks) {
+            NCHTTPblock* victim = (NCHTTPblock*)ncxcachelast(cache->blocks);
+            if(victim == NULL) break;
+            dropblock(cache,victim);
+        }
+        if((block = (NCHTTPblock*)calloc(1,sizeof(NCHTTPblock))) == NULL
+           || (block->data = (char*)malloc(len)) == NULL) {
+            if(block) free(block);
+            stat = NC_ENOMEM;
+            goto done;
+        }
+        block->index = b;
+        block->len = len;
+        memcpy(block->data,ncbytescontents(cache->range) + (b - lo) * bs,len);
+        if((stat = ncxcacheinsert(cache->blocks,ncxcachekey(&b,sizeof(b)),block))) {
+            free(block->data);
+            free(block);
+            goto done;
+        }
+    }
+done:
+    return stat;
+}
+
+/* Find the first and last blocks in [first,last] that are not cached,
+   or -1; the cached ones become the most recently used. */
+static int
+missing(NC_HTTP_CACHE* cache, long long first, long long last, long long* lop, long long* hip)
+{
+    long long b, lo = -1, hi = -1;
+    for(b=first;b<=last;b++) {
+        if(findblock(cache,b,1) == NULL) {
+            if(lo < 0) lo = b;
+            hi = b;
+        }
+    }
+    *lop = lo;
+    *hip = hi;
+    return NC_NOERR;
+}
+
+/* Find a cached block; if touch, also make it the most recently used */
+static NCHTTPblock*
+findblock(NC_HTTP_CACHE* cache, long long index, int touch)
+{
+    void* obj = NULL;
+    ncexhashkey_t hkey = ncxcachekey(&index,sizeof(index));
+    if(ncxcachelookup(cache->blocks,hkey,&obj) != NC_NOERR)
+        return NULL;
+    if(((NCHTTPblock*)obj)->index != index) {
+        /* Hash collision: drop the other block */
+        dropblock(cache,(NCHTTPblock*)obj);
+        return NULL;
+    }
+    if(touch)
+        (void)ncxcachetouch(cache->blocks,hkey);
+    return (NCHTTPblock*)obj;
+}
+
+static void
+dropblock(NC_HTTP_CACHE* cache, NCHTTPblock* block)
+{
+    (void)ncxcacheremove(cache->blocks,ncxcachekey(&block->index,sizeof(block->index)),NULL);
+    free(block->data);
+    free(block);
+}
+
+/* Copy a range, all of whose blocks are cached, into buf */
+static int
+copyout(NC_HTTP_CACHE* cache, long long start, long long count, char* buf)
+{
+    long long bs = (long long)cache->blocksize;
+    long long first = start / bs;
+    long long last = (start + count - 1) / bs;
+    long long b;
+
+    for(b=first;b<=last;b++) {
+        NCHTTPblock* block = findblock(cache,b,0);
+        long long lo = (b == first ? start - b * bs : 0);
+        long long hi = (b == last ? start + count - b * bs : bs);
+        if(block == NULL || hi > (long long)block->len) return NC_EIO;
+        memcpy(buf + (b * bs + lo - start),block->data + lo,(size_t)(hi - lo));
+    }
+    return NC_NOERR;
+}
+
+/* Zero the part of buf past the end of the object and return the
+   number of bytes to read */
+static long long
+clip(NC_HTTP_CACHE* cache, size64_t start, size64_t count, void* buf)
+{
+    if(count == 0) return 0;
+    if((long long)start >= cache->size) {
+        memset(buf,0,(size_t)count);
+        return 0;
+    }
+    if((long long)(start + count) > cache->size) {
+        long long n = cache->size - (long long)start;
+        memset((char*)buf + n,0,(size_t)((long long)count - n));
+        return n;
+    }
+    return (long long)count;
+}
+
+static int
+cmplonglong(const void* a, const void* b)
+{
+    long long x = *(const long long*)a;
+    long long y = *(const long long*)b;
+    return (x < y ? -1 : (x > y ? 1 : 0));
+}
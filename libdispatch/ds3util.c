@@ -98,6 +98,7 @@ NC_s3urlrebuild(NCURI* url, NCS3INFO* s3, NCURI** newurlp)
     char* path = NULL;
     char* region = NULL;
     NCS3SVC svc = NCS3UNK;
+    int http = 0;
     
     if(url == NULL)
         {stat = NC_EURL; goto done;}
@@ -243,8 +244,10 @@ NC_s3urlrebuild(NCURI* url, NCS3INFO* s3, NCURI** newurlp)
     /* clone the url so we can modify it*/
     if((newurl=ncuriclone(url))==NULL) {stat = NC_ENOMEM; goto done;}
 
-    /* Modify the URL to canonical form */
-    ncurisetprotocol(newurl,"https");
+    /* Modify the URL to canonical form; only a host other than
+       AWS or Google may keep a plain http url */
+    if(svc == NCS3UNK && strcasecmp(url->protocol,"http")==0) http = 1;
+    ncurisetprotocol(newurl,(http?"http":"https"));
     assert(host != NULL);
     ncurisethost(newurl,host);
     assert(path != NULL);
@@ -264,6 +267,7 @@ NC_s3urlrebuild(NCURI* url, NCS3INFO* s3, NCURI** newurlp)
         s3->bucket = bucket; bucket = NULL;
         s3->region = region; region = NULL;
         s3->svc = svc;
+        s3->http = http;
     }
 done:
     nullfree(region);
@@ -344,6 +348,7 @@ NC_s3clone(NCS3INFO* s3, NCS3INFO** news3p)
 	if((news3->bucket = nulldup(s3->bucket))==NULL) return NC_ENOMEM;
 	if((news3->rootkey = nulldup(s3->rootkey))==NULL) return NC_ENOMEM;
 	if((news3->profile = nulldup(s3->profile))==NULL) return NC_ENOMEM;
+	news3->http = s3->http;
     }
     if(news3p) {*news3p = news3; news3 = NULL;}
     else {NC_s3clear(news3); nullfree(news3);}
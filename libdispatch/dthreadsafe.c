@@ -0,0 +1,661 @@
+/*
+  Copyright (c) 1998-2018 University Corporation for Atmospheric Research/Unidata
+  See LICENSE.txt for license information.
+*/
+
+/** \file \internal
+    The thread-safe layer.
+
+    With NETCDF_ENABLE_THREADSAFE, NC_open and NC_create interpose a
+    table of wrappers on the dispatch table of each file. Each
+    wrapper locks the file according to NC.concurrency (see
+    ncthreadsafe.h), calls the same member of the file's own table,
+    and unlocks. The locks are:
+
+    - a global recursive mutex, held by open, create, close and
+      abort, and by every call on a file of NC_CONCURRENT_NONE;
+    - a reader/writer lock per file; calls that only look at the
+      file take it shared when the dispatcher allows it;
+    - a small array of mutexes per file, indexed by varid, taken by
+      reads of NC_CONCURRENT_VARS files so that reads of one variable
+      are serialized while reads of different variables overlap.
+
+    A thread holding a file lock never waits for the global lock,
+    so close (global, then file) cannot deadlock against a call in
+    progress. Calls made by the library itself while the thread
+    already holds a lock are not locked again; the nesting depth is
+    kept per thread.
+
+    Closing a file while other threads are still using its ncid is
+    an error, as it is with a single thread: close waits for calls
+    already holding the file lock, but not for calls that have not
+    got that far.
+*/
+
+#include "config.h"
+
+#ifdef NETCDF_ENABLE_THREADSAFE
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "ncdispatch.h"
+
+/* Number of variable locks per file; a power of 2 */
+#define NC_VARLOCKS 16
+
+/* Most dispatch tables that can be in use at once */
+#define NC_MAXTABLES 16
+
+/* What a call does to the file */
+#define TS_WRITE 0 /* anything that may change the in-memory state */
+#define TS_READ  1 /* an inquiry that changes nothing */
+#define TS_VREAD 2 /* a read of the data of one variable */
+
+struct NClock {
+    const NC_Dispatch* dispatch; /* the file's own table */
+    pthread_rwlock_t file;
+    pthread_mutex_t vars[NC_VARLOCKS];
+};
+
+static pthread_once_t tsonce = PTHREAD_ONCE_INIT;
+static pthread_mutex_t globallock;
+static pthread_key_t depthkey; /* number of calls in progress in this thread */
+
+static struct NCwrapped {
+    const NC_Dispatch* dispatch;
+    NC_Dispatch wrapped;
+} tables[NC_MAXTABLES];
+static int ntables = 0;
+
+static void
+tsinitialize(void)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr,PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&globallock,&attr);
+    pthread_mutexattr_destroy(&attr);
+    (void)pthread_key_create(&depthkey,NULL);
+}
+
+void
+NC_lock_global(void)
+{
+    pthread_once(&tsonce,tsinitialize);
+    pthread_mutex_lock(&globallock);
+}
+
+void
+NC_unlock_global(void)
+{
+    pthread_mutex_unlock(&globallock);
+}
+
+/**************************************************/
+/* Locking */
+
+static void
+tslock(NC* ncp, int varid, int op)
+{
+    switch (ncp->concurrency) {
+    case NC_CONCURRENT_FILES:
+        pthread_rwlock_wrlock(&ncp->lock->file);
+        break;
+    case NC_CONCURRENT_READS:
+    case NC_CONCURRENT_VARS:
+        if(op == TS_WRITE)
+            pthread_rwlock_wrlock(&ncp->lock->file);
+        else
+            pthread_rwlock_rdlock(&ncp->lock->file);
+        if(op == TS_VREAD && ncp->concurrency == NC_CONCURRENT_VARS)
+            pthread_mutex_lock(&ncp->lock->vars[(unsigned)varid & (NC_VARLOCKS-1)]);
+        break;
+    default:
+        pthread_mutex_lock(&globallock);
+        break;
+    }
+}
+
+static void
+tsunlock(NC* ncp, int varid, int op)
+{
+    switch (ncp->concurrency) {
+    case NC_CONCURRENT_FILES:
+        pthread_rwlock_unlock(&ncp->lock->file);
+        break;
+    case NC_CONCURRENT_READS:
+    case NC_CONCURRENT_VARS:
+        if(op == TS_VREAD && ncp->concurrency == NC_CONCURRENT_VARS)
+            pthread_mutex_unlock(&ncp->lock->vars[(unsigned)varid & (NC_VARLOCKS-1)]);
+        pthread_rwlock_unlock(&ncp->lock->file);
+        break;
+    default:
+        pthread_mutex_unlock(&globallock);
+        break;
+    }
+}
+
+/* Find the file and, for the outermost call of this thread, lock it */
+static int
+tsenter(int ncid, int varid, int op, NC** ncpp)
+{
+    intptr_t depth = (intptr_t)pthread_getspecific(depthkey);
+    int stat = NC_check_id(ncid,ncpp);
+    if(stat != NC_NOERR) return stat;
+    if(depth == 0)
+        tslock(*ncpp,varid,op);
+    pthread_setspecific(depthkey,(void*)(depth+1));
+    return NC_NOERR;
+}
+
+static void
+tsleave(NC* ncp, int varid, int op)
+{
+    intptr_t depth = (intptr_t)pthread_getspecific(depthkey) - 1;
+    pthread_setspecific(depthkey,(void*)depth);
+    if(depth == 0)
+        tsunlock(ncp,varid,op);
+}
+
+/* Body of a wrapper: call member fcn of the file's own table */
+#define TSCALL(op,ncid,varid,fcn,args) \
+    NC* ncp = NULL; \
+    int stat; \
+    if((stat = tsenter((ncid),(varid),(op),&ncp))) return stat; \
+    stat = ncp->lock->dispatch->fcn args; \
+    tsleave(ncp,(varid),(op)); \
+    return stat
+
+/**************************************************/
+/* Wrappers, in the order of NC_Dispatch */
+
+static int
+TS_redef(int ncid)
+{TSCALL(TS_WRITE,ncid,0,redef,(ncid));}
+
+static int
+TS__enddef(int ncid, size_t h_minfree, size_t v_align, size_t v_minfree, size_t r_align)
+{TSCALL(TS_WRITE,ncid,0,_enddef,(ncid,h_minfree,v_align,v_minfree,r_align));}
+
+static int
+TS_sync(int ncid)
+{TSCALL(TS_WRITE,ncid,0,sync,(ncid));}
+
+static int
+TS_abort(int ncid)
+{TSCALL(TS_WRITE,ncid,0,abort,(ncid));}
+
+static int
+TS_close(int ncid, void* params)
+{TSCALL(TS_WRITE,ncid,0,close,(ncid,params));}
+
+static int
+TS_set_fill(int ncid, int fillmode, int* old)
+{TSCALL(TS_WRITE,ncid,0,set_fill,(ncid,fillmode,old));}
+
+static int
+TS_inq_format(int ncid, int* formatp)
+{TSCALL(TS_READ,ncid,0,inq_format,(ncid,formatp));}
+
+static int
+TS_inq_format_extended(int ncid, int* formatp, int* modep)
+{TSCALL(TS_READ,ncid,0,inq_format_extended,(ncid,formatp,modep));}
+
+/* The number of attributes may be read lazily */
+static int
+TS_inq(int ncid, int* ndimsp, int* nvarsp, int* nattsp, int* unlimdimidp)
+{TSCALL(TS_WRITE,ncid,0,inq,(ncid,ndimsp,nvarsp,nattsp,unlimdimidp));}
+
+static int
+TS_inq_type(int ncid, nc_type xtype, char* name, size_t* sizep)
+{TSCALL(TS_READ,ncid,0,inq_type,(ncid,xtype,name,sizep));}
+
+static int
+TS_def_dim(int ncid, const char* name, size_t len, int* idp)
+{TSCALL(TS_WRITE,ncid,0,def_dim,(ncid,name,len,idp));}
+
+static int
+TS_inq_dimid(int ncid, const char* name, int* idp)
+{TSCALL(TS_READ,ncid,0,inq_dimid,(ncid,name,idp));}
+
+static int
+TS_inq_dim(int ncid, int dimid, char* name, size_t* lenp)
+{TSCALL(TS_READ,ncid,0,inq_dim,(ncid,dimid,name,lenp));}
+
+static int
+TS_inq_unlimdim(int ncid, int* unlimdimidp)
+{TSCALL(TS_READ,ncid,0,inq_unlimdim,(ncid,unlimdimidp));}
+
+static int
+TS_rename_dim(int ncid, int dimid, const char* name)
+{TSCALL(TS_WRITE,ncid,0,rename_dim,(ncid,dimid,name));}
+
+/* Attributes are decoded lazily, so even inquiries are writes */
+static int
+TS_inq_att(int ncid, int varid, const char* name, nc_type* xtypep, size_t* lenp)
+{TSCALL(TS_WRITE,ncid,varid,inq_att,(ncid,varid,name,xtypep,lenp));}
+
+static int
+TS_inq_attid(int ncid, int varid, const char* name, int* idp)
+{TSCALL(TS_WRITE,ncid,varid,inq_attid,(ncid,varid,name,idp));}
+
+static int
+TS_inq_attname(int ncid, int varid, int attnum, char* name)
+{TSCALL(TS_WRITE,ncid,varid,inq_attname,(ncid,varid,attnum,name));}
+
+static int
+TS_rename_att(int ncid, int varid, const char* name, const char* newname)
+{TSCALL(TS_WRITE,ncid,varid,rename_att,(ncid,varid,name,newname));}
+
+static int
+TS_del_att(int ncid, int varid, const char* name)
+{TSCALL(TS_WRITE,ncid,varid,del_att,(ncid,varid,name));}
+
+static int
+TS_get_att(int ncid, int varid, const char* name, void* value, nc_type memtype)
+{TSCALL(TS_WRITE,ncid,varid,get_att,(ncid,varid,name,value,memtype));}
+
+static int
+TS_put_att(int ncid, int varid, const char* name, nc_type xtype, size_t len,
+           const void* value, nc_type memtype)
+{TSCALL(TS_WRITE,ncid,varid,put_att,(ncid,varid,name,xtype,len,value,memtype));}
+
+static int
+TS_def_var(int ncid, const char* name, nc_type xtype, int ndims,
+           const int* dimidsp, int* varidp)
+{TSCALL(TS_WRITE,ncid,0,def_var,(ncid,name,xtype,ndims,dimidsp,varidp));}
+
+static int
+TS_inq_varid(int ncid, const char* name, int* varidp)
+{TSCALL(TS_READ,ncid,0,inq_varid,(ncid,name,varidp));}
+
+static int
+TS_rename_var(int ncid, int varid, const char* name)
+{TSCALL(TS_WRITE,ncid,varid,rename_var,(ncid,varid,name));}
+
+static int
+TS_get_vara(int ncid, int varid, const size_t* start, const size_t* edges,
+            void* value, nc_type memtype)
+{TSCALL(TS_VREAD,ncid,varid,get_vara,(ncid,varid,start,edges,value,memtype));}
+
+static int
+TS_put_vara(int ncid, int varid, const size_t* start, const size_t* edges,
+            const void* value, nc_type memtype)
+{TSCALL(TS_WRITE,ncid,varid,put_vara,(ncid,varid,start,edges,value,memtype));}
+
+static int
+TS_get_vars(int ncid, int varid, const size_t* start, const size_t* edges,
+            const ptrdiff_t* stride, void* value, nc_type memtype)
+{TSCALL(TS_VREAD,ncid,varid,get_vars,(ncid,varid,start,edges,stride,value,memtype));}
+
+static int
+TS_put_vars(int ncid, int varid, const size_t* start, const size_t* edges,
+            const ptrdiff_t* stride, const void* value, nc_type memtype)
+{TSCALL(TS_WRITE,ncid,varid,put_vars,(ncid,varid,start,edges,stride,value,memtype));}
+
+static int
+TS_get_varm(int ncid, int varid, const size_t* start, const size_t* edges,
+            const ptrdiff_t* stride, const ptrdiff_t* imap, void* value,
+            nc_type memtype)
+{TSCALL(TS_VREAD,ncid,varid,get_varm,(ncid,varid,start,edges,stride,imap,value,memtype));}
+
+static int
+TS_put_varm(int ncid, int varid, const size_t* start, const size_t* edges,
+            const ptrdiff_t* stride, const ptrdiff_t* imap, const void* value,
+            nc_type memtype)
+{TSCALL(TS_WRITE,ncid,varid,put_varm,(ncid,varid,start,edges,stride,imap,value,memtype));}
+
+/* The fill value and the attributes may be read lazily */
+static int
+TS_inq_var_all(int ncid, int varid, char* name, nc_type* xtypep,
+               int* ndimsp, int* dimidsp, int* nattsp,
+               int* shufflep, int* deflatep, int* deflate_levelp,
+               int* fletcher32p, int* contiguousp, size_t* chunksizesp,
+               int* no_fill, void* fill_valuep, int* endiannessp,
+               unsigned int* idp, size_t* nparamsp, unsigned int* params)
+{TSCALL(TS_WRITE,ncid,varid,inq_var_all,(ncid,varid,name,xtypep,ndimsp,dimidsp,
+        nattsp,shufflep,deflatep,deflate_levelp,fletcher32p,contiguousp,
+        chunksizesp,no_fill,fill_valuep,endiannessp,idp,nparamsp,params));}
+
+static int
+TS_var_par_access(int ncid, int varid, int par_access)
+{TSCALL(TS_WRITE,ncid,varid,var_par_access,(ncid,varid,par_access));}
+
+static int
+TS_def_var_fill(int ncid, int varid, int no_fill, const void* fill_value)
+{TSCALL(TS_WRITE,ncid,varid,def_var_fill,(ncid,varid,no_fill,fill_value));}
+
+static int
+TS_show_metadata(int ncid)
+{TSCALL(TS_WRITE,ncid,0,show_metadata,(ncid));}
+
+static int
+TS_inq_unlimdims(int ncid, int* nunlimdimsp, int* unlimdimidsp)
+{TSCALL(TS_READ,ncid,0,inq_unlimdims,(ncid,nunlimdimsp,unlimdimidsp));}
+
+static int
+TS_inq_ncid(int ncid, const char* name, int* grp_ncid)
+{TSCALL(TS_READ,ncid,0,inq_ncid,(ncid,name,grp_ncid));}
+
+static int
+TS_inq_grps(int ncid, int* numgrps, int* ncids)
+{TSCALL(TS_READ,ncid,0,inq_grps,(ncid,numgrps,ncids));}
+
+static int
+TS_inq_grpname(int ncid, char* name)
+{TSCALL(TS_READ,ncid,0,inq_grpname,(ncid,name));}
+
+static int
+TS_inq_grpname_full(int ncid, size_t* lenp, char* full_name)
+{TSCALL(TS_READ,ncid,0,inq_grpname_full,(ncid,lenp,full_name));}
+
+static int
+TS_inq_grp_parent(int ncid, int* parent_ncid)
+{TSCALL(TS_READ,ncid,0,inq_grp_parent,(ncid,parent_ncid));}
+
+static int
+TS_inq_grp_full_ncid(int ncid, const char* full_name, int* grp_ncid)
+{TSCALL(TS_READ,ncid,0,inq_grp_full_ncid,(ncid,full_name,grp_ncid));}
+
+static int
+TS_inq_varids(int ncid, int* nvars, int* varids)
+{TSCALL(TS_READ,ncid,0,inq_varids,(ncid,nvars,varids));}
+
+static int
+TS_inq_dimids(int ncid, int* ndims, int* dimids, int include_parents)
+{TSCALL(TS_READ,ncid,0,inq_dimids,(ncid,ndims,dimids,include_parents));}
+
+static int
+TS_inq_typeids(int ncid, int* ntypes, int* typeids)
+{TSCALL(TS_READ,ncid,0,inq_typeids,(ncid,ntypes,typeids));}
+
+/* Only the first file is locked; types are not changed once defined */
+static int
+TS_inq_type_equal(int ncid1, nc_type typeid1, int ncid2, nc_type typeid2, int* equal)
+{TSCALL(TS_READ,ncid1,0,inq_type_equal,(ncid1,typeid1,ncid2,typeid2,equal));}
+
+static int
+TS_def_grp(int parent_ncid, const char* name, int* new_ncid)
+{TSCALL(TS_WRITE,parent_ncid,0,def_grp,(parent_ncid,name,new_ncid));}
+
+static int
+TS_rename_grp(int grpid, const char* name)
+{TSCALL(TS_WRITE,grpid,0,rename_grp,(grpid,name));}
+
+static int
+TS_inq_user_type(int ncid, nc_type xtype, char* name, size_t* size,
+                 nc_type* base_nc_typep, size_t* nfieldsp, int* classp)
+{TSCALL(TS_READ,ncid,0,inq_user_type,(ncid,xtype,name,size,base_nc_typep,nfieldsp,classp));}
+
+static int
+TS_inq_typeid(int ncid, const char* name, nc_type* typeidp)
+{TSCALL(TS_READ,ncid,0,inq_typeid,(ncid,name,typeidp));}
+
+static int
+TS_def_compound(int ncid, size_t size, const char* name, nc_type* typeidp)
+{TSCALL(TS_WRITE,ncid,0,def_compound,(ncid,size,name,typeidp));}
+
+static int
+TS_insert_compound(int ncid, nc_type xtype, const char* name, size_t offset,
+                   nc_type field_typeid)
+{TSCALL(TS_WRITE,ncid,0,insert_compound,(ncid,xtype,name,offset,field_typeid));}
+
+static int
+TS_insert_array_compound(int ncid, nc_type xtype, const char* name,
+                         size_t offset, nc_type field_typeid, int ndims,
+                         const int* dim_sizes)
+{TSCALL(TS_WRITE,ncid,0,insert_array_compound,(ncid,xtype,name,offset,field_typeid,ndims,dim_sizes));}
+
+static int
+TS_inq_compound_field(int ncid, nc_type xtype, int fieldid, char* name,
+                      size_t* offsetp, nc_type* field_typeidp, int* ndimsp,
+                      int* dim_sizesp)
+{TSCALL(TS_READ,ncid,0,inq_compound_field,(ncid,xtype,fieldid,name,offsetp,field_typeidp,ndimsp,dim_sizesp));}
+
+static int
+TS_inq_compound_fieldindex(int ncid, nc_type xtype, const char* name, int* fieldidp)
+{TSCALL(TS_READ,ncid,0,inq_compound_fieldindex,(ncid,xtype,name,fieldidp));}
+
+static int
+TS_def_vlen(int ncid, const char* name, nc_type base_typeid, nc_type* xtypep)
+{TSCALL(TS_WRITE,ncid,0,def_vlen,(ncid,name,base_typeid,xtypep));}
+
+static int
+TS_put_vlen_element(int ncid, int typeid1, void* vlen_element, size_t len,
+                    const void* data)
+{TSCALL(TS_WRITE,ncid,0,put_vlen_element,(ncid,typeid1,vlen_element,len,data));}
+
+static int
+TS_get_vlen_element(int ncid, int typeid1, const void* vlen_element,
+                    size_t* len, void* data)
+{TSCALL(TS_WRITE,ncid,0,get_vlen_element,(ncid,typeid1,vlen_element,len,data));}
+
+static int
+TS_def_enum(int ncid, nc_type base_typeid, const char* name, nc_type* typeidp)
+{TSCALL(TS_WRITE,ncid,0,def_enum,(ncid,base_typeid,name,typeidp));}
+
+static int
+TS_insert_enum(int ncid, nc_type xtype, const char* name, const void* value)
+{TSCALL(TS_WRITE,ncid,0,insert_enum,(ncid,xtype,name,value));}
+
+static int
+TS_inq_enum_member(int ncid, nc_type xtype, int idx, char* name, void* value)
+{TSCALL(TS_READ,ncid,0,inq_enum_member,(ncid,xtype,idx,name,value));}
+
+static int
+TS_inq_enum_ident(int ncid, nc_type xtype, long long value, char* identifier)
+{TSCALL(TS_READ,ncid,0,inq_enum_ident,(ncid,xtype,value,identifier));}
+
+static int
+TS_def_opaque(int ncid, size_t size, const char* name, nc_type* xtypep)
+{TSCALL(TS_WRITE,ncid,0,def_opaque,(ncid,size,name,xtypep));}
+
+static int
+TS_def_var_deflate(int ncid, int varid, int shuffle, int deflate, int deflate_level)
+{TSCALL(TS_WRITE,ncid,varid,def_var_deflate,(ncid,varid,shuffle,deflate,deflate_level));}
+
+static int
+TS_def_var_fletcher32(int ncid, int varid, int fletcher32)
+{TSCALL(TS_WRITE,ncid,varid,def_var_fletcher32,(ncid,varid,fletcher32));}
+
+static int
+TS_def_var_chunking(int ncid, int varid, int storage, const size_t* chunksizesp)
+{TSCALL(TS_WRITE,ncid,varid,def_var_chunking,(ncid,varid,storage,chunksizesp));}
+
+static int
+TS_def_var_endian(int ncid, int varid, int endian)
+{TSCALL(TS_WRITE,ncid,varid,def_var_endian,(ncid,varid,endian));}
+
+static int
+TS_def_var_filter(int ncid, int varid, unsigned int id, size_t nparams,
+                  const unsigned int* params)
+{TSCALL(TS_WRITE,ncid,varid,def_var_filter,(ncid,varid,id,nparams,params));}
+
+static int
+TS_set_var_chunk_cache(int ncid, int varid, size_t size, size_t nelems, float preemption)
+{TSCALL(TS_WRITE,ncid,varid,set_var_chunk_cache,(ncid,varid,size,nelems,preemption));}
+
+static int
+TS_get_var_chunk_cache(int ncid, int varid, size_t* sizep, size_t* nelemsp,
+                       float* preemptionp)
+{TSCALL(TS_READ,ncid,varid,get_var_chunk_cache,(ncid,varid,sizep,nelemsp,preemptionp));}
+
+/* The filters may be read lazily */
+static int
+TS_inq_var_filter_ids(int ncid, int varid, size_t* nfilters, unsigned int* filterids)
+{TSCALL(TS_WRITE,ncid,varid,inq_var_filter_ids,(ncid,varid,nfilters,filterids));}
+
+static int
+TS_inq_var_filter_info(int ncid, int varid, unsigned int id, size_t* nparams,
+                       unsigned int* params)
+{TSCALL(TS_WRITE,ncid,varid,inq_var_filter_info,(ncid,varid,id,nparams,params));}
+
+static int
+TS_def_var_quantize(int ncid, int varid, int quantize_mode, int nsd)
+{TSCALL(TS_WRITE,ncid,varid,def_var_quantize,(ncid,varid,quantize_mode,nsd));}
+
+static int
+TS_inq_var_quantize(int ncid, int varid, int* quantize_modep, int* nsdp)
+{TSCALL(TS_WRITE,ncid,varid,inq_var_quantize,(ncid,varid,quantize_modep,nsdp));}
+
+static int
+TS_inq_filter_avail(int ncid, unsigned id)
+{TSCALL(TS_WRITE,ncid,0,inq_filter_avail,(ncid,id));}
+
+/**************************************************/
+
+/* Copy the members of table d, replacing each one that is set by
+   its wrapper. */
+#define WRAP(fcn) if(d->fcn != NULL) w->fcn = TS_##fcn
+
+static void
+buildwrapped(const NC_Dispatch* d, NC_Dispatch* w)
+{
+    *w = *d; /* model, version, create, open and any NULL members */
+    WRAP(redef);
+    WRAP(_enddef);
+    WRAP(sync);
+    WRAP(abort);
+    WRAP(close);
+    WRAP(set_fill);
+    WRAP(inq_format);
+    WRAP(inq_format_extended);
+    WRAP(inq);
+    WRAP(inq_type);
+    WRAP(def_dim);
+    WRAP(inq_dimid);
+    WRAP(inq_dim);
+    WRAP(inq_unlimdim);
+    WRAP(rename_dim);
+    WRAP(inq_att);
+    WRAP(inq_attid);
+    WRAP(inq_attname);
+    WRAP(rename_att);
+    WRAP(del_att);
+    WRAP(get_att);
+    WRAP(put_att);
+    WRAP(def_var);
+    WRAP(inq_varid);
+    WRAP(rename_var);
+    WRAP(get_vara);
+    WRAP(put_vara);
+    WRAP(get_vars);
+    WRAP(put_vars);
+    WRAP(get_varm);
+    WRAP(put_varm);
+    WRAP(inq_var_all);
+    WRAP(var_par_access);
+    WRAP(def_var_fill);
+    WRAP(show_metadata);
+    WRAP(inq_unlimdims);
+    WRAP(inq_ncid);
+    WRAP(inq_grps);
+    WRAP(inq_grpname);
+    WRAP(inq_grpname_full);
+    WRAP(inq_grp_parent);
+    WRAP(inq_grp_full_ncid);
+    WRAP(inq_varids);
+    WRAP(inq_dimids);
+    WRAP(inq_typeids);
+    WRAP(inq_type_equal);
+    WRAP(def_grp);
+    WRAP(rename_grp);
+    WRAP(inq_user_type);
+    WRAP(inq_typeid);
+    WRAP(def_compound);
+    WRAP(insert_compound);
+    WRAP(insert_array_compound);
+    WRAP(inq_compound_field);
+    WRAP(inq_compound_fieldindex);
+    WRAP(def_vlen);
+    WRAP(put_vlen_element);
+    WRAP(get_vlen_element);
+    WRAP(def_enum);
+    WRAP(insert_enum);
+    WRAP(inq_enum_member);
+    WRAP(inq_enum_ident);
+    WRAP(def_opaque);
+    WRAP(def_var_deflate);
+    WRAP(def_var_fletcher32);
+    WRAP(def_var_chunking);
+    WRAP(def_var_endian);
+    WRAP(def_var_filter);
+    WRAP(set_var_chunk_cache);
+    WRAP(get_var_chunk_cache);
+    WRAP(inq_var_filter_ids);
+    WRAP(inq_var_filter_info);
+    WRAP(def_var_quantize);
+    WRAP(inq_var_quantize);
+    WRAP(inq_filter_avail);
+}
+
+/* Return the wrapped copy of table d. Called with the global lock held. */
+static const NC_Dispatch*
+wrapped(const NC_Dispatch* d)
+{
+    int i;
+    for(i=0;i<ntables;i++) {
+        if(tables[i].dispatch == d)
+            return &tables[i].wrapped;
+    }
+    if(ntables == NC_MAXTABLES) return NULL;
+    tables[ntables].dispatch = d;
+    buildwrapped(d,&tables[ntables].wrapped);
+    return &tables[ntables++].wrapped;
+}
+
+/**
+ * @internal Interpose the locking wrappers on the dispatch table of
+ * a new NC. Called by NC_open and NC_create, with the global lock
+ * held, before the file is opened; until the dispatcher's open or
+ * create sets ncp->concurrency, calls hold the global lock.
+ *
+ * @param ncp The NC.
+ *
+ * @return ::NC_NOERR No error.
+ * @return ::NC_ENOMEM Out of memory.
+ */
+int
+NC_threadsafe_attach(NC* ncp)
+{
+    struct NClock* lock = NULL;
+    const NC_Dispatch* table = NULL;
+    int i;
+
+    if(ncp->lock != NULL) return NC_NOERR;
+    if((table = wrapped(ncp->dispatch)) == NULL) return NC_ENOMEM;
+    if((lock = calloc(1,sizeof(struct NClock))) == NULL) return NC_ENOMEM;
+    lock->dispatch = ncp->dispatch;
+    pthread_rwlock_init(&lock->file,NULL);
+    for(i=0;i<NC_VARLOCKS;i++)
+        pthread_mutex_init(&lock->vars[i],NULL);
+    ncp->concurrency = NC_CONCURRENT_NONE;
+    ncp->lock = lock;
+    ncp->dispatch = table;
+    return NC_NOERR;
+}
+
+/**
+ * @internal Undo NC_threadsafe_attach. Called by free_NC, after the
+ * file has been closed.
+ *
+ * @param ncp The NC.
+ */
+void
+NC_threadsafe_detach(NC* ncp)
+{
+    struct NClock* lock = ncp->lock;
+    int i;
+
+    if(lock == NULL) return;
+    ncp->dispatch = lock->dispatch;
+    ncp->lock = NULL;
+    pthread_rwlock_destroy(&lock->file);
+    for(i=0;i<NC_VARLOCKS;i++)
+        pthread_mutex_destroy(&lock->vars[i]);
+    free(lock);
+}
+
+#endif /*NETCDF_ENABLE_THREADSAFE*/
@@ -0,0 +1,305 @@
+/*! \file
+Buffered implementation of the mapped (varm) get and put operations.
+
+Copyright 2018 University Corporation for Atmospheric
+Research/Unidata. See \ref copyright file for more info.
+
+The generic NCDEFAULT_get_varm()/NCDEFAULT_put_varm() walk the
+hyperslab and issue one vara call per run of the fastest varying
+dimension, which degenerates to one call per element whenever the
+memory map is not unit along that dimension (e.g. a transposing or
+Fortran ordered read). Dispatchers whose get_vars/put_vars are
+efficient can instead use the functions here: the hyperslab is moved
+with a single vars call (or a few, to bound the buffer size) to or
+from a contiguous buffer, and the elements are then scattered to, or
+gathered from, the caller's memory map with a cache tiled copy.
+*/
+
+#include "ncdispatch.h"
+
+/* Upper bound, in bytes, on the intermediate buffer; a single slab
+   of the slowest varying dimension is always allowed. */
+#define VARM_BUFSIZE (4 * 1024 * 1024)
+
+/* Edge length, in elements, of the tiles used when the fastest
+   varying dimensions of the source and destination differ. */
+#define VARM_TILE 32
+
+#undef MIN
+#define MIN(x,y) ((x) < (y) ? (x) : (y))
+#undef ABS
+#define ABS(x) ((x) < 0 ? -(x) : (x))
+
+/* Copy a nrows x ncols tile of 'size' byte elements. Strides are in
+   bytes. The element copy is specialized on the common sizes so that
+   the compiler can turn it into a single load/store. */
+#define TILELOOP(size) \
+    for(r = r0; r < rend; r++) { \
+        char* d = dst + (ptrdiff_t)r * drow + (ptrdiff_t)c0 * dcol; \
+        const char* s = src + (ptrdiff_t)r * srow + (ptrdiff_t)c0 * scol; \
+        for(c = c0; c < cend; c++, d += dcol, s += scol) \
+            memcpy(d, s, size); \
+    }
+
+/**
+ * @internal Copy a two dimensional block of elements, one
+ * VARM_TILE x VARM_TILE tile at a time, so that both source and
+ * destination stay in cache even when one of them is accessed with a
+ * large stride.
+ *
+ * @param dst Destination.
+ * @param drow Destination byte stride between rows.
+ * @param dcol Destination byte stride between columns.
+ * @param src Source.
+ * @param srow Source byte stride between rows.
+ * @param scol Source byte stride between columns.
+ * @param nrows Number of rows.
+ * @param ncols Number of columns.
+ * @param size Size of an element in bytes.
+ */
+static void
+tilecopy(char* dst, ptrdiff_t drow, ptrdiff_t dcol,
+         const char* src, ptrdiff_t srow, ptrdiff_t scol,
+         size_t nrows, size_t ncols, size_t size)
+{
+    size_t r0, c0, r, c;
+
+    for(r0 = 0; r0 < nrows; r0 += VARM_TILE) {
+        size_t rend = MIN(nrows, r0 + VARM_TILE);
+        for(c0 = 0; c0 < ncols; c0 += VARM_TILE) {
+            size_t cend = MIN(ncols, c0 + VARM_TILE);
+            switch (size) {
+            case 1: TILELOOP(1); break;
+            case 2: TILELOOP(2); break;
+            case 4: TILELOOP(4); break;
+            case 8: TILELOOP(8); break;
+            default: TILELOOP(size); break;
+            }
+        }
+    }
+}
+
+/**
+ * @internal Copy every element of a hyperslab of shape 'edges' from
+ * 'src' to 'dst', where each side has its own (byte) stride per
+ * dimension. The dimension along which the source is densest is used
+ * as the tile column and the dimension along which the destination is
+ * densest as the tile row; all other dimensions are walked with an
+ * odometer.
+ *
+ * @param rank Number of dimensions.
+ * @param edges Shape of the hyperslab.
+ * @param dst Destination.
+ * @param dstride Destination byte strides.
+ * @param src Source.
+ * @param sstride Source byte strides.
+ * @param size Size of an element in bytes.
+ */
+static void
+varm_copy(int rank, const size_t* edges,
+          char* dst, const ptrdiff_t* dstride,
+          const char* src, const ptrdiff_t* sstride, size_t size)
+{
+    int i, rdim, cdim;
+    size_t index[NC_MAX_VAR_DIMS];
+
+    /* Pick the densest dimension on each side */
+    rdim = cdim = -1;
+    for(i = rank - 1; i >= 0; i--) {
+        if(edges[i] < 2) continue;
+        if(cdim < 0 || ABS(sstride[i]) < ABS(sstride[cdim])) cdim = i;
+        if(rdim < 0 || ABS(dstride[i]) < ABS(dstride[rdim])) rdim = i;
+    }
+    if(cdim < 0) { /* a single element */
+        memcpy(dst, src, size);
+        return;
+    }
+
+    memset(index, 0, sizeof(index));
+    for(;;) {
+        ptrdiff_t doff = 0, soff = 0;
+        for(i = 0; i < rank; i++) {
+            doff += (ptrdiff_t)index[i] * dstride[i];
+            soff += (ptrdiff_t)index[i] * sstride[i];
+        }
+        if(rdim == cdim)
+            tilecopy(dst + doff, 0, dstride[cdim], src + soff, 0, sstride[cdim],
+                     1, edges[cdim], size);
+        else
+            tilecopy(dst + doff, dstride[rdim], dstride[cdim],
+                     src + soff, sstride[rdim], sstride[cdim],
+                     edges[rdim], edges[cdim], size);
+        /* Advance over the remaining dimensions */
+        for(i = rank - 1; i >= 0; i--) {
+            if(i == rdim || i == cdim) continue;
+            if(++index[i] < edges[i]) break;
+            index[i] = 0;
+        }
+        if(i < 0) break;
+    }
+}
+
+/**
+ * @internal Validate start, edges and stride against the variable
+ * shape, so that errors are reported before any data is moved.
+ *
+ * @param ncid NetCDF or group ID.
+ * @param varid Variable ID.
+ * @param rank Number of dimensions of the variable.
+ * @param start Start indices.
+ * @param edges Counts.
+ * @param stride Strides.
+ * @param isput Non-zero for writes; record dimensions are then not
+ * bounded.
+ * @param nelsp Pointer that gets the number of elements.
+ *
+ * @return ::NC_NOERR No error.
+ * @return ::NC_EINVALCOORDS Bad start.
+ * @return ::NC_EEDGE Bad edges.
+ * @return ::NC_ESTRIDE Bad stride.
+ */
+static int
+varm_check(int ncid, int varid, int rank, const size_t* start,
+           const size_t* edges, const ptrdiff_t* stride, int isput,
+           size_t* nelsp)
+{
+    int stat = NC_NOERR;
+    int i, nrecdims;
+    int is_recdim[NC_MAX_VAR_DIMS];
+    size_t shape[NC_MAX_VAR_DIMS];
+    size_t numrecs = 0;
+    size_t nels = 1;
+
+    if(rank > 0 && start == NULL) return NC_EINVALCOORDS;
+    if((stat = NC_inq_recvar(ncid, varid, &nrecdims, is_recdim))) return stat;
+    if((stat = NC_getshape(ncid, varid, rank, shape))) return stat;
+    if(!isput) (void)NC_is_recvar(ncid, varid, &numrecs);
+
+    for(i = 0; i < rank; i++) {
+        size_t dimlen = (i == 0 && is_recdim[i] ? numrecs : shape[i]);
+        size_t extent;
+        if(stride[i] <= 0 || ((unsigned long)stride[i] >= X_INT_MAX))
+            return NC_ESTRIDE;
+        nels *= edges[i];
+        if(isput && is_recdim[i]) continue;
+        if(start[i] > dimlen) return NC_EINVALCOORDS;
+        if(start[i] == dimlen && edges[i] > 0) return NC_EINVALCOORDS;
+        extent = (edges[i] == 0 ? 0 : (edges[i] - 1) * (size_t)stride[i] + 1);
+        if(start[i] + extent > dimlen) return NC_EEDGE;
+    }
+    if(nelsp) *nelsp = nels;
+    return stat;
+}
+
+/**
+ * @internal Common driver for the buffered get and put varm.
+ *
+ * @return ::NC_NOERR No error.
+ */
+static int
+varm_transfer(int ncid, int varid, const size_t* start,
+              const size_t* edges, const ptrdiff_t* stride,
+              const ptrdiff_t* imapp, char* value, nc_type memtype,
+              int isput)
+{
+    int stat = NC_NOERR;
+    int i, rank;
+    NC* ncp;
+    nc_type vartype = NC_NAT;
+    size_t size, nels, slabbytes, nslab, i0;
+    size_t mystart[NC_MAX_VAR_DIMS];
+    size_t myedges[NC_MAX_VAR_DIMS];
+    ptrdiff_t mystride[NC_MAX_VAR_DIMS];
+    ptrdiff_t bstride[NC_MAX_VAR_DIMS]; /* buffer byte strides */
+    ptrdiff_t ustride[NC_MAX_VAR_DIMS]; /* user memory byte strides */
+    char* buf = NULL;
+
+    if((stat = NC_check_id(ncid, &ncp))) return stat;
+    if((stat = nc_inq_vartype(ncid, varid, &vartype))) return stat;
+    /* Check that this is an atomic type */
+    if(vartype > NC_MAX_ATOMIC_TYPE) return NC_EMAPTYPE;
+    if(memtype == NC_NAT) memtype = vartype;
+    if(memtype == NC_CHAR && vartype != NC_CHAR) return NC_ECHAR;
+    else if(memtype != NC_CHAR && vartype == NC_CHAR) return NC_ECHAR;
+    if((stat = nc_inq_varndims(ncid, varid, &rank))) return stat;
+
+    for(i = 0; i < rank; i++)
+        mystride[i] = (stride == NULL ? 1 : stride[i]);
+
+    /* Without a map, or for a scalar, this is just vars */
+    if(imapp == NULL || rank == 0) {
+        if(isput)
+            return ncp->dispatch->put_vars(ncid, varid, start, edges, mystride, value, memtype);
+        return ncp->dispatch->get_vars(ncid, varid, start, edges, mystride, value, memtype);
+    }
+
+    if((stat = varm_check(ncid, varid, rank, start, edges, mystride, isput, &nels)))
+        return stat;
+    if(nels == 0) return NC_NOERR; /* nothing to transfer */
+
+    size = (size_t)nctypelen(memtype);
+    bstride[rank - 1] = (ptrdiff_t)size;
+    for(i = rank - 2; i >= 0; i--)
+        bstride[i] = bstride[i + 1] * (ptrdiff_t)edges[i + 1];
+    for(i = 0; i < rank; i++)
+        ustride[i] = imapp[i] * (ptrdiff_t)size;
+
+    /* Move at most VARM_BUFSIZE bytes at a time, splitting on the
+       slowest varying dimension */
+    slabbytes = (size_t)bstride[0];
+    nslab = (slabbytes >= VARM_BUFSIZE ? 1 : VARM_BUFSIZE / slabbytes);
+    nslab = MIN(nslab, edges[0]);
+    if((buf = (char*)malloc(nslab * slabbytes)) == NULL) return NC_ENOMEM;
+
+    memcpy(mystart, start, sizeof(size_t) * (size_t)rank);
+    memcpy(myedges, edges, sizeof(size_t) * (size_t)rank);
+    for(i0 = 0; i0 < edges[0]; i0 += myedges[0]) {
+        int lstat;
+        char* uvalue = value + (ptrdiff_t)i0 * ustride[0];
+        mystart[0] = start[0] + i0 * (size_t)mystride[0];
+        myedges[0] = MIN(nslab, edges[0] - i0);
+        if(isput) {
+            varm_copy(rank, myedges, buf, bstride, uvalue, ustride, size);
+            lstat = ncp->dispatch->put_vars(ncid, varid, mystart, myedges, mystride, buf, memtype);
+        } else {
+            lstat = ncp->dispatch->get_vars(ncid, varid, mystart, myedges, mystride, buf, memtype);
+            /* The data is still converted when NC_ERANGE is returned */
+            if(lstat == NC_NOERR || lstat == NC_ERANGE)
+                varm_copy(rank, myedges, uvalue, ustride, buf, bstride, size);
+        }
+        if(lstat != NC_NOERR) {
+            if(lstat != NC_ERANGE) {stat = lstat; break;} /* fatal */
+            if(stat == NC_NOERR) stat = lstat;
+        }
+    }
+    free(buf);
+    return stat;
+}
+
+/** \internal
+\ingroup variables
+Get a mapped array by reading the hyperslab into a contiguous buffer
+with the dispatcher's get_vars and scattering it into memory.
+ */
+int
+NCBUFFERED_get_varm(int ncid, int varid, const size_t *start,
+                    const size_t *edges, const ptrdiff_t *stride,
+                    const ptrdiff_t *imapp, void *value, nc_type memtype)
+{
+    return varm_transfer(ncid, varid, start, edges, stride, imapp,
+                         (char*)value, memtype, 0);
+}
+
+/** \internal
+\ingroup variables
+Put a mapped array by gathering it from memory into a contiguous
+buffer and writing it with the dispatcher's put_vars.
+ */
+int
+NCBUFFERED_put_varm(int ncid, int varid, const size_t *start,
+                    const size_t *edges, const ptrdiff_t *stride,
+                    const ptrdiff_t *imapp, const void *value, nc_type memtype)
+{
+    return varm_transfer(ncid, varid, start, edges, stride, imapp,
+                         (char*)value, memtype, 1);
+}
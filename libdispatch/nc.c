@@ -61,6 +61,9 @@ free_NC(NC *ncp)
 {
     if(ncp == NULL)
         return;
+#ifdef NETCDF_ENABLE_THREADSAFE
+    NC_threadsafe_detach(ncp);
+#endif
     if(ncp->path)
         free(ncp->path);
     /* We assume caller has already cleaned up ncp->dispatchdata */
@@ -1403,6 +1403,185 @@ done:
     return UNTRACEX(ret_value,"response=[%d]",ncbyteslength(response));
 } /* NCH5_s3comms_s3r_getkeys */
 
+/*----------------------------------------------------------------------------
+ * Function: NCH5_s3comms_s3r_getobject()
+ * Purpose:
+ *     Read the whole of an object with a single GET request, so that
+ *     the size of the object need not be obtained first.
+ *     The content is returned in malloc'd memory in dest->content.
+ * Return:
+ *     - SUCCESS: `SUCCEED`
+ *     - FAILURE: `FAIL`
+ *----------------------------------------------------------------------------
+ */
+int
+NCH5_s3comms_s3r_getobject(s3r_t *handle, const char* url, s3r_buf_t* dest, long* httpcodep)
+{
+    int ret_value = SUCCEED;
+    long httpcode = 0;
+    VString* content = vsnew();
+
+    TRACE(0,"handle=%p url=%s",handle,url);
+
+    if((ret_value = NCH5_s3comms_s3r_execute(handle, url, HTTPGET, NULL, NULL, NULL, &httpcode, content)))
+        HGOTO_ERROR(H5E_ARGS, ret_value, FAIL, "execute failed.");
+    if(dest) {
+	dest->count = vslength(content);
+	dest->content = vsextract(content);
+	/* Zero length objects still get memory */
+	if(dest->content == NULL && (dest->content = calloc(1,1)) == NULL)
+            HGOTO_ERROR(H5E_ARGS, NC_ENOMEM, FAIL, "could not allocate content.");
+    }
+
+done:
+    if(httpcodep) *httpcodep = httpcode;
+    vsfree(content);
+    curl_reset(handle);
+    return UNTRACE(ret_value);
+} /* NCH5_s3comms_s3r_getobject */
+
+/*----------------------------------------------------------------------------
+ * Function: NCH5_s3comms_s3r_multi()
+ * Purpose:
+ *     Perform n whole object GET or PUT requests at once, using the
+ *     curl multi interface. Request i uses handles[i], which must be
+ *     distinct, and urls[i]. For GET, the content of object i is
+ *     returned in malloc'd memory in data[i]; for PUT, data[i] is the
+ *     content to write. The http code of each request is returned in
+ *     httpcodes[i].
+ *     The curl multi handle is created on first use and returned
+ *     through *multip; reusing it lets later calls reuse its
+ *     connections. Close it with NCH5_s3comms_s3r_multi_close().
+ * Return:
+ *     - SUCCESS: `SUCCEED`
+ *     - FAILURE: `FAIL`; some request could not be performed at all.
+ *----------------------------------------------------------------------------
+ */
+int
+NCH5_s3comms_s3r_multi(void** multip, size_t n, s3r_t** handles, HTTPVerb verb,
+                       const char** urls, s3r_buf_t* data, long* httpcodes)
+{
+    int ret_value = SUCCEED;
+    CURLM* multi = NULL;
+    CURLMcode mc = CURLM_OK;
+    CURLMsg* msg = NULL;
+    NCURI* purl = NULL;
+    VString** wraps = NULL;
+    struct s3r_cbstruct* sds = NULL;
+    VList* otherheaders = NULL;
+    char digits[64];
+    size_t i, nadded = 0;
+    int running = 0;
+    int left = 0;
+
+    TRACE(0,"n=%d verb=%s",(int)n,verbtext(verb));
+
+    if(verb != HTTPGET && verb != HTTPPUT)
+        HGOTO_ERRORVA(H5E_ARGS, NC_EINVAL, FAIL, "Illegal verb: %d.",(int)verb);
+    if(n == 0) goto done;
+    if(*multip == NULL && (*multip = curl_multi_init()) == NULL)
+        HGOTO_ERROR(H5E_ARGS, NC_EINVAL, FAIL, "problem creating curl multi handle!");
+    multi = (CURLM*)*multip;
+
+    if((wraps = (VString**)calloc(n,sizeof(VString*))) == NULL
+       || (sds = (struct s3r_cbstruct*)calloc(n,sizeof(struct s3r_cbstruct))) == NULL)
+        HGOTO_ERROR(H5E_ARGS, NC_ENOMEM, FAIL, "could not allocate request state.");
+
+    /* Prepare every request */
+    for(i=0;i<n;i++) {
+        httpcodes[i] = 0;
+        if((ret_value = validate_handle(handles[i], urls[i])))
+            HGOTO_ERROR(H5E_ARGS, NC_EINVAL, FAIL, "invalid handle.");
+        ncurifree(purl); purl = NULL;
+        ncuriparse(urls[i],&purl);
+        if((ret_value = validate_url(purl)))
+            HGOTO_ERRORVA(H5E_ARGS, NC_EINVAL, FAIL, "unparsable url: %s", urls[i]);
+        wraps[i] = vsnew();
+        vlistfreeall(otherheaders); otherheaders = NULL;
+        if(verb == HTTPPUT) {
+            vssetcontents(wraps[i],data[i].content,data[i].count);
+            vssetlength(wraps[i],data[i].count);
+            snprintf(digits,sizeof(digits),"%llu",(unsigned long long)data[i].count);
+            otherheaders = vlistnew();
+            vlistpush(otherheaders,strdup("Content-Length"));
+            vlistpush(otherheaders,strdup(digits));
+            vlistpush(otherheaders,strdup("Content-Type"));
+            vlistpush(otherheaders,strdup("binary/octet-stream"));
+            vlistpush(otherheaders,NULL);
+        }
+        sds[i].magic = S3COMMS_CALLBACK_STRUCT_MAGIC;
+        sds[i].data = wraps[i];
+        if((ret_value = build_request(handles[i],purl,NULL,(otherheaders?(const char**)vlistcontents(otherheaders):NULL),wraps[i],verb)))
+            HGOTO_ERROR(H5E_ARGS, ret_value, FAIL, "unable to build request.");
+        if((ret_value = request_setup(handles[i], urls[i], verb, &sds[i])))
+            HGOTO_ERROR(H5E_ARGS, ret_value, FAIL, "request_setup failed.");
+        if(curl_multi_add_handle(multi,handles[i]->curlhandle) != CURLM_OK)
+            HGOTO_ERROR(H5E_ARGS, NC_EINVAL, FAIL, "could not add handle to curl multi handle.");
+        nadded++;
+    }
+
+    /* Run them all to completion */
+    do {
+        if((mc = curl_multi_perform(multi,&running)) != CURLM_OK)
+            HGOTO_ERRORVA(H5E_ARGS, NC_EACCESS, FAIL, "curl_multi_perform failed: %s", curl_multi_strerror(mc));
+        if(running && (mc = curl_multi_wait(multi,NULL,0,1000,NULL)) != CURLM_OK)
+            HGOTO_ERRORVA(H5E_ARGS, NC_EACCESS, FAIL, "curl_multi_wait failed: %s", curl_multi_strerror(mc));
+    } while(running);
+
+    /* Collect the results */
+    while((msg = curl_multi_info_read(multi,&left)) != NULL) {
+        if(msg->msg != CURLMSG_DONE) continue;
+        for(i=0;i<n;i++) {
+            if(handles[i]->curlhandle != msg->easy_handle) continue;
+            /* As with perform_request, an http error is not a curl error */
+            if(msg->data.result != CURLE_OK && msg->data.result != CURLE_HTTP_RETURNED_ERROR)
+                HDONE_ERROR(H5E_VFL, NC_EACCESS, FAIL, "curl cannot perform request");
+            (void)curl_easy_getinfo(msg->easy_handle, CURLINFO_RESPONSE_CODE, &httpcodes[i]);
+            break;
+        }
+    }
+
+done:
+    for(i=0;i<nadded;i++)
+        (void)curl_multi_remove_handle(multi,handles[i]->curlhandle);
+    for(i=0;i<n && wraps != NULL;i++) {
+        if(handles[i] != NULL && i < nadded) {
+            if(handles[i]->curlheaders != NULL) {
+                curl_slist_free_all(handles[i]->curlheaders);
+                handles[i]->curlheaders = NULL;
+            }
+            curl_reset(handles[i]);
+        }
+        if(wraps[i] == NULL) continue;
+        if(verb == HTTPGET && ret_value == SUCCEED) {
+            data[i].count = vslength(wraps[i]);
+            data[i].content = vsextract(wraps[i]);
+            if(data[i].content == NULL) data[i].content = calloc(1,1);
+        } else if(verb == HTTPPUT)
+            (void)vsextract(wraps[i]); /* content belongs to the caller */
+        vsfree(wraps[i]);
+    }
+    nullfree(wraps);
+    nullfree(sds);
+    ncurifree(purl);
+    vlistfreeall(otherheaders);
+    return UNTRACE(ret_value);
+} /* NCH5_s3comms_s3r_multi */
+
+/*----------------------------------------------------------------------------
+ * Function: NCH5_s3comms_s3r_multi_close()
+ * Purpose:
+ *     Reclaim a curl multi handle created by NCH5_s3comms_s3r_multi()
+ *     and close its connections.
+ *----------------------------------------------------------------------------
+ */
+void
+NCH5_s3comms_s3r_multi_close(void* multi)
+{
+    if(multi != NULL)
+        (void)curl_multi_cleanup((CURLM*)multi);
+}
+
 /****************************************************************************
  * MISCELLANEOUS FUNCTIONS
  ****************************************************************************/
@@ -514,6 +514,12 @@ EXTERNL int NCH5_s3comms_s3r_write(s3r_t *handle, const char* url, const s3r_buf
 
 EXTERNL int NCH5_s3comms_s3r_getkeys(s3r_t *handle, const char* url, s3r_buf_t* response, long* httpcodep);
 
+EXTERNL int NCH5_s3comms_s3r_getobject(s3r_t *handle, const char* url, s3r_buf_t* dest, long* httpcodep);
+
+EXTERNL int NCH5_s3comms_s3r_multi(void** multip, size_t n, s3r_t** handles, HTTPVerb verb, const char** urls, s3r_buf_t* data, long* httpcodes);
+
+EXTERNL void NCH5_s3comms_s3r_multi_close(void* multi);
+
 EXTERNL int NCH5_s3comms_s3r_getsize(s3r_t *handle, const char* url, long long * sizep, long* httpcodep);
 
 EXTERNL int NCH5_s3comms_s3r_deletekey(s3r_t *handle, const char* url, long* httpcodep);
@@ -33,6 +33,141 @@ static NC** nc_filelist = NULL;
 /** The number of files currently open. */
 static int numfiles = 0;
 
+/* Lookups by ncid read nc_filelist without a lock. In thread-safe
+ * builds, slots are changed only under the global lock, and are
+ * published with release stores so that a reader sees a fully built
+ * NC. */
+#if defined(NETCDF_ENABLE_THREADSAFE) && defined(__GNUC__)
+#define SLOTGET(i) __atomic_load_n(&nc_filelist[i], __ATOMIC_ACQUIRE)
+#define SLOTSET(i,ncp) __atomic_store_n(&nc_filelist[i], (ncp), __ATOMIC_RELEASE)
+#else
+#define SLOTGET(i) (nc_filelist[i])
+#define SLOTSET(i,ncp) (nc_filelist[i] = (ncp))
+#endif
+
+/* Free slots are kept in a three level bitmap, so that the lowest
+ * free slot, which is the ncid that has always been handed out, is
+ * found in constant time. Bit b of freemap[w] is set when slot
+ * w*64+b is free; bit b of freemap1[w] is set when freemap[w*64+b]
+ * has a free slot; bit b of freemap2 is set when freemap1[b] does. */
+#define MAPBITS 64
+#define NMAPWORDS (NCFILELISTLENGTH / MAPBITS)
+static unsigned long long freemap[NMAPWORDS];
+static unsigned long long freemap1[NMAPWORDS / MAPBITS];
+static unsigned long long freemap2;
+
+/* Files are indexed by path in a hash table with NHASH buckets.
+ * The chains are threaded through the slots: hashhead[h] is the
+ * first slot in bucket h, and hashnext[i] and hashprev[i] the slots
+ * after and before slot i; 0, which is never a slot, ends a chain. */
+#define NHASH 4096
+static unsigned short* hashhead = NULL;
+static unsigned short* hashnext = NULL;
+static unsigned short* hashprev = NULL;
+
+/* Index of the lowest set bit of a non-zero word. */
+static unsigned int
+lowbit(unsigned long long word)
+{
+#if defined(__GNUC__)
+    return (unsigned int)__builtin_ctzll(word);
+#else
+    unsigned int b = 0;
+    while((word & 1) == 0) {word >>= 1; b++;}
+    return b;
+#endif
+}
+
+/* Mark slot i as free (isfree != 0) or taken. */
+static void
+markslot(unsigned int i, int isfree)
+{
+    unsigned int w = i / MAPBITS;
+    unsigned int w1 = w / MAPBITS;
+    if(isfree) {
+        freemap[w] |= 1ULL << (i % MAPBITS);
+        freemap1[w1] |= 1ULL << (w % MAPBITS);
+        freemap2 |= 1ULL << w1;
+    } else {
+        freemap[w] &= ~(1ULL << (i % MAPBITS));
+        if(freemap[w] == 0) {
+            freemap1[w1] &= ~(1ULL << (w % MAPBITS));
+            if(freemap1[w1] == 0)
+                freemap2 &= ~(1ULL << w1);
+        }
+    }
+}
+
+/* Return the lowest free slot, or 0 if there is none. */
+static unsigned int
+lowestfree(void)
+{
+    unsigned int w1, w;
+    if(freemap2 == 0) return 0;
+    w1 = lowbit(freemap2);
+    w = w1 * MAPBITS + lowbit(freemap1[w1]);
+    return w * MAPBITS + lowbit(freemap[w]);
+}
+
+/* FNV-1a hash of a path, reduced to a bucket. */
+static unsigned int
+hashpath(const char* path)
+{
+    unsigned int h = 2166136261U;
+    const unsigned char* p;
+    for(p = (const unsigned char*)path; *p; p++) {
+        h ^= *p;
+        h *= 16777619U;
+    }
+    return h % NHASH;
+}
+
+/* Add slot i, which holds an NC, to the path index. */
+static void
+hashadd(unsigned int i)
+{
+    unsigned int h;
+    if(nc_filelist[i]->path == NULL) return;
+    h = hashpath(nc_filelist[i]->path);
+    hashnext[i] = hashhead[h];
+    hashprev[i] = 0;
+    if(hashhead[h] != 0)
+        hashprev[hashhead[h]] = (unsigned short)i;
+    hashhead[h] = (unsigned short)i;
+}
+
+/* Remove slot i, which holds an NC, from the path index. */
+static void
+hashdel(unsigned int i)
+{
+    if(nc_filelist[i]->path == NULL) return;
+    if(hashprev[i] != 0)
+        hashnext[hashprev[i]] = hashnext[i];
+    else
+        hashhead[hashpath(nc_filelist[i]->path)] = hashnext[i];
+    if(hashnext[i] != 0)
+        hashprev[hashnext[i]] = hashprev[i];
+    hashnext[i] = hashprev[i] = 0;
+}
+
+/* Put ncp in free slot i. */
+static void
+takeslot(unsigned int i, NC* ncp)
+{
+    markslot(i, 0);
+    SLOTSET(i, ncp);
+    hashadd(i);
+}
+
+/* Empty slot i. */
+static void
+freeslot(unsigned int i)
+{
+    hashdel(i);
+    SLOTSET(i, NULL);
+    markslot(i, 1);
+}
+
 /**
  * How many files are currently open?
  *
@@ -57,6 +192,42 @@ free_NCList(void)
     if(numfiles > 0) return; /* not empty */
     if(nc_filelist != NULL) free(nc_filelist);
     nc_filelist = NULL;
+    if(hashhead != NULL) free(hashhead);
+    hashhead = NULL;
+    if(hashnext != NULL) free(hashnext);
+    hashnext = NULL;
+    if(hashprev != NULL) free(hashprev);
+    hashprev = NULL;
+}
+
+/* Allocate an empty list, with every slot but 0 free. */
+static int
+new_NCList(void)
+{
+    NC** list;
+    unsigned int i;
+
+    if (!(hashhead = calloc(NHASH, sizeof(unsigned short)))
+        || !(hashnext = calloc(NCFILELISTLENGTH, sizeof(unsigned short)))
+        || !(hashprev = calloc(NCFILELISTLENGTH, sizeof(unsigned short)))
+        || !(list = calloc(1, sizeof(NC*)*NCFILELISTLENGTH))) {
+        numfiles = 0;
+        free_NCList();
+        return NC_ENOMEM;
+    }
+    for(i = 0; i < NMAPWORDS; i++)
+        freemap[i] = ~0ULL;
+    for(i = 0; i < NMAPWORDS / MAPBITS; i++)
+        freemap1[i] = ~0ULL;
+    freemap2 = (1ULL << (NMAPWORDS / MAPBITS)) - 1;
+    markslot(0, 0); /* id's begin at 1 */
+    numfiles = 0;
+#if defined(NETCDF_ENABLE_THREADSAFE) && defined(__GNUC__)
+    __atomic_store_n(&nc_filelist, list, __ATOMIC_RELEASE);
+#else
+    nc_filelist = list;
+#endif
+    return NC_NOERR;
 }
 
 /**
@@ -81,22 +252,18 @@ free_NCList(void)
 int
 add_to_NCList(NC* ncp)
 {
-    unsigned int i;
     unsigned int new_id;
     if(nc_filelist == NULL) {
-        if (!(nc_filelist = calloc(1, sizeof(NC*)*NCFILELISTLENGTH)))
-            return NC_ENOMEM;
-        numfiles = 0;
+        int stat = new_NCList();
+        if(stat) return stat;
     }
 
-    new_id = 0; /* id's begin at 1 */
-    for(i=1; i < NCFILELISTLENGTH; i++) {
-        if(nc_filelist[i] == NULL) {new_id = i; break;}
-    }
+    new_id = lowestfree();
     if(new_id == 0) return NC_ENOMEM; /* no more slots */
-    nc_filelist[new_id] = ncp;
-    numfiles++;
+    /* The ncid must be set before other threads can see the NC */
     ncp->ext_ncid = (int)(new_id << ID_SHIFT);
+    takeslot(new_id, ncp);
+    numfiles++;
     return NC_NOERR;
 }
 
@@ -117,14 +284,18 @@ move_in_NCList(NC *ncp, int new_id)
     if (!nc_filelist)
         return NC_EINVAL;
 
+    /* Slot 0 is never used. */
+    if (new_id <= 0 || new_id >= NCFILELISTLENGTH)
+        return NC_EINVAL;
+
     /* If new slot is already taken, error. */
     if (nc_filelist[new_id])
         return NC_EINVAL;
 
     /* Move the file. */
-    nc_filelist[ncp->ext_ncid >> ID_SHIFT] = NULL;
-    nc_filelist[new_id] = ncp;
+    freeslot(((unsigned int)ncp->ext_ncid) >> ID_SHIFT);
     ncp->ext_ncid = (new_id << ID_SHIFT);
+    takeslot((unsigned int)new_id, ncp);
 
     return NC_NOERR;
 }
@@ -148,12 +319,15 @@ del_from_NCList(NC* ncp)
     if(numfiles == 0 || ncid == 0 || nc_filelist == NULL) return;
     if(nc_filelist[ncid] != ncp) return;
 
-    nc_filelist[ncid] = NULL;
+    freeslot(ncid);
     numfiles--;
 
-    /* If all files have been closed, release the filelist memory. */
+#ifndef NETCDF_ENABLE_THREADSAFE
+    /* If all files have been closed, release the filelist memory.
+     * Thread-safe builds keep it, since find_in_NCList does not lock. */
     if (numfiles == 0)
         free_NCList();
+#endif
 }
 
 /**
@@ -178,8 +352,8 @@ find_in_NCList(int ext_ncid)
      * for this ncid. */
     if (nc_filelist)
     {
-        assert(numfiles);
-        f = nc_filelist[ncid];
+        f = SLOTGET(ncid);
+        assert(f == NULL || numfiles);
     }
 
     /* For classic files, ext_ncid must be a multiple of
@@ -195,7 +369,8 @@ find_in_NCList(int ext_ncid)
 }
 
 /**
- * Find an NC in the list using the file name.
+ * Find an NC in the list using the file name. If the file is open
+ * more than once, the one with the lowest ncid is returned.
  *
  * @param path Name of the file.
  *
@@ -205,19 +380,16 @@ find_in_NCList(int ext_ncid)
 NC*
 find_in_NCList_by_name(const char* path)
 {
-    int i;
-    NC* f = NULL;
-    if(nc_filelist == NULL)
+    unsigned int i, found = 0;
+    if(nc_filelist == NULL || path == NULL)
         return NULL;
-    for(i=1; i < NCFILELISTLENGTH; i++) {
-        if(nc_filelist[i] != NULL) {
-            if(strcmp(nc_filelist[i]->path,path)==0) {
-                f = nc_filelist[i];
-                break;
-            }
+    for(i = hashhead[hashpath(path)]; i != 0; i = hashnext[i]) {
+        if(strcmp(nc_filelist[i]->path,path)==0) {
+            if(found == 0 || i < found)
+                found = i;
         }
     }
-    return f;
+    return (found == 0 ? NULL : nc_filelist[found]);
 }
 
 /**
@@ -240,6 +412,6 @@ iterate_NCList(int index, NC** ncp)
     /* Walk from 0 ...; 0 return => stop */
     if(index < 0 || index >= NCFILELISTLENGTH)
         return NC_ERANGE;
-    if(ncp) *ncp = nc_filelist[index];
+    if(ncp) *ncp = (nc_filelist == NULL ? NULL : nc_filelist[index]);
     return NC_NOERR;
 }
@@ -18,6 +18,7 @@
 #include <string.h>
 #include <iostream>
 #include <streambuf>
+#include <vector>
 #include "netcdf.h"
 #include "ncrc.h"
 #include "ncutil.h"
@@ -216,7 +217,7 @@ s3sdkcreateconfig(NCS3INFO* info)
 
     if(info->profile)
         config.profileName = info->profile;
-    config.scheme = Aws::Http::Scheme::HTTPS;
+    config.scheme = (info->http ? Aws::Http::Scheme::HTTP : Aws::Http::Scheme::HTTPS);
     //config.connectTimeoutMs = 1000;
     //config.requestTimeoutMs = 0;
     config.connectTimeoutMs = 300000;
@@ -225,6 +226,7 @@ s3sdkcreateconfig(NCS3INFO* info)
     if(info->host) config.endpointOverride = info->host;
     config.enableEndpointDiscovery = true;
     config.followRedirects = Aws::Client::FollowRedirectsPolicy::ALWAYS;
+    config.maxConnections = NC_S3_MAXCONNECTIONS;
     NCUNTRACENOOP(NC_NOERR);
     return config;
 }
@@ -538,6 +540,111 @@ NC_s3sdkread(void* s3client0, const char* bucket, const char* pathkey, size64_t
     return NCUNTRACE(stat);
 }
 
+/* Map the outcome of a GetObject request to an error code and
+   on success, copy out the object content.
+*/
+static int
+getobjectresult(Aws::S3::Model::GetObjectOutcome& outcome, const char* key, size64_t* lenp, void** contentp, char** errmsgp)
+{
+    int stat = NC_NOERR;
+    if(!outcome.IsSuccess()) {
+        switch (outcome.GetError().GetErrorType()) {
+	case Aws::S3::S3Errors::NO_SUCH_KEY:
+	case Aws::S3::S3Errors::RESOURCE_NOT_FOUND:
+	    stat = NC_EEMPTY;
+	    break;
+	default:
+	    if(errmsgp && *errmsgp == NULL) *errmsgp = makeerrmsg(outcome.GetError(),key);
+	    stat = NC_ES3;
+	    break;
+	}
+    } else {
+	Aws::IOStream &result = outcome.GetResultWithOwnership().GetBody();
+	std::string str((std::istreambuf_iterator<char>(result)),std::istreambuf_iterator<char>());
+	size_t slen = str.size();
+	void* content = malloc(slen == 0 ? 1 : slen);
+	if(content == NULL) return NC_ENOMEM;
+	memcpy(content,str.c_str(),slen);
+	if(lenp) *lenp = (size64_t)slen;
+	if(contentp) *contentp = content; else free(content);
+    }
+    return stat;
+}
+
+/*
+Read a whole object with one request; no separate request
+is needed to get its size.
+@return NC_NOERR if success
+@return NC_EEMPTY if object at key does not exist
+@return NC_EXXX if fail
+*/
+/*EXTERNL*/ int
+NC_s3sdkreadobject(void* s3client0, const char* bucket, const char* pathkey, size64_t* lenp, void** contentp, char** errmsgp)
+{
+    int stat = NC_NOERR;
+    const char* key = NULL;
+
+    NCTRACE(11,"bucket=%s pathkey=%s",bucket,pathkey);
+
+    AWSS3CLIENT s3client = (AWSS3CLIENT)s3client0;
+
+    if(errmsgp) *errmsgp = NULL;
+    if(*pathkey != '/') return NCUNTRACE(NC_EINTERNAL);
+    if((stat = makes3key(pathkey,&key))) return NCUNTRACE(stat);
+
+    Aws::S3::Model::GetObjectRequest object_request;
+    object_request.SetBucket(bucket);
+    object_request.SetKey(key);
+    auto get_object_result = AWSS3GET(s3client)->GetObject(object_request);
+    stat = getobjectresult(get_object_result,key,lenp,contentp,errmsgp);
+    return NCUNTRACE(stat);
+}
+
+/*
+Read n whole objects, keeping up to NC_S3_MAXCONNECTIONS
+requests in flight at once. The content of object i is returned
+in malloc'd memory in contents[i], its length in lens[i], and
+the outcome of its request (e.g. NC_EEMPTY) in stats[i].
+@return NC_NOERR if every request was performed
+@return NC_EXXX if fail
+*/
+/*EXTERNL*/ int
+NC_s3sdkreadobjects(void* s3client0, const char* bucket, size_t n, const char** pathkeys, size64_t* lens, void** contents, int* stats, char** errmsgp)
+{
+    int stat = NC_NOERR;
+    size_t i, j, batch;
+
+    NCTRACE(11,"bucket=%s n=%d",bucket,(int)n);
+
+    AWSS3CLIENT s3client = (AWSS3CLIENT)s3client0;
+
+    if(errmsgp) *errmsgp = NULL;
+    for(i=0;i<n;i++) {lens[i] = 0; contents[i] = NULL;}
+    for(i=0;i<n;i+=batch) {
+        std::vector<Aws::S3::Model::GetObjectOutcomeCallable> pending;
+        batch = n - i;
+	if(batch > NC_S3_MAXCONNECTIONS) batch = NC_S3_MAXCONNECTIONS;
+	for(j=0;j<batch;j++) {
+	    const char* key = NULL;
+	    if(*pathkeys[i+j] != '/') return NCUNTRACE(NC_EINTERNAL);
+	    if((stat = makes3key(pathkeys[i+j],&key))) return NCUNTRACE(stat);
+	    Aws::S3::Model::GetObjectRequest object_request;
+	    object_request.SetBucket(bucket);
+	    object_request.SetKey(key);
+	    pending.push_back(AWSS3GET(s3client)->GetObjectCallable(object_request));
+	}
+	for(j=0;j<batch;j++) {
+	    const char* key = NULL;
+	    (void)makes3key(pathkeys[i+j],&key);
+	    auto outcome = pending[j].get();
+	    stats[i+j] = getobjectresult(outcome,key,&lens[i+j],&contents[i+j],errmsgp);
+	    if(stats[i+j] == NC_ENOMEM) stat = NC_ENOMEM;
+	}
+	if(stat) break;
+    }
+    return NCUNTRACE(stat);
+}
+
 /*
 For S3, I can see no way to do a byterange write;
 so we are effectively writing the whole object
@@ -593,6 +700,55 @@ NC_s3sdkwriteobject(void* s3client0, const char* bucket, const char* pathkey,  s
     return NCUNTRACE(stat);
 }
 
+/*
+Write n whole objects, keeping up to NC_S3_MAXCONNECTIONS
+requests in flight at once. The outcome of request i is
+returned in stats[i].
+@return NC_NOERR if every request was performed
+@return NC_EXXX if fail
+*/
+/*EXTERNL*/ int
+NC_s3sdkwriteobjects(void* s3client0, const char* bucket, size_t n, const char** pathkeys, const size64_t* counts, const void** contents, int* stats, char** errmsgp)
+{
+    int stat = NC_NOERR;
+    size_t i, j, batch;
+
+    NCTRACE(11,"bucket=%s n=%d",bucket,(int)n);
+
+    AWSS3CLIENT s3client = (AWSS3CLIENT)s3client0;
+
+    if(errmsgp) *errmsgp = NULL;
+    for(i=0;i<n;i+=batch) {
+        std::vector<Aws::S3::Model::PutObjectOutcomeCallable> pending;
+        batch = n - i;
+	if(batch > NC_S3_MAXCONNECTIONS) batch = NC_S3_MAXCONNECTIONS;
+	for(j=0;j<batch;j++) {
+	    const char* key = NULL;
+	    if(*pathkeys[i+j] != '/') return NCUNTRACE(NC_EINTERNAL);
+	    if((stat = makes3key(pathkeys[i+j],&key))) return NCUNTRACE(stat);
+	    Aws::S3::Model::PutObjectRequest put_request;
+	    put_request.SetBucket(bucket);
+	    put_request.SetKey(key);
+	    put_request.SetContentLength((long long)counts[i+j]);
+	    std::shared_ptr<Aws::IOStream> data = std::shared_ptr<Aws::IOStream>(new Aws::StringStream());
+	    data->rdbuf()->pubsetbuf((char*)contents[i+j],(std::streamsize)counts[i+j]);
+	    put_request.SetBody(data);
+	    pending.push_back(AWSS3GET(s3client)->PutObjectCallable(put_request));
+	}
+	for(j=0;j<batch;j++) {
+	    auto put_result = pending[j].get();
+	    stats[i+j] = NC_NOERR;
+	    if(!put_result.IsSuccess()) {
+		const char* key = NULL;
+		(void)makes3key(pathkeys[i+j],&key);
+		if(errmsgp && *errmsgp == NULL) *errmsgp = makeerrmsg(put_result.GetError(),key);
+		stats[i+j] = NC_ES3;
+	    }
+	}
+    }
+    return NCUNTRACE(stat);
+}
+
 /*EXTERNL*/ int
 NC_s3sdkclose(void* s3client0, char** errmsgp)
 {
@@ -50,6 +50,13 @@ extern char* strdup(const char*);
 typedef struct NCS3CLIENT {
     char*	rooturl;      /* The URL (minus any fragment) for the dataset root path (excludes bucket on down) */ 
     s3r_t*	h5s3client; /* From h5s3comms */  
+    /* Needed to open more handles for concurrent requests */
+    NCS3SVC	svc;
+    char*	region;
+    char*	accessid;
+    char*	accesskey;
+    NClist*	pool;  /* NClist<s3r_t*>; idle handles for concurrent requests */
+    void*	multi; /* curl multi handle; keeps the pool's connections open */
 } NCS3CLIENT;
 
 struct Object {
@@ -105,6 +112,7 @@ static int s3commonprefixes(NClist* list, NClist* keys);
 static int mergekeysets(NClist*,NClist*,NClist*);
 static int rawtokeys(s3r_buf_t* response, NClist* keys, NClist* lengths, struct LISTOBJECTSV2** listv2p);
 static int httptonc(long httpcode);
+static int s3transfer(NCS3CLIENT* s3client, const char* bucket, HTTPVerb verb, size_t n, const char** pathkeys, s3r_buf_t* data, int* stats);
 
 static int queryadd(NClist* query, const char* key, const char* value);
 static int queryend(NClist* query, char** querystring);
@@ -188,6 +196,11 @@ NC_s3sdkcreateclient(NCS3INFO* info)
     if(s3client == NULL) goto done;
     NC_s3getcredentials(info->profile, NULL, &accessid, &accesskey);
     if((s3client->rooturl = makes3rooturl(info))==NULL) {stat = NC_ENOMEM; goto done;}
+    s3client->svc = info->svc;
+    s3client->region = nulldup(info->region);
+    s3client->accessid = (accessid == NULL ? NULL : strdup(accessid));
+    s3client->accesskey = (accesskey == NULL ? NULL : strdup(accesskey));
+    s3client->pool = nclistnew();
     s3client->h5s3client = NCH5_s3comms_s3r_open(s3client->rooturl,info->svc,info->region,accessid,accesskey);
     if(s3client->h5s3client == NULL) {stat = NC_ES3; goto done;}
 
@@ -314,6 +327,72 @@ done:
     return NCUNTRACE(stat);
 }
 
+/*
+Read a whole object with one request; no separate request
+is needed to get its size.
+@return NC_NOERR if success
+@return NC_ENOOBJECT if object at key does not exist
+@return NC_EXXX if fail
+*/
+/*EXTERNL*/ int
+NC_s3sdkreadobject(void* s3client0, const char* bucket, const char* pathkey, size64_t* lenp, void** contentp, char** errmsgp)
+{
+    int stat = NC_NOERR;
+    NCS3CLIENT* s3client = (NCS3CLIENT*)s3client0;
+    NCbytes* url = ncbytesnew();
+    struct s3r_buf_t data = {0,NULL};
+    long httpcode = 0;
+
+    NCTRACE(11,"bucket=%s pathkey=%s",bucket,pathkey);
+
+    if(errmsgp) *errmsgp = NULL;
+    if((stat = makes3fullpath(s3client->rooturl,bucket,pathkey,NULL,url))) goto done;
+    if((stat = NCH5_s3comms_s3r_getobject(s3client->h5s3client,ncbytescontents(url),&data,&httpcode))) goto done;
+    if((stat = httptonc(httpcode))) goto done;
+    if(lenp) *lenp = data.count;
+    if(contentp) {*contentp = data.content; data.content = NULL;}
+done:
+    nullfree(data.content);
+    ncbytesfree(url);
+    return NCUNTRACEX(stat,"len=%d",PTRVAL(int,lenp,-1));
+}
+
+/*
+Read n whole objects, keeping up to NC_S3_MAXCONNECTIONS
+requests in flight at once. The content of object i is returned
+in malloc'd memory in contents[i], its length in lens[i], and
+the outcome of its request (e.g. NC_ENOOBJECT) in stats[i].
+@return NC_NOERR if every request was performed
+@return NC_EXXX if fail
+*/
+/*EXTERNL*/ int
+NC_s3sdkreadobjects(void* s3client0, const char* bucket, size_t n, const char** pathkeys, size64_t* lens, void** contents, int* stats, char** errmsgp)
+{
+    int stat = NC_NOERR;
+    NCS3CLIENT* s3client = (NCS3CLIENT*)s3client0;
+    s3r_buf_t* data = NULL;
+    size_t i;
+
+    NCTRACE(11,"bucket=%s n=%d",bucket,(int)n);
+
+    if(errmsgp) *errmsgp = NULL;
+    if((data = (s3r_buf_t*)calloc(n == 0 ? 1 : n,sizeof(s3r_buf_t))) == NULL) {stat = NC_ENOMEM; goto done;}
+    stat = s3transfer(s3client,bucket,HTTPGET,n,pathkeys,data,stats);
+    for(i=0;i<n;i++) {
+        if(stat == NC_NOERR && stats[i] == NC_NOERR) {
+	    lens[i] = data[i].count;
+	    contents[i] = data[i].content;
+	} else {
+	    lens[i] = 0;
+	    contents[i] = NULL;
+	    nullfree(data[i].content);
+	}
+    }
+done:
+    nullfree(data);
+    return NCUNTRACE(stat);
+}
+
 /*
 For S3, I can see no way to do a byterange write;
 so we are effectively writing the whole object
@@ -342,6 +421,35 @@ done:
     return NCUNTRACE(stat);
 }
 
+/*
+Write n whole objects, keeping up to NC_S3_MAXCONNECTIONS
+requests in flight at once. The outcome of request i is
+returned in stats[i].
+@return NC_NOERR if every request was performed
+@return NC_EXXX if fail
+*/
+/*EXTERNL*/ int
+NC_s3sdkwriteobjects(void* s3client0, const char* bucket, size_t n, const char** pathkeys, const size64_t* counts, const void** contents, int* stats, char** errmsgp)
+{
+    int stat = NC_NOERR;
+    NCS3CLIENT* s3client = (NCS3CLIENT*)s3client0;
+    s3r_buf_t* data = NULL;
+    size_t i;
+
+    NCTRACE(11,"bucket=%s n=%d",bucket,(int)n);
+
+    if(errmsgp) *errmsgp = NULL;
+    if((data = (s3r_buf_t*)calloc(n == 0 ? 1 : n,sizeof(s3r_buf_t))) == NULL) {stat = NC_ENOMEM; goto done;}
+    for(i=0;i<n;i++) {
+        data[i].count = counts[i];
+	data[i].content = (void*)contents[i];
+    }
+    stat = s3transfer(s3client,bucket,HTTPPUT,n,pathkeys,data,stats);
+done:
+    nullfree(data);
+    return NCUNTRACE(stat);
+}
+
 /*EXTERNL*/ int
 NC_s3sdkclose(void* s3client0, char** errmsgp)
 {
@@ -547,7 +655,7 @@ makes3rooturl(NCS3INFO* info)
     NCbytes* buf = ncbytesnew();
     char* result = NULL;
     
-    ncbytescat(buf,"https://");
+    ncbytescat(buf,(info->http?"http://":"https://"));
     ncbytescat(buf,info->host);
     result = ncbytesextract(buf);
     ncbytesfree(buf);
@@ -625,13 +733,74 @@ mergekeysets(NClist* keys1, NClist* keys2, NClist* merge)
 static void
 s3client_destroy(NCS3CLIENT* s3client)
 {
+    size_t i;
     if(s3client) {
 	nullfree(s3client->rooturl);
-        (void)NCH5_s3comms_s3r_close(s3client->h5s3client);
+        if(s3client->h5s3client != NULL)
+            (void)NCH5_s3comms_s3r_close(s3client->h5s3client);
+	for(i=0;i<nclistlength(s3client->pool);i++)
+	    (void)NCH5_s3comms_s3r_close((s3r_t*)nclistget(s3client->pool,i));
+	nclistfree(s3client->pool);
+	NCH5_s3comms_s3r_multi_close(s3client->multi);
+	nullfree(s3client->region);
+	nullfree(s3client->accessid);
+	nullfree(s3client->accesskey);
         free(s3client);
     }
 }
 
+/*
+Perform n whole object requests, NC_S3_MAXCONNECTIONS at a time,
+each with its own handle from the pool of the client. The handles,
+and the connections of the curl multi handle, are kept for reuse.
+If a batch cannot be performed, its requests and all later ones
+get the error as their outcome.
+*/
+static int
+s3transfer(NCS3CLIENT* s3client, const char* bucket, HTTPVerb verb, size_t n, const char** pathkeys, s3r_buf_t* data, int* stats)
+{
+    int stat = NC_NOERR;
+    size_t i, j, batch;
+    s3r_t* handles[NC_S3_MAXCONNECTIONS];
+    char* urls[NC_S3_MAXCONNECTIONS];
+    long httpcodes[NC_S3_MAXCONNECTIONS];
+    NCbytes* url = ncbytesnew();
+
+    memset(handles,0,sizeof(handles));
+    memset(urls,0,sizeof(urls));
+    for(i=0;i<n;i+=batch) {
+        batch = n - i;
+	if(batch > NC_S3_MAXCONNECTIONS) batch = NC_S3_MAXCONNECTIONS;
+	for(j=0;j<batch;j++) {
+	    if(nclistlength(s3client->pool) > 0)
+	        handles[j] = (s3r_t*)nclistpop(s3client->pool);
+	    else {
+	        handles[j] = NCH5_s3comms_s3r_open(s3client->rooturl,s3client->svc,s3client->region,s3client->accessid,s3client->accesskey);
+	        if(handles[j] == NULL) {stat = NC_ES3; goto done;}
+	    }
+	    ncbytesclear(url);
+	    if((stat = makes3fullpath(s3client->rooturl,bucket,pathkeys[i+j],NULL,url))) goto done;
+	    urls[j] = ncbytesextract(url);
+	}
+	memset(httpcodes,0,sizeof(httpcodes));
+	stat = NCH5_s3comms_s3r_multi(&s3client->multi,batch,handles,verb,(const char**)urls,&data[i],httpcodes);
+	for(j=0;j<batch;j++) {
+	    if(stat == NC_NOERR) stats[i+j] = httptonc(httpcodes[j]);
+	    nclistpush(s3client->pool,handles[j]); handles[j] = NULL;
+	    nullfree(urls[j]); urls[j] = NULL;
+	}
+	if(stat) goto done;
+    }
+done:
+    if(stat) {for(;i<n;i++) stats[i] = stat;}
+    for(j=0;j<NC_S3_MAXCONNECTIONS;j++) {
+        if(handles[j] != NULL) nclistpush(s3client->pool,handles[j]);
+	nullfree(urls[j]);
+    }
+    ncbytesfree(url);
+    return NCTHROW(stat);
+}
+
 /**************************************************/
 /* XML Response Parser(s) */
 
@@ -0,0 +1,208 @@
+/*
+  Copyright (c) 1998-2018 University Corporation for Atmospheric Research/Unidata
+  See LICENSE.txt for license information.
+*/
+
+/** \file \internal
+    A fixed size pool of worker threads.
+
+    Tasks are queued in FIFO order and executed by the first free
+    worker. Each task belongs to a task group so that a caller can
+    wait for just its own tasks. Without pthreads, or with fewer
+    than two threads, ncthreadpoolsubmit runs the task inline.
+*/
+
+#include "config.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+#include "netcdf.h"
+#include "ncthreadpool.h"
+
+typedef struct NCtaskentry {
+    struct NCtaskentry* next;
+    NCtask task;
+    void* arg;
+    NCtaskgroup* group;
+} NCtaskentry;
+
+struct NCthreadpool {
+    size_t nthreads; /* 0 => run inline */
+#ifdef HAVE_PTHREAD_H
+    pthread_t* threads;
+    pthread_mutex_t lock;
+    pthread_cond_t work; /* signalled when a task is queued or on shutdown */
+    pthread_cond_t done; /* broadcast when any task completes */
+    NCtaskentry* head;
+    NCtaskentry* tail;
+    int shutdown;
+#endif
+};
+
+/**************************************************/
+
+static void
+taskdone(NCtaskgroup* group, int stat)
+{
+    assert(group->pending > 0);
+    group->pending--;
+    if(stat != NC_NOERR && group->stat == NC_NOERR)
+        group->stat = stat;
+}
+
+#ifdef HAVE_PTHREAD_H
+static void*
+worker(void* arg)
+{
+    NCthreadpool* pool = (NCthreadpool*)arg;
+    for(;;) {
+        NCtaskentry* t = NULL;
+	int stat;
+        pthread_mutex_lock(&pool->lock);
+	while(pool->head == NULL && !pool->shutdown)
+	    pthread_cond_wait(&pool->work,&pool->lock);
+	if(pool->head == NULL) { /* shutdown and nothing left to do */
+	    pthread_mutex_unlock(&pool->lock);
+	    break;
+	}
+	t = pool->head;
+	pool->head = t->next;
+	if(pool->head == NULL) pool->tail = NULL;
+        pthread_mutex_unlock(&pool->lock);
+
+	stat = t->task(t->arg);
+
+        pthread_mutex_lock(&pool->lock);
+	taskdone(t->group,stat);
+	pthread_cond_broadcast(&pool->done);
+        pthread_mutex_unlock(&pool->lock);
+	free(t);
+    }
+    return NULL;
+}
+#endif
+
+int
+ncthreadpoolnew(size_t nthreads, NCthreadpool** poolp)
+{
+    int stat = NC_NOERR;
+    NCthreadpool* pool = NULL;
+
+    if((pool = (NCthreadpool*)calloc(1,sizeof(NCthreadpool))) == NULL)
+        {stat = NC_ENOMEM; goto done;}
+#ifdef HAVE_PTHREAD_H
+    if(nthreads > 1) {
+	size_t i;
+	pthread_mutex_init(&pool->lock,NULL);
+	pthread_cond_init(&pool->work,NULL);
+	pthread_cond_init(&pool->done,NULL);
+	if((pool->threads = (pthread_t*)calloc(nthreads,sizeof(pthread_t))) == NULL)
+	    {stat = NC_ENOMEM; goto done;}
+	for(i=0;i<nthreads;i++) {
+	    if(pthread_create(&pool->threads[i],NULL,worker,pool) != 0) break;
+	    pool->nthreads++;
+	}
+	if(pool->nthreads == 0) {stat = NC_EINTERNAL; goto done;}
+    }
+#else
+    (void)nthreads;
+#endif
+    if(poolp) {*poolp = pool; pool = NULL;}
+done:
+    ncthreadpoolfree(pool);
+    return stat;
+}
+
+void
+ncthreadpoolfree(NCthreadpool* pool)
+{
+    if(pool == NULL) return;
+#ifdef HAVE_PTHREAD_H
+    if(pool->threads != NULL) {
+	size_t i;
+        pthread_mutex_lock(&pool->lock);
+	pool->shutdown = 1;
+	pthread_cond_broadcast(&pool->work);
+        pthread_mutex_unlock(&pool->lock);
+	for(i=0;i<pool->nthreads;i++)
+	    pthread_join(pool->threads[i],NULL);
+	free(pool->threads);
+	pthread_cond_destroy(&pool->done);
+	pthread_cond_destroy(&pool->work);
+	pthread_mutex_destroy(&pool->lock);
+    }
+#endif
+    free(pool);
+}
+
+size_t
+ncthreadpoolsize(NCthreadpool* pool)
+{
+    return (pool == NULL ? 0 : pool->nthreads);
+}
+
+void
+nctaskgroupinit(NCtaskgroup* group)
+{
+    group->pending = 0;
+    group->stat = NC_NOERR;
+}
+
+int
+ncthreadpoolsubmit(NCthreadpool* pool, NCtaskgroup* group, NCtask task, void* arg)
+{
+    int stat = NC_NOERR;
+#ifdef HAVE_PTHREAD_H
+    NCtaskentry* t = NULL;
+
+    if(pool != NULL && pool->nthreads > 0) {
+	if((t = (NCtaskentry*)calloc(1,sizeof(NCtaskentry))) == NULL)
+	    {stat = NC_ENOMEM; goto done;}
+	t->task = task;
+	t->arg = arg;
+	t->group = group;
+        pthread_mutex_lock(&pool->lock);
+	group->pending++;
+	if(pool->tail == NULL) pool->head = t; else pool->tail->next = t;
+	pool->tail = t;
+	pthread_cond_signal(&pool->work);
+        pthread_mutex_unlock(&pool->lock);
+	goto done;
+    }
+#endif
+    /* Run it now */
+    group->pending++;
+    taskdone(group,task(arg));
+#ifdef HAVE_PTHREAD_H
+done:
+#endif
+    return stat;
+}
+
+int
+ncthreadpoolwait(NCthreadpool* pool, NCtaskgroup* group, size_t maxpending)
+{
+    int stat = NC_NOERR;
+#ifdef HAVE_PTHREAD_H
+    if(pool != NULL && pool->nthreads > 0) {
+        pthread_mutex_lock(&pool->lock);
+	while(group->pending > maxpending)
+	    pthread_cond_wait(&pool->done,&pool->lock);
+	stat = group->stat;
+	group->stat = NC_NOERR;
+        pthread_mutex_unlock(&pool->lock);
+	return stat;
+    }
+#else
+    (void)pool;
+#endif
+    (void)maxpending;
+    stat = group->stat;
+    group->stat = NC_NOERR;
+    return stat;
+}
@@ -67,6 +67,14 @@ typedef off_t file_offset_t;
 /* The driver identification number, initialized at runtime */
 static hid_t H5FD_HTTP_g = 0;
 
+/* Counters of all the files read by this driver, see H5FD_http_get_stats() */
+static NC_HTTP_STATS H5FD_http_stats_g;
+
+/* The number of bytes at the start of the file to read at open; this
+   gets the superblock and, in most files, the object headers and
+   B-tree nodes of the root group in one request. */
+#define METADATA_PREFETCH (256*1024)
+
 /* File operations */
 typedef enum {
     H5FD_HTTP_OP_UNKNOWN=0,
@@ -94,6 +102,7 @@ typedef struct H5FD_http_t {
     unsigned    write_access;   /* Flag to indicate the file was opened with write access */
     H5FD_http_file_op op;	/* last operation */
     NC_HTTP_STATE*  state;       /* Curl handle + extra */
+    NC_HTTP_CACHE*  cache;      /* Pages of the object, see dhttpcache.c */
     char*           url;        /* The URL (minus any fragment) for the dataset */ 
 } H5FD_http_t;
 
@@ -133,6 +142,10 @@ static herr_t H5FD_http_read(H5FD_t *lf, H5FD_mem_t type, hid_t fapl_id, haddr_t
                 size_t size, void *buf);
 static herr_t H5FD_http_write(H5FD_t *lf, H5FD_mem_t type, hid_t fapl_id, haddr_t addr,
                 size_t size, const void *buf);
+#if H5FD_CLASS_VERSION > 0
+static herr_t H5FD_http_read_vector(H5FD_t *lf, hid_t dxpl_id, uint32_t count,
+                H5FD_mem_t types[], haddr_t addrs[], size_t sizes[], void *bufs[]);
+#endif
 static herr_t H5FD_http_term(void);
 
 /* The H5FD_class_t structure has different versions */
@@ -175,7 +188,7 @@ static const H5FD_class_t H5FD_http_g = {
     H5FD_http_read,		/* read         */
     H5FD_http_write,		/* write        */
 #if H5FD_CLASS_VERSION > 0
-    NULL,			/* read_vector     */
+    H5FD_http_read_vector,	/* read_vector     */
     NULL,			/* write_vector    */
     NULL,			/* read_selection  */
     NULL,			/* write_selection */
@@ -294,6 +307,31 @@ H5Pset_fapl_http(hid_t fapl_id)
 } /* end H5Pset_fapl_http() */
 
 
+/*-------------------------------------------------------------------------
+ * Function:  H5FD_http_get_stats
+ *
+ * Purpose:  Get the counters of the byte-range requests made for all
+ *    the files read with this driver, and optionally reset them.
+ *
+ * Return:  Non-negative on success/Negative on failure
+ *
+ *-------------------------------------------------------------------------
+ */
+EXTERNL herr_t
+H5FD_http_get_stats(H5FD_http_stats_t *stats, hbool_t reset)
+{
+    if(stats != NULL) {
+        stats->requests = H5FD_http_stats_g.requests;
+        stats->bytes = H5FD_http_stats_g.bytes;
+        stats->hits = H5FD_http_stats_g.hits;
+        stats->misses = H5FD_http_stats_g.misses;
+    }
+    if(reset)
+        memset(&H5FD_http_stats_g,0,sizeof(H5FD_http_stats_g));
+    return 0;
+} /* end H5FD_http_get_stats() */
+
+
 /*-------------------------------------------------------------------------
  * Function:  H5FD_http_open
  *
@@ -365,9 +403,15 @@ H5FD_http_open( const char *name, unsigned flags, hid_t /*UNUSED*/ fapl_id,
     file->write_access = write_access;    /* Note the write_access for later */
     file->eof = (haddr_t)len;
     file->state = state; state = NULL;
+    /* Set up the page cache and read the front of the file */
+    if((ncstat = nc_http_cache_open(file->state,len,&H5FD_http_stats_g,&file->cache))
+       || (ncstat = nc_http_cache_prefetch(file->cache,0,METADATA_PREFETCH))) {
+        H5FD_http_close((H5FD_t*)file);
+        H5Epush_ret(func, H5E_ERR_CLS, H5E_IO, H5E_CANTOPENFILE, "cannot access object", NULL);
+    }
     file->url = H5allocate_memory(strlen(name)+1,0);
     if(file->url == NULL) {
-	nc_http_close(state);
+        H5FD_http_close((H5FD_t*)file);
         H5Epush_ret(func, H5E_ERR_CLS, H5E_RESOURCE, H5E_NOSPACE, "memory allocation failed", NULL);
     }
     memcpy(file->url,name,strlen(name)+1);
@@ -402,6 +446,7 @@ H5FD_http_close(H5FD_t *_file)
     H5Eclear2(H5E_DEFAULT);
 
     /* Close the underlying curl handle*/
+    nc_http_cache_close(file->cache);
     if(file->state) nc_http_close(file->state);
     if(file->url) H5free_memory(file->url);
 
@@ -717,25 +762,12 @@ H5FD_http_read(H5FD_t *_file, H5FD_mem_t /*UNUSED*/ type, hid_t /*UNUSED*/ dxpl_
         size -= nbytes;
     }
 
-    {
-	NCbytes* bbuf = ncbytesnew();
-        if((ncstat = nc_http_read(file->state,addr,size,bbuf))) {
-            file->op = H5FD_HTTP_OP_UNKNOWN;
-            file->pos = HADDR_UNDEF;
-	    ncbytesfree(bbuf); bbuf = NULL;
-            H5Epush_ret(func, H5E_ERR_CLS, H5E_IO, H5E_READERROR, "HTTP byte-range read failed", -1);
-        } /* end if */
-
-	/* Check that proper number of bytes was read */
-	if(ncbyteslength(bbuf) != size) {
-	    ncbytesfree(bbuf); bbuf = NULL;
-            H5Epush_ret(func, H5E_ERR_CLS, H5E_IO, H5E_READERROR, "HTTP byte-range read mismatch ", -1);
-	}	
-
-	/* Extract the data from buf */
-	memcpy(buf,ncbytescontents(bbuf),size);	        
-	ncbytesfree(bbuf);
-    }
+    /* Read through the page cache */
+    if((ncstat = nc_http_cache_read(file->cache,addr,size,buf))) {
+        file->op = H5FD_HTTP_OP_UNKNOWN;
+        file->pos = HADDR_UNDEF;
+        H5Epush_ret(func, H5E_ERR_CLS, H5E_IO, H5E_READERROR, "HTTP byte-range read failed", -1);
+    } /* end if */
 
     /* Update the file position data. */
     file->op = H5FD_HTTP_OP_READ;
@@ -745,6 +777,74 @@ H5FD_http_read(H5FD_t *_file, H5FD_mem_t /*UNUSED*/ type, hid_t /*UNUSED*/ dxpl_
 }
 
 
+#if H5FD_CLASS_VERSION > 0
+/*-------------------------------------------------------------------------
+ * Function:  H5FD_http_read_vector
+ *
+ * Purpose:  Reads COUNT pieces of file LF, piece I being SIZES[I] bytes
+ *    at address ADDRS[I] into BUFS[I]. A size of zero means the
+ *    same size as the previous piece. The pages missing from the
+ *    cache are fetched together, adjacent pages in one request.
+ *
+ * Errors:
+ *    IO    READERROR  read failed.
+ *
+ * Return:  Non-negative on success/Negative on failure
+ *
+ *-------------------------------------------------------------------------
+ */
+static herr_t
+H5FD_http_read_vector(H5FD_t *_file, hid_t /*UNUSED*/ dxpl_id, uint32_t count,
+    H5FD_mem_t /*UNUSED*/ types[], haddr_t addrs[], size_t sizes[], void /*OUT*/ *bufs[])
+{
+    H5FD_http_t    *file = (H5FD_http_t*)_file;
+    static const char *func = "H5FD_http_read_vector";  /* Function Name for error reporting */
+    int ncstat = NC_NOERR;
+    size64_t *starts = NULL;
+    size64_t *counts = NULL;
+    size_t size = 0;
+    uint32_t i;
+
+    /* Quiet the compiler */
+    types = types;
+    dxpl_id = dxpl_id;
+
+    /* Clear the error stack */
+    H5Eclear2(H5E_DEFAULT);
+
+    if (0 == count)
+        return 0;
+    starts = (size64_t*)malloc(count * sizeof(size64_t));
+    counts = (size64_t*)malloc(count * sizeof(size64_t));
+    if (starts == NULL || counts == NULL) {
+        free(starts); free(counts);
+        H5Epush_ret(func, H5E_ERR_CLS, H5E_RESOURCE, H5E_NOSPACE, "memory allocation failed", -1);
+    }
+    for (i = 0; i < count; i++) {
+        if (i == 0 || sizes[i] != 0)
+            size = sizes[i];
+        /* Check for overflow */
+        if (HADDR_UNDEF == addrs[i] || REGION_OVERFLOW(addrs[i], size)) {
+            free(starts); free(counts);
+            H5Epush_ret(func, H5E_ERR_CLS, H5E_IO, H5E_OVERFLOW, "file address overflowed", -1);
+        }
+        starts[i] = (size64_t)addrs[i];
+        counts[i] = (size64_t)size;
+    }
+    ncstat = nc_http_cache_readv(file->cache, (size_t)count, starts, counts, bufs);
+    free(starts);
+    free(counts);
+    if (ncstat) {
+        file->op = H5FD_HTTP_OP_UNKNOWN;
+        file->pos = HADDR_UNDEF;
+        H5Epush_ret(func, H5E_ERR_CLS, H5E_IO, H5E_READERROR, "HTTP byte-range read failed", -1);
+    }
+    file->op = H5FD_HTTP_OP_READ;
+    file->pos = HADDR_UNDEF;
+    return 0;
+} /* end H5FD_http_read_vector() */
+#endif
+
 /*-------------------------------------------------------------------------
  * Function:  H5FD_http_write
  *
@@ -60,6 +60,16 @@ EXTERNL hid_t H5FD_http_init(void);
 EXTERNL hid_t H5FD_http_finalize(void);
 EXTERNL herr_t H5Pset_fapl_http(hid_t fapl_id);
 
+/* Counters of the byte-range requests made by the driver */
+typedef struct H5FD_http_stats_t {
+    unsigned long long requests; /* range requests made */
+    unsigned long long bytes;    /* bytes received */
+    unsigned long long hits;     /* reads served from the page cache */
+    unsigned long long misses;   /* reads that needed a request */
+} H5FD_http_stats_t;
+
+EXTERNL herr_t H5FD_http_get_stats(H5FD_http_stats_t *stats, hbool_t reset);
+
 #ifdef __cplusplus
 }
 #endif
@@ -268,9 +268,15 @@ nc4_find_dim_len(NC_GRP_INFO_T *grp, int dimid, size_t **len)
     /* If there are any groups, call this function recursively on
      * them. */
     for (size_t i = 0; i < ncindexsize(grp->children); i++)
-        if ((retval = nc4_find_dim_len((NC_GRP_INFO_T*)ncindexith(grp->children, i),
-                                       dimid, len)))
+    {
+        NC_GRP_INFO_T *child = (NC_GRP_INFO_T *)ncindexith(grp->children, i);
+
+        /* Variables in unread groups may use the dim too. */
+        if ((retval = nc4_read_deferred_grp(child)))
             return retval;
+        if ((retval = nc4_find_dim_len(child, dimid, len)))
+            return retval;
+    }
 
     /* For all variables in this group, find the ones that use this
      * dimension, and remember the max length. */
@@ -67,6 +67,7 @@ extern int NC4_open_image_file(NC_FILE_INFO_T* h5);
 
 /* Defined later in this file. */
 static int rec_read_metadata(NC_GRP_INFO_T *grp);
+static int read_deferred_grp(NC_GRP_INFO_T *grp);
 static int read_type(NC_GRP_INFO_T *grp, hid_t hdf_typeid, char *type_name);
 
 /**
@@ -973,6 +974,11 @@ nc4_open_file(const char *path, int mode, void* parameters, int ncid)
 	  BAIL(NC_EHDFERR);
     }
 
+    /* With NC_LAZY_GROUPS, a read-only serial open reads only the
+     * root group here; the others are read when first used. */
+    if ((mode & NC_LAZY_GROUPS) && nc4_info->no_write && !nc4_info->parallel)
+        nc4_info->read_grp = read_deferred_grp;
+
     /* Now read in all the metadata. Some types and dimscale
      * information may be difficult to resolve here, if, for example, a
      * dataset of user-defined type is encountered before the
@@ -2483,6 +2489,10 @@ read_scale(NC_GRP_INFO_T *grp, hid_t datasetid, const char *obj_name,
         /* Check if scale's dimid should impact the group's next dimid */
         if (assigned_id >= grp->nc4_info->next_dimid)
             grp->nc4_info->next_dimid = assigned_id + 1;
+        /* A group read after others (NC_LAZY_GROUPS) may find its
+         * dimid already given to a phony dim; take a new one. */
+        else if (nclistget(grp->nc4_info->alldims, (size_t)assigned_id))
+            assigned_id = -1;
     }
 
     /* Get dim size. On machines with a size_t of less than 8 bytes, it
@@ -2902,8 +2912,11 @@ rec_read_metadata(NC_GRP_INFO_T *grp)
         if (!(child_grp->format_grp_info = calloc(1, sizeof(NC_HDF5_GRP_INFO_T))))
             return NC_ENOMEM;
 
-        /* Recursively read the child group's metadata. */
-        if ((retval = rec_read_metadata(child_grp)))
+        /* Recursively read the child group's metadata, or leave it
+         * until the group is used. */
+        if (grp->nc4_info->read_grp)
+            child_grp->meta_deferred = NC_TRUE;
+        else if ((retval = rec_read_metadata(child_grp)))
             BAIL(retval);
     }
 
@@ -2929,6 +2942,37 @@ exit:
     return retval;
 }
 
+/**
+ * @internal Read the metadata of a group left unread by an
+ * NC_LAZY_GROUPS open, and match its vars to their dimscales. This is
+ * the read_grp hook of the file; it is called through
+ * nc4_read_deferred_grp() when the group is first used. The group's
+ * children are added, but are not read. As on an eager open, vars
+ * are only matched to dimscales in the group and its ancestors,
+ * which have all been read by now.
+ *
+ * @param grp Pointer to a group.
+ *
+ * @return ::NC_NOERR No error.
+ * @return ::NC_EHDFERR HDF5 error.
+ * @return ::NC_ENOMEM Out of memory.
+ */
+static int
+read_deferred_grp(NC_GRP_INFO_T *grp)
+{
+    int retval;
+
+    assert(grp && grp->meta_deferred && grp->parent);
+    LOG((3, "%s: grp->hdr.name %s", __func__, grp->hdr.name));
+
+    /* Clear this first, so lookups made while reading the group do
+     * not come back here. */
+    grp->meta_deferred = NC_FALSE;
+    if ((retval = rec_read_metadata(grp)))
+        return retval;
+    return rec_match_dimscales(grp);
+}
+
 /**
  * Wrapper function for H5Fopen.
  * Converts the filename from ANSI to UTF-8 as needed before calling H5Fopen.
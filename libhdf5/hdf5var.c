@@ -1506,6 +1506,162 @@ set_par_access(NC_FILE_INFO_T *h5, NC_VAR_INFO_T *var, hid_t xfer_plistid)
 }
 #endif /* USE_PARALLEL4 */
 
+/**
+ * @internal Decide whether a transfer of len elements that needs type
+ * conversion should be done in strips by convert_strips() rather than
+ * through a single buffer holding all the data in the file type.
+ *
+ * @param h5 Pointer to HDF5 file info struct.
+ * @param var Pointer to var info struct.
+ * @param len Number of elements to transfer.
+ *
+ * @returns 1 to use strips, 0 otherwise.
+ */
+static int
+use_strips(NC_FILE_INFO_T *h5, NC_VAR_INFO_T *var, size_t len)
+{
+    if (var->ndims == 0 || var->type_info->nc_type_class == NC_STRING)
+        return 0;
+#ifdef USE_PARALLEL4
+    /* Collective transfers need the same number of calls on every
+     * process. */
+    if (h5->parallel)
+        return 0;
+#else
+    NC_UNUSED(h5);
+#endif
+    return (len * var->type_info->size > NC_HDF5_CONVERT_STRIP_SIZE);
+}
+
+/**
+ * @internal Read or write a hyperslab that needs type conversion, a
+ * strip of the leading dimension at a time. Only a strip sized buffer
+ * in the file type is needed, and each strip is converted while it is
+ * still in cache. For chunked variables the strips start and end on
+ * chunk boundaries along the leading dimension, so that each chunk is
+ * only read once.
+ *
+ * @param h5 Pointer to HDF5 file info struct.
+ * @param var Pointer to var info struct.
+ * @param file_spaceid File dataspace; its selection is overwritten.
+ * @param xfer_plistid Data transfer property list.
+ * @param start Start of the hyperslab in the file.
+ * @param count Counts of the hyperslab.
+ * @param stride Strides of the hyperslab.
+ * @param data The caller's data, in mem_nc_type.
+ * @param mem_nc_type The type of the data in memory.
+ * @param writing Non-zero to write data, zero to read it.
+ * @param range_errorp Set to 1 if any conversion has a range error.
+ *
+ * @returns ::NC_NOERR No error.
+ * @returns ::NC_EHDFERR HDF5 function returned error.
+ * @returns ::NC_ENOMEM Out of memory.
+ */
+static int
+convert_strips(NC_FILE_INFO_T *h5, NC_VAR_INFO_T *var, hid_t file_spaceid,
+               hid_t xfer_plistid, const hsize_t *start, const hsize_t *count,
+               const hsize_t *stride, void *data, nc_type mem_nc_type,
+               int writing, int *range_errorp)
+{
+    NC_HDF5_VAR_INFO_T *hdf5_var = (NC_HDF5_VAR_INFO_T *)var->format_var_info;
+    hid_t native_typeid = ((NC_HDF5_TYPE_INFO_T *)var->type_info->format_type_info)->native_hdf_typeid;
+    hid_t mem_spaceid = 0;
+    hsize_t sstart[NC_MAX_VAR_DIMS], scount[NC_MAX_VAR_DIMS];
+    hsize_t rows, done, chunk0 = 0;
+    size_t file_type_size = var->type_info->size;
+    size_t mem_type_size, inner = 1;
+    char *memp = (char *)data;
+    void *bufr = NULL;
+    int retval = NC_NOERR, range_error, d;
+
+    if ((retval = nc4_get_typelen_mem(h5, mem_nc_type, &mem_type_size)))
+        return retval;
+
+    for (d = 0; d < var->ndims; d++)
+    {
+        sstart[d] = start[d];
+        scount[d] = count[d];
+        if (d > 0)
+            inner *= count[d];
+    }
+    if (inner == 0 || count[0] == 0)
+        return NC_NOERR;
+
+    /* How many leading indices fit in a strip? */
+    if ((rows = NC_HDF5_CONVERT_STRIP_SIZE / (inner * file_type_size)) == 0)
+        rows = 1;
+    if (var->storage == NC_CHUNKED && stride[0] == 1 && var->chunksizes &&
+        var->chunksizes[0] > 1)
+    {
+        chunk0 = var->chunksizes[0];
+        rows = ((rows + chunk0 - 1) / chunk0) * chunk0;
+    }
+    if (rows > count[0])
+        rows = count[0];
+
+    if (!(bufr = malloc(rows * inner * file_type_size)))
+        BAIL(NC_ENOMEM);
+
+    for (done = 0; done < count[0]; done += scount[0])
+    {
+        size_t n;
+
+        sstart[0] = start[0] + done * stride[0];
+        scount[0] = rows;
+        if (chunk0)
+        {
+            /* End the strip on a chunk boundary. */
+            hsize_t end = ((sstart[0] + rows) / chunk0) * chunk0;
+            if (end > sstart[0])
+                scount[0] = end - sstart[0];
+        }
+        if (scount[0] > count[0] - done)
+            scount[0] = count[0] - done;
+        n = (size_t)scount[0] * inner;
+
+        if (H5Sselect_hyperslab(file_spaceid, H5S_SELECT_SET, sstart, stride,
+                                scount, NULL) < 0)
+            BAIL(NC_EHDFERR);
+        if (mem_spaceid > 0 && H5Sclose(mem_spaceid) < 0)
+            BAIL(NC_EHDFERR);
+        if ((mem_spaceid = H5Screate_simple((int)var->ndims, scount, NULL)) < 0)
+            BAIL(NC_EHDFERR);
+
+        if (writing)
+        {
+            if ((retval = nc4_convert_type(memp, bufr, mem_nc_type, var->type_info->hdr.id,
+                                           n, &range_error, var->fill_value,
+                                           (h5->cmode & NC_CLASSIC_MODEL), var->quantize_mode,
+                                           var->nsd)))
+                BAIL(retval);
+            if (H5Dwrite(hdf5_var->hdf_datasetid, native_typeid, mem_spaceid,
+                         file_spaceid, xfer_plistid, bufr) < 0)
+                BAIL(NC_EHDFERR);
+        }
+        else
+        {
+            if (H5Dread(hdf5_var->hdf_datasetid, native_typeid, mem_spaceid,
+                        file_spaceid, xfer_plistid, bufr) < 0)
+                BAIL(NC_EHDFERR);
+            if ((retval = nc4_convert_type(bufr, memp, var->type_info->hdr.id, mem_nc_type,
+                                           n, &range_error, var->fill_value,
+                                           (h5->cmode & NC_CLASSIC_MODEL), var->quantize_mode,
+                                           var->nsd)))
+                BAIL(retval);
+        }
+        if (range_error)
+            *range_errorp = 1;
+        memp += n * mem_type_size;
+    }
+
+exit:
+    if (mem_spaceid > 0 && H5Sclose(mem_spaceid) < 0)
+        BAIL2(NC_EHDFERR);
+    if (bufr)
+        free(bufr);
+    return retval;
+}
+
 /**
  * @internal Write a strided array of data to a variable. This is
  * called by nc_put_vars() and other nc_put_vars_* functions, for
@@ -1559,6 +1715,7 @@ NC4_put_vars(int ncid, int varid, const size_t *startp, const size_t *countp,
     int retval, range_error = 0, i, d2;
     void *bufr = NULL;
     int need_to_convert = 0;
+    int strips = 0;
     int zero_count = 0; /* true if a count is zero */
     size_t len = 1;
 
@@ -1692,8 +1849,11 @@ NC4_put_vars(int ncid, int varid, const size_t *startp, const size_t *countp,
 
         /* If we're reading, we need bufr to have enough memory to store
          * the data in the file. If we're writing, we need bufr to be
-         * big enough to hold all the data in the file's type. */
-        if (len > 0)
+         * big enough to hold all the data in the file's type. Large
+         * writes convert a strip at a time instead. */
+        if (use_strips(h5, var, len))
+            strips++;
+        else if (len > 0)
             if (!(bufr = malloc(len * file_type_size)))
                 BAIL(NC_ENOMEM);
     }
@@ -1796,23 +1956,34 @@ NC4_put_vars(int ncid, int varid, const size_t *startp, const size_t *countp,
         }
     }
 
-    /* Do we need to convert the data? */
-    if (need_to_convert)
+    if (strips)
     {
-        if ((retval = nc4_convert_type(data, bufr, mem_nc_type, var->type_info->hdr.id,
-                                       len, &range_error, var->fill_value,
-                                       (h5->cmode & NC_CLASSIC_MODEL), var->quantize_mode,
-				       var->nsd)))
+        /* Convert and write the data a strip at a time. */
+        if ((retval = convert_strips(h5, var, file_spaceid, xfer_plistid, start,
+                                     count, stride, (void *)data, mem_nc_type, 1,
+                                     &range_error)))
             BAIL(retval);
     }
+    else
+    {
+        /* Do we need to convert the data? */
+        if (need_to_convert)
+        {
+            if ((retval = nc4_convert_type(data, bufr, mem_nc_type, var->type_info->hdr.id,
+                                           len, &range_error, var->fill_value,
+                                           (h5->cmode & NC_CLASSIC_MODEL), var->quantize_mode,
+                                           var->nsd)))
+                BAIL(retval);
+        }
 
-    /* Write the data. At last! */
-    LOG((4, "about to H5Dwrite datasetid 0x%x mem_spaceid 0x%x "
-         "file_spaceid 0x%x", hdf5_var->hdf_datasetid, mem_spaceid, file_spaceid));
-    if (H5Dwrite(hdf5_var->hdf_datasetid,
-                 ((NC_HDF5_TYPE_INFO_T *)var->type_info->format_type_info)->native_hdf_typeid,
-                 mem_spaceid, file_spaceid, xfer_plistid, bufr) < 0)
-        BAIL(NC_EHDFERR);
+        /* Write the data. At last! */
+        LOG((4, "about to H5Dwrite datasetid 0x%x mem_spaceid 0x%x "
+             "file_spaceid 0x%x", hdf5_var->hdf_datasetid, mem_spaceid, file_spaceid));
+        if (H5Dwrite(hdf5_var->hdf_datasetid,
+                     ((NC_HDF5_TYPE_INFO_T *)var->type_info->format_type_info)->native_hdf_typeid,
+                     mem_spaceid, file_spaceid, xfer_plistid, bufr) < 0)
+            BAIL(NC_EHDFERR);
+    }
 
     /* Remember that we have written to this var so that Fill Value
      * can't be set for it. */
@@ -1899,6 +2070,7 @@ NC4_get_vars(int ncid, int varid, const size_t *startp, const size_t *countp,
     int scalar = 0, retval, range_error = 0, i, d2;
     void *bufr = NULL;
     int need_to_convert = 0;
+    int strips = 0;
     size_t len = 1;
     int fixedlengthstring = 0;
     hsize_t fstring_len = 0;
@@ -1987,8 +2159,11 @@ NC4_get_vars(int ncid, int varid, const size_t *startp, const size_t *countp,
 
         /* If we're reading, we need bufr to have enough memory to store
          * the data in the file. If we're writing, we need bufr to be
-         * big enough to hold all the data in the file's type. */
-        if (len > 0)
+         * big enough to hold all the data in the file's type. Large
+         * reads convert a strip at a time instead. */
+        if (use_strips(h5, var, len))
+            strips++;
+        else if (len > 0)
             if (!(bufr = malloc(len * file_type_size)))
                 BAIL(NC_ENOMEM);
     }
@@ -2155,9 +2330,16 @@ NC4_get_vars(int ncid, int varid, const size_t *startp, const size_t *countp,
 
         /* Read this hyperslab into memory. */
         LOG((5, "About to H5Dread some data..."));
-        if (H5Dread(hdf5_var->hdf_datasetid,
-                    ((NC_HDF5_TYPE_INFO_T *)var->type_info->format_type_info)->native_hdf_typeid,
-                    mem_spaceid, file_spaceid, xfer_plistid, bufr) < 0)
+        if (strips)
+        {
+            if ((retval = convert_strips(h5, var, file_spaceid, xfer_plistid, start,
+                                         count, stride, data, mem_nc_type, 0,
+                                         &range_error)))
+                BAIL(retval);
+        }
+        else if (H5Dread(hdf5_var->hdf_datasetid,
+                         ((NC_HDF5_TYPE_INFO_T *)var->type_info->format_type_info)->native_hdf_typeid,
+                         mem_spaceid, file_spaceid, xfer_plistid, bufr) < 0)
             BAIL(NC_EHDFERR);
     } /* endif ! no_read */
     else
@@ -2235,8 +2417,18 @@ NC4_get_vars(int ncid, int varid, const size_t *startp, const size_t *countp,
         for (fill_len = 1, d2 = 0; d2 < var->ndims; d2++)
             fill_len *= (fill_value_size[d2] ? fill_value_size[d2] : 1);
 
-        /* Copy the fill value into the rest of the data buffer. */
-        filldata = (char *)bufr + real_data_size;
+        /* Copy the fill value into the rest of the data buffer. When
+         * reading in strips, the real data has already been converted
+         * into the caller's buffer, so the fill values get a buffer of
+         * their own. */
+        if (strips)
+        {
+            if (!(bufr = malloc(fill_len * file_type_size)))
+                BAIL(NC_ENOMEM);
+            filldata = bufr;
+        }
+        else
+            filldata = (char *)bufr + real_data_size;
         for (i = 0; i < fill_len; i++)
         {
 
@@ -2247,12 +2439,29 @@ NC4_get_vars(int ncid, int varid, const size_t *startp, const size_t *countp,
 	    }
             filldata = (char *)filldata + file_type_size;
 	}        
+
+        if (strips)
+        {
+            size_t mem_type_size;
+            int fill_range_error = 0;
+
+            if ((retval = nc4_get_typelen_mem(h5, mem_nc_type, &mem_type_size)))
+                BAIL(retval);
+            if ((retval = nc4_convert_type(bufr, (char *)data + (real_data_size / file_type_size) * mem_type_size,
+                                           var->type_info->hdr.id, mem_nc_type,
+                                           fill_len, &fill_range_error, var->fill_value,
+                                           (h5->cmode & NC_CLASSIC_MODEL), var->quantize_mode, var->nsd)))
+                BAIL(retval);
+            if (fill_range_error)
+                range_error = 1;
+        }
     }
 
     /* Convert data type if needed. */
     if (need_to_convert)
     {
-        if ((retval = nc4_convert_type(bufr, data, var->type_info->hdr.id, mem_nc_type,
+        if (!strips &&
+            (retval = nc4_convert_type(bufr, data, var->type_info->hdr.id, mem_nc_type,
 				       len, &range_error, var->fill_value,
 				       (h5->cmode & NC_CLASSIC_MODEL), var->quantize_mode, var->nsd)))
             BAIL(retval);
@@ -214,6 +214,11 @@ nc_finalize(void)
     /* Do general finalization */
     if((stat = NCDISPATCH_finalize())) failed = stat;
 
+#ifdef NETCDF_ENABLE_THREADSAFE
+    /* The list of open files is kept when it empties; see del_from_NCList */
+    free_NCList();
+#endif
+
 done:
     if(failed) fprintf(stderr,"nc_finalize failed: %d\n",failed);
     return failed;
@@ -153,12 +153,14 @@ ncz_open_dataset(NC_FILE_INFO_T* file, NClist* controls)
     	goto done;
     }
 
-    /* Determine zarr format of existing dataset */
-    if((stat = NCZ_infer_zarr_format(file))) {
+    /* Read any consolidated metadata first so that the format
+       can be inferred from it without more requests */
+    if((stat = NCZMD_set_metadata_handler(zinfo))) {
         goto done;
     }
 
-    if((stat = NCZMD_set_metadata_handler(zinfo))) {
+    /* Determine zarr format of existing dataset */
+    if((stat = NCZ_infer_zarr_format(file))) {
         goto done;
     }
 
@@ -268,7 +270,6 @@ applycontrols(NCZ_FILE_INFO_T* zinfo)
     /* Process the modelist first */
     zinfo->controls.mapimpl = NCZM_DEFAULT;
     zinfo->controls.flags |= FLAG_XARRAYDIMS; /* Always support XArray convention where possible */
-    zinfo->controls.flags |= (NCZARR_CONSOLIDATED_DEFAULT ? FLAG_CONSOLIDATED : 0);
     for(i=0;i<nclistlength(modelist);i++) {
         const char* p = nclistget(modelist,i);
 	if(strcasecmp(p,PUREZARRCONTROL)==0)
@@ -280,8 +281,10 @@ applycontrols(NCZ_FILE_INFO_T* zinfo)
 	else if(strcasecmp(p,"zip")==0) zinfo->controls.mapimpl = NCZM_ZIP;
 	else if(strcasecmp(p,"file")==0) zinfo->controls.mapimpl = NCZM_FILE;
 	else if(strcasecmp(p,"s3")==0) zinfo->controls.mapimpl = NCZM_S3;
-	else if(strcasecmp(p,"consolidated") == 0)
-	        zinfo->controls.flags |= FLAG_CONSOLIDATED;
+	else if(strcasecmp(p,CONSOLIDATEDCONTROL)==0)
+	    zinfo->controls.flags |= FLAG_CONSOLIDATED;
+	else if(strcasecmp(p,NOCONSOLIDATEDCONTROL)==0)
+	    zinfo->controls.flags |= FLAG_NOCONSOLIDATED;
     }
     /* Apply negative controls by turning off negative flags */
     /* This is necessary to avoid order dependence of mode flags when both positive and negative flags are defined */
@@ -54,6 +54,7 @@ EXTERNL int ncz_read_grp(NC_FILE_INFO_T* file, NC_GRP_INFO_T* grp);
 EXTERNL int ncz_read_atts(NC_FILE_INFO_T* file, NC_OBJ* container);
 EXTERNL int ncz_read_vars(NC_FILE_INFO_T* file, NC_GRP_INFO_T* grp);
 EXTERNL int ncz_read_file(NC_FILE_INFO_T* file);
+EXTERNL int ncz_read_deferred_grp(NC_GRP_INFO_T* grp);
 EXTERNL int ncz_write_var(NC_VAR_INFO_T* var);
 
 /* zutil.c */
@@ -324,6 +324,16 @@ NCZ_del_att(int ncid, int varid, const char *name)
     if (!(att = (NC_ATT_INFO_T*)ncindexlookup(attlist, name)))
         return NC_ENOTATT;
 
+    /* Deleting the shards attribute unshards the variable */
+    if (varid != NC_GLOBAL && strcmp(name,NC_NCZARR_SHARDS_ATTR)==0
+        && ((NCZ_VAR_INFO_T*)var->format_var_info)->shards != NULL) {
+        NCZ_VAR_INFO_T* zvar = (NCZ_VAR_INFO_T*)var->format_var_info;
+        if (var->created)
+            return NC_ELATEDEF;
+        nullfree(zvar->shards);
+        zvar->shards = NULL;
+    }
+
     /* Reclaim the content of the attribute */
     if(att->data) {
 	if((retval = NC_reclaim_data_all(h5->controller,att->nc_typeid,att->data,att->len))) return retval;
@@ -495,6 +505,33 @@ ncz_put_att(NC_GRP_INFO_T* grp, int varid, const char *name, nc_type file_type,
             return NC_ENAMEINUSE;
     }
 
+    /* A shards attribute sets the shard shape of the variable, which
+     * can only be done before the variable is written. Pure Zarr has
+     * no way to record it, so there it is just an attribute. */
+    if(!force && varid != NC_GLOBAL && strcmp(norm_name,NC_NCZARR_SHARDS_ATTR)==0
+       && !(((NCZ_FILE_INFO_T*)h5->format_file_info)->controls.flags & FLAG_PUREZARR)) {
+        NCZ_VAR_INFO_T* zvar = (NCZ_VAR_INFO_T*)var->format_var_info;
+        int shards[NC_MAX_VAR_DIMS];
+        size_t i;
+        if (var->created)
+            return NC_ELATEDEF;
+        if (var->ndims == 0 || len != var->ndims || mem_type < NC_BYTE || mem_type > NC_UINT64
+            || mem_type == NC_CHAR || mem_type == NC_FLOAT || mem_type == NC_DOUBLE)
+            return NC_EINVAL;
+        if ((retval = nc4_convert_type(data, shards, mem_type, NC_INT, len, &range_error,
+                                       NULL, NC_CLASSIC_MODEL, NC_NOQUANTIZE, 0)))
+            return retval;
+        if (range_error)
+            return NC_EINVAL;
+        for(i=0;i<len;i++)
+            if(shards[i] < 1) return NC_EINVAL;
+        if(zvar->shards == NULL
+           && (zvar->shards = (size64_t*)calloc(var->ndims,sizeof(size64_t))) == NULL)
+            return NC_ENOMEM;
+        for(i=0;i<len;i++)
+            zvar->shards[i] = (size64_t)shards[i];
+    }
+
     /* See if there is already an attribute with this name. */
     att = (NC_ATT_INFO_T*)ncindexlookup(attlist,norm_name);
 
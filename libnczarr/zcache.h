@@ -34,6 +34,7 @@ typedef struct NCZCacheEntry {
     int isfiltered; /* 1=>data contains filtered data else real data */
     int isfixedstring; /* 1 => data contains the fixed strings, 0 => data contains pointers to strings */
     size64_t size; /* |data| */
+    size64_t alloc; /* allocated size of data; 0 => size */
     void* data; /* contains either filtered or real data */
 } NCZCacheEntry;
 
@@ -49,17 +50,37 @@ typedef struct NCZChunkCache {
     NClist* mru; /* NClist<NCZCacheEntry> all cache entries in mru order */
     struct NCxcache* xcache;
     char dimension_separator;
+    struct WriteBehind { /* modified chunks evicted from the cache but not yet written */
+	NClist* queue; /* NClist<struct ChunkTask*> in eviction order */
+	NCtaskgroup group; /* encode tasks for the queued chunks */
+	size64_t inflight; /* total |data| of the queued chunks */
+    } writebehind;
+    struct NCZShards* shards; /* staged shards and shard indices; see zshard.c */
+    struct Spares { /* free buffers of chunksize bytes, reused by later chunks */
+	NClist* buffers;
+	size_t reserve; /* room for more while a batch of chunks is read */
+    } spares;
 } NCZChunkCache;
 
+/* Counts of the chunk sized buffers allocated for all chunk caches */
+typedef struct NCZBufferStats {
+    size64_t allocs; /* allocated because no spare buffer was free */
+    size64_t reuses; /* spare buffers used instead */
+    size64_t filterallocs; /* allocated by filters that could not use a spare */
+} NCZBufferStats;
+
 /**************************************************/
 
 #define FILTERED(cache) (nclistlength((NClist*)(cache)->var->filters))
+#define SHARDED(cache) (((NCZ_VAR_INFO_T*)(cache)->var->format_var_info)->shards != NULL)
 
 extern int NCZ_set_var_chunk_cache(int ncid, int varid, size_t size, size_t nelems, float preemption);
 extern int NCZ_adjust_var_cache(NC_VAR_INFO_T *var);
 extern int NCZ_create_chunk_cache(NC_VAR_INFO_T* var, size64_t, char dimsep, NCZChunkCache** cachep);
 extern void NCZ_free_chunk_cache(NCZChunkCache* cache);
 extern int NCZ_read_cache_chunk(NCZChunkCache* cache, const size64_t* indices, void** datap);
+extern size_t NCZ_prefetch_limit(NCZChunkCache* cache);
+extern int NCZ_prefetch_cache_chunks(NCZChunkCache* cache, size_t nchunks, const size64_t* indices);
 extern int NCZ_flush_chunk_cache(NCZChunkCache* cache);
 extern size64_t NCZ_cache_entrysize(NCZChunkCache* cache);
 extern NCZCacheEntry* NCZ_cache_entry(NCZChunkCache* cache, const size64_t* indices);
@@ -68,5 +89,12 @@ extern int NCZ_buildchunkpath(NCZChunkCache* cache, const size64_t* chunkindices
 extern int NCZ_ensure_fill_chunk(NCZChunkCache* cache);
 extern int NCZ_reclaim_fill_chunk(NCZChunkCache* cache);
 extern int NCZ_chunk_cache_modify(NCZChunkCache* cache, const size64_t* indices);
+EXTERNL void NCZ_buffer_stats(NCZBufferStats* stats, int reset);
+
+/* zshard.c */
+extern int NCZ_shard_read(NCZChunkCache* cache, const size64_t* indices, size64_t* sizep, void** datap);
+extern int NCZ_shard_write(NCZChunkCache* cache, const size64_t* indices, size64_t size, const void* data);
+extern int NCZ_shard_flush(NCZChunkCache* cache);
+extern void NCZ_shard_free(NCZChunkCache* cache);
 
 #endif /*ZCACHE_H*/
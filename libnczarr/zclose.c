@@ -176,6 +176,7 @@ NCZ_zclose_var1(NC_VAR_INFO_T* var)
     /* reclaim dispatch info */
     zvar = var->format_var_info;;
     if(zvar->cache) NCZ_free_chunk_cache(zvar->cache);
+    nullfree(zvar->shards);
     /* reclaim xarray */
     if(zvar->xarray) nclistfreeall(zvar->xarray);
     nullfree(zvar->zarray.prefix);
@@ -43,6 +43,7 @@ ncz_create_file(const char *path, int cmode, size_t initialsz, NClist* controls,
         BAIL(retval);
     assert(h5 && h5->root_grp);
     h5->root_grp->atts_read = 1;
+    h5->controller->concurrency = NC_CONCURRENT_FILES;
 
     h5->mem.inmemory = ((cmode & NC_INMEMORY) == NC_INMEMORY);
     h5->mem.diskless = ((cmode & NC_DISKLESS) == NC_DISKLESS);
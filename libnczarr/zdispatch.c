@@ -57,8 +57,8 @@ static const NC_Dispatch NCZ_dispatcher = {
     NCZ_put_vara,
     NCZ_get_vars,
     NCZ_put_vars,
-    NCDEFAULT_get_varm,
-    NCDEFAULT_put_varm,
+    NCBUFFERED_get_varm,
+    NCBUFFERED_put_varm,
 
     NCZ_inq_var_all,
 
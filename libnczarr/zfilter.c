@@ -689,16 +689,15 @@ NCZ_filter_finalize(void)
 done:
     return ZUNTRACE(stat);
 }
+/* Make sure all the filters in a chain are loaded && setup.
+   Once this succeeds, NCZ_applyfilterchain does not modify the
+   chain and so may be called concurrently for the same variable. */
 int
-NCZ_applyfilterchain(const NC_FILE_INFO_T* file, NC_VAR_INFO_T* var, NClist* chain, size_t inlen, void* indata, size_t* outlenp, void** outdatap, int encode)
+NCZ_prepare_filterchain(NC_VAR_INFO_T* var, NClist* chain)
 {
     size_t i;
     int stat = NC_NOERR;
-    void* lastbuffer = NULL; /* if not null, then last allocated buffer */
-    
-    ZTRACE(6,"|chain|=%u inlen=%u indata=%p encode=%d", (unsigned)nclistlength(chain), (unsigned)inlen, indata, encode);
 
-    /* Make sure all the filters are loaded && setup */
     for(i=0;i<nclistlength(chain);i++) {
 	struct NCZ_Filter* f = (struct NCZ_Filter*)nclistget(chain,i);
 	assert(f != NULL);
@@ -714,72 +713,111 @@ NCZ_applyfilterchain(const NC_FILE_INFO_T* file, NC_VAR_INFO_T* var, NClist* cha
 	    if((stat = ensure_working(var,f))) goto done;
 	}
     }
+done:
+    return stat;
+}
 
-    {
-	struct NCZ_Filter* f = NULL;
-	const H5Z_class2_t* ff = NULL;
-	size_t current_alloc = inlen;
-	void* current_buf = indata;
-	size_t current_used = inlen;
-	size_t next_alloc = 0;
-	void* next_buf = NULL;
-	size_t next_used = 0;
+/* Number of scratch buffers (at most 2) that NCZ_applyfilterchain
+   can use for a chain; 0 if no filter provides NCZ_filter_into.
+   The chain must have been prepared. */
+size_t
+NCZ_filterchain_scratch(NClist* chain)
+{
+    size_t i, n = 0;
+    for(i=0;i<nclistlength(chain) && n < 2;i++) {
+	struct NCZ_Filter* f = (struct NCZ_Filter*)nclistget(chain,i);
+	const NCZ_codec_t* codec = (f->plugin == NULL ? NULL : f->plugin->codec.codec);
+	if(f->flags & FLAG_SUPPRESS) continue;
+	if(codec != NULL && codec->version >= 2 && codec->NCZ_filter_into != NULL) n++;
+    }
+    return n;
+}
+
+/* Keep a buffer the chain is done with in an empty slot of the
+   scratch, if it is big enough, else reclaim it */
+static void
+releasebuffer(NCZScratch* scratch, void* buf, size_t alloc)
+{
+    if(scratch != NULL && alloc >= scratch->size) {
+	if(scratch->buf[0] == NULL) {scratch->buf[0] = buf; return;}
+	if(scratch->buf[1] == NULL) {scratch->buf[1] = buf; return;}
+    }
+    nullfree(buf);
+}
+
+/**
+Apply a filter chain to a buffer.
+The chain takes ownership of indata: it is reclaimed, kept in the
+scratch, or returned as *outdatap, even if the chain fails.
+@param inalloc allocated size of indata; 0 if it is only known to be inlen
+@param outallocp return the allocated size of *outdatap
+@param scratch buffers to filter into; may be NULL
+*/
+int
+NCZ_applyfilterchain(const NC_FILE_INFO_T* file, NC_VAR_INFO_T* var, NClist* chain, size_t inlen, size_t inalloc, void* indata, size_t* outlenp, size_t* outallocp, void** outdatap, int encode, NCZScratch* scratch)
+{
+    int stat = NC_NOERR;
+    size_t i, n = nclistlength(chain);
+    unsigned flags = (encode ? 0 : H5Z_FLAG_REVERSE);
+    void* current_buf = indata;
+    size_t current_alloc = (inalloc < inlen ? inlen : inalloc);
+    size_t current_used = inlen;
+
+    ZTRACE(6,"|chain|=%u inlen=%u indata=%p encode=%d", (unsigned)n, (unsigned)inlen, indata, encode);
+
+    if((stat = NCZ_prepare_filterchain(var,chain))) goto done;
 
 #ifdef DEBUG
 fprintf(stderr,">>> current: alloc=%u used=%u buf=%p\n",(unsigned)current_alloc,(unsigned)current_used,current_buf);
 #endif
-        /* Apply in proper order */
-        if(encode) {
-            for(i=0;i<nclistlength(chain);i++) {
-	        f = (struct NCZ_Filter*)nclistget(chain,i);	
-		if(f->flags & FLAG_SUPPRESS) continue; /* this filter should not be applied */		
-	        ff = f->plugin->hdf5.filter;
-	        /* code can be simplified */
-	        next_alloc = current_alloc;
-	        next_buf = current_buf;
-	        next_used = 0;
-	        next_used = ff->filter(0,f->hdf5.working.nparams,f->hdf5.working.params,current_used,&next_alloc,&next_buf);
-#ifdef DEBUG
-fprintf(stderr,">>> next: alloc=%u used=%u buf=%p\n",(unsigned)next_alloc,(unsigned)next_used,next_buf);
-#endif
-		if(next_used == 0) {stat = NC_EFILTER; lastbuffer = next_buf; goto done; }
-		/* If the filter did not need to create a new buffer, then next == current else current was reclaimed */
-	        current_buf = next_buf;
-	        current_alloc = next_alloc;
-	        current_used = next_used;
-	    }
-	} else {
-	    /* Apply in reverse order */
-            for(size_t k=nclistlength(chain); k-->0;) {
-              f = (struct NCZ_Filter*)nclistget(chain, k);
-		if(f->flags & FLAG_SUPPRESS) continue; /* this filter should not be applied */
-	        ff = f->plugin->hdf5.filter;
-	        /* code can be simplified */
-	        next_alloc = current_alloc;
-	        next_buf = current_buf;
-	        next_used = 0;
-	        next_used = ff->filter(H5Z_FLAG_REVERSE,f->hdf5.working.nparams,f->hdf5.working.params,current_used,&next_alloc,&next_buf);
-#ifdef DEBUG
-fprintf(stderr,">>> next: alloc=%u used=%u buf=%p\n",(unsigned)next_alloc,(unsigned)next_used,next_buf);
-#endif
-		if(next_used == 0) {stat = NC_EFILTER; lastbuffer = next_buf; goto done;}
-		/* If the filter did not need to create a new buffer, then next == current else current was reclaimed */
-	        current_buf = next_buf;
-	        current_alloc = next_alloc;
-	        current_used = next_used;
+    /* Apply in proper order when encoding, in reverse order when decoding */
+    for(i=0;i<n;i++) {
+	struct NCZ_Filter* f = (struct NCZ_Filter*)nclistget(chain,(encode ? i : n-1-i));
+	const NCZ_codec_t* codec = f->plugin->codec.codec;
+	size_t next_alloc = 0;
+	size_t next_used = 0;
+	void* next_buf = NULL;
+
+	if(f->flags & FLAG_SUPPRESS) continue; /* this filter should not be applied */
+	/* Prefer filtering into a scratch buffer */
+	if(scratch != NULL && codec != NULL && codec->version >= 2 && codec->NCZ_filter_into != NULL) {
+	    int k = (scratch->buf[0] != NULL ? 0 : 1);
+	    if(scratch->buf[k] != NULL)
+		next_used = codec->NCZ_filter_into(flags,f->hdf5.working.nparams,f->hdf5.working.params,
+						   current_used,current_buf,scratch->size,scratch->buf[k]);
+	    if(next_used > 0) {
+		next_buf = scratch->buf[k];
+		scratch->buf[k] = NULL;
+		releasebuffer(scratch,current_buf,current_alloc);
+		current_buf = next_buf;
+		current_alloc = scratch->size;
+		current_used = next_used;
+		continue;
 	    }
 	}
+	/* Otherwise the filter either reuses current_buf or reclaims it and allocates a new one */
+	next_alloc = current_alloc;
+	next_buf = current_buf;
+	next_used = f->plugin->hdf5.filter->filter(flags,f->hdf5.working.nparams,f->hdf5.working.params,current_used,&next_alloc,&next_buf);
 #ifdef DEBUG
-fprintf(stderr,">>> current: alloc=%u used=%u buf=%p\n",(unsigned)current_alloc,(unsigned)current_used,current_buf);
+fprintf(stderr,">>> next: alloc=%u used=%u buf=%p\n",(unsigned)next_alloc,(unsigned)next_used,next_buf);
 #endif
-	/* return results */
-	if(outlenp) {*outlenp = current_used;} /* or should it be current_alloc? */
-	if(outdatap) {*outdatap = current_buf;}
+	if(next_used == 0) {stat = NC_EFILTER; goto done;}
+	if(next_buf != current_buf && scratch != NULL) scratch->allocs++;
+	current_buf = next_buf;
+	current_alloc = next_alloc;
+	current_used = next_used;
     }
 
+    /* return results */
+    if(outlenp) {*outlenp = current_used;}
+    if(outallocp) {*outallocp = current_alloc;}
+    if(outdatap) {*outdatap = current_buf;}
+    current_buf = NULL;
+
 done:
-    if(lastbuffer != NULL && lastbuffer != indata) nullfree(lastbuffer); /* cleanup */
-    return ZUNTRACEX(stat,"outlen=%u outdata=%p",(unsigned)*outlenp,*outdatap);
+    nullfree(current_buf); /* cleanup */
+    return ZUNTRACEX(stat,"outlen=%u",(unsigned)current_used);
 }
 
 /**************************************************/
@@ -22,13 +22,26 @@
 /* Opaque */
 struct NCZ_Filter;
 
+/* Buffers that NCZ_applyfilterchain may fill, through the
+   NCZ_filter_into function of a codec, instead of letting the
+   HDF5 filter function allocate; an empty slot is NULL. Buffers
+   it no longer needs that are at least size bytes go back into
+   empty slots. */
+typedef struct NCZScratch {
+    size_t size; /* of every buffer */
+    void* buf[2];
+    size_t allocs; /* number of filters that allocated their output */
+} NCZScratch;
+
 int NCZ_filter_initialize(void);
 int NCZ_filter_finalize(void);
 int NCZ_addfilter(NC_FILE_INFO_T*, NC_VAR_INFO_T* var, unsigned int id, size_t nparams, const unsigned int* params);
 int NCZ_filter_setup(NC_VAR_INFO_T* var);
 int NCZ_filter_freelists(NC_VAR_INFO_T* var);
 int NCZ_codec_freelist(NCZ_VAR_INFO_T* zvar);
-int NCZ_applyfilterchain(const NC_FILE_INFO_T*, NC_VAR_INFO_T*, NClist* chain, size_t insize, void* indata, size_t* outlen, void** outdata, int encode);
+int NCZ_prepare_filterchain(NC_VAR_INFO_T*, NClist* chain);
+size_t NCZ_filterchain_scratch(NClist* chain);
+int NCZ_applyfilterchain(const NC_FILE_INFO_T*, NC_VAR_INFO_T*, NClist* chain, size_t insize, size_t inalloc, void* indata, size_t* outlen, size_t* outalloc, void** outdata, int encode, NCZScratch* scratch);
 int NCZ_filter_jsonize(const NC_FILE_INFO_T*, const NC_VAR_INFO_T*, struct NCZ_Filter* filter, struct NCjson**);
 int NCZ_filter_build(const NC_FILE_INFO_T*, NC_VAR_INFO_T* var, const NCjson* jfilter, int chainindex);
 int NCZ_codec_attr(const NC_VAR_INFO_T* var, size_t* lenp, void* data);
@@ -49,6 +49,7 @@ extern "C" {
 #include "ncjson.h"
 #include "ncproplist.h"
 #include "ncutil.h"
+#include "ncthreadpool.h"
 
 #include "zmap.h"
 #include "zmetadata.h"
@@ -55,6 +55,8 @@ NCZ_initialize_internal(void)
 {
     int stat = NC_NOERR;
     char* dimsep = NULL;
+    const char* nthreads = NULL;
+    const char* maxinflight = NULL;
     NCglobalstate* ngs = NULL;
 
     ncz_initialized = 1;
@@ -68,6 +70,22 @@ NCZ_initialize_internal(void)
 	    if(dimsep != NULL && strlen(dimsep) == 1 && islegaldimsep(dimsep[0]))
 		ngs->zarr.dimension_separator = dimsep[0];
         }    
+	ngs->zarr.nthreads = 1;
+	if((nthreads = getenv(NCZARR_THREADS_ENV)) == NULL)
+	    nthreads = NC_rclookup("ZARR.THREADS",NULL,NULL);
+	if(nthreads != NULL) {
+	    int n = 0;
+	    if(sscanf(nthreads,"%d",&n) == 1 && n > 0)
+	        ngs->zarr.nthreads = (size_t)n;
+	}
+	ngs->zarr.maxinflight = 0;
+	if((maxinflight = getenv(NCZARR_WRITEBEHIND_ENV)) == NULL)
+	    maxinflight = NC_rclookup("ZARR.WRITEBEHIND.MAX",NULL,NULL);
+	if(maxinflight != NULL) {
+	    unsigned long long n = 0;
+	    if(sscanf(maxinflight,"%llu",&n) == 1)
+	        ngs->zarr.maxinflight = (size_t)n;
+	}
     }
 
     return stat;
@@ -80,8 +98,14 @@ NCZ_initialize_internal(void)
 int
 NCZ_finalize_internal(void)
 {
+    NCglobalstate* ngs = NC_getglobalstate();
+
     /* Reclaim global resources */
     ncz_initialized = 0;
+    if(ngs != NULL) {
+        ncthreadpoolfree(ngs->zarr.pool);
+	ngs->zarr.pool = NULL;
+    }
 #ifdef NETCDF_ENABLE_NCZARR_FILTERS
     NCZ_filter_finalize();
 #endif
@@ -238,8 +262,11 @@ ncz_find_dim_len(NC_GRP_INFO_T *grp, int dimid, size_t **len)
     /* If there are any groups, call this function recursively on
      * them. */
     for (i = 0; i < ncindexsize(grp->children); i++) {
-        if ((retval = ncz_find_dim_len((NC_GRP_INFO_T*)ncindexith(grp->children, i),
-                                       dimid, len)))
+        NC_GRP_INFO_T *child = (NC_GRP_INFO_T*)ncindexith(grp->children, i);
+        /* Variables in unread groups may use the dim too. */
+        if ((retval = nc4_read_deferred_grp(child)))
+            return retval;
+        if ((retval = ncz_find_dim_len(child, dimid, len)))
             return retval;
     }
     /* For all variables in this group, find the ones that use this
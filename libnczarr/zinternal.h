@@ -74,6 +74,7 @@ Inserted into any array level .zattrs
 "_nczarr_array": "{
 \"dimension_references\": [\"/g1/g2/d1\", \"/d2\",...]
 \"storage\": \"scalar\"|\"contiguous\"|\"chunked\"
+\"shards\": [<integer>, ...] (only if sharded: inner chunks per shard in each dimension)
 }"
 
 Inserted into any .zattrs
@@ -91,14 +92,24 @@ Inserted into any .zattrs
 #define PUREZARRCONTROL "zarr"
 #define XARRAYCONTROL "xarray"
 #define NOXARRAYCONTROL "noxarray"
+#define CONSOLIDATEDCONTROL "consolidated"
+#define NOCONSOLIDATEDCONTROL "noconsolidated"
 #define XARRAYSCALAR "_scalar_"
 
 #define NC_NCZARR_MAXSTRLEN_ATTR "_nczarr_maxstrlen"
 #define NC_NCZARR_DEFAULT_MAXSTRLEN_ATTR "_nczarr_default_maxstrlen"
+#define NC_NCZARR_SHARDS_ATTR "_nczarr_shards"
+/* The .zarray compressor of a sharded variable */
+#define NCZ_SHARD_CODEC "nczarr_shard"
 
 #define LEGAL_DIM_SEPARATORS "./"
 #define DFALT_DIM_SEPARATOR '.'
 
+/* Number of worker threads for chunk transfers; ZARR.THREADS in .rc */
+#define NCZARR_THREADS_ENV "NCZARR_THREADS"
+/* Cap on bytes queued for write-behind; ZARR.WRITEBEHIND.MAX in .rc */
+#define NCZARR_WRITEBEHIND_ENV "NCZARR_WRITEBEHIND_MAX"
+
 #define islegaldimsep(c) ((c) != '\0' && strchr(LEGAL_DIM_SEPARATORS,(c)) != NULL)
 
 /* Default max string length for fixed length strings */
@@ -150,6 +161,7 @@ typedef struct NCZ_FILE_INFO {
 #		define FLAG_XARRAYDIMS  8
 #		define FLAG_NCZARR_KEY  16 /* _nczarr_xxx keys are stored in object and not in _nczarr_attrs */
 #		define FLAG_CONSOLIDATED 32
+#		define FLAG_NOCONSOLIDATED 64
 	NCZM_IMPL mapimpl;
     } controls;
     int default_maxstrlen; /* default max str size for variables of type string */
@@ -189,6 +201,7 @@ typedef struct NCZ_VAR_INFO {
     char dimension_separator; /* '.' | '/' */
     NClist* incompletefilters;
     int maxstrlen; /* max length of strings for this variable */
+    size64_t* shards; /* inner chunks per shard in each dimension; NULL => not sharded */
     /* Read .zarray and .zattrs once */
     struct ZARROBJ zarray;
     struct ZARROBJ zattrs;
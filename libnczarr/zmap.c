@@ -9,9 +9,27 @@
 #include "ncpathmgr.h"
 #include "ncutil.h"
 
+#ifdef NETCDF_ENABLE_THREADSAFE
+#define ZMLOCK(map) pthread_mutex_lock(&(map)->lock)
+#define ZMUNLOCK(map) pthread_mutex_unlock(&(map)->lock)
+#else
+#define ZMLOCK(map)
+#define ZMUNLOCK(map)
+#endif
+
 /**************************************************/
 /* Import the current implementations */
 
+#ifdef NETCDF_ENABLE_THREADSAFE
+static int
+zmaplockinit(NCZMAP* map)
+{
+    if(pthread_mutex_init(&map->lock,NULL)) return NC_ENOMEM;
+    map->haslock = 1;
+    return NC_NOERR;
+}
+#endif
+
 
 /**************************************************/
 
@@ -68,6 +86,9 @@ nczmap_create(NCZM_IMPL impl, const char *path, int mode, size64_t flags, void*
     default:
 	{stat = REPORT(NC_ENOTBUILT,"nczmap_create"); goto done;}
     }
+#ifdef NETCDF_ENABLE_THREADSAFE
+    if((stat = zmaplockinit(map))) {(void)map->api->close(map,0); goto done;}
+#endif
     if(mapp) *mapp = map;
 done:
     ncurifree(uri);
@@ -107,6 +128,10 @@ nczmap_open(NCZM_IMPL impl, const char *path, int mode, size64_t flags, void* pa
 	{stat = REPORT(NC_ENOTBUILT,"nczmap_open"); goto done;}
     }
 
+#ifdef NETCDF_ENABLE_THREADSAFE
+    if((stat = zmaplockinit(map))) {(void)map->api->close(map,0); goto done;}
+#endif
+
 done:
     ncurifree(uri);
     if(!stat) {
@@ -147,6 +172,12 @@ int
 nczmap_close(NCZMAP* map, int delete)
 {
     int stat = NC_NOERR;
+#ifdef NETCDF_ENABLE_THREADSAFE
+    if(map && map->haslock) {
+        (void)pthread_mutex_destroy(&map->lock);
+        map->haslock = 0;
+    }
+#endif
     if(map && map->api)
         stat = map->api->close(map,delete);
     return THROW(stat);
@@ -155,25 +186,112 @@ nczmap_close(NCZMAP* map, int delete)
 int
 nczmap_exists(NCZMAP* map, const char* key)
 {
-    return map->api->exists(map, key);
+    int stat;
+    ZMLOCK(map);
+    stat = map->api->exists(map, key);
+    ZMUNLOCK(map);
+    return stat;
 }
 
 int
 nczmap_len(NCZMAP* map, const char* key, size64_t* lenp)
 {
-    return map->api->len(map, key, lenp);
+    int stat;
+    ZMLOCK(map);
+    stat = map->api->len(map, key, lenp);
+    ZMUNLOCK(map);
+    return stat;
 }
 
 int
 nczmap_read(NCZMAP* map, const char* key, size64_t start, size64_t count, void* content)
 {
-    return map->api->read(map, key, start, count, content);
+    int stat;
+    ZMLOCK(map);
+    stat = map->api->read(map, key, start, count, content);
+    ZMUNLOCK(map);
+    return stat;
+}
+
+int
+nczmap_readobj(NCZMAP* map, const char* key, size64_t* sizep, void** contentp)
+{
+    int stat = NC_NOERR;
+    size64_t len = 0;
+    void* content = NULL;
+
+    ZMLOCK(map);
+    if(map->api->readobj != NULL) {
+        stat = map->api->readobj(map, key, sizep, contentp);
+        goto done;
+    }
+    if((stat = map->api->len(map, key, &len))) goto done;
+    if((content = malloc(len == 0 ? 1 : (size_t)len)) == NULL)
+        {stat = NC_ENOMEM; goto done;}
+    if((stat = map->api->read(map, key, 0, len, content))) goto done;
+    if(sizep) *sizep = len;
+    if(contentp) {*contentp = content; content = NULL;}
+done:
+    ZMUNLOCK(map);
+    nullfree(content);
+    return stat;
 }
 
 int
 nczmap_write(NCZMAP* map, const char* key, size64_t count, const void* content)
 {
-    return map->api->write(map, key, count, content);
+    int stat;
+    ZMLOCK(map);
+    stat = map->api->write(map, key, count, content);
+    ZMUNLOCK(map);
+    return stat;
+}
+
+int
+nczmap_readmany(NCZMAP* map, size_t n, const char** keys, size64_t* sizes, void** contents, int* stats)
+{
+    int stat = NC_NOERR;
+    size_t i;
+
+    if(n == 0) return NC_NOERR;
+    if(map->api->readmany != NULL) {
+        ZMLOCK(map);
+        stat = map->api->readmany(map, n, keys, sizes, contents, stats);
+        ZMUNLOCK(map);
+        if(stat) return stat;
+    } else {
+        for(i=0;i<n;i++) {
+            sizes[i] = 0;
+            contents[i] = NULL;
+            stats[i] = nczmap_readobj(map, keys[i], &sizes[i], &contents[i]);
+        }
+    }
+    /* Report the first real failure */
+    for(i=0;i<n;i++) {
+        switch (stats[i]) {
+        case NC_NOERR: case NC_EEMPTY: case NC_ENOOBJECT: break;
+        default: return stats[i];
+        }
+    }
+    return NC_NOERR;
+}
+
+int
+nczmap_writemany(NCZMAP* map, size_t n, const char** keys, const size64_t* counts, const void** contents)
+{
+    int stat = NC_NOERR;
+    size_t i;
+
+    if(n == 0) return NC_NOERR;
+    ZMLOCK(map);
+    if(map->api->writemany != NULL)
+        stat = map->api->writemany(map, n, keys, counts, contents);
+    else {
+        for(i=0;i<n;i++)
+            if((stat = map->api->write(map, keys[i], counts[i], contents[i]))) break;
+    }
+    ZMUNLOCK(map);
+    return stat;
 }
 
 /* Define a static qsort comparator for strings for use with qsort */
@@ -189,7 +307,10 @@ int
 nczmap_search(NCZMAP* map, const char* prefix, NClist* matches)
 {
     int stat = NC_NOERR;
-    if((stat = map->api->search(map, prefix, matches)) == NC_NOERR) {
+    ZMLOCK(map);
+    stat = map->api->search(map, prefix, matches);
+    ZMUNLOCK(map);
+    if(stat == NC_NOERR) {
         /* sort the list */
         if(nclistlength(matches) > 1) {
 	    void* base = nclistcontents(matches);
@@ -137,6 +137,9 @@ of the implementation.
 
 #include "ncexternl.h"
 #include <stddef.h>
+#ifdef NETCDF_ENABLE_THREADSAFE
+#include <pthread.h>
+#endif
 
 #define NCZM_SEP "/"
 
@@ -177,12 +180,32 @@ so we can cast to this form; avoids need for
 a separate per-implementation malloc piece.
 
 */
+
+/* I/O counters for a map; each implementation counts
+   the system (or remote) calls that it actually makes. */
+typedef struct NCZM_STATS {
+    size64_t opens;  /* objects opened or created */
+    size64_t closes; /* objects closed */
+    size64_t stats;  /* stat/fstat calls */
+    size64_t seeks;  /* lseek calls */
+    size64_t reads;  /* read/pread calls */
+    size64_t writes; /* write/pwrite calls */
+    size64_t hits;   /* opens avoided by a cached descriptor */
+} NCZM_STATS;
+
 typedef struct NCZMAP {
     NCZM_IMPL format;
     char* url;
     int mode;
     size64_t flags; /* Passed in by caller */
     struct NCZMAP_API* api;
+    NCZM_STATS stats;
+#ifdef NETCDF_ENABLE_THREADSAFE
+    /* Serializes the object operations; reads of different
+       variables may be made by different threads at once */
+    pthread_mutex_t lock;
+    int haslock;
+#endif
 } NCZMAP;
 
 /* zmap_s3sdk related-types and constants */
@@ -202,6 +225,11 @@ struct NCZMAP_API {
 	int (*read)(NCZMAP* map, const char* key, size64_t start, size64_t count, void* content);
 	int (*write)(NCZMAP* map, const char* key, size64_t count, const void* content);
         int (*search)(NCZMAP* map, const char* prefix, struct NClist* matches);
+	/* Optional; NULL => nczmap_readobj uses len+read */
+	int (*readobj)(NCZMAP* map, const char* key, size64_t* sizep, void** contentp);
+	/* Optional; NULL => nczmap_readmany/writemany loop over readobj/write */
+	int (*readmany)(NCZMAP* map, size_t n, const char** keys, size64_t* sizes, void** contents, int* stats);
+	int (*writemany)(NCZMAP* map, size_t n, const char** keys, const size64_t* counts, const void** contents);
 };
 
 /* Define the Dataset level API */
@@ -275,6 +303,52 @@ Read the content of a specified content-bearing object.
 */
 EXTERNL int nczmap_read(NCZMAP* map, const char* key, size64_t start, size64_t count, void* content);
 
+/**
+Read the whole content of a specified content-bearing object.
+This is equivalent to nczmap_len followed by nczmap_read, but
+implementations may do it with a single lookup of the object.
+@param map -- the containing map
+@param key -- the key specifying the content-bearing object
+@param sizep -- the object's size is returned thru this pointer.
+@param contentp -- return the content in malloc'd memory; caller frees
+@return NC_NOERR if the operation succeeded
+@return NC_EEMPTY if the object is not content-bearing.
+@return NC_EXXX if the operation failed for one of several possible reasons
+*/
+EXTERNL int nczmap_readobj(NCZMAP* map, const char* key, size64_t* sizep, void** contentp);
+
+/**
+Read the whole content of each of a set of content-bearing objects.
+This is equivalent to calling nczmap_readobj for each key, but
+implementations may perform the reads concurrently.
+@param map -- the containing map
+@param n -- the number of keys
+@param keys -- the keys specifying the content-bearing objects
+@param sizes -- the size of object i is returned in sizes[i]
+@param contents -- the content of object i is returned in malloc'd
+                   memory in contents[i]; caller frees
+@param stats -- the outcome for object i is returned in stats[i];
+                NC_EEMPTY if it is not content-bearing.
+@return NC_NOERR if the operation succeeded for every key,
+        allowing for NC_EEMPTY
+@return NC_EXXX if the operation failed for one of several possible reasons
+*/
+EXTERNL int nczmap_readmany(NCZMAP* map, size_t n, const char** keys, size64_t* sizes, void** contents, int* stats);
+
+/**
+Write the content of each of a set of content-bearing objects.
+This is equivalent to calling nczmap_write for each key, but
+implementations may perform the writes concurrently.
+@param map -- the containing map
+@param n -- the number of keys
+@param keys -- the keys specifying the content-bearing objects
+@param counts -- the number of bytes to write for each key
+@param contents -- write the data for each key from this memory
+@return NC_NOERR if the operation succeeded
+@return NC_EXXX if the operation failed for one of several possible reasons
+*/
+EXTERNL int nczmap_writemany(NCZMAP* map, size_t n, const char** keys, const size64_t* counts, const void** contents);
+
 /**
 Write the content of a specified content-bearing object.
 This assumes that it is not possible to write a subset of an object.
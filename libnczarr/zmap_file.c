@@ -108,14 +108,33 @@ For the object API, the mapping is as follows:
 
 typedef struct FD {
   int fd;
+  int cached; /* fd is owned by the descriptor cache */
 } FD;
 
-static FD FDNUL = {-1};
+static FD FDNUL = {-1,0};
+
+/*
+Chunk reads typically touch the same few objects over and over,
+so keep a small LRU cache of open descriptors keyed by object key
+rather than doing an open+close per access.
+The size can be overridden by the NCZ_FDCACHE_SIZE environment
+variable; zero disables the cache.
+*/
+#define DFALT_FDCACHE_SIZE 16
+
+typedef struct ZFSLOT {
+    char* key; /* NULL => unused */
+    int fd;
+    size64_t lastuse;
+} ZFSLOT;
 
 /* Define the "subclass" of NCZMAP */
 typedef struct ZFMAP {
     NCZMAP map;
     char* root;
+    size_t nslots;
+    ZFSLOT* fdcache;
+    size64_t clock; /* for LRU */
 } ZFMAP;
 
 /* Forward */
@@ -123,6 +142,9 @@ static NCZMAP_API zapi;
 static int zfileclose(NCZMAP* map, int delete);
 static int zfcreategroup(ZFMAP*, const char* key, int nskip);
 static int zflookupobj(ZFMAP*, const char* key, FD* fd);
+static int zfcacheinit(ZFMAP* zfmap);
+static void zfcacheinsert(ZFMAP* zfmap, const char* key, FD* fd);
+static void zfcacheclear(ZFMAP* zfmap);
 static int zfparseurl(const char* path0, NCURI** urip);
 static int zffullpath(ZFMAP* zfmap, const char* key, char**);
 static void zfrelease(ZFMAP* zfmap, FD* fd);
@@ -135,9 +157,10 @@ static int platformopenfile(int mode, const char* truepath, FD* fd);
 static int platformopendir(int mode, const char* truepath);
 static int platformdircontent(const char* path, NClist* contents);
 static int platformdelete(const char* path, int delroot);
-static int platformseek(FD* fd, int pos, size64_t* offset);
-static int platformread(FD* fd, size64_t count, void* content);
-static int platformwrite(FD* fd, size64_t count, const void* content);
+static int platformsize(FD* fd, size64_t* sizep);
+static int platformread(FD* fd, size64_t start, size64_t count, void* content);
+static int platformwrite(FD* fd, size64_t start, size64_t count, const void* content);
+static int platformtruncate(FD* fd, size64_t size);
 static void platformrelease(FD* fd);
 static int platformtestcontentbearing(const char* truepath);
 
@@ -147,6 +170,7 @@ static int verifykey(const char* key, int isdir);
 #endif
 
 static int zfinitialized = 0;
+static size_t zffdcachesize = DFALT_FDCACHE_SIZE;
 static void
 zfileinitialize(void)
 {
@@ -162,6 +186,10 @@ zfileinitialize(void)
 	if(env != NULL && strlen(env) > 0) {
 	    if(sscanf(env,"%d",&perms) == 1) NC_DEFAULT_DIR_PERMS = perms;
 	}
+	env = getenv("NCZ_FDCACHE_SIZE");
+	if(env != NULL && strlen(env) > 0) {
+	    if(sscanf(env,"%d",&perms) == 1 && perms >= 0) zffdcachesize = (size_t)perms;
+	}
         zfinitialized = 1;
 	(void)ZUNTRACE(NC_NOERR);
     }
@@ -224,6 +252,7 @@ zfilecreate(const char *path, int mode, size64_t flags, void* parameters, NCZMAP
     zfmap->map.api = &zapi;
     zfmap->root = abspath;
         abspath = NULL;
+    if((stat = zfcacheinit(zfmap))) goto done;
 
     /* If NC_CLOBBER, then delete below file tree */
     if(!fIsSet(mode,NC_NOCLOBBER))
@@ -297,6 +326,7 @@ zfileopen(const char *path, int mode, size64_t flags, void* parameters, NCZMAP**
     zfmap->map.api = (NCZMAP_API*)&zapi;
     zfmap->root = abspath;
 	abspath = NULL;
+    if((stat = zfcacheinit(zfmap))) goto done;
     
     /* Verify root dir exists */
     if((stat = platformopendir(zfmap->map.mode,zfmap->root)))
@@ -363,16 +393,17 @@ zfilelen(NCZMAP* map, const char* key, size64_t* lenp)
     switch (stat=zflookupobj(zfmap,key,&fd)) {
     case NC_NOERR:
         /* Get file size */
-        if((stat=platformseek(&fd, SEEK_END, &len))) goto done;
+	map->stats.stats++;
+        if((stat=platformsize(&fd, &len))) goto done;
 	break;
     case NC_ENOOBJECT: stat = NC_EEMPTY;
     case NC_EEMPTY: break;
     default: break;
     }
-    zfrelease(zfmap,&fd);
     if(lenp) *lenp = len;
 
 done:
+    zfrelease(zfmap,&fd);
     return ZUNTRACEX(stat,"len=%llu",(lenp?*lenp:777777777777));
 }
 
@@ -392,8 +423,8 @@ zfileread(NCZMAP* map, const char* key, size64_t start, size64_t count, void* co
 
     switch (stat = zflookupobj(zfmap,key,&fd)) {
     case NC_NOERR:
-        if((stat = platformseek(&fd, SEEK_SET, &start))) goto done;
-        if((stat = platformread(&fd, count, content))) goto done;
+	map->stats.reads++;
+        if((stat = platformread(&fd, start, count, content))) goto done;
 	break;
     case NC_ENOOBJECT: stat = NC_EEMPTY;
     case NC_EEMPTY: break;
@@ -405,6 +436,45 @@ done:
     return ZUNTRACE(stat);
 }
 
+/* Read the whole object: one lookup, one fstat, one pread */
+static int
+zfilereadobj(NCZMAP* map, const char* key, size64_t* sizep, void** contentp)
+{
+    int stat = NC_NOERR;
+    FD fd = FDNUL;
+    ZFMAP* zfmap = (ZFMAP*)map; /* cast to true type */
+    size64_t len = 0;
+    void* content = NULL;
+
+    ZTRACE(5,"map=%s key=%s",map->url,key);
+
+#ifdef VERIFY
+    if(!verifykey(key,!FLAG_ISDIR))
+        assert(!"expected file, have dir");
+#endif
+
+    switch (stat = zflookupobj(zfmap,key,&fd)) {
+    case NC_NOERR:
+	map->stats.stats++;
+        if((stat = platformsize(&fd, &len))) goto done;
+	if((content = malloc(len == 0 ? 1 : (size_t)len)) == NULL)
+	    {stat = NC_ENOMEM; goto done;}
+	map->stats.reads++;
+        if((stat = platformread(&fd, 0, len, content))) goto done;
+	if(sizep) *sizep = len;
+	if(contentp) {*contentp = content; content = NULL;}
+	break;
+    case NC_ENOOBJECT: stat = NC_EEMPTY;
+    case NC_EEMPTY: break;
+    default: break;
+    }
+
+done:
+    nullfree(content);
+    zfrelease(zfmap,&fd);
+    return ZUNTRACEX(stat,"len=%llu",len);
+}
+
 static int
 zfilewrite(NCZMAP* map, const char* key, size64_t count, const void* content)
 {
@@ -430,11 +500,15 @@ zfilewrite(NCZMAP* map, const char* key, size64_t count, const void* content)
         /* Create truepath */
         if((stat = zffullpath(zfmap,key,&truepath))) goto done;
 	/* Create file */
+	map->stats.opens++;
 	if((stat = platformcreatefile(zfmap->map.mode,truepath,&fd))) goto done;
+	zfcacheinsert(zfmap,key,&fd);
 	/* Fall thru to write the object */
     case NC_NOERR:
-        if((stat = platformseek(&fd, SEEK_SET, &start))) goto done;
-        if((stat = platformwrite(&fd, count, content))) goto done;
+	map->stats.writes++;
+        if((stat = platformwrite(&fd, start, count, content))) goto done;
+	/* The object may have been longer */
+        if((stat = platformtruncate(&fd, count))) goto done;
 	break;
     default: break;
     }
@@ -453,6 +527,10 @@ zfileclose(NCZMAP* map, int delete)
 
     ZTRACE(5,"map=%s delete=%d",map->url,delete);
     if(zfmap == NULL) return NC_NOERR;
+
+    /* Must close cached descriptors before any deletion */
+    zfcacheclear(zfmap);
+    nullfree(zfmap->fdcache);
     
     /* Delete the subtree below the root and the root */
     if(delete) {
@@ -573,16 +651,34 @@ zflookupobj(ZFMAP* zfmap, const char* key, FD* fd)
 
     ZTRACE(5,"map=%s key=%s",zfmap->map.url,key);
 
+    /* Try the descriptor cache first */
+    {
+	size_t i;
+        for(i=0;i<zfmap->nslots;i++) {
+	    ZFSLOT* slot = &zfmap->fdcache[i];
+	    if(slot->key != NULL && strcmp(slot->key,key)==0) {
+	        slot->lastuse = ++zfmap->clock;
+		fd->fd = slot->fd;
+		fd->cached = 1;
+		zfmap->map.stats.hits++;
+		goto done;
+	    }
+	}
+    }
+
     if((stat = zffullpath(zfmap,key,&path)))
 	{goto done;}    
 
     /* See if this is content-bearing */
+    zfmap->map.stats.stats++;
     if((stat = platformtestcontentbearing(path)))
 	goto done;        
 
     /* Open the file */
+    zfmap->map.stats.opens++;
     if((stat = platformopenfile(zfmap->map.mode,path,fd)))
         goto done;
+    zfcacheinsert(zfmap,key,fd);
 
 done:
     errno = 0;
@@ -595,10 +691,73 @@ static void
 zfrelease(ZFMAP* zfmap, FD* fd)
 {
     ZTRACE(5,"map=%s fd=%d",zfmap->map.url,(fd?fd->fd:-1));
-    platformrelease(fd);
+    if(fd->cached) {
+	/* The cache still owns it */
+	fd->fd = -1;
+	fd->cached = 0;
+    } else {
+        if(fd->fd >= 0) zfmap->map.stats.closes++;
+        platformrelease(fd);
+    }
     (void)ZUNTRACE(NC_NOERR);
 }
 
+/**************************************************/
+/* Descriptor cache */
+
+static int
+zfcacheinit(ZFMAP* zfmap)
+{
+    zfmap->nslots = zffdcachesize;
+    if(zfmap->nslots == 0) return NC_NOERR;
+    if((zfmap->fdcache = (ZFSLOT*)calloc(zfmap->nslots,sizeof(ZFSLOT)))==NULL)
+        return NC_ENOMEM;
+    return NC_NOERR;
+}
+
+/* Hand ownership of an open fd to the cache, evicting the least
+   recently used entry if necessary; if the cache is disabled or
+   the key cannot be saved, the caller retains ownership. */
+static void
+zfcacheinsert(ZFMAP* zfmap, const char* key, FD* fd)
+{
+    size_t i;
+    ZFSLOT* victim = NULL;
+    char* keycopy = NULL;
+
+    if(zfmap->nslots == 0 || fd->fd < 0) return;
+    if((keycopy = strdup(key)) == NULL) return;
+    for(i=0;i<zfmap->nslots;i++) {
+	ZFSLOT* slot = &zfmap->fdcache[i];
+	if(slot->key == NULL) {victim = slot; break;}
+	if(victim == NULL || slot->lastuse < victim->lastuse) victim = slot;
+    }
+    if(victim->key != NULL) {
+	zfmap->map.stats.closes++;
+	NCclose(victim->fd);
+	nullfree(victim->key);
+    }
+    victim->key = keycopy;
+    victim->fd = fd->fd;
+    victim->lastuse = ++zfmap->clock;
+    fd->cached = 1;
+}
+
+static void
+zfcacheclear(ZFMAP* zfmap)
+{
+    size_t i;
+    for(i=0;i<zfmap->nslots;i++) {
+	ZFSLOT* slot = &zfmap->fdcache[i];
+	if(slot->key == NULL) continue;
+	zfmap->map.stats.closes++;
+	NCclose(slot->fd);
+	nullfree(slot->key);
+	slot->key = NULL;
+	slot->fd = -1;
+    }
+}
+
 /**************************************************/
 /* External API objects */
 
@@ -618,6 +777,9 @@ static NCZMAP_API zapi = {
     zfileread,
     zfilewrite,
     zfilesearch,
+    zfilereadobj,
+    NULL, /* readmany */
+    NULL, /* writemany */
 };
 
 static int
@@ -1059,68 +1221,111 @@ done:
 }
 
 static int
-platformseek(FD* fd, int pos, size64_t* sizep)
+platformsize(FD* fd, size64_t* sizep)
 {
     int ret = NC_NOERR;
-    size64_t size, newsize;
     struct stat statbuf;    
     
     assert(fd && fd->fd >= 0);
     
-    ZTRACE(6,"fd=%d pos=%d",(fd?fd->fd:-1),pos);
+    ZTRACE(6,"fd=%d",(fd?fd->fd:-1));
 
     errno = 0;
     ret = NCfstat(fd->fd, &statbuf);    
     if(ret < 0)
 	{ret = platformerr(errno); goto done;}
-    if(sizep) size = *sizep; else size = 0;
-    newsize = (size64_t)lseek(fd->fd,(off_t)size,pos);
-    if(sizep) *sizep = newsize;
+    if(sizep) *sizep = (size64_t)statbuf.st_size;
 done:
     errno = 0;
     return ZUNTRACEX(ret,"sizep=%llu",*sizep);
 }
 
+/* Set the size of a file */
 static int
-platformread(FD* fd, size64_t count, void* content)
+platformtruncate(FD* fd, size64_t size)
+{
+    int ret = NC_NOERR;
+
+    assert(fd && fd->fd >= 0);
+
+    ZTRACE(6,"fd=%d size=%llu",(fd?fd->fd:-1),size);
+
+    errno = 0;
+#ifdef _WIN32
+    if(_chsize_s(fd->fd,(__int64)size) != 0)
+#else
+    if(ftruncate(fd->fd,(off_t)size) < 0)
+#endif
+	{ret = platformerr(errno); goto done;}
+done:
+    errno = 0;
+    return ZUNTRACE(ret);
+}
+
+/* Positional read; the file offset of fd is not used */
+static int
+platformread(FD* fd, size64_t start, size64_t count, void* content)
 {
     int stat = NC_NOERR;
     size_t need = count;
     unsigned char* readpoint = content;
+    off_t offset = (off_t)start;
 
     assert(fd && fd->fd >= 0);
 
-    ZTRACE(6,"fd=%d count=%llu",(fd?fd->fd:-1),count);
+    ZTRACE(6,"fd=%d start=%llu count=%llu",(fd?fd->fd:-1),start,count);
 
+#ifdef _WIN32
+    if(lseek(fd->fd,offset,SEEK_SET) < 0)
+	{stat = errno; goto done;}
+#endif
     while(need > 0) {
         ssize_t red;
-        if((red = read(fd->fd,readpoint,need)) <= 0)
+#ifdef _WIN32
+        red = read(fd->fd,readpoint,need);
+#else
+        red = pread(fd->fd,readpoint,need,offset);
+#endif
+        if(red <= 0)
 	    {stat = errno; goto done;}
         need -= red;
 	readpoint += red;
+	offset += red;
     }
 done:
     errno = 0;
     return ZUNTRACE(stat);
 }
 
+/* Positional write; the file offset of fd is not used */
 static int
-platformwrite(FD* fd, size64_t count, const void* content)
+platformwrite(FD* fd, size64_t start, size64_t count, const void* content)
 {
     int ret = NC_NOERR;
     size_t need = count;
     unsigned char* writepoint = (unsigned char*)content;
+    off_t offset = (off_t)start;
 
     assert(fd && fd->fd >= 0);
     
-    ZTRACE(6,"fd=%d count=%llu",(fd?fd->fd:-1),count);
+    ZTRACE(6,"fd=%d start=%llu count=%llu",(fd?fd->fd:-1),start,count);
 
+#ifdef _WIN32
+    if(lseek(fd->fd,offset,SEEK_SET) < 0)
+	{ret = NC_EACCESS; goto done;}
+#endif
     while(need > 0) {
         ssize_t red = 0;
-        if((red = write(fd->fd,(void*)writepoint,need)) <= 0)	
+#ifdef _WIN32
+        red = write(fd->fd,(void*)writepoint,need);
+#else
+        red = pwrite(fd->fd,(void*)writepoint,need,offset);
+#endif
+        if(red <= 0)
 	    {ret = NC_EACCESS; goto done;}
         need -= red;
 	writepoint += red;
+	offset += red;
     }
 done:
     return ZUNTRACE(ret);
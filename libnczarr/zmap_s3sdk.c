@@ -246,6 +246,7 @@ zs3truncate(const char *s3url)
     NCS3INFO info;
 
     ZTRACE(6,"url=%s",s3url);
+    memset(&info,0,sizeof(info));
     ncuriparse(s3url,&url);
     if(url == NULL) {stat = NC_EURL; goto done;}
     if((stat=NC_s3urlprocess(url,&info,&purl))) goto done;
@@ -353,39 +354,85 @@ zs3write(NCZMAP* map, const char* key, size64_t count, const void* content)
 {
     int stat = NC_NOERR;
     ZS3MAP* z3map = (ZS3MAP*)map; /* cast to true type */
-    char* chunk = NULL; /* use char* so we can do arithmetic with it */
     char* truekey = NULL;
-    size64_t objsize;
 	
     ZTRACE(6,"map=%s key=%s count=%llu",map->url,key,count);
 
     if((stat = maketruekey(z3map->s3.rootkey,key,&truekey))) goto done;
 
-    /* Apparently S3 has no write byterange operation, so we need to read the whole object,
-       copy data, and then rewrite */       
-    switch (stat=NC_s3sdkinfo(z3map->s3client, z3map->s3.bucket, truekey, &objsize, &z3map->errmsg)) {
-    case NC_NOERR: /* Figure out the new size of the object */
-        break;
-    case NC_EEMPTY: case NC_ENOOBJECT:
-	stat = NC_NOERR; /* reset */
-        break;
-    default: reporterr(z3map); goto done;
-    }
-
-    chunk = (char*)calloc(1,count); /* initialize it */
-    if(chunk == NULL)
-	{stat = NC_ENOMEM; goto done;}
-    /* overwrite the relevant part of the memory with the contents */
-    if(count > 0)
-        memcpy((char*)chunk,content,count);
-    /* (re-)write */
-    if((stat = NC_s3sdkwriteobject(z3map->s3client, z3map->s3.bucket, truekey, count, (void*)chunk, &z3map->errmsg)))
+    /* S3 has no write byterange operation, so always write the whole object */
+    if((stat = NC_s3sdkwriteobject(z3map->s3client, z3map->s3.bucket, truekey, count, content, &z3map->errmsg)))
         goto done;
 
 done:
     nullfree(truekey);
     reporterr(z3map);
-    nullfree(chunk);
+    return ZUNTRACE(stat);
+}
+
+/* Read a whole object with one GET instead of a HEAD plus a GET */
+static int
+zs3readobj(NCZMAP* map, const char* key, size64_t* sizep, void** contentp)
+{
+    int stat = NC_NOERR;
+    ZS3MAP* z3map = (ZS3MAP*)map; /* cast to true type */
+    char* truekey = NULL;
+
+    ZTRACE(6,"map=%s key=%s",map->url,key);
+
+    if((stat = maketruekey(z3map->s3.rootkey,key,&truekey))) goto done;
+    if((stat = NC_s3sdkreadobject(z3map->s3client, z3map->s3.bucket, truekey, sizep, contentp, &z3map->errmsg)))
+        goto done;
+done:
+    nullfree(truekey);
+    reporterr(z3map);
+    return ZUNTRACE(stat);
+}
+
+static int
+zs3readmany(NCZMAP* map, size_t n, const char** keys, size64_t* sizes, void** contents, int* stats)
+{
+    int stat = NC_NOERR;
+    ZS3MAP* z3map = (ZS3MAP*)map; /* cast to true type */
+    char** truekeys = NULL;
+    size_t i;
+
+    ZTRACE(6,"map=%s n=%d",map->url,(int)n);
+
+    if((truekeys = (char**)calloc(n,sizeof(char*))) == NULL) {stat = NC_ENOMEM; goto done;}
+    for(i=0;i<n;i++)
+        if((stat = maketruekey(z3map->s3.rootkey,keys[i],&truekeys[i]))) goto done;
+    if((stat = NC_s3sdkreadobjects(z3map->s3client, z3map->s3.bucket, n, (const char**)truekeys, sizes, contents, stats, &z3map->errmsg)))
+        goto done;
+done:
+    if(truekeys != NULL) freevector(n,truekeys);
+    reporterr(z3map);
+    return ZUNTRACE(stat);
+}
+
+static int
+zs3writemany(NCZMAP* map, size_t n, const char** keys, const size64_t* counts, const void** contents)
+{
+    int stat = NC_NOERR;
+    ZS3MAP* z3map = (ZS3MAP*)map; /* cast to true type */
+    char** truekeys = NULL;
+    int* stats = NULL;
+    size_t i;
+
+    ZTRACE(6,"map=%s n=%d",map->url,(int)n);
+
+    if((truekeys = (char**)calloc(n,sizeof(char*))) == NULL) {stat = NC_ENOMEM; goto done;}
+    if((stats = (int*)calloc(n,sizeof(int))) == NULL) {stat = NC_ENOMEM; goto done;}
+    for(i=0;i<n;i++)
+        if((stat = maketruekey(z3map->s3.rootkey,keys[i],&truekeys[i]))) goto done;
+    if((stat = NC_s3sdkwriteobjects(z3map->s3client, z3map->s3.bucket, n, (const char**)truekeys, counts, contents, stats, &z3map->errmsg)))
+        goto done;
+    for(i=0;i<n;i++)
+        if(stats[i] != NC_NOERR) {stat = stats[i]; break;}
+done:
+    if(truekeys != NULL) freevector(n,truekeys);
+    nullfree(stats);
+    reporterr(z3map);
     return ZUNTRACE(stat);
 }
 
@@ -584,4 +631,7 @@ nczs3sdkapi = {
     zs3read,
     zs3write,
     zs3search,
+    zs3readobj,
+    zs3readmany,
+    zs3writemany,
 };
@@ -748,6 +748,9 @@ static NCZMAP_API zapi = {
     zipread,
     zipwrite,
     zipsearch,
+    NULL, /* readobj */
+    NULL, /* readmany */
+    NULL, /* writemany */
 };
 
 static int
@@ -88,14 +88,17 @@ int NCZMD_get_metadata_format(NCZ_FILE_INFO_T *zfile, int *zarrformat)
 }
 
 int NCZ_use_consolidated(NCZ_FILE_INFO_T *zfile) {
-    int use_consolidated = NCZARR_CONSOLIDATED_DEFAULT || (zfile->controls.flags & FLAG_CONSOLIDATED);
-    const char *e = getenv(NCZARR_CONSOLIDATED_ENV);
-
-    int env_use_consolidated = (e != NULL)  && (
-            (atoi(e) > 0) ||(strcasecmp(e, "true") == 0) || (strcasecmp(e, "yes") == 0)
-        );
-
-    return use_consolidated || env_use_consolidated;
+    const char *e = NULL;
+
+    /* A mode flag in the url wins, then the env var, then the default */
+    if (zfile->controls.flags & FLAG_NOCONSOLIDATED)
+        return 0;
+    if (zfile->controls.flags & FLAG_CONSOLIDATED)
+        return 1;
+    if ((e = getenv(NCZARR_CONSOLIDATED_ENV)) != NULL)
+        return (atoi(e) > 0) || (strcasecmp(e, "true") == 0)
+               || (strcasecmp(e, "yes") == 0) || (strcasecmp(e, "on") == 0);
+    return NCZARR_CONSOLIDATED_DEFAULT;
 }
 
 int NCZMD_set_metadata_handler(NCZ_FILE_INFO_T *zfile) {
@@ -115,14 +118,21 @@ int NCZMD_set_metadata_handler(NCZ_FILE_INFO_T *zfile) {
     if (!use_consolidated)
         return NC_NOERR;
 
+    /* One read of .zmetadata replaces a read of every .zgroup, .zarray and .zattrs */
     if (NCZ_downloadjson(zfile->map, Z2METADATA, &jcsl) || jcsl == NULL) {
         nclog(NCLOGNOTE, "Dataset not consolidated! Doing so will improve performance");
         return NC_NOERR;
     }
 
     if (NCZ_csl_metadata_handler2->validate_consolidated(jcsl) != NC_NOERR) {
+        NCJreclaim(jcsl);
+        /* Only an error if consolidated metadata was asked for explicitly */
+        if (zfile->controls.flags & FLAG_CONSOLIDATED) {
+            nclog(NCLOGERR,"Consolidated metadata is invalid!");
+            return NC_EZARRMETA;
+        }
         nclog(NCLOGWARN,"Consolidated metadata is invalid, ignoring it!");
-        return NC_EZARRMETA;
+        return NC_NOERR;
     }
 
     zfile->metadata = *NCZ_csl_metadata_handler2;
@@ -139,7 +149,8 @@ void NCZMD_free_metadata_handler(NCZ_Metadata * zmd){
 int NCZMD_consolidate(NCZ_FILE_INFO_T *zfile)
 {
 	int stat = NC_NOERR;
-	if (zfile->creating == 1 && zfile->metadata.jcsl !=NULL){
+	/* Rewrite .zmetadata for any store being written whose metadata it holds */
+	if (zfile->metadata.jcsl != NULL && !zfile->common.file->no_write){
 		stat = NCZ_uploadjson(zfile->map, Z2METADATA ,zfile->metadata.jcsl);
 	}
 	return stat;
@@ -95,6 +95,15 @@ ncz_open_file(const char *path, int mode, NClist* controls, int ncid)
     if ((mode & NC_WRITE) == 0)
 	h5->no_write = NC_TRUE;
 
+    /* With NC_LAZY_GROUPS, a read-only open reads only the root group
+       here; the others are read when first used. */
+    if ((mode & NC_LAZY_GROUPS) && h5->no_write)
+	h5->read_grp = ncz_read_deferred_grp;
+
+    /* Read-only, reads of different variables may overlap; not so when
+       an inquiry may read a group */
+    nc->concurrency = (h5->no_write && h5->read_grp == NULL ? NC_CONCURRENT_VARS : NC_CONCURRENT_FILES);
+
     /* Setup zarr state */
     if((stat = ncz_open_dataset(h5,controls)))
 	goto exit;
@@ -0,0 +1,498 @@
+/*********************************************************************
+ *   Copyright 2018, UCAR/Unidata
+ *   See netcdf/COPYRIGHT file for copying and redistribution conditions.
+ *********************************************************************/
+
+/**
+ * @file @internal Sharded chunk storage.
+ *
+ * A sharded variable packs a block of its chunks (the inner chunks)
+ * into a single map object, a shard, instead of storing each chunk
+ * as its own object. The layout of a shard follows the Zarr version 3
+ * sharding codec with the index at the end: the raw (possibly
+ * filtered) inner chunks one after the other, followed by an index
+ * giving the offset and size of each inner chunk, in row major order,
+ * as pairs of little endian unsigned 64 bit integers. An inner chunk
+ * that was never written has offset and size both 2^64-1.
+ *
+ * Shards are named exactly as chunks are, but by their own indices,
+ * so for a variable with chunks of size 10x10 and shards of 4x4
+ * chunks, the shard "1.0" holds rows 40-79 and columns 0-39.
+ *
+ * Inner chunks are read with byte range reads, using an index cached
+ * per shard. Inner chunks that are written are staged with their
+ * shard, and a shard is written as a whole when all of its inner
+ * chunks have been staged, when the staged data outgrows the chunk
+ * cache, and when the chunk cache is flushed.
+ */
+
+#include "zincludes.h"
+#include "zcache.h"
+#include "ncxcache.h"
+
+#undef DEBUG
+
+/* Marks an inner chunk that has never been written */
+#define EMPTYCHUNK 0xFFFFFFFFFFFFFFFFULL
+/* Bytes per index entry: offset + size */
+#define ENTRYSIZE (2*sizeof(unsigned long long))
+/* Number of shard indices kept when nothing is staged */
+#define MAXINDICES 64
+
+/* One shard of a variable */
+typedef struct NCZShard {
+    size64_t* indices; /* the shard indices */
+    ncexhashkey_t hashkey;
+    char* path; /* map key of the shard object */
+    int loaded; /* 1 => exists and index are valid */
+    int exists; /* 1 => the shard object exists */
+    size64_t* index; /* 2 per inner chunk: (offset,size) in the shard object */
+    void** staged; /* per inner chunk: raw data not yet written, or NULL */
+    size64_t* stagedsize;
+    size64_t nstaged;
+} NCZShard;
+
+/* The shards of a variable known to its chunk cache */
+typedef struct NCZShards {
+    size64_t rank;
+    size64_t nchunks; /* inner chunks per shard */
+    size64_t staged; /* total bytes of staged inner chunks */
+    NClist* list; /* NClist<NCZShard*>; least recently used first */
+} NCZShards;
+
+/* Forward */
+static int getshards(NCZChunkCache* cache, NCZShards** shardsp);
+static int locate(NCZChunkCache* cache, const size64_t* indices, NCZShard** shardp, size64_t* posp);
+static int loadindex(NCZChunkCache* cache, NCZShards* shards, NCZShard* shard);
+static int assemble(NCZChunkCache* cache, NCZShards* shards, NCZShard* shard, size64_t* sizep, void** contentp, size64_t* index);
+static void commit(NCZShards* shards, NCZShard* shard, size64_t* index);
+static void freeshard(NCZShard* shard, size64_t nchunks);
+static NCZMAP* getmap(NCZChunkCache* cache);
+static size64_t decode64(const unsigned char* p);
+static void encode64(unsigned char* p, size64_t v);
+
+/**************************************************/
+
+/**
+ * @internal Read the raw data of an inner chunk.
+ *
+ * @param cache the chunk cache of a sharded variable
+ * @param indices the chunk indices
+ * @param sizep return the size of the raw data
+ * @param datap return the raw data in malloc'd memory
+ *
+ * @return ::NC_NOERR No error.
+ * @return ::NC_EEMPTY The chunk has never been written.
+ */
+int
+NCZ_shard_read(NCZChunkCache* cache, const size64_t* indices, size64_t* sizep, void** datap)
+{
+    int stat = NC_NOERR;
+    NCZShards* shards = NULL;
+    NCZShard* shard = NULL;
+    size64_t pos, offset, size;
+    void* data = NULL;
+
+    if((stat = getshards(cache,&shards))) goto done;
+    if((stat = locate(cache,indices,&shard,&pos))) goto done;
+    if(shard->staged != NULL && shard->staged[pos] != NULL) {
+        /* Written but not yet stored */
+	size = shard->stagedsize[pos];
+	if((data = malloc(size == 0 ? 1 : (size_t)size)) == NULL) {stat = NC_ENOMEM; goto done;}
+	memcpy(data,shard->staged[pos],(size_t)size);
+    } else {
+	if((stat = loadindex(cache,shards,shard))) goto done;
+	if(!shard->exists) {stat = NC_EEMPTY; goto done;}
+	offset = shard->index[2*pos];
+	size = shard->index[2*pos+1];
+	if(offset == EMPTYCHUNK && size == EMPTYCHUNK) {stat = NC_EEMPTY; goto done;}
+	if((data = malloc(size == 0 ? 1 : (size_t)size)) == NULL) {stat = NC_ENOMEM; goto done;}
+	if(size > 0 && (stat = nczmap_read(getmap(cache),shard->path,offset,size,data))) goto done;
+    }
+    if(sizep) *sizep = size;
+    if(datap) {*datap = data; data = NULL;}
+done:
+    nullfree(data);
+    return THROW(stat);
+}
+
+/**
+ * @internal Write the raw data of an inner chunk. The data is
+ * copied and staged with its shard.
+ *
+ * @param cache the chunk cache of a sharded variable
+ * @param indices the chunk indices
+ * @param size the size of the raw data
+ * @param data the raw data
+ *
+ * @return ::NC_NOERR No error.
+ */
+int
+NCZ_shard_write(NCZChunkCache* cache, const size64_t* indices, size64_t size, const void* data)
+{
+    int stat = NC_NOERR;
+    NCZShards* shards = NULL;
+    NCZShard* shard = NULL;
+    size64_t pos;
+    void* copy = NULL;
+
+    if((stat = getshards(cache,&shards))) goto done;
+    if((stat = locate(cache,indices,&shard,&pos))) goto done;
+    if(shard->staged == NULL) {
+	if((shard->staged = (void**)calloc((size_t)shards->nchunks,sizeof(void*))) == NULL
+	   || (shard->stagedsize = (size64_t*)calloc((size_t)shards->nchunks,sizeof(size64_t))) == NULL)
+	    {stat = NC_ENOMEM; goto done;}
+    }
+    if((copy = malloc(size == 0 ? 1 : (size_t)size)) == NULL) {stat = NC_ENOMEM; goto done;}
+    memcpy(copy,data,(size_t)size);
+    if(shard->staged[pos] != NULL) {
+	shards->staged -= shard->stagedsize[pos];
+	free(shard->staged[pos]);
+    } else
+	shard->nstaged++;
+    shard->staged[pos] = copy; copy = NULL;
+    shard->stagedsize[pos] = size;
+    shards->staged += size;
+
+    if(shard->nstaged == shards->nchunks) {
+	/* Every inner chunk is new, so just write the shard */
+	size64_t* index = NULL;
+	size64_t len = 0;
+	void* content = NULL;
+	if((index = (size64_t*)malloc((size_t)(2*shards->nchunks)*sizeof(size64_t))) == NULL)
+	    {stat = NC_ENOMEM; goto done;}
+	if((stat = assemble(cache,shards,shard,&len,&content,index)) == NC_NOERR)
+	    stat = nczmap_write(getmap(cache),shard->path,len,content);
+	if(stat == NC_NOERR) commit(shards,shard,index); else nullfree(index);
+	nullfree(content);
+    } else if(shards->staged > cache->params.size)
+	stat = NCZ_shard_flush(cache);
+
+done:
+    nullfree(copy);
+    return THROW(stat);
+}
+
+/**
+ * @internal Write every shard with staged inner chunks, with one
+ * nczmap_writemany call.
+ *
+ * @param cache the chunk cache of a sharded variable
+ *
+ * @return ::NC_NOERR No error.
+ */
+int
+NCZ_shard_flush(NCZChunkCache* cache)
+{
+    int stat = NC_NOERR;
+    NCZShards* shards = (NCZShards*)cache->shards;
+    size_t i, n = 0, nshards;
+    NCZShard** pending = NULL;
+    char** paths = NULL;
+    size64_t* counts = NULL;
+    void** contents = NULL;
+    size64_t** indices = NULL;
+
+    if(shards == NULL || shards->staged == 0) goto done;
+    nshards = nclistlength(shards->list);
+    if((pending = (NCZShard**)calloc(nshards,sizeof(NCZShard*))) == NULL
+       || (paths = (char**)calloc(nshards,sizeof(char*))) == NULL
+       || (counts = (size64_t*)calloc(nshards,sizeof(size64_t))) == NULL
+       || (contents = (void**)calloc(nshards,sizeof(void*))) == NULL
+       || (indices = (size64_t**)calloc(nshards,sizeof(size64_t*))) == NULL)
+	{stat = NC_ENOMEM; goto done;}
+    for(i=0;i<nshards;i++) {
+	NCZShard* shard = (NCZShard*)nclistget(shards->list,i);
+	if(shard->nstaged == 0) continue;
+	if((indices[n] = (size64_t*)malloc((size_t)(2*shards->nchunks)*sizeof(size64_t))) == NULL)
+	    {stat = NC_ENOMEM; goto done;}
+	if((stat = assemble(cache,shards,shard,&counts[n],&contents[n],indices[n]))) goto done;
+	pending[n] = shard;
+	paths[n] = shard->path;
+	n++;
+    }
+    if((stat = nczmap_writemany(getmap(cache),n,(const char**)paths,counts,(const void**)contents))) goto done;
+    for(i=0;i<n;i++) {
+	commit(shards,pending[i],indices[i]);
+	indices[i] = NULL;
+    }
+
+done:
+    for(i=0;i<n;i++) {
+	nullfree(contents[i]);
+	nullfree(indices[i]);
+    }
+    nullfree(pending);
+    nullfree(paths);
+    nullfree(counts);
+    nullfree(contents);
+    nullfree(indices);
+    return THROW(stat);
+}
+
+/**
+ * @internal Reclaim the shard state of a chunk cache, discarding
+ * anything still staged.
+ *
+ * @param cache the chunk cache
+ */
+void
+NCZ_shard_free(NCZChunkCache* cache)
+{
+    NCZShards* shards = (NCZShards*)cache->shards;
+    size_t i;
+
+    if(shards == NULL) return;
+    for(i=0;i<nclistlength(shards->list);i++)
+	freeshard((NCZShard*)nclistget(shards->list,i),shards->nchunks);
+    nclistfree(shards->list);
+    free(shards);
+    cache->shards = NULL;
+}
+
+/**************************************************/
+
+static int
+getshards(NCZChunkCache* cache, NCZShards** shardsp)
+{
+    int stat = NC_NOERR;
+    NCZ_VAR_INFO_T* zvar = (NCZ_VAR_INFO_T*)cache->var->format_var_info;
+    NCZShards* shards = (NCZShards*)cache->shards;
+    size_t i;
+
+    assert(zvar->shards != NULL && !zvar->scalar);
+    if(shards == NULL) {
+	if((shards = (NCZShards*)calloc(1,sizeof(NCZShards))) == NULL) {stat = NC_ENOMEM; goto done;}
+	shards->rank = cache->ndims;
+	shards->nchunks = 1;
+	for(i=0;i<shards->rank;i++)
+	    shards->nchunks *= zvar->shards[i];
+	shards->list = nclistnew();
+	cache->shards = shards;
+    }
+    if(shardsp) *shardsp = shards;
+done:
+    return stat;
+}
+
+/* Find, or add, the shard holding the chunk with the given indices,
+   and return the position of the chunk within the shard */
+static int
+locate(NCZChunkCache* cache, const size64_t* indices, NCZShard** shardp, size64_t* posp)
+{
+    int stat = NC_NOERR;
+    NCZ_VAR_INFO_T* zvar = (NCZ_VAR_INFO_T*)cache->var->format_var_info;
+    NCZShards* shards = (NCZShards*)cache->shards;
+    size64_t shardindices[NC_MAX_VAR_DIMS];
+    size64_t pos = 0;
+    ncexhashkey_t hkey;
+    NCZShard* shard = NULL;
+    struct ChunkKey key = {NULL,NULL};
+    size_t i;
+
+    for(i=0;i<shards->rank;i++) {
+	shardindices[i] = indices[i] / zvar->shards[i];
+	pos = (pos * zvar->shards[i]) + (indices[i] % zvar->shards[i]);
+    }
+    hkey = ncxcachekey(shardindices,sizeof(size64_t)*shards->rank);
+
+    /* Most recently used is last */
+    for(i=nclistlength(shards->list);i-->0;) {
+	NCZShard* s = (NCZShard*)nclistget(shards->list,i);
+	if(s->hashkey == hkey && memcmp(s->indices,shardindices,sizeof(size64_t)*shards->rank)==0) {
+	    shard = s;
+	    if(i+1 < nclistlength(shards->list)) {
+		(void)nclistremove(shards->list,i);
+		nclistpush(shards->list,shard);
+	    }
+	    break;
+	}
+    }
+
+    if(shard == NULL) {
+	/* Forget the oldest indices of shards with nothing staged */
+	for(i=0;i<nclistlength(shards->list) && nclistlength(shards->list) >= MAXINDICES;) {
+	    NCZShard* s = (NCZShard*)nclistget(shards->list,i);
+	    if(s->nstaged > 0) {i++; continue;}
+	    (void)nclistremove(shards->list,i);
+	    freeshard(s,shards->nchunks);
+	}
+	if((shard = (NCZShard*)calloc(1,sizeof(NCZShard))) == NULL) {stat = NC_ENOMEM; goto done;}
+	if((shard->indices = (size64_t*)malloc(sizeof(size64_t)*shards->rank)) == NULL)
+	    {freeshard(shard,0); stat = NC_ENOMEM; goto done;}
+	memcpy(shard->indices,shardindices,sizeof(size64_t)*shards->rank);
+	shard->hashkey = hkey;
+	if((stat = NCZ_buildchunkpath(cache,shardindices,&key))) {freeshard(shard,0); goto done;}
+	if((shard->path = NCZ_chunkpath(key)) == NULL) {freeshard(shard,0); stat = NC_ENOMEM; goto done;}
+	nclistpush(shards->list,shard);
+    }
+    if(shardp) *shardp = shard;
+    if(posp) *posp = pos;
+done:
+    nullfree(key.varkey);
+    nullfree(key.chunkkey);
+    return stat;
+}
+
+/* Read the index of a shard, if not already known */
+static int
+loadindex(NCZChunkCache* cache, NCZShards* shards, NCZShard* shard)
+{
+    int stat = NC_NOERR;
+    NCZMAP* map = getmap(cache);
+    size64_t len = 0, indexsize, i;
+    unsigned char* raw = NULL;
+
+    if(shard->loaded) goto done;
+    indexsize = shards->nchunks * ENTRYSIZE;
+    switch (stat = nczmap_len(map,shard->path,&len)) {
+    case NC_NOERR: break;
+    case NC_EEMPTY: case NC_ENOOBJECT:
+	stat = NC_NOERR;
+	shard->exists = 0;
+	shard->loaded = 1;
+	goto done;
+    default: goto done;
+    }
+    if(len < indexsize) {stat = NC_ENCZARR; goto done;} /* corrupt */
+    if((raw = (unsigned char*)malloc((size_t)indexsize)) == NULL) {stat = NC_ENOMEM; goto done;}
+    if((stat = nczmap_read(map,shard->path,len - indexsize,indexsize,raw))) goto done;
+    if(shard->index == NULL
+       && (shard->index = (size64_t*)malloc((size_t)(2*shards->nchunks)*sizeof(size64_t))) == NULL)
+	{stat = NC_ENOMEM; goto done;}
+    for(i=0;i<2*shards->nchunks;i++)
+	shard->index[i] = decode64(raw + (i*sizeof(unsigned long long)));
+    /* Check that the chunks lie within the object */
+    for(i=0;i<shards->nchunks;i++) {
+	size64_t offset = shard->index[2*i];
+	size64_t size = shard->index[2*i+1];
+	if(offset == EMPTYCHUNK && size == EMPTYCHUNK) continue;
+	if(offset > len - indexsize || size > (len - indexsize) - offset)
+	    {stat = NC_ENCZARR; goto done;}
+    }
+    shard->exists = 1;
+    shard->loaded = 1;
+done:
+    nullfree(raw);
+    return stat;
+}
+
+/* Build the new content of a shard from its staged inner chunks and,
+   if not all are staged, its existing content. Returns the index of
+   the new content in index. */
+static int
+assemble(NCZChunkCache* cache, NCZShards* shards, NCZShard* shard, size64_t* sizep, void** contentp, size64_t* index)
+{
+    int stat = NC_NOERR;
+    void* old = NULL;
+    size64_t oldlen = 0, total, offset, i;
+    unsigned char* content = NULL;
+
+    if(shard->nstaged < shards->nchunks) {
+	/* Keep the inner chunks that were not rewritten */
+	if((stat = loadindex(cache,shards,shard))) goto done;
+	if(shard->exists) {
+	    if((stat = nczmap_readobj(getmap(cache),shard->path,&oldlen,&old))) goto done;
+	}
+    }
+    total = shards->nchunks * ENTRYSIZE;
+    for(i=0;i<shards->nchunks;i++) {
+	if(shard->staged[i] != NULL)
+	    total += shard->stagedsize[i];
+	else if(old != NULL && shard->index[2*i] != EMPTYCHUNK)
+	    total += shard->index[2*i+1];
+    }
+    if((content = (unsigned char*)malloc((size_t)total)) == NULL) {stat = NC_ENOMEM; goto done;}
+    offset = 0;
+    for(i=0;i<shards->nchunks;i++) {
+	const void* src = NULL;
+	size64_t size = 0;
+	if(shard->staged[i] != NULL) {
+	    src = shard->staged[i];
+	    size = shard->stagedsize[i];
+	} else if(old != NULL && shard->index[2*i] != EMPTYCHUNK) {
+	    src = ((unsigned char*)old) + shard->index[2*i];
+	    size = shard->index[2*i+1];
+	}
+	if(src == NULL) {
+	    index[2*i] = EMPTYCHUNK;
+	    index[2*i+1] = EMPTYCHUNK;
+	} else {
+	    memcpy(content+offset,src,(size_t)size);
+	    index[2*i] = offset;
+	    index[2*i+1] = size;
+	    offset += size;
+	}
+    }
+    /* Append the index */
+    for(i=0;i<2*shards->nchunks;i++)
+	encode64(content + offset + (i*sizeof(unsigned long long)),index[i]);
+    if(sizep) *sizep = total;
+    if(contentp) {*contentp = content; content = NULL;}
+done:
+    nullfree(old);
+    nullfree(content);
+    return stat;
+}
+
+/* Record that a shard has been written with the given index */
+static void
+commit(NCZShards* shards, NCZShard* shard, size64_t* index)
+{
+    size64_t i;
+    nullfree(shard->index);
+    shard->index = index;
+    shard->exists = 1;
+    shard->loaded = 1;
+    for(i=0;i<shards->nchunks;i++) {
+	if(shard->staged[i] == NULL) continue;
+	shards->staged -= shard->stagedsize[i];
+	free(shard->staged[i]);
+	shard->staged[i] = NULL;
+    }
+    shard->nstaged = 0;
+}
+
+static void
+freeshard(NCZShard* shard, size64_t nchunks)
+{
+    size64_t i;
+    if(shard == NULL) return;
+    if(shard->staged != NULL) {
+	for(i=0;i<nchunks;i++) nullfree(shard->staged[i]);
+	free(shard->staged);
+    }
+    nullfree(shard->stagedsize);
+    nullfree(shard->index);
+    nullfree(shard->indices);
+    nullfree(shard->path);
+    free(shard);
+}
+
+static NCZMAP*
+getmap(NCZChunkCache* cache)
+{
+    NC_FILE_INFO_T* file = (cache->var->container)->nc4_info;
+    NCZ_FILE_INFO_T* zfile = file->format_file_info;
+    return zfile->map;
+}
+
+static size64_t
+decode64(const unsigned char* p)
+{
+    size64_t v = 0;
+    int i;
+    for(i=7;i>=0;i--)
+	v = (v << 8) | p[i];
+    return v;
+}
+
+static void
+encode64(unsigned char* p, size64_t v)
+{
+    int i;
+    for(i=0;i<8;i++) {
+	p[i] = (unsigned char)(v & 0xFF);
+	v >>= 8;
+    }
+}
@@ -21,6 +21,7 @@
 /* Forward */
 static int ncz_collect_dims(NC_FILE_INFO_T* file, NC_GRP_INFO_T* grp, NCjson** jdimsp);
 static int ncz_sync_var(NC_FILE_INFO_T* file, NC_VAR_INFO_T* var, int isclose);
+static int isshardcodec(const NCjson* jcodec);
 
 static int download_jatts(NC_FILE_INFO_T* file, NC_OBJ* container, const NCjson** jattsp, const NCjson** jtypesp);
 static int zconvert(const NCjson* src, nc_type typeid, size_t typelen, int* countp, NCbytes* dst);
@@ -223,8 +224,9 @@ ncz_sync_grp(NC_FILE_INFO_T* file, NC_GRP_INFO_T* grp, int isclose)
         jsubgrps = NULL; /* avoid memory problems */
     }
 
-    /* Build the .zattrs object */
+    /* Build the .zattrs object; attributes never read must be kept */
     assert(grp->att);
+    if(!grp->atts_read && (stat = ncz_read_atts(file,(NC_OBJ*)grp))) goto done;
     NCJnew(NCJ_DICT,&jatts);
     NCJnew(NCJ_DICT,&jtypes);
     if((stat = ncz_sync_atts(file, (NC_OBJ*)grp, grp->att, jatts, jtypes, isclose))) goto done;
@@ -314,6 +316,7 @@ ncz_sync_var_meta(NC_FILE_INFO_T* file, NC_VAR_INFO_T* var, int isclose)
 #ifdef NETCDF_ENABLE_NCZARR_FILTERS
     NClist* filterchain = NULL;
     NCjson* jfilter = NULL;
+    size_t nfilters = 0;
 #endif
 
     ZTRACE(3,"file=%s var=%s isclose=%d",file->controller->path,var->hdr.name,isclose);
@@ -429,6 +432,25 @@ ncz_sync_var_meta(NC_FILE_INFO_T* file, NC_VAR_INFO_T* var, int isclose)
     if((stat = NCJaddstring(jvar,NCJ_STRING,"compressor"))<0) {stat = NC_EINVAL; goto done;}
 #ifdef NETCDF_ENABLE_NCZARR_FILTERS
     filterchain = (NClist*)var->filters;
+    /* All filters of a sharded variable go in the filters key */
+    nfilters = nclistlength(filterchain);
+    if(zvar->shards == NULL && nfilters > 0) nfilters--;
+#endif
+    if(zvar->shards != NULL) {
+	/* Name a codec that plain Zarr readers do not have, so that they
+	   refuse the variable rather than decode a shard as a chunk */
+	NCjson* jshards = NULL;
+	char digits[64];
+	NCJnew(NCJ_DICT,&jtmp);
+	if((stat = NCJinsertstring(jtmp,"id",NCZ_SHARD_CODEC))<0) {stat = NC_EINVAL; goto done;}
+	NCJnew(NCJ_ARRAY,&jshards);
+	for(i=0;i<var->ndims;i++) {
+	    snprintf(digits,sizeof(digits),"%llu",(unsigned long long)zvar->shards[i]);
+	    NCJaddstring(jshards,NCJ_INT,digits);
+	}
+	if((stat = NCJinsert(jtmp,"shards",jshards))<0) {stat = NC_EINVAL; goto done;}
+    } else
+#ifdef NETCDF_ENABLE_NCZARR_FILTERS
     if(nclistlength(filterchain) > 0) {
 	struct NCZ_Filter* filter = (struct NCZ_Filter*)nclistget(filterchain,nclistlength(filterchain)-1);
         /* encode up the compressor */
@@ -450,11 +472,11 @@ ncz_sync_var_meta(NC_FILE_INFO_T* file, NC_VAR_INFO_T* var, int isclose)
        if no filters are to be applied. */
     if((stat = NCJaddstring(jvar,NCJ_STRING,"filters"))<0) {stat = NC_EINVAL; goto done;}
 #ifdef NETCDF_ENABLE_NCZARR_FILTERS
-    if(nclistlength(filterchain) > 1) {
+    if(nfilters > 0) {
 	size_t k;
 	/* jtmp holds the array of filters */
 	NCJnew(NCJ_ARRAY,&jtmp);
-	for(k=0;k<nclistlength(filterchain)-1;k++) {
+	for(k=0;k<nfilters;k++) {
  	    struct NCZ_Filter* filter = (struct NCZ_Filter*)nclistget(filterchain,k);
 	    /* encode up the filter as a string */
 	    if((stat = NCZ_filter_jsonize(file,var,filter,&jfilter))) goto done;
@@ -521,10 +543,22 @@ ncz_sync_var_meta(NC_FILE_INFO_T* file, NC_VAR_INFO_T* var, int isclose)
 	NCJnewstring(NCJ_STRING,"chunked",&jtmp);
 	if((stat = NCJinsert(jncvar,"storage",jtmp))<0) {stat = NC_EINVAL; goto done;}
 	jtmp = NULL;
+	/* Record the inner chunks per shard, if sharded */
+	if(zvar->shards != NULL) {
+	    char digits[64];
+	    NCJnew(NCJ_ARRAY,&jtmp);
+	    for(i=0;i<var->ndims;i++) {
+		snprintf(digits,sizeof(digits),"%llu",(unsigned long long)zvar->shards[i]);
+		NCJaddstring(jtmp,NCJ_INT,digits);
+	    }
+	    if((stat = NCJinsert(jncvar,"shards",jtmp))<0) {stat = NC_EINVAL; goto done;}
+	    jtmp = NULL;
+	}
     }
 
-    /* Build .zattrs object */
+    /* Build .zattrs object; attributes never read must be kept */
     assert(var->att);
+    if(!var->atts_read && (stat = ncz_read_atts(file,(NC_OBJ*)var))) goto done;
     NCJnew(NCJ_DICT,&jatts);
     NCJnew(NCJ_DICT,&jtypes);
     if((stat = ncz_sync_atts(file,(NC_OBJ*)var, var->att, jatts, jtypes, isclose))) goto done;
@@ -1087,6 +1121,30 @@ done:
     return ZUNTRACE(stat);
 }
 
+/**
+ * @internal Read a group left unread by an NC_LAZY_GROUPS open. This
+ * is the read_grp hook of the file; it is called through
+ * nc4_read_deferred_grp() when the group is first used. The group's
+ * subgroups are added, but are not read.
+ *
+ * @param grp Pointer to grp struct
+ *
+ * @return ::NC_NOERR No error.
+ */
+int
+ncz_read_deferred_grp(NC_GRP_INFO_T* grp)
+{
+    int stat = NC_NOERR;
+
+    ZTRACE(3,"grp=%s",grp->hdr.name);
+    assert(grp->meta_deferred && grp->parent != NULL);
+    /* Clear this first, so lookups made while reading the group do
+       not come back here */
+    grp->meta_deferred = NC_FALSE;
+    stat = define_grp(grp->nc4_info,grp);
+    return ZUNTRACE(stat);
+}
+
 /**
  * @internal Read group data from map to memory
  *
@@ -1517,6 +1575,17 @@ define_var1(NC_FILE_INFO_T* file, NC_GRP_INFO_T* grp, const char* varname)
 	    }
 	    jdimrefs = NULL; /* avoid double free */
 	} /* else  simulate it from the shape of the variable */
+	/* Extract the inner chunks per shard */
+	if((stat = NCJdictget(jncvar,"shards",&jvalue))<0) {stat = NC_EINVAL; goto done;}
+	if(jvalue != NULL && !zvar->scalar && rank > 0) {
+	    if(NCJsort(jvalue) != NCJ_ARRAY || NCJarraylength(jvalue) != rank)
+		{stat = NC_ENCZARR; goto done;}
+	    if((zvar->shards = (size64_t*)calloc(NCJarraylength(jvalue),sizeof(size64_t))) == NULL)
+		{stat = NC_ENOMEM; goto done;}
+	    if((stat = decodeints(jvalue, zvar->shards))) goto done;
+	    for(j=0;j<NCJarraylength(jvalue);j++)
+		if(zvar->shards[j] == 0) {stat = NC_ENCZARR; goto done;}
+	}
     }
 
     /* Capture dimension_separator (must precede chunk cache creation) */
@@ -1679,9 +1748,20 @@ define_var1(NC_FILE_INFO_T* file, NC_GRP_INFO_T* grp, const char* varname)
 	if((stat = NCJdictget(jvar,"compressor",&jfilter))<0) {stat = NC_EINVAL; goto done;}
 	if(jfilter != NULL && NCJsort(jfilter) != NCJ_NULL) {
 	    if(NCJsort(jfilter) != NCJ_DICT) {stat = NC_EFILTER; goto done;}
-	    if((stat = NCZ_filter_build(file,var,jfilter,chainindex++))) goto done;
+	    /* The shard codec of a sharded variable is not a filter;
+	       anywhere else it is an unknown one */
+	    if(zvar->shards == NULL || !isshardcodec(jfilter)) {
+		if((stat = NCZ_filter_build(file,var,jfilter,chainindex++))) goto done;
+	    }
 	}
     }
+#endif
+    /* A sharded variable must name the shard codec */
+    if(zvar->shards != NULL) {
+	if((stat = NCJdictget(jvar,"compressor",&jvalue))<0) {stat = NC_EINVAL; goto done;}
+	if(jvalue == NULL || !isshardcodec(jvalue)) {stat = NC_ENCZARR; goto done;}
+    }
+#ifdef NETCDF_ENABLE_NCZARR_FILTERS
     /* Suppress variable if there are filters and var is not fixed-size */
     if(varsized && nclistlength((NClist*)var->filters) > 0)
 	suppress = 1;
@@ -1782,10 +1862,12 @@ define_subgrps(NC_FILE_INFO_T* file, NC_GRP_INFO_T* grp, NClist* subgrpnames)
 	((NCZ_GRP_INFO_T*)g->format_grp_info)->common.file = file;
     }
 
-    /* Recurse to fill in subgroups */
+    /* Recurse to fill in subgroups, or leave them until used */
     for(i=0;i<ncindexsize(grp->children);i++) {
 	NC_GRP_INFO_T* g = (NC_GRP_INFO_T*)ncindexith(grp->children,i);
-	if((stat = define_grp(file,g)))
+	if(file->read_grp != NULL)
+	    g->meta_deferred = NC_TRUE;
+	else if((stat = define_grp(file,g)))
 	    goto done;
     }
 
@@ -1889,6 +1971,16 @@ done:
     return ZUNTRACE(THROW(stat));
 }
 
+/* Is jcodec the codec that marks a sharded variable? */
+static int
+isshardcodec(const NCjson* jcodec)
+{
+    const NCjson* jid = NULL;
+    if(NCJsort(jcodec) != NCJ_DICT) return 0;
+    if(NCJdictget(jcodec,"id",&jid) < 0 || jid == NULL) return 0;
+    return (NCJsort(jid) == NCJ_STRING && strcmp(NCJstring(jid),NCZ_SHARD_CODEC) == 0);
+}
+
 /* Convert a list of integer strings to 64 bit dimension sizes (shapes) */
 static int
 decodeints(const NCjson* jshape, size64_t* shapes)
@@ -1954,6 +2046,8 @@ locategroup(NC_FILE_INFO_T* file, size_t nsegs, NClist* segments, NC_GRP_INFO_T*
 	char norm_name[NC_MAX_NAME];
 	found = 0;
 	if((stat = nc4_check_name(segment,norm_name))) goto done;
+	/* An unread group has no children yet */
+	if((stat = nc4_read_deferred_grp(grp))) goto done;
 	for(j=0;j<ncindexsize(grp->children);j++) {
 	    NC_GRP_INFO_T* subgrp = (NC_GRP_INFO_T*)ncindexith(grp->children,j);
 	    if(strcmp(subgrp->hdr.name,norm_name)==0) {
@@ -1964,7 +2058,8 @@ locategroup(NC_FILE_INFO_T* file, size_t nsegs, NClist* segments, NC_GRP_INFO_T*
 	}
 	if(!found) {stat = NC_ENOGRP; goto done;}
     }
-    /* grp should be group of interest */
+    /* grp should be group of interest; read it for its dims */
+    if((stat = nc4_read_deferred_grp(grp))) goto done;
     if(grpp) *grpp = grp;
 
 done:
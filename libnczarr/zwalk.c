@@ -24,6 +24,8 @@ static int rangecount(NCZChunkRange range);
 static int readfromcache(void* source, size64_t* chunkindices, void** chunkdata);
 static int iswholechunk(struct Common* common,NCZSlice*);
 static int wholechunk_indices(struct Common* common, NCZSlice* slices, size64_t* chunkindices);
+static int chunkskipped(const struct Common* common, const size64_t* chunkindices);
+static int prefetchchunks(const struct Common* common, NCZOdometer* aheadodom, size_t limit, size64_t* batch, size_t* consumedp);
 #ifdef TRANSFERN
 static int transfern(const struct Common* common, unsigned char* slpptr, unsigned char* memptr, size_t avail, size_t slpstride, void* chunkdata);
 #endif
@@ -98,6 +100,7 @@ NCZ_transferslice(NC_VAR_INFO_T* var, int reading,
     NCZ_FILE_INFO_T* zfile = NULL;
     NCZ_VAR_INFO_T* zvar = NULL;
     size_t typesize;
+    NCZM_STATS before;
 
     if(!initialized) ncz_chunking_init();
 
@@ -174,12 +177,24 @@ NCZ_transferslice(NC_VAR_INFO_T* var, int reading,
     common.reader.source = ((NCZ_VAR_INFO_T*)(var->format_var_info))->cache;
     common.reader.read = readfromcache;
 
+    /* Snapshot the map I/O counters so we can report the cost of this transfer */
+    if(wdebug >= 1) before = zfile->map->stats;
+
     if(common.scalar) {
         if((stat = NCZ_transferscalar(&common))) goto done;
     }
     else {
         if((stat = NCZ_transfer(&common, slices))) goto done;
     }
+
+    if(wdebug >= 1) {
+	const NCZM_STATS* after = &zfile->map->stats;
+        fprintf(stderr,"	map: opens=%llu closes=%llu stats=%llu seeks=%llu reads=%llu writes=%llu hits=%llu\n",
+		after->opens - before.opens, after->closes - before.closes,
+		after->stats - before.stats, after->seeks - before.seeks,
+		after->reads - before.reads, after->writes - before.writes,
+		after->hits - before.hits);
+    }
 done:
     NCZ_clearcommon(&common);
     return stat;
@@ -198,8 +213,12 @@ NCZ_transfer(struct Common* common, NCZSlice* slices)
     NCZOdometer* chunkodom =  NULL;
     NCZOdometer* slpodom = NULL;
     NCZOdometer* memodom = NULL;
+    NCZOdometer* aheadodom = NULL; /* runs ahead of chunkodom when prefetching */
     void* chunkdata = NULL;
     int wholechunk = 0;
+    size_t prefetch = 0; /* max chunks per prefetch batch; 0 => no prefetch */
+    size_t ahead = 0; /* chunkodom positions already covered by aheadodom */
+    size64_t* batch = NULL;
 
     /*
      We will need three sets of odometers.
@@ -268,6 +287,15 @@ NCZ_transfer(struct Common* common, NCZSlice* slices)
 	goto done;
     }
 
+    /* If there is a worker pool, then fetch and decode the chunks
+       in batches ahead of the walk below */
+    if(common->cache != NULL && common->reader.read == readfromcache
+       && (prefetch = NCZ_prefetch_limit(common->cache)) > 0) {
+        aheadodom = nczodom_new(chunkodom->rank,chunkodom->start,chunkodom->stop,chunkodom->stride,chunkodom->len);
+	batch = (size64_t*)malloc(prefetch*sizeof(size64_t)*(size_t)common->rank);
+	if(aheadodom == NULL || batch == NULL) {stat = NC_ENOMEM; goto done;}
+    }
+
     /* iterate over the odometer: all combination of chunk
        indices in the projections */
     for(;nczodom_more(chunkodom);) {
@@ -278,6 +306,13 @@ NCZ_transfer(struct Common* common, NCZSlice* slices)
         NCZProjection* proj[NC_MAX_VAR_DIMS];
 	size64_t shape[NC_MAX_VAR_DIMS];
 
+	if(aheadodom != NULL) {
+	    if(ahead == 0) {
+	        if((stat = prefetchchunks(common,aheadodom,prefetch,batch,&ahead))) goto done;
+	    }
+	    if(ahead > 0) ahead--;
+	}
+
 	chunkindices = nczodom_indices(chunkodom);
 	if(wdebug >= 1)
 	    fprintf(stderr,"chunkindices: %s\n",nczprint_vector(common->rank,chunkindices));
@@ -348,9 +383,52 @@ done:
     nczodom_free(slpodom);
     nczodom_free(memodom);
     nczodom_free(chunkodom);
+    nczodom_free(aheadodom);
+    nullfree(batch);
     return stat;
 }
 
+/* Return 1 if some projection for these chunk indices is a skip */
+static int
+chunkskipped(const struct Common* common, const size64_t* chunkindices)
+{
+    int r;
+    for(r=0;r<common->rank;r++) {
+	NCZSliceProjections* slp = &common->allprojections[r];
+	if(slp->projections[chunkindices[r] - slp->range.start].skip) return 1;
+    }
+    return 0;
+}
+
+/*
+Advance aheadodom over the next limit non-skipped chunks and
+bring those chunks into the cache in one batch.
+@param common common parameters
+@param aheadodom chunk odometer to advance
+@param limit max number of chunks to prefetch
+@param batch space for limit chunk index vectors
+@param consumedp return number of odometer positions consumed
+*/
+static int
+prefetchchunks(const struct Common* common, NCZOdometer* aheadodom, size_t limit, size64_t* batch, size_t* consumedp)
+{
+    size_t n = 0;
+    size_t consumed = 0;
+    size_t rank = (size_t)common->rank;
+
+    for(;n < limit && nczodom_more(aheadodom);consumed++,nczodom_next(aheadodom)) {
+	size64_t* chunkindices = nczodom_indices(aheadodom);
+	if(chunkskipped(common,chunkindices)) continue;
+	memcpy(&batch[n*rank],chunkindices,rank*sizeof(size64_t));
+	n++;
+    }
+    *consumedp = consumed;
+    if(wdebug >= 1)
+        fprintf(stderr,"prefetch: %u chunks\n",(unsigned)n);
+    if(n < 2) return NC_NOERR; /* nothing to overlap */
+    return NCZ_prefetch_cache_chunks(common->cache,n,batch);
+}
+
 #ifdef WDEBUG
 static void
 wdebug2(const struct Common* common, unsigned char* slpptr, unsigned char* memptr, size_t avail, size_t stride, void* chunkdata)
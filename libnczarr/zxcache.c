@@ -15,6 +15,9 @@
 #include "ncxcache.h"
 #include "zfilter.h"
 #include <stddef.h>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
 
 #undef DEBUG
 
@@ -26,10 +29,38 @@
 
 /* Forward */
 static int get_chunk(NCZChunkCache* cache, NCZCacheEntry* entry);
+static int fetch_chunk(NCZChunkCache* cache, NCZCacheEntry* entry, int* emptyp);
+static int fetched_chunk(NCZChunkCache* cache, NCZCacheEntry* entry, int readstat, size64_t size, int* emptyp);
+static int decode_chunk(NCZChunkCache* cache, NCZCacheEntry* entry);
+static int finish_chunk(NCZChunkCache* cache, NCZCacheEntry* entry, int empty);
 static int put_chunk(NCZChunkCache* cache, NCZCacheEntry*);
+static int prepare_put(NCZChunkCache* cache, NCZCacheEntry* entry);
+static int encode_chunk(NCZChunkCache* cache, NCZCacheEntry* entry);
+static int store_chunk(NCZChunkCache* cache, NCZCacheEntry* entry);
+static int writebehind(NCZChunkCache* cache, NCZCacheEntry* entry);
+static int drainwrites(NCZChunkCache* cache);
+static int pendingwrite(NCZChunkCache* cache, ncexhashkey_t hkey);
+static NCthreadpool* chunkpool(void);
 static int verifycache(NCZChunkCache* cache);
 static int flushcache(NCZChunkCache* cache);
 static int constraincache(NCZChunkCache* cache, size64_t needed);
+static void* getspare(NCZChunkCache* cache);
+static void putspare(NCZChunkCache* cache, void* buf);
+static void freespares(NCZChunkCache* cache);
+static void reservespares(NCZChunkCache* cache, size_t n);
+static void getscratch(NCZChunkCache* cache, NCZScratch* scratch);
+static void putscratch(NCZChunkCache* cache, NCZScratch* scratch);
+
+/* Spare buffers and the buffer counts are shared with the worker threads */
+#ifdef HAVE_PTHREAD_H
+static pthread_mutex_t sparelock = PTHREAD_MUTEX_INITIALIZER;
+#define LOCKSPARES() pthread_mutex_lock(&sparelock)
+#define UNLOCKSPARES() pthread_mutex_unlock(&sparelock)
+#else
+#define LOCKSPARES()
+#define UNLOCKSPARES()
+#endif
+static NCZBufferStats bufferstats;
 
 static void
 setmodified(NCZCacheEntry* e, int tf)
@@ -125,9 +156,17 @@ fprintf(stderr,"xxx: adjusting cache for: %s\n",var->hdr.name);
 
     /* completely empty the cache */
     flushcache(zcache);
+    /* queued writes hold buffers of the old chunk size */
+    if((stat = drainwrites(zcache))) goto done;
+    /* the shard state depends on the cache size */
+    if(SHARDED(zcache)) {
+	if((stat = NCZ_shard_flush(zcache))) goto done;
+    }
+    NCZ_shard_free(zcache);
 
-    /* Reclaim any existing fill_chunk */
+    /* Reclaim any existing fill_chunk and spares */
     if((stat = NCZ_reclaim_fill_chunk(zcache))) goto done;
+    freespares(zcache);
     /* Reset the parameters */
     zvar->cache->params.size = var->chunkcache.size;
     zvar->cache->params.nelems = var->chunkcache.nelems;
@@ -205,6 +244,11 @@ NCZ_create_chunk_cache(NC_VAR_INFO_T* var, size64_t chunksize, char dimsep, NCZC
     if((cache->mru = nclistnew()) == NULL)
 	{stat = NC_ENOMEM; goto done;}
     nclistsetalloc(cache->mru,cache->params.nelems);
+    if((cache->writebehind.queue = nclistnew()) == NULL)
+	{stat = NC_ENOMEM; goto done;}
+    nctaskgroupinit(&cache->writebehind.group);
+    if((cache->spares.buffers = nclistnew()) == NULL)
+	{stat = NC_ENOMEM; goto done;}
 
     if(cachep) {*cachep = cache; cache = NULL;}
 done:
@@ -220,6 +264,9 @@ free_cache_entry(NCZChunkCache* cache, NCZCacheEntry* entry)
         int tid = cache->var->type_info->hdr.id;
 	if(tid == NC_STRING && !entry->isfixedstring) {
             NC_reclaim_data(cache->var->container->nc4_info->controller,tid,entry->data,cache->chunkcount);
+	} else if(entry->data != NULL && entry->alloc >= cache->chunksize) {
+	    putspare(cache,entry->data);
+	    entry->data = NULL;
 	}
 	nullfree(entry->data);
 	nullfree(entry->key.varkey);
@@ -235,6 +282,12 @@ NCZ_free_chunk_cache(NCZChunkCache* cache)
 
     ZTRACE(4,"cache.var=%s",cache->var->hdr.name);
 
+    /* Normally already empty since the cache was flushed */
+    (void)drainwrites(cache);
+    nclistfree(cache->writebehind.queue);
+    (void)NCZ_shard_flush(cache);
+    NCZ_shard_free(cache);
+
     /* Iterate over the entries */
     while(nclistlength(cache->mru) > 0) {
 	void* ptr;
@@ -249,6 +302,8 @@ fprintf(stderr,"|cache.free|=%ld\n",nclistlength(cache->mru));
     ncxcachefree(cache->xcache);
     nclistfree(cache->mru);
     cache->mru = NULL;
+    freespares(cache);
+    nclistfree(cache->spares.buffers);
     (void)NCZ_reclaim_fill_chunk(cache);
     nullfree(cache);
     (void)ZUNTRACE(NC_NOERR);
@@ -323,6 +378,199 @@ done:
     return THROW(stat);
 }
 
+/* Return the shared worker pool, or NULL if chunk transfers are serial */
+static NCthreadpool*
+chunkpool(void)
+{
+    NCglobalstate* ngs = NC_getglobalstate();
+#ifdef NETCDF_ENABLE_THREADSAFE
+    /* Not the global lock: the caller may hold the lock of a file */
+    static pthread_mutex_t poollock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+    if(ngs->zarr.nthreads <= 1) return NULL;
+    if(ngs->zarr.pool == NULL) {
+#ifdef NETCDF_ENABLE_THREADSAFE
+        pthread_mutex_lock(&poollock);
+        if(ngs->zarr.pool == NULL)
+#endif
+        (void)ncthreadpoolnew(ngs->zarr.nthreads,&ngs->zarr.pool);
+#ifdef NETCDF_ENABLE_THREADSAFE
+        pthread_mutex_unlock(&poollock);
+#endif
+    }
+    if(ncthreadpoolsize(ngs->zarr.pool) == 0) return NULL;
+    return ngs->zarr.pool;
+}
+
+/* Does the map of the cache transfer many objects at once? */
+static int
+batchedmap(NCZChunkCache* cache)
+{
+    NCZ_FILE_INFO_T* zfile = ((cache->var->container)->nc4_info)->format_file_info;
+    return (zfile->map->api->readmany != NULL);
+}
+
+/**
+ * Return the maximum number of chunks that NCZ_prefetch_cache_chunks
+ * should be given at once: as many as the cache can hold without
+ * evicting any of them. Zero means prefetching is not worthwhile.
+ */
+size_t
+NCZ_prefetch_limit(NCZChunkCache* cache)
+{
+    size_t n;
+    if(chunkpool() == NULL && !batchedmap(cache)) return 0;
+    n = cache->params.nelems;
+    if(cache->chunksize > 0 && cache->params.size / cache->chunksize < n)
+        n = (size_t)(cache->params.size / cache->chunksize);
+    return (n < 2 ? 0 : n);
+}
+
+struct ChunkTask {
+    NCZChunkCache* cache;
+    NCZCacheEntry* entry;
+};
+
+static int
+decode_task(void* arg)
+{
+    struct ChunkTask* da = (struct ChunkTask*)arg;
+    return decode_chunk(da->cache,da->entry);
+}
+
+static int
+encode_task(void* arg)
+{
+    struct ChunkTask* ea = (struct ChunkTask*)arg;
+    return encode_chunk(ea->cache,ea->entry);
+}
+
+/**
+ * Bring a set of chunks into the cache. The chunks not already
+ * cached are read from the map with one nczmap_readmany call and
+ * then decoded concurrently by the worker pool, if any; the cache
+ * itself is only modified by the calling thread.
+ *
+ * @param cache the chunk cache
+ * @param nchunks number of chunks
+ * @param indices nchunks vectors of chunk indices, each of rank cache->ndims
+ * @return NC_NOERR if successful
+ */
+int
+NCZ_prefetch_cache_chunks(NCZChunkCache* cache, size_t nchunks, const size64_t* indices)
+{
+    int stat = NC_NOERR;
+    size_t i, nmissing = 0;
+    size_t rank = (size_t)cache->ndims;
+    NCZCacheEntry** missing = NULL;
+    int* empty = NULL;
+    struct ChunkTask* args = NULL;
+    char** paths = NULL;
+    void** contents = NULL;
+    size64_t* sizes = NULL;
+    int* stats = NULL;
+    NCthreadpool* pool = chunkpool();
+    NCZ_FILE_INFO_T* zfile = ((cache->var->container)->nc4_info)->format_file_info;
+
+    if((pool == NULL && !batchedmap(cache)) || nchunks == 0) goto done;
+
+    if((missing = (NCZCacheEntry**)calloc(nchunks,sizeof(NCZCacheEntry*))) == NULL
+       || (empty = (int*)calloc(nchunks,sizeof(int))) == NULL
+       || (args = (struct ChunkTask*)calloc(nchunks,sizeof(struct ChunkTask))) == NULL
+       || (paths = (char**)calloc(nchunks,sizeof(char*))) == NULL
+       || (contents = (void**)calloc(nchunks,sizeof(void*))) == NULL
+       || (sizes = (size64_t*)calloc(nchunks,sizeof(size64_t))) == NULL
+       || (stats = (int*)calloc(nchunks,sizeof(int))) == NULL)
+	{stat = NC_ENOMEM; goto done;}
+
+    /* Find the chunks we do not have */
+    for(i=0;i<nchunks;i++) {
+	const size64_t* chunkindices = indices + (i * rank);
+	ncexhashkey_t hkey = ncxcachekey(chunkindices,sizeof(size64_t)*rank);
+	NCZCacheEntry* entry = NULL;
+	if(ncxcachelookup(cache->xcache,hkey,(void**)&entry) == NC_NOERR) {
+	    (void)ncxcachetouch(cache->xcache,hkey);
+	    continue;
+	}
+	if((entry = calloc(1,sizeof(NCZCacheEntry)))==NULL)
+	    {stat = NC_ENOMEM; goto done;}
+	missing[nmissing++] = entry;
+	memcpy(entry->indices,chunkindices,rank*sizeof(size64_t));
+        if((stat = NCZ_buildchunkpath(cache,chunkindices,&entry->key))) goto done;
+        entry->hashkey = hkey;
+	/* A queued write of this chunk must reach the map first */
+	if(pendingwrite(cache,hkey)) {
+	    if((stat = drainwrites(cache))) goto done;
+	}
+	paths[nmissing-1] = NCZ_chunkpath(entry->key);
+    }
+
+    /* Read their raw data all at once */
+    if(nmissing > 0) {
+	if(SHARDED(cache)) {
+	    /* Inner chunks are byte ranges of their shards */
+	    for(i=0;i<nmissing;i++)
+		stats[i] = NCZ_shard_read(cache,missing[i]->indices,&sizes[i],&contents[i]);
+	} else
+	    stat = nczmap_readmany(zfile->map,nmissing,(const char**)paths,sizes,contents,stats);
+	for(i=0;i<nmissing;i++) {missing[i]->data = contents[i]; contents[i] = NULL;}
+	if(stat) goto done;
+	for(i=0;i<nmissing;i++) {
+	    if((stat = fetched_chunk(cache,missing[i],stats[i],sizes[i],&empty[i]))) goto done;
+	}
+    }
+
+    /* Make room for them in the cache before they are decoded, keeping
+       the buffers of the evicted chunks for them */
+    if(nmissing > 0) {
+	reservespares(cache,nmissing);
+	if((stat = constraincache(cache,(size64_t)nmissing * cache->chunksize))) goto done;
+    }
+
+    /* Decode them, in parallel if there is a worker pool */
+    if(nmissing > 0 && FILTERED(cache)) {
+	NCtaskgroup group;
+	int waitstat;
+        if((stat = NCZ_prepare_filterchain(cache->var,(NClist*)cache->var->filters))) goto done;
+	nctaskgroupinit(&group);
+	for(i=0;i<nmissing;i++) {
+	    if(empty[i]) continue;
+	    args[i].cache = cache;
+	    args[i].entry = missing[i];
+	    if((stat = ncthreadpoolsubmit(pool,&group,decode_task,&args[i]))) break;
+	}
+	/* Always wait, even on error, since the tasks reference our entries */
+	waitstat = ncthreadpoolwait(pool,&group,0);
+	if(stat == NC_NOERR) stat = waitstat;
+	if(stat) goto done;
+    }
+
+    /* Add them to the cache */
+    for(i=0;i<nmissing;i++) {
+	NCZCacheEntry* entry = missing[i];
+	if((stat = finish_chunk(cache,entry,empty[i]))) goto done;
+	missing[i] = NULL;
+	if((stat=verifycache(cache))) {free_cache_entry(cache,entry); goto done;}
+        nclistpush(cache->mru,entry);
+	if((stat = ncxcacheinsert(cache->xcache,entry->hashkey,entry))) goto done;
+    }
+
+done:
+    reservespares(cache,0);
+    for(i=0;i<nmissing;i++) {
+	if(missing[i] != NULL) free_cache_entry(cache,missing[i]);
+	nullfree(paths[i]);
+    }
+    nullfree(missing);
+    nullfree(empty);
+    nullfree(args);
+    nullfree(paths);
+    nullfree(contents);
+    nullfree(sizes);
+    nullfree(stats);
+    return THROW(stat);
+}
+
 #if 0
 int
 NCZ_write_cache_chunk(NCZChunkCache* cache, const size64_t* indices, void* content)
@@ -440,10 +688,10 @@ constraincache(NCZChunkCache* cache, size64_t needed)
 	assert(cache->used >= e->size);
 	/* Note that |old chunk data| may not be same as |new chunk data| because of filters */
 	cache->used -= e->size; /* old size */
-	if(e->modified) /* flush to file */
-	    stat=put_chunk(cache,e);
-	/* reclaim */
-        nullfree(e->data); nullfree(e->key.varkey); nullfree(e->key.chunkkey); nullfree(e);
+	if(e->modified) { /* flush to file; reclaims e */
+	    if((stat=writebehind(cache,e))) goto done;
+	} else /* reclaim */
+	    free_cache_entry(cache,e);
     }
 #ifdef DEBUG
 fprintf(stderr,"|cache.makeroom|=%ld\n",nclistlength(cache->mru));
@@ -452,6 +700,128 @@ done:
     return stat;
 }
 
+/**************************************************/
+/* Spare buffers */
+
+/* The most spares a cache keeps: enough for the scratch of a
+   decode by every worker and by the calling thread */
+static size_t
+maxspares(NCZChunkCache* cache, size_t nw)
+{
+    return 2 * (nw + 1) + cache->spares.reserve;
+}
+
+static size_t
+nworkers(void)
+{
+    NCthreadpool* pool = chunkpool();
+    return (pool == NULL ? 0 : ncthreadpoolsize(pool));
+}
+
+/* Take a buffer of cache->chunksize bytes from the spares, else allocate one */
+static void*
+getspare(NCZChunkCache* cache)
+{
+    void* buf = NULL;
+
+    LOCKSPARES();
+    if(nclistlength(cache->spares.buffers) > 0) {
+	buf = nclistpop(cache->spares.buffers);
+	bufferstats.reuses++;
+    } else
+	bufferstats.allocs++;
+    UNLOCKSPARES();
+    if(buf == NULL) buf = malloc(cache->chunksize);
+    return buf;
+}
+
+/* Keep a buffer of at least cache->chunksize bytes as a spare, else reclaim it */
+static void
+putspare(NCZChunkCache* cache, void* buf)
+{
+    size_t n = nworkers();
+
+    LOCKSPARES();
+    if(nclistlength(cache->spares.buffers) < maxspares(cache,n)) {
+	nclistpush(cache->spares.buffers,buf);
+	buf = NULL;
+    }
+    UNLOCKSPARES();
+    nullfree(buf);
+}
+
+static void
+freespares(NCZChunkCache* cache)
+{
+    LOCKSPARES();
+    while(nclistlength(cache->spares.buffers) > 0)
+	free(nclistpop(cache->spares.buffers));
+    UNLOCKSPARES();
+}
+
+/* Allow n more spares than usual, while a batch of n chunks
+   replaces as many evicted ones; n == 0 trims the spares again. */
+static void
+reservespares(NCZChunkCache* cache, size_t n)
+{
+    size_t nw = nworkers();
+
+    LOCKSPARES();
+    cache->spares.reserve = n;
+    while(nclistlength(cache->spares.buffers) > maxspares(cache,nw))
+	free(nclistpop(cache->spares.buffers));
+    UNLOCKSPARES();
+}
+
+/* Give the filter chain of the variable as many spares as it can use */
+static void
+getscratch(NCZChunkCache* cache, NCZScratch* scratch)
+{
+    size_t i, n = NCZ_filterchain_scratch((NClist*)cache->var->filters);
+
+    memset(scratch,0,sizeof(NCZScratch));
+    scratch->size = cache->chunksize;
+    for(i=0;i<n;i++)
+	scratch->buf[i] = getspare(cache);
+}
+
+static void
+putscratch(NCZChunkCache* cache, NCZScratch* scratch)
+{
+    int i;
+
+    for(i=0;i<2;i++) {
+	if(scratch->buf[i] == NULL) continue;
+	if(scratch->size >= cache->chunksize)
+	    putspare(cache,scratch->buf[i]);
+	else
+	    free(scratch->buf[i]);
+	scratch->buf[i] = NULL;
+    }
+    LOCKSPARES();
+    bufferstats.filterallocs += scratch->allocs;
+    UNLOCKSPARES();
+}
+
+/**
+ * Return the counts of the chunk sized buffers allocated by all
+ * chunk caches, and optionally reset them. Once its cache is
+ * warm, reading a variable allocates none of them if each of its
+ * filters provides NCZ_filter_into; the map still allocates the
+ * object it reads.
+ *
+ * @param stats return the counts; may be NULL
+ * @param reset if true then set the counts to zero
+ */
+void
+NCZ_buffer_stats(NCZBufferStats* stats, int reset)
+{
+    LOCKSPARES();
+    if(stats) *stats = bufferstats;
+    if(reset) memset(&bufferstats,0,sizeof(bufferstats));
+    UNLOCKSPARES();
+}
+
 /**
 Push modified cache entries to disk.
 Also make sure the cache size is correct.
@@ -466,17 +836,19 @@ NCZ_flush_chunk_cache(NCZChunkCache* cache)
 
     ZTRACE(4,"cache.var=%s |cache|=%d",cache->var->hdr.name,(int)nclistlength(cache->mru));
 
-    if(NCZ_cache_size(cache) == 0) goto done;
-    
-    /* Iterate over the entries in hashmap */
-    for(i=0;i<nclistlength(cache->mru);i++) {
+    if(NCZ_cache_size(cache) == 0) goto drain;
+
+    /* Write out the modified entries. They leave the cache because
+       writing replaces their data by the encoded (filtered and/or
+       fixed string) form, which a later read could not use. */
+    for(i=nclistlength(cache->mru);i-->0;) {
+	void* ptr;
         NCZCacheEntry* entry = nclistget(cache->mru,i);
-        if(entry->modified) {
-	    /* Write out this chunk in toto*/
-  	    if((stat=put_chunk(cache,entry)))
-	        goto done;
-	}
-        setmodified(entry,0);
+	if(!entry->modified) continue;
+	(void)nclistremove(cache->mru,i);
+	if((stat = ncxcacheremove(cache->xcache,entry->hashkey,&ptr))) goto done;
+	assert(ptr == entry);
+	if((stat = writebehind(cache,entry))) goto done;
     }
     /* Re-compute space used */
     cache->used = 0;
@@ -487,6 +859,11 @@ NCZ_flush_chunk_cache(NCZChunkCache* cache)
     /* Make sure cache size and nelems are correct */
     if((stat=verifycache(cache))) goto done;
 
+drain:
+    /* Wait for everything that is still queued */
+    if((stat=drainwrites(cache))) goto done;
+    /* and store the shards it went into */
+    if(SHARDED(cache) && (stat=NCZ_shard_flush(cache))) goto done;
 
 done:
     return ZUNTRACE(stat);
@@ -643,22 +1020,35 @@ static int
 put_chunk(NCZChunkCache* cache, NCZCacheEntry* entry)
 {
     int stat = NC_NOERR;
-    NC_FILE_INFO_T* file = NULL;
-    NCZ_FILE_INFO_T* zfile = NULL;
-    NCZMAP* map = NULL;
-    char* path = NULL;
-    nc_type tid = NC_NAT;
-    void* strchunk = NULL;
 
     ZTRACE(5,"cache.var=%s entry.key=%s",cache->var->hdr.name,entry->key);
     LOG((3, "%s: var: %p", __func__, cache->var));
 
-    file = (cache->var->container)->nc4_info;
-    zfile = file->format_file_info;
-    map = zfile->map;
+    if((stat = prepare_put(cache,entry))) goto done;
+    if((stat = encode_chunk(cache,entry))) goto done;
+    if((stat = store_chunk(cache,entry))) goto done;
+
+done:
+    return ZUNTRACE(stat);
+}
 
-    /* Collect some info */
-    tid = cache->var->type_info->hdr.id;
+/**
+ * @internal Convert an entry to the fixed string form, if needed,
+ * and make sure its filters are ready. Must be called by the
+ * thread owning the cache before encode_chunk.
+ *
+ * @param cache Pointer to parent cache
+ * @param entry cache entry to be written
+ *
+ * @return ::NC_NOERR No error.
+ */
+static int
+prepare_put(NCZChunkCache* cache, NCZCacheEntry* entry)
+{
+    int stat = NC_NOERR;
+    NC_FILE_INFO_T* file = (cache->var->container)->nc4_info;
+    nc_type tid = cache->var->type_info->hdr.id;
+    void* strchunk = NULL;
 
     if(tid == NC_STRING && !entry->isfixedstring) {
         /* Convert from char* to char[strlen] format */
@@ -672,148 +1062,388 @@ put_chunk(NCZChunkCache* cache, NCZCacheEntry* entry)
         entry->data = NULL;
         entry->data = strchunk; strchunk = NULL;
         entry->size = (cache->chunkcount * (size64_t)maxstrlen);
+        entry->alloc = 0;
         entry->isfixedstring = 1;
     }
 
+#ifdef NETCDF_ENABLE_NCZARR_FILTERS
+    if(!entry->isfiltered && FILTERED(cache)) {
+        if((stat = NCZ_prepare_filterchain(cache->var,(NClist*)cache->var->filters))) goto done;
+    }
+#endif
+
+done:
+    nullfree(strchunk);
+    return stat;
+}
+
+/**
+ * @internal Apply the filter chain to a prepared entry.
+ * Safe to call concurrently for different entries.
+ *
+ * @param cache Pointer to parent cache
+ * @param entry cache entry to be written
+ *
+ * @return ::NC_NOERR No error.
+ */
+static int
+encode_chunk(NCZChunkCache* cache, NCZCacheEntry* entry)
+{
+    int stat = NC_NOERR;
 
 #ifdef NETCDF_ENABLE_NCZARR_FILTERS
     /* Make sure the entry is in filtered state */
     if(!entry->isfiltered) {
+        NC_FILE_INFO_T* file = (cache->var->container)->nc4_info;
         NC_VAR_INFO_T* var = cache->var;
         void* filtered = NULL; /* pointer to the filtered data */
+        void* real = NULL; /* pointer to the real data */
 	size_t flen; /* length of filtered data */
+	size_t falloc; /* allocated size of filtered data */
+	NCZScratch scratch;
 	/* Get the filter chain to apply */
 	NClist* filterchain = (NClist*)var->filters;
 	if(nclistlength(filterchain) > 0) {
-	    /* Apply the filter chain to get the filtered data; will reclaim entry->data */
-	    if((stat = NCZ_applyfilterchain(file,var,filterchain,entry->size,entry->data,&flen,&filtered,ENCODING))) goto done;
+	    /* Apply the filter chain to get the filtered data; will reclaim the real data */
+	    real = entry->data;
+	    entry->data = NULL;
+	    getscratch(cache,&scratch);
+	    stat = NCZ_applyfilterchain(file,var,filterchain,entry->size,entry->alloc,real,&flen,&falloc,&filtered,ENCODING,&scratch);
+	    putscratch(cache,&scratch);
+	    if(stat) goto done;
 	    /* Fix up the cache entry */
-	    /* Note that if filtered is different from entry->data, then entry->data will have been freed */
 	    entry->data = filtered;
  	    entry->size = flen;
+	    entry->alloc = falloc;
             entry->isfiltered = 1;
 	}
     }
+done:
+#else
+    NC_UNUSED(cache);
+    NC_UNUSED(entry);
 #endif
+    return stat;
+}
 
+/**
+ * @internal Write an encoded entry to the map.
+ *
+ * @param cache Pointer to parent cache
+ * @param entry cache entry to be written
+ *
+ * @return ::NC_NOERR No error.
+ */
+static int
+store_chunk(NCZChunkCache* cache, NCZCacheEntry* entry)
+{
+    int stat = NC_NOERR;
+    NC_FILE_INFO_T* file = (cache->var->container)->nc4_info;
+    NCZ_FILE_INFO_T* zfile = file->format_file_info;
+    char* path = NULL;
+
+    if(SHARDED(cache))
+	return NCZ_shard_write(cache,entry->indices,entry->size,entry->data);
     path = NCZ_chunkpath(entry->key);
-    stat = nczmap_write(map,path,entry->size,entry->data);
-    nullfree(path); path = NULL;
+    stat = nczmap_write(zfile->map,path,entry->size,entry->data);
+    nullfree(path);
+    return stat;
+}
 
-    switch(stat) {
-    case NC_NOERR:
-	break;
-    case NC_ENOOBJECT: case NC_EEMPTY:
-    default: goto done;
+/**
+ * @internal Write out a modified entry that has been removed from
+ * the cache, and reclaim it. With a worker pool and a filtered
+ * variable, the entry is queued and encoded in the background;
+ * with a map that writes many objects at once, it is queued in
+ * any case. The queued chunks are written, in order, by drainwrites(),
+ * which is called once the queue holds more than the in-flight
+ * limit and when the cache is flushed. The map is only ever
+ * accessed by the calling thread.
+ *
+ * @param cache Pointer to parent cache
+ * @param entry modified entry; always reclaimed
+ *
+ * @return ::NC_NOERR No error.
+ */
+static int
+writebehind(NCZChunkCache* cache, NCZCacheEntry* entry)
+{
+    int stat = NC_NOERR;
+    NCthreadpool* pool = chunkpool();
+    struct ChunkTask* task = NULL;
+    size64_t maxinflight;
+
+    if(!batchedmap(cache) && (pool == NULL || !FILTERED(cache))) {
+	stat = put_chunk(cache,entry);
+	goto done;
+    }
+
+    if((stat = prepare_put(cache,entry))) goto done;
+    if((task = (struct ChunkTask*)calloc(1,sizeof(struct ChunkTask))) == NULL)
+	{stat = NC_ENOMEM; goto done;}
+    task->cache = cache;
+    task->entry = entry;
+    entry = NULL;
+    nclistpush(cache->writebehind.queue,task);
+    cache->writebehind.inflight += task->entry->size;
+    if((stat = ncthreadpoolsubmit(pool,&cache->writebehind.group,encode_task,task))) {
+	/* Not submitted, so do not let drainwrites store it */
+	setmodified(task->entry,0);
+	goto done;
     }
+
+    /* By default allow a quarter of the cache size, but at least
+       enough to keep every worker busy */
+    maxinflight = NC_getglobalstate()->zarr.maxinflight;
+    if(maxinflight == 0) {
+	maxinflight = cache->params.size / 4;
+	if(maxinflight < ncthreadpoolsize(pool) * cache->chunksize)
+	    maxinflight = ncthreadpoolsize(pool) * cache->chunksize;
+    }
+    if(cache->writebehind.inflight > maxinflight)
+	stat = drainwrites(cache);
+
 done:
-    nullfree(strchunk);
-    nullfree(path);
-    return ZUNTRACE(stat);
+    if(entry) free_cache_entry(cache,entry);
+    return THROW(stat);
+}
+
+/**
+ * @internal Wait for all the queued encodes and write the
+ * results to the map, in the order they were queued, with one
+ * nczmap_writemany call.
+ *
+ * @param cache Pointer to parent cache
+ *
+ * @return ::NC_NOERR No error.
+ */
+static int
+drainwrites(NCZChunkCache* cache)
+{
+    int stat = NC_NOERR;
+    size_t i, n = 0, nqueued;
+    NClist* queue = cache->writebehind.queue;
+    NCZ_FILE_INFO_T* zfile = ((cache->var->container)->nc4_info)->format_file_info;
+    char** paths = NULL;
+    size64_t* counts = NULL;
+    const void** contents = NULL;
+
+    if(queue == NULL || (nqueued = nclistlength(queue)) == 0) goto done;
+
+    stat = ncthreadpoolwait(chunkpool(),&cache->writebehind.group,0);
+    if(stat == NC_NOERR) {
+	if((paths = (char**)calloc(nqueued,sizeof(char*))) == NULL
+	   || (counts = (size64_t*)calloc(nqueued,sizeof(size64_t))) == NULL
+	   || (contents = (const void**)calloc(nqueued,sizeof(void*))) == NULL)
+	    stat = NC_ENOMEM;
+    }
+    if(stat == NC_NOERR) {
+	for(i=0;i<nqueued;i++) {
+	    struct ChunkTask* task = (struct ChunkTask*)nclistget(queue,i);
+	    if(!task->entry->modified) continue;
+	    paths[n] = NCZ_chunkpath(task->entry->key);
+	    counts[n] = task->entry->size;
+	    contents[n] = task->entry->data;
+	    n++;
+	}
+	if(SHARDED(cache)) {
+	    for(i=0;i<nqueued && stat == NC_NOERR;i++) {
+		struct ChunkTask* task = (struct ChunkTask*)nclistget(queue,i);
+		if(task->entry->modified) stat = store_chunk(cache,task->entry);
+	    }
+	} else
+	    stat = nczmap_writemany(zfile->map,n,(const char**)paths,counts,contents);
+    }
+    for(i=0;i<nqueued;i++) {
+	struct ChunkTask* task = (struct ChunkTask*)nclistget(queue,i);
+	free_cache_entry(cache,task->entry);
+	free(task);
+    }
+    nclistclear(queue);
+    cache->writebehind.inflight = 0;
+
+done:
+    for(i=0;i<n;i++) nullfree(paths[i]);
+    nullfree(paths);
+    nullfree(counts);
+    nullfree(contents);
+    return THROW(stat);
 }
 
 /**
- * @internal Push data from memory to file.
+ * @internal Is a write of the chunk with the given hash key queued?
+ */
+static int
+pendingwrite(NCZChunkCache* cache, ncexhashkey_t hkey)
+{
+    size_t i;
+    NClist* queue = cache->writebehind.queue;
+    for(i=0;i<nclistlength(queue);i++) {
+	struct ChunkTask* task = (struct ChunkTask*)nclistget(queue,i);
+	if(task->entry->hashkey == hkey) return 1;
+    }
+    return 0;
+}
+
+/**
+ * @internal Read the raw chunk data from the map into an entry.
+ * Sets *emptyp if the chunk does not exist.
  *
  * @param cache Pointer to parent cache
- * @param key chunk key
  * @param entry cache entry to read into
+ * @param emptyp set to 1 if the chunk is not in the map
  *
  * @return ::NC_NOERR No error.
- * @author Dennis Heimbigner
  */
 static int
-get_chunk(NCZChunkCache* cache, NCZCacheEntry* entry)
+fetch_chunk(NCZChunkCache* cache, NCZCacheEntry* entry, int* emptyp)
 {
     int stat = NC_NOERR;
     NCZMAP* map = NULL;
     NC_FILE_INFO_T* file = NULL;
     NCZ_FILE_INFO_T* zfile = NULL;
-    NC_TYPE_INFO_T* xtype = NULL;
-    char** strchunk = NULL;
-    size64_t size;
-    int empty = 0;
+    size64_t size = 0;
     char* path = NULL;
-    int tid;
 
     ZTRACE(5,"cache.var=%s entry.key=%s sep=%d",cache->var->hdr.name,entry->key,cache->dimension_separator);
-    
-    LOG((3, "%s: file: %p", __func__, file));
 
     file = (cache->var->container)->nc4_info;
     zfile = file->format_file_info;
     map = zfile->map;
     assert(map);
 
-    /* Collect some info */
-    xtype = cache->var->type_info;
-    tid = xtype->hdr.id;
-
-    /* get size of the "raw" data on "disk" */
-    path = NCZ_chunkpath(entry->key);
-    stat = nczmap_len(map,path,&size);
-    nullfree(path); path = NULL;
-    switch(stat) {
-    case NC_NOERR: entry->size = size; break;
-    case NC_ENOOBJECT: case NC_EEMPTY: empty = 1; stat = NC_NOERR; break;
-    default: goto done;
+    /* A queued write of this chunk must reach the map first */
+    if(pendingwrite(cache,entry->hashkey)) {
+	if((stat = drainwrites(cache))) goto done;
     }
 
-    /* make room in the cache */
-    if((stat = constraincache(cache,size))) goto done;    
+    /* get the "raw" data on "disk" and its size in one operation */
+    if(SHARDED(cache))
+	stat = NCZ_shard_read(cache,entry->indices,&size,&entry->data);
+    else {
+	path = NCZ_chunkpath(entry->key);
+	stat = nczmap_readobj(map,path,&size,&entry->data);
+	nullfree(path); path = NULL;
+    }
+    stat = fetched_chunk(cache,entry,stat,size,emptyp);
+done:
+    return ZUNTRACE(stat);
+}
 
-    if(!empty) {
-        /* Make sure we have a place to read it */
-        if((entry->data = (void*)calloc(1,entry->size)) == NULL)
-	    {stat = NC_ENOMEM; goto done;}
-	/* Read the raw data */
-        path = NCZ_chunkpath(entry->key);
-        stat = nczmap_read(map,path,0,entry->size,(char*)entry->data);
-        nullfree(path); path = NULL;
-        switch (stat) {
-        case NC_NOERR: break;
-        case NC_ENOOBJECT: case NC_EEMPTY: empty = 1; stat = NC_NOERR;break;
-	default: goto done;
-	}
+/**
+ * @internal Record the outcome of reading the raw data of an entry.
+ *
+ * @param cache Pointer to parent cache
+ * @param entry cache entry read into
+ * @param readstat the result of the read
+ * @param size the size of the data read
+ * @param emptyp set to 1 if the chunk is not in the map
+ *
+ * @return ::NC_NOERR No error.
+ */
+static int
+fetched_chunk(NCZChunkCache* cache, NCZCacheEntry* entry, int readstat, size64_t size, int* emptyp)
+{
+    *emptyp = 0;
+    switch(readstat) {
+    case NC_NOERR:
+	entry->size = size;
+	entry->alloc = size;
         entry->isfiltered = (int)FILTERED(cache); /* Is the data being read filtered? */
-	if(tid == NC_STRING)
+	if(cache->var->type_info->hdr.id == NC_STRING)
 	    entry->isfixedstring = 1; /* fill cache is in char[maxstrlen] format */
+	break;
+    case NC_ENOOBJECT: case NC_EEMPTY: *emptyp = 1; readstat = NC_NOERR; break;
+    default: break;
     }
-    if(empty) {
-	/* fake the chunk */
-        setmodified(entry,(file->no_write?0:1));
-	entry->size = cache->chunksize;
-	entry->data = NULL;
-        entry->isfixedstring = 0;
-        entry->isfiltered = 0;
-        /* apply fill value */
-	if(cache->fillchunk == NULL)
-	    {if((stat = NCZ_ensure_fill_chunk(cache))) goto done;}
-	if((entry->data = calloc(1,entry->size))==NULL) {stat = NC_ENOMEM; goto done;}
-	if((stat = NCZ_copy_data(file,cache->var,cache->fillchunk,cache->chunkcount,ZREADING,entry->data))) goto done;
-	stat = NC_NOERR;
-    }
+    return readstat;
+}
+
+/**
+ * @internal Apply the filter chain to raw data read by fetch_chunk.
+ * Does not touch the cache itself, so it may be run concurrently
+ * for distinct entries once NCZ_prepare_filterchain has been called.
+ *
+ * @param cache Pointer to parent cache
+ * @param entry cache entry to decode
+ *
+ * @return ::NC_NOERR No error.
+ */
+static int
+decode_chunk(NCZChunkCache* cache, NCZCacheEntry* entry)
+{
+    int stat = NC_NOERR;
 #ifdef NETCDF_ENABLE_NCZARR_FILTERS
     /* Make sure the entry is in unfiltered state */
-    if(!empty && entry->isfiltered) {
+    if(entry->isfiltered) {
         NC_VAR_INFO_T* var = cache->var;
+	NC_FILE_INFO_T* file = (var->container)->nc4_info;
         void* unfiltered = NULL; /* pointer to the unfiltered data */
         void* filtered = NULL; /* pointer to the filtered data */
 	size_t unflen; /* length of unfiltered data */
-	assert(tid != NC_STRING || entry->isfixedstring);
+	size_t unfalloc; /* allocated size of unfiltered data */
+	NCZScratch scratch;
+	assert(var->type_info->hdr.id != NC_STRING || entry->isfixedstring);
 	/* Get the filter chain to apply */
 	NClist* filterchain = (NClist*)var->filters;
 	if(nclistlength(filterchain) == 0) {stat = NC_EFILTER; goto done;}
-	/* Apply the filter chain to get the unfiltered data */
+	/* Apply the filter chain to get the unfiltered data,
+	   straight into a spare buffer if the filters allow */
 	filtered = entry->data;
 	entry->data = NULL;
-	if((stat = NCZ_applyfilterchain(file,var,filterchain,entry->size,filtered,&unflen,&unfiltered,!ENCODING))) goto done;
+	getscratch(cache,&scratch);
+	stat = NCZ_applyfilterchain(file,var,filterchain,entry->size,entry->alloc,filtered,&unflen,&unfalloc,&unfiltered,!ENCODING,&scratch);
+	putscratch(cache,&scratch);
+	if(stat) goto done;
 	/* Fix up the cache entry */
 	entry->data = unfiltered;
 	entry->size = unflen;
+	entry->alloc = unfalloc;
 	entry->isfiltered = 0;
     }
+done:
+#else
+    NC_UNUSED(cache);
+    NC_UNUSED(entry);
 #endif
+    return stat;
+}
+
+/**
+ * @internal Complete a chunk read: fake a missing chunk from the
+ * fill value, convert strings to char* form, and account for the
+ * space used.
+ *
+ * @param cache Pointer to parent cache
+ * @param entry cache entry
+ * @param empty 1 if the chunk was not in the map
+ *
+ * @return ::NC_NOERR No error.
+ */
+static int
+finish_chunk(NCZChunkCache* cache, NCZCacheEntry* entry, int empty)
+{
+    int stat = NC_NOERR;
+    NC_FILE_INFO_T* file = (cache->var->container)->nc4_info;
+    int tid = cache->var->type_info->hdr.id;
+    char** strchunk = NULL;
+
+    if(empty) {
+	/* fake the chunk */
+        setmodified(entry,(file->no_write?0:1));
+	nullfree(entry->data);
+	entry->size = cache->chunksize;
+	entry->data = NULL;
+        entry->isfixedstring = 0;
+        entry->isfiltered = 0;
+        /* apply fill value */
+	if(cache->fillchunk == NULL)
+	    {if((stat = NCZ_ensure_fill_chunk(cache))) goto done;}
+	if((entry->data = getspare(cache))==NULL) {stat = NC_ENOMEM; goto done;}
+	entry->alloc = cache->chunksize;
+	if((stat = NCZ_copy_data(file,cache->var,cache->fillchunk,cache->chunkcount,ZREADING,entry->data))) goto done;
+	stat = NC_NOERR;
+    }
 
     if(tid == NC_STRING && entry->isfixedstring) {
         /* Convert from char[strlen] to char* format */
@@ -828,6 +1458,7 @@ get_chunk(NCZChunkCache* cache, NCZCacheEntry* entry)
 	entry->data = NULL;
 	entry->data = strchunk; strchunk = NULL;
 	entry->size = cache->chunkcount * sizeof(char*);
+	entry->alloc = 0;
 	entry->isfixedstring = 0;
     }
 
@@ -836,7 +1467,36 @@ get_chunk(NCZChunkCache* cache, NCZCacheEntry* entry)
 
 done:
     nullfree(strchunk);
-    nullfree(path);
+    return stat;
+}
+
+/**
+ * @internal Read a chunk from the map and make it usable.
+ *
+ * @param cache Pointer to parent cache
+ * @param entry cache entry to read into
+ *
+ * @return ::NC_NOERR No error.
+ */
+static int
+get_chunk(NCZChunkCache* cache, NCZCacheEntry* entry)
+{
+    int stat = NC_NOERR;
+    int empty = 0;
+
+    ZTRACE(5,"cache.var=%s entry.key=%s sep=%d",cache->var->hdr.name,entry->key,cache->dimension_separator);
+    
+    if((stat = fetch_chunk(cache,entry,&empty))) goto done;
+
+    /* make room in the cache */
+    if((stat = constraincache(cache,(empty?0:entry->size)))) goto done;    
+
+    if(!empty) {
+	if((stat = decode_chunk(cache,entry))) goto done;
+    }
+    if((stat = finish_chunk(cache,entry,empty))) goto done;
+
+done:
     return ZUNTRACE(stat);
 }
 
@@ -173,6 +173,14 @@ free_NC_attrarrayV0(NC_attrarray *ncap)
 	if(ncap->nelems == 0)
 		return;
 
+	if(ncap->xattrs != NULL)
+	{
+		/* never decoded, nothing allocated */
+		ncap->xattrs = NULL;
+		ncap->nelems = 0;
+		return;
+	}
+
 	assert(ncap->value != NULL);
 
 	{
@@ -199,7 +207,10 @@ free_NC_attrarrayV(NC_attrarray *ncap)
 	assert(ncap != NULL);
 
 	if(ncap->nalloc == 0)
+	{
+		free_NC_attrarrayV0(ncap);
 		return;
+	}
 
 	assert(ncap->value != NULL);
 
@@ -219,6 +230,10 @@ dup_NC_attrarrayV(NC_attrarray *ncap, const NC_attrarray *ref)
 	assert(ref != NULL);
 	assert(ncap != NULL);
 
+	status = NC_loadattrs((NC_attrarray *)ref);
+	if(status != NC_NOERR)
+		return status;
+
 	if(ref->nelems != 0)
 	{
 		const size_t sz = ref->nelems * sizeof(NC_attr *);
@@ -311,6 +326,8 @@ elem_NC_attrarray(const NC_attrarray *ncap, size_t elem)
 	if(ncap->nelems == 0 || (unsigned long) elem >= ncap->nelems)
 		return NULL;
 
+	if(NC_loadattrs((NC_attrarray *)ncap) != NC_NOERR)
+		return NULL;
 	assert(ncap->value != NULL);
 
 	return ncap->value[elem];
@@ -340,6 +357,8 @@ NC_attrarray0(NC3_INFO* ncp, int varid)
 	} else {
 		ap = NULL;
 	}
+	if(ap != NULL && NC_loadattrs(ap) != NC_NOERR)
+		ap = NULL;
 	return(ap);
 }
 
@@ -362,6 +381,10 @@ NC_findattr(const NC_attrarray *ncap, const char *uname)
 	if(ncap->nelems == 0)
 	    goto done;
 
+	/* decode the attributes on first use */
+	if(NC_loadattrs((NC_attrarray *)ncap) != NC_NOERR)
+	    goto done;
+
 	/* normalized version of uname */
 	stat = nc_utf8_normalize((const unsigned char *)uname,(unsigned char**)&name);
 	if(stat != NC_NOERR)
@@ -469,6 +469,23 @@ ncio_ffio_init2(ncio *const nciop, size_t *sizehintp)
 }
 
 
+/* ffio_pgin() seeks the shared descriptor, so in a thread-safe build
+   there is no read method and reads go through the buffer. */
+#ifndef NETCDF_ENABLE_THREADSAFE
+static int
+ncio_ffio_read(ncio *nciop, off_t offset, size_t extent, void *buf)
+{
+	ncio_ffio *ffp = (ncio_ffio *)nciop->pvt;
+	size_t nread;
+	int status;
+
+	status = ffio_pgin(nciop, offset, extent, buf, &nread, &ffp->pos);
+	if(status == NC_NOERR && nread < extent)
+		(void) memset((char *)buf + nread, 0, extent - nread);
+	return status;
+}
+#endif
+
 static void
 ncio_ffio_init(ncio *const nciop)
 {
@@ -481,6 +498,11 @@ ncio_ffio_init(ncio *const nciop)
 	*((ncio_filesizefunc **)&nciop->filesize) = ncio_ffio_filesize; /* cast away const */
 	*((ncio_pad_lengthfunc **)&nciop->pad_length) = ncio_ffio_pad_length; /* cast away const */
 	*((ncio_closefunc **)&nciop->close) = ncio_ffio_close; /* cast away const */
+#ifndef NETCDF_ENABLE_THREADSAFE
+	*((ncio_readfunc **)&nciop->read) = ncio_ffio_read; /* cast away const */
+#else
+	*((ncio_readfunc **)&nciop->read) = NULL; /* cast away const */
+#endif
 
 	ffp->pos = -1;
 	ffp->bf_offset = OFF_NONE;
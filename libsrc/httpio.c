@@ -46,8 +46,9 @@
 typedef struct NCHTTP {
     NC_HTTP_STATE* state;
     long long size; /* of the object */
-    NCbytes* interval;
+    NCbytes* interval; /* holds the result of a get */
     int verbose;
+    NC_HTTP_CACHE* cache; /* blocks of the object, see dhttpcache.c */
 } NCHTTP;
 
 /* Forward */
@@ -88,12 +89,15 @@ httpio_new(const char* path, int ioflags, ncio** nciopp, NCHTTP** hpp)
     *((ncio_filesizefunc**)&nciop->filesize) = httpio_filesize;
     *((ncio_pad_lengthfunc**)&nciop->pad_length) = httpio_pad_length;
     *((ncio_closefunc**)&nciop->close) = httpio_close;
+    *((ncio_readfunc**)&nciop->read) = NULL;
 
     http = (NCHTTP*)calloc(1,sizeof(NCHTTP));
     if(http == NULL) {status = NC_ENOMEM; goto fail;}
     *((void* *)&nciop->pvt) = http;
 
     http->verbose = (getenv("CURLOPT_VERBOSE") == NULL ? 0 : 1);
+    http->interval = ncbytesnew();
+    if(http->interval == NULL) {status = NC_ENOMEM; goto fail;}
 
     if(nciopp) *nciopp = nciop;
     if(hpp) *hpp = http;
@@ -103,8 +107,7 @@ done:
 
 fail:
     if(http != NULL) {
-	if(http->interval)
-	    ncbytesfree(http->interval);
+	ncbytesfree(http->interval);
 	free(http);
     }
     if(nciop != NULL) {
@@ -160,7 +163,7 @@ httpio_open(const char* path,
     ncio* *nciopp,
     /* ignored */ void** const mempp)
 {
-    ncio* nciop;
+    ncio* nciop = NULL;
     int status;
     NCHTTP* http = NULL;
     size_t sizehint;
@@ -178,6 +181,8 @@ httpio_open(const char* path,
     if((status = nc_http_open_verbose(path,http->verbose,&http->state))) goto done;
     if((status = nc_http_size(http->state,&http->size))) goto done;
 
+    if((status = nc_http_cache_open(http->state,http->size,NULL,&http->cache))) goto done;
+
     sizehint = pagesize;
 
     /* sizehint must be multiple of 8 */
@@ -187,6 +192,7 @@ httpio_open(const char* path,
     *sizehintp = sizehint;
     *nciopp = nciop;
 done:
+    ncurifree(uri);
     if(status)
         httpio_close(nciop,0);
     return status;
@@ -236,6 +242,8 @@ httpio_close(ncio* nciop, int doUnlink)
     http = (NCHTTP*)nciop->pvt;
     assert(http != NULL);
 
+    nc_http_cache_close(http->cache);
+    http->cache = NULL;
     status = nc_http_close(http->state);
 
     /* do cleanup  */
@@ -251,6 +259,7 @@ httpio_close(ncio* nciop, int doUnlink)
 /*
  * Request that the interval (offset, extent)
  * be made available through *vpp.
+ * The interval is read through the block cache.
  */
 static int
 httpio_get(ncio* const nciop, off_t offset, size_t extent, int rflags, void** const vpp)
@@ -261,12 +270,11 @@ httpio_get(ncio* const nciop, off_t offset, size_t extent, int rflags, void** co
     if(nciop == NULL || nciop->pvt == NULL) {status = NC_EINVAL; goto done;}
     http = (NCHTTP*)nciop->pvt;
 
-    assert(http->interval == NULL);
-    http->interval = ncbytesnew();
+    ncbytesclear(http->interval);
     ncbytessetalloc(http->interval,(unsigned long)extent);
-    if((status = nc_http_read(http->state,(size64_t)offset,extent,http->interval)))
+    ncbytessetlength(http->interval,(unsigned long)extent);
+    if((status = nc_http_cache_read(http->cache,(size64_t)offset,extent,ncbytescontents(http->interval))))
 	goto done;
-    assert(ncbyteslength(http->interval) == extent);
     if(vpp) *vpp = ncbytescontents(http->interval);
 done:
     return status;
@@ -289,8 +297,7 @@ httpio_rel(ncio* const nciop, off_t offset, int rflags)
 
     if(nciop == NULL || nciop->pvt == NULL) {status = NC_EINVAL; goto done;}
     http = (NCHTTP*)nciop->pvt;
-    ncbytesfree(http->interval);
-    http->interval = NULL;
+    ncbytesclear(http->interval);
 done:
     return status;
 }
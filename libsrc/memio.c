@@ -188,6 +188,7 @@ memio_new(const char* path, int ioflags, size_t initialsize, ncio** nciopp, NCME
     *((ncio_filesizefunc**)&nciop->filesize) = memio_filesize;
     *((ncio_pad_lengthfunc**)&nciop->pad_length) = memio_pad_length;
     *((ncio_closefunc**)&nciop->close) = memio_close;
+    *((ncio_readfunc**)&nciop->read) = NULL;
 
     memio = (NCMEMIO*)calloc(1,sizeof(NCMEMIO));
     if(memio == NULL) {status = NC_ENOMEM; goto fail;}
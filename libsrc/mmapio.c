@@ -155,6 +155,7 @@ mmapio_new(const char* path, int ioflags, size_t initialsize, ncio** nciopp, NCM
     *((ncio_filesizefunc**)&nciop->filesize) = mmapio_filesize;
     *((ncio_pad_lengthfunc**)&nciop->pad_length) = mmapio_pad_length;
     *((ncio_closefunc**)&nciop->close) = mmapio_close;
+    *((ncio_readfunc**)&nciop->read) = NULL;
 
     mmapio = (NCMMAPIO*)calloc(1,sizeof(NCMMAPIO));
     if(mmapio == NULL) {status = NC_ENOMEM; goto fail;}
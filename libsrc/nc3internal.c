@@ -20,6 +20,7 @@
 #include "rnd.h"
 #include "ncx.h"
 #include "ncrc.h"
+#include "nclog.h"
 
 /* These have to do with version numbers. */
 #define MAGIC_NUM_LEN 4
@@ -34,6 +35,19 @@
 /* For cdf5 */
 #define NC_NUMRECS_EXTENT5 8
 
+/* Largest single ncio_move() made when moving data out in NC_endef,
+   and how much data is moved between progress reports. */
+#define NC_MOVE_PIECE ((off_t)64 * 1024 * 1024)
+#define NC_MOVE_REPORT ((off_t)1024 * 1024 * 1024)
+
+/* Progress of one pass of moving data out. */
+typedef struct NC_moveinfo {
+	const char *what;	/* which data, for the progress reports */
+	off_t total;	/* bytes to move */
+	off_t done;	/* bytes moved so far */
+	off_t reported;	/* value of done at the last report */
+} NC_moveinfo;
+
 /* Internal function; breaks ncio abstraction */
 extern int memio_extract(ncio* const nciop, size_t* sizep, void** memoryp);
 
@@ -45,6 +59,7 @@ free_NC3INFO(NC3_INFO *nc3)
 	free_NC_dimarrayV(&nc3->dims);
 	free_NC_attrarrayV(&nc3->attrs);
 	free_NC_vararrayV(&nc3->vars);
+	free(nc3->xhdr);
 	free(nc3);
 }
 
@@ -596,9 +611,47 @@ fill_added(NC3_INFO *gnu, NC3_INFO *old)
 }
 
 
+/*
+ * Move nbytes of data from "from" up to "to", in pieces of at most
+ * NC_MOVE_PIECE starting from the end, so that the ranges may overlap.
+ * Progress is logged (NCLOGGING=NOTE) every NC_MOVE_REPORT bytes.
+ */
+static int
+move_block(NC3_INFO *ncp, off_t to, off_t from, off_t nbytes,
+	NC_moveinfo *mv)
+{
+	assert(to > from);
+	while(nbytes > 0)
+	{
+		const off_t n = nbytes < NC_MOVE_PIECE ? nbytes : NC_MOVE_PIECE;
+		int status;
+
+		nbytes -= n;
+		status = ncio_move(ncp->nciop, to + nbytes, from + nbytes,
+			 (size_t)n, 0);
+		if(status != NC_NOERR)
+			return status;
+		mv->done += n;
+		if(mv->done - mv->reported >= NC_MOVE_REPORT)
+		{
+			nclog(NCLOGNOTE, "nc_enddef: moved %lld of %lld MiB of %s data",
+			      (long long)(mv->done >> 20), (long long)(mv->total >> 20),
+			      mv->what);
+			mv->reported = mv->done;
+		}
+	}
+	return NC_NOERR;
+}
+
 /*
  * Move the records "out".
  * Fill as needed.
+ *
+ * The old record variables keep their order in the record and,
+ * unless the alignment changed, their place in it. Then the part of
+ * each record they take up is moved as one block, and if the record
+ * size is unchanged too, all the records are moved as one block.
+ * Otherwise each variable of each record is moved by itself.
  */
 static int
 move_recs_r(NC3_INFO *gnu, NC3_INFO *old)
@@ -613,7 +666,62 @@ move_recs_r(NC3_INFO *gnu, NC3_INFO *old)
 	off_t gnu_off;
 	off_t old_off;
 	const size_t old_nrecs = NC_get_numrecs(old);
+	off_t lo = OFF_NONE, hi = 0, delta = 0;
+	int blocks = 1;
+	NC_moveinfo mv = {"record", 0, 0, 0};
+
+	for(varid = 0; varid < (int)old->vars.nelems; varid++)
+	{
+		gnu_varp = *(gnu_varpp + varid);
+		if(!IS_RECVAR(gnu_varp))
+			continue;
+		old_varp = *(old_varpp + varid);
+		if(lo == OFF_NONE)
+		{
+			lo = old_varp->begin;
+			delta = gnu_varp->begin - old_varp->begin;
+		}
+		else if(gnu_varp->begin - old_varp->begin != delta)
+			blocks = 0;
+		if(old_varp->begin + (off_t)old_varp->len > hi)
+			hi = old_varp->begin + (off_t)old_varp->len;
+	}
 
+	if(lo == OFF_NONE || old_nrecs == 0)
+		goto done;
+
+	if(blocks)
+	{
+		assert(delta >= 0 && gnu->recsize >= old->recsize);
+		if(gnu->recsize == old->recsize)
+		{
+			/* all the records at once */
+			const off_t nbytes = (off_t)(old->recsize * (old_nrecs - 1))
+				+ (hi - lo);
+			if(delta == 0)
+				goto done;
+			mv.total = nbytes;
+			status = move_block(gnu, lo + delta, lo, nbytes, &mv);
+			if(status != NC_NOERR)
+				return status;
+			goto done;
+		}
+		mv.total = (off_t)old_nrecs * (hi - lo);
+		/* Don't parallelize this loop */
+		for(recno = (int)old_nrecs -1; recno >= 0; recno--)
+		{
+			gnu_off = lo + delta + (off_t)(gnu->recsize * (size_t)recno);
+			old_off = lo + (off_t)(old->recsize * (size_t)recno);
+			if(gnu_off == old_off)
+				continue; 	/* nothing to do */
+			status = move_block(gnu, gnu_off, old_off, hi - lo, &mv);
+			if(status != NC_NOERR)
+				return status;
+		}
+		goto done;
+	}
+
+	mv.total = (off_t)old_nrecs * (off_t)old->recsize;
 	/* Don't parallelize this loop */
 	for(recno = (int)old_nrecs -1; recno >= 0; recno--)
 	{
@@ -638,8 +746,8 @@ move_recs_r(NC3_INFO *gnu, NC3_INFO *old)
 
 		assert(gnu_off > old_off);
 
-		status = ncio_move(gnu->nciop, gnu_off, old_off,
-			 old_varp->len, 0);
+		status = move_block(gnu, gnu_off, old_off,
+			 (off_t)old_varp->len, &mv);
 
 		if(status != NC_NOERR)
 			return status;
@@ -647,6 +755,7 @@ move_recs_r(NC3_INFO *gnu, NC3_INFO *old)
 	}
 	}
 
+done:
 	NC_set_numrecs(gnu, old_nrecs);
 
 	return NC_NOERR;
@@ -656,18 +765,30 @@ move_recs_r(NC3_INFO *gnu, NC3_INFO *old)
 /*
  * Move the "non record" variables "out".
  * Fill as needed.
+ *
+ * Runs of variables that move by the same distance are moved
+ * together, along with any alignment padding between them.
  */
 static int
 move_vars_r(NC3_INFO *gnu, NC3_INFO *old)
 {
 	int err, status=NC_NOERR;
-	int varid;
+	int varid, first;
 	NC_var **gnu_varpp = (NC_var **)gnu->vars.value;
 	NC_var **old_varpp = (NC_var **)old->vars.value;
 	NC_var *gnu_varp;
 	NC_var *old_varp;
-	off_t gnu_off;
-	off_t old_off;
+	off_t delta;
+	off_t lo, hi;
+	NC_moveinfo mv = {"fixed size", 0, 0, 0};
+
+	for(varid = 0; varid < (int)old->vars.nelems; varid++)
+	{
+		gnu_varp = *(gnu_varpp + varid);
+		old_varp = *(old_varpp + varid);
+		if(!IS_RECVAR(gnu_varp) && gnu_varp->begin > old_varp->begin)
+			mv.total += (off_t)old_varp->len;
+	}
 
 	/* Don't parallelize this loop */
 	for(varid = (int)old->vars.nelems -1;
@@ -682,14 +803,26 @@ move_vars_r(NC3_INFO *gnu, NC3_INFO *old)
 		/* else */
 
 		old_varp = *(old_varpp + varid);
-		gnu_off = gnu_varp->begin;
-		old_off = old_varp->begin;
+		delta = gnu_varp->begin - old_varp->begin;
+		if(delta <= 0)
+			continue;
+		hi = old_varp->begin + (off_t)old_varp->len;
+		lo = old_varp->begin;
 
-		if (gnu_off > old_off) {
-		    err = ncio_move(gnu->nciop, gnu_off, old_off,
-			               old_varp->len, 0);
-		    if (status == NC_NOERR) status = err;
+		/* take in the variables below that move as far */
+		for(first = varid - 1; first >= 0; first--)
+		{
+			if(IS_RECVAR(*(gnu_varpp + first)))
+				continue;
+			if((*(gnu_varpp + first))->begin
+			   - (*(old_varpp + first))->begin != delta)
+				break;
+			lo = (*(old_varpp + first))->begin;
+			varid = first;
 		}
+
+		err = move_block(gnu, lo + delta, lo, hi - lo, &mv);
+		if (status == NC_NOERR) status = err;
 	}
 	return status;
 }
@@ -1098,6 +1231,7 @@ NC3_create(const char *path, int ioflags, size_t initialsz, int basepe,
 	/* Link nc3 and nc */
         NC3_DATA_SET(nc,nc3);
 	nc->int_ncid = nc3->nciop->fd;
+	nc->concurrency = NC_CONCURRENT_FILES;
 
 	return NC_NOERR;
 
@@ -1206,6 +1340,19 @@ NC3_open(const char *path, int ioflags, int basepe, size_t *chunksizehintp,
         NC3_DATA_SET(nc,nc3);
 	nc->int_ncid = nc3->nciop->fd;
 
+	/*
+	 * Nothing in a file opened read-only changes, so if the data
+	 * can be read without the ncio buffer, reads may overlap.
+	 */
+	nc->concurrency = NC_CONCURRENT_FILES;
+#ifdef NETCDF_ENABLE_THREADSAFE
+	if(NC_readonly(nc3) && !NC_doNsync(nc3) && nc3->nciop->read != NULL)
+	{
+		fSet(nc3->state, NC_PREAD);
+		nc->concurrency = NC_CONCURRENT_READS;
+	}
+#endif
+
 	return NC_NOERR;
 
 unwind_ioc:
@@ -8,6 +8,7 @@
 #endif
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "netcdf.h"
 #include "ncio.h"
@@ -174,6 +175,34 @@ ncio_close(ncio* const nciop, int doUnlink)
     return status;
 }
 
+int
+ncio_read(ncio* const nciop, off_t offset, size_t extent, void *buf)
+{
+    int status = NC_NOERR;
+    off_t filesize;
+    size_t avail = 0;
+    void *vp = NULL;
+
+    if(nciop->read != NULL)
+        return nciop->read(nciop,offset,extent,buf);
+    /* else go through get(), which sees the whole region at once
+       in the packages that leave read() unset */
+    if((status = nciop->filesize(nciop,&filesize)))
+        return status;
+    if(offset < filesize)
+        avail = (size_t)(filesize - offset) < extent
+                ? (size_t)(filesize - offset) : extent;
+    if(avail > 0) {
+        if((status = nciop->get(nciop,offset,avail,0,&vp)))
+            return status;
+        memcpy(buf,vp,avail);
+        status = nciop->rel(nciop,offset,0);
+    }
+    if(avail < extent)
+        memset((char*)buf + avail,0,extent - avail);
+    return status;
+}
+
 /* URL utilities */
 
 /*
@@ -95,6 +95,17 @@ typedef int ncio_filesizefunc(ncio *nciop, off_t *filesizep);
 */
 typedef int ncio_closefunc(ncio *nciop, int doUnlink);
 
+/*
+ *  Copy the region (offset, extent) into the caller's buffer 'buf'
+ *  in as few reads as possible, without going through the buffer
+ *  used by get(). Bytes past the end of the file read as zero.
+ *  The caller syncs first. May be NULL, see ncio_read().
+ *  With NETCDF_ENABLE_THREADSAFE, calls may overlap, so it must not
+ *  change the state of nciop; leave it NULL where it would.
+ */
+typedef int ncio_readfunc(ncio *nciop, off_t offset, size_t extent,
+			void *buf);
+
 /* Get around cplusplus "const xxx in class ncio without constructor" error */
 #if defined(__cplusplus)
 #define NCIO_CONST
@@ -134,6 +145,8 @@ struct ncio {
   
 	ncio_closefunc *NCIO_CONST close;
 
+	ncio_readfunc *NCIO_CONST read;
+
 	/*
 	 * A copy of the 'path' argument passed in to ncio_open()
 	 * or ncio_create(). Used by ncabort() to remove (unlink)
@@ -156,6 +169,7 @@ extern int ncio_sync(ncio* const);
 extern int ncio_filesize(ncio* const, off_t*);
 extern int ncio_pad_length(ncio* const, off_t);
 extern int ncio_close(ncio* const, int);
+extern int ncio_read(ncio* const, off_t, size_t, void*);
 
 extern int ncio_create(const char *path, int ioflags, size_t initialsz,
                        off_t igeto, size_t igetsz, size_t *sizehintp,
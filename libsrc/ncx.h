@@ -1028,4 +1028,47 @@ ncx_putn_void(void **xpp, size_t nchars, const void *vp);
 extern int
 ncx_pad_putn_void(void **xpp, size_t nchars, const void *vp);
 
+/*
+ * Vectorized byte swapping and conversion, in ncxvec.c, used by the
+ * aggregate functions above on little-endian IEEE hosts. A getn or
+ * putn kernel returns non-zero if any element is out of range or
+ * otherwise needs the element-wise conversion, in which case the
+ * caller redoes the whole array with the element-wise functions.
+ */
+#if !defined(WORDS_BIGENDIAN) && !defined(NO_IEEE_FLOAT) && !defined(CRAYFLOAT) \
+    && SIZEOF_SHORT == X_SIZEOF_SHORT && SIZEOF_INT == X_SIZEOF_INT \
+    && SIZEOF_FLOAT == X_SIZEOF_FLOAT && SIZEOF_DOUBLE == X_SIZEOF_DOUBLE
+#define NCX_VEC 1
+
+extern void ncx_vec_swapn2b(void *dst, const void *src, size_t nn);
+extern void ncx_vec_swapn4b(void *dst, const void *src, size_t nn);
+extern void ncx_vec_swapn8b(void *dst, const void *src, size_t nn);
+
+extern int ncx_vec_getn_short_int(const void *xp, size_t nelems, int *tp);
+extern int ncx_vec_getn_short_float(const void *xp, size_t nelems, float *tp);
+extern int ncx_vec_getn_short_double(const void *xp, size_t nelems, double *tp);
+extern int ncx_vec_getn_int_short(const void *xp, size_t nelems, short *tp);
+extern int ncx_vec_getn_int_float(const void *xp, size_t nelems, float *tp);
+extern int ncx_vec_getn_int_double(const void *xp, size_t nelems, double *tp);
+extern int ncx_vec_getn_float_short(const void *xp, size_t nelems, short *tp);
+extern int ncx_vec_getn_float_int(const void *xp, size_t nelems, int *tp);
+extern int ncx_vec_getn_float_double(const void *xp, size_t nelems, double *tp);
+extern int ncx_vec_getn_double_short(const void *xp, size_t nelems, short *tp);
+extern int ncx_vec_getn_double_int(const void *xp, size_t nelems, int *tp);
+extern int ncx_vec_getn_double_float(const void *xp, size_t nelems, float *tp);
+
+extern int ncx_vec_putn_short_int(void *xp, size_t nelems, const int *tp);
+extern int ncx_vec_putn_short_float(void *xp, size_t nelems, const float *tp);
+extern int ncx_vec_putn_short_double(void *xp, size_t nelems, const double *tp);
+extern int ncx_vec_putn_int_short(void *xp, size_t nelems, const short *tp);
+extern int ncx_vec_putn_int_float(void *xp, size_t nelems, const float *tp);
+extern int ncx_vec_putn_int_double(void *xp, size_t nelems, const double *tp);
+extern int ncx_vec_putn_float_short(void *xp, size_t nelems, const short *tp);
+extern int ncx_vec_putn_float_int(void *xp, size_t nelems, const int *tp);
+extern int ncx_vec_putn_float_double(void *xp, size_t nelems, const double *tp);
+extern int ncx_vec_putn_double_short(void *xp, size_t nelems, const short *tp);
+extern int ncx_vec_putn_double_int(void *xp, size_t nelems, const int *tp);
+extern int ncx_vec_putn_double_float(void *xp, size_t nelems, const float *tp);
+#endif
+
 #endif /* _NCX_H_ */
@@ -308,6 +308,12 @@ swapn2b(void *dst, const void *src, IntType nn)
     char *op = (char*) dst;
     char *ip = (char*) src;
     uint16_t tmp;
+#ifdef NCX_VEC
+    if (nn > 1) {
+        ncx_vec_swapn2b(dst, src, (size_t)nn);
+        return;
+    }
+#endif
     for (i=0; i<nn; i++) {
         /* memcpy is used to handle the case of unaligned memory */
         memcpy(&tmp, ip, sizeof(tmp));
@@ -337,6 +343,12 @@ swapn4b(void *dst, const void *src, IntType nn)
     char *op = (char*) dst;
     char *ip = (char*) src;
     uint32_t tmp;
+#ifdef NCX_VEC
+    if (nn > 1) {
+        ncx_vec_swapn4b(dst, src, (size_t)nn);
+        return;
+    }
+#endif
     for (i=0; i<nn; i++) {
         /* memcpy is used to handle the case of unaligned memory */
         memcpy(&tmp, ip, sizeof(tmp));
@@ -367,6 +379,12 @@ swapn8b(void *dst, const void *src, IntType nn)
     char *op = (char*) dst;
     char *ip = (char*) src;
     uint64_t tmp;
+#ifdef NCX_VEC
+    if (nn > 1) {
+        ncx_vec_swapn8b(dst, src, (size_t)nn);
+        return;
+    }
+#endif
     for (i=0; i<nn; i++) {
         /* memcpy is used to handle the case of unaligned memory */
         memcpy(&tmp, ip, sizeof(tmp));
@@ -2352,6 +2370,15 @@ dnl dnl dnl
 dnl
 dnl NCX_GETN(xtype, itype)
 dnl
+dnl
+dnl VecPair(xtype, itype) is 1 if ncxvec.c has a kernel for the pair
+dnl
+define(`VecPair',`ifelse(dnl
+`$1$2', `shortint', 1, `$1$2', `shortfloat', 1, `$1$2', `shortdouble', 1,dnl
+`$1$2', `intshort', 1, `$1$2', `intfloat', 1, `$1$2', `intdouble', 1,dnl
+`$1$2', `floatshort', 1, `$1$2', `floatint', 1, `$1$2', `floatdouble', 1,dnl
+`$1$2', `doubleshort', 1, `$1$2', `doubleint', 1, `$1$2', `doublefloat', 1,dnl
+0)')dnl
 define(`NCX_GETN',dnl
 `dnl
 int
@@ -2406,6 +2433,16 @@ APIPrefix`x_getn_'NC_TYPE($1)_$2(const void **xpp, IntType nelems, $2 *tp)
 #else   /* not SX */
 	const char *xp = (const char *) *xpp;
 	int status = NC_NOERR;
+ifelse(VecPair($1,$2), 1,`dnl
+
+`#'ifdef NCX_VEC
+	/* Only values needing NC_ERANGE handling go element by element */
+	if (APIPrefix`x_vec_getn_'$1_$2(xp, nelems, tp) == 0) {
+		*xpp = (const void *)(xp + nelems * Xsizeof($1));
+		return NC_NOERR;
+	}
+`#'endif
+')dnl
 
 	for( ; nelems != 0; nelems--, xp += Xsizeof($1), tp++)
 	{
@@ -2615,6 +2652,16 @@ ifelse( $1$2, intfloat,dnl
 
 	char *xp = (char *) *xpp;
 	int status = NC_NOERR;
+ifelse(VecPair($1,$2), 1,`dnl
+
+`#'ifdef NCX_VEC
+	/* Only values needing NC_ERANGE handling go element by element */
+	if (APIPrefix`x_vec_putn_'$1_$2(xp, nelems, tp) == 0) {
+		*xpp = (void *)(xp + nelems * Xsizeof($1));
+		return NC_NOERR;
+	}
+`#'endif
+')dnl
 
 	for( ; nelems != 0; nelems--, xp += Xsizeof($1), tp++)
 	{
@@ -0,0 +1,137 @@
+/*
+ *	Copyright 2018, University Corporation for Atmospheric Research
+ *	See netcdf/COPYRIGHT file for copying and redistribution conditions.
+ */
+
+/*
+ * Vectorized versions of the ncx aggregate conversions between the
+ * big-endian external short, int, float and double and the native
+ * types, for little-endian IEEE hosts.
+ *
+ * Each kernel byte swaps and converts the whole array in one loop
+ * the compiler can vectorize (see ncsimd.h). Rather than reproduce
+ * every rule for out of range values (NC_ERANGE, ERANGE_FILL, fill
+ * values), a kernel only reports whether any element was out of
+ * range or NaN; the caller then redoes the array with the
+ * element-wise functions in ncx.c, so results are always the same.
+ */
+
+#include "config.h"
+#include <string.h>
+#include <float.h>
+#include "ncx.h"
+#include "ncsimd.h"
+
+#ifdef NCX_VEC
+
+#define BSWAP2(a) ((uint16_t)((((a) & 0xFFU) << 8) | (((a) >> 8) & 0xFFU)))
+#define BSWAP4(a) ((((a) & 0x000000FFU) << 24) | \
+                   (((a) & 0x0000FF00U) <<  8) | \
+                   (((a) & 0x00FF0000U) >>  8) | \
+                   (((a) & 0xFF000000U) >> 24))
+#define BSWAP8(a) ((((a) & 0x00000000000000FFULL) << 56) | \
+                   (((a) & 0x000000000000FF00ULL) << 40) | \
+                   (((a) & 0x0000000000FF0000ULL) << 24) | \
+                   (((a) & 0x00000000FF000000ULL) <<  8) | \
+                   (((a) & 0x000000FF00000000ULL) >>  8) | \
+                   (((a) & 0x0000FF0000000000ULL) >> 24) | \
+                   (((a) & 0x00FF000000000000ULL) >> 40) | \
+                   (((a) & 0xFF00000000000000ULL) >> 56))
+
+/* Non-zero unless lo <= v <= hi; NaN is out of range. */
+#define OUTSIDE(v, lo, hi) (!(((v) <= (hi)) & ((v) >= (lo))))
+#define NOCHECK(v) 0
+
+#define SWAPN(name, utype, BSWAP) \
+NC_SIMD_CLONES void \
+name(void *dst, const void *src, size_t nn) \
+{ \
+    char *op = (char *)dst; \
+    const char *ip = (const char *)src; \
+    size_t i; \
+    NC_SIMD_LOOP \
+    for (i = 0; i < nn; i++) { \
+        utype tmp; \
+        memcpy(&tmp, ip + i * sizeof(tmp), sizeof(tmp)); \
+        tmp = BSWAP(tmp); \
+        memcpy(op + i * sizeof(tmp), &tmp, sizeof(tmp)); \
+    } \
+}
+
+SWAPN(ncx_vec_swapn2b, uint16_t, BSWAP2)
+SWAPN(ncx_vec_swapn4b, uint32_t, BSWAP4)
+SWAPN(ncx_vec_swapn8b, uint64_t, BSWAP8)
+
+/* External xtype (stored as utype) to native itype. */
+#define GETN(xtype, itype, utype, BSWAP, CHECK) \
+NC_SIMD_CLONES int \
+ncx_vec_getn_##xtype##_##itype(const void *xp, size_t nelems, itype *tp) \
+{ \
+    const char *cp = (const char *)xp; \
+    int err = 0; \
+    size_t i; \
+    NC_SIMD_LOOP_ERR \
+    for (i = 0; i < nelems; i++) { \
+        utype u; \
+        xtype v; \
+        memcpy(&u, cp + i * sizeof(u), sizeof(u)); \
+        u = BSWAP(u); \
+        memcpy(&v, &u, sizeof(v)); \
+        err |= CHECK(v); \
+        tp[i] = (itype)v; \
+    } \
+    return err; \
+}
+
+/* Native itype to external xtype (stored as utype). */
+#define PUTN(xtype, itype, utype, BSWAP, CHECK) \
+NC_SIMD_CLONES int \
+ncx_vec_putn_##xtype##_##itype(void *xp, size_t nelems, const itype *tp) \
+{ \
+    char *cp = (char *)xp; \
+    int err = 0; \
+    size_t i; \
+    NC_SIMD_LOOP_ERR \
+    for (i = 0; i < nelems; i++) { \
+        utype u; \
+        itype v = tp[i]; \
+        xtype w = (xtype)v; \
+        err |= CHECK(v); \
+        memcpy(&u, &w, sizeof(u)); \
+        u = BSWAP(u); \
+        memcpy(cp + i * sizeof(u), &u, sizeof(u)); \
+    } \
+    return err; \
+}
+
+#define SHORT_RANGE(v) OUTSIDE(v, X_SHORT_MIN, X_SHORT_MAX)
+#define INT_RANGE(v) OUTSIDE((double)(v), (double)X_INT_MIN, (double)X_INT_MAX)
+#define FLOAT_RANGE(v) OUTSIDE(v, (double)X_FLOAT_MIN, (double)X_FLOAT_MAX)
+
+GETN(short, int, uint16_t, BSWAP2, NOCHECK)
+GETN(short, float, uint16_t, BSWAP2, NOCHECK)
+GETN(short, double, uint16_t, BSWAP2, NOCHECK)
+GETN(int, short, uint32_t, BSWAP4, SHORT_RANGE)
+GETN(int, float, uint32_t, BSWAP4, NOCHECK)
+GETN(int, double, uint32_t, BSWAP4, NOCHECK)
+GETN(float, short, uint32_t, BSWAP4, SHORT_RANGE)
+GETN(float, int, uint32_t, BSWAP4, INT_RANGE)
+GETN(float, double, uint32_t, BSWAP4, NOCHECK)
+GETN(double, short, uint64_t, BSWAP8, SHORT_RANGE)
+GETN(double, int, uint64_t, BSWAP8, INT_RANGE)
+GETN(double, float, uint64_t, BSWAP8, FLOAT_RANGE)
+
+PUTN(short, int, uint16_t, BSWAP2, SHORT_RANGE)
+PUTN(short, float, uint16_t, BSWAP2, SHORT_RANGE)
+PUTN(short, double, uint16_t, BSWAP2, SHORT_RANGE)
+PUTN(int, short, uint32_t, BSWAP4, NOCHECK)
+PUTN(int, float, uint32_t, BSWAP4, INT_RANGE)
+PUTN(int, double, uint32_t, BSWAP4, INT_RANGE)
+PUTN(float, short, uint32_t, BSWAP4, NOCHECK)
+PUTN(float, int, uint32_t, BSWAP4, NOCHECK)
+PUTN(float, double, uint32_t, BSWAP4, FLOAT_RANGE)
+PUTN(double, short, uint64_t, BSWAP8, NOCHECK)
+PUTN(double, int, uint64_t, BSWAP8, NOCHECK)
+PUTN(double, float, uint64_t, BSWAP8, NOCHECK)
+
+#endif /* NCX_VEC */
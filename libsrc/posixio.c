@@ -6,6 +6,11 @@
 
 /* For MinGW Build */
 
+/* For copy_file_range(); this has to come before any system header. */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #if HAVE_CONFIG_H
 #include <config.h>
 #endif
@@ -52,6 +57,8 @@
 #include "ncio.h"
 #include "fbits.h"
 #include "rnd.h"
+#include "ncrc.h"
+#include "nclog.h"
 
 /* #define INSTRUMENT 1 */
 #if INSTRUMENT /* debugging */
@@ -89,6 +96,12 @@
 #define S_IWOTH   0000002
 #endif
 
+/* Without pread(), reading moves the file position, so the read
+   method cannot be called by several threads at once. */
+#if !defined(NETCDF_ENABLE_THREADSAFE) || defined(HAVE_PREAD)
+#define PX_READ 1
+#endif
+
 /*Forward*/
 static int ncio_px_filesize(ncio *nciop, off_t *filesizep);
 static int ncio_px_pad_length(ncio *nciop, off_t length);
@@ -101,6 +114,27 @@ static int ncio_spx_close(ncio *nciop, int doUnlink);
  */
 /* #define ALWAYS_NC_SHARE 1 */
 
+/* Read-ahead of sequential accesses; the number of pages is taken
+   from the NETCDF_READAHEAD environment variable or the
+   NETCDF.READAHEAD .rc key when a file is opened or created. */
+#define READAHEAD_ENV "NETCDF_READAHEAD"
+#define READAHEAD_RC "NETCDF.READAHEAD"
+#define READAHEAD_MAX 1024 /* pages */
+
+/* Pool of pages kept behind the buffer, see px_pool_pgin(); the
+   number of pages is taken from the NETCDF_PAGECACHE environment
+   variable or the NETCDF.PAGECACHE .rc key, 0 (the default) turns
+   it off. A page is blksz bytes, which some parallel file systems
+   report in MiB, so the pool is also limited in bytes. */
+#define PAGECACHE_ENV "NETCDF_PAGECACHE"
+#define PAGECACHE_RC "NETCDF.PAGECACHE"
+#define PAGECACHE_DEFAULT 0 /* pages */
+#define PAGECACHE_MAX 65536 /* pages */
+#define PAGECACHE_MAXBYTES ((size_t)64 * 1024 * 1024)
+
+/* Size of the pieces in which ncio_px_move() copies large moves. */
+#define MOVE_BUFSIZE ((size_t)4 * 1024 * 1024)
+
 /* Begin OS */
 
 #ifndef POSIXIO_DEFAULT_PAGESIZE
@@ -399,6 +433,56 @@ px_pgin(ncio *const nciop,
     return NC_NOERR;
 }
 
+#ifdef PX_READ
+/*! Read a region of the file into vp, for the read method of the
+  ncio. With pread(), the file position is neither used nor moved, so
+  reads of a file opened read-only may overlap, see NC_PREAD.
+
+  @param[in] nciop  A pointer to the ncio struct for this file.
+  @param[in] offset The byte offset in file where read starts.
+  @param[in] extent The number of bytes to read.
+  @param[in] vp     A pointer to where the data will end up.
+  @param[in,out] posp The pointer to current position in file.
+  @return Return 0 on success, otherwise an error code.
+*/
+static int
+px_read(ncio *const nciop,
+	off_t const offset, const size_t extent,
+	void *const vp, off_t *posp)
+{
+#ifdef HAVE_PREAD
+	char *cp = (char *)vp;
+	size_t left = extent;
+	off_t where = offset;
+	ssize_t nread;
+
+	NC_UNUSED(posp);
+	while(left > 0)
+	{
+		nread = pread(nciop->fd, cp, left, where);
+		if(nread == -1)
+		{
+			if(errno == EINTR)
+				continue;
+			return errno;
+		}
+		if(nread == 0)
+			break; /* EOF, the rest reads as zeros */
+		cp += nread;
+		where += nread;
+		left -= (size_t)nread;
+	}
+	if(left > 0)
+		(void) memset(cp, 0, left);
+	return NC_NOERR;
+#else
+	size_t nread;
+
+	return px_pgin(nciop, offset, extent, vp, &nread, posp);
+#endif
+}
+#endif
+
 /* This struct is for POSIX systems, with NC_SHARE not in effect. If
    NC_SHARE is used, see ncio_spx.
 
@@ -413,6 +497,11 @@ px_pgin(ncio *const nciop,
    of data in the buffer.
    bf_refcount - buffer reference count.
    slave - used in moves.
+   ra_pages - number of pages to read ahead, 0 if read-ahead is off.
+   ra_last - offset of the page last asked for.
+   ra_stride - distance from the page before that to ra_last.
+   ra_until - read-ahead has been requested up to this offset.
+   pool - pages held behind the buffer, NULL if there is no pool.
 */
 typedef struct ncio_px {
 	size_t blksz;
@@ -426,8 +515,429 @@ typedef struct ncio_px {
 	int	bf_refcount;
 	/* chain for double buffering in px_move */
 	struct ncio_px *slave;
+	/* read-ahead, see px_readahead() */
+	size_t	ra_pages;
+	off_t	ra_last;
+	off_t	ra_stride;
+	off_t	ra_until;
+	/* page pool, see px_pool_pgin() */
+	struct px_pool *pool;
 } ncio_px;
 
+/* A page of the file held in the pool.
+
+   offset - file offset of the page, a multiple of blksz.
+   cnt - number of valid bytes, less than blksz only for the page
+   holding the end of the file.
+   dirty - the page has been written but not yet paged out.
+   lru - value of the pool clock when the page was last used.
+   next - next page in the same hash bucket, -1 at the end.
+   base - the data.
+*/
+typedef struct px_page {
+	off_t	offset;
+	size_t	cnt;
+	int	dirty;
+	unsigned long long lru;
+	long	next;
+	void	*base;
+} px_page;
+
+/* The page pool of a non-shared file.
+
+   Reads and writes of the buffer go through the pool, which holds
+   the most recently used pages of the file so that switching the
+   buffer between parts of the file (two variables read or written
+   alternately) does not go back to the disk. Written pages are kept
+   until they are evicted or the file is synced.
+
+   blksz - size of a page, the same as the ncio_px blksz.
+   npages - maximum number of pages.
+   nused - number of entries of pages in use.
+   nbuckets - size of the hash table, a power of 2.
+   buckets - hash table of page indexes by page number.
+   clock - incremented on each use of a page.
+   hits, misses - pages found and not found in the pool when read.
+   evictions - pages dropped to make room for others.
+   writebacks - dirty pages written to the file.
+*/
+typedef struct px_pool {
+	size_t	blksz;
+	size_t	npages;
+	size_t	nused;
+	size_t	nbuckets;
+	long	*buckets;
+	px_page	*pages;
+	unsigned long long clock;
+	unsigned long long hits;
+	unsigned long long misses;
+	unsigned long long evictions;
+	unsigned long long writebacks;
+} px_pool;
+
+
+/* Detect sequential access and ask the system to start reading the
+   pages that will be wanted next, so that they are already in
+   memory when px_pgin() gets to them.
+
+   Access is sequential once two successive pages asked for are the
+   same distance apart. If that distance is at most the size of the
+   buffer (reading straight through the file) the next ra_pages pages
+   after the buffer are requested, topped up each time half of them
+   have been consumed. Otherwise (one record variable read record by
+   record) the pages at the same stride for the next ra_pages records
+   are requested.
+
+   This is a hint only; without posix_fadvise() it does nothing.
+
+   nciop - pointer to ncio struct.
+   pxp - pointer to posix non-share ncio_px struct.
+   blkoffset - offset of the page about to be used.
+*/
+static void
+px_readahead(ncio *const nciop, ncio_px *const pxp, off_t blkoffset)
+{
+#ifdef HAVE_POSIX_FADVISE
+	const off_t bufsz = 2 * (off_t)pxp->blksz;
+	off_t stride;
+
+	if(pxp->ra_pages == 0 || blkoffset == pxp->ra_last)
+		return;
+	stride = blkoffset - pxp->ra_last;
+	if(pxp->ra_last == OFF_NONE || stride <= 0 || stride != pxp->ra_stride)
+	{
+		/* not (yet) sequential */
+		pxp->ra_stride = (pxp->ra_last == OFF_NONE ? 0 : stride);
+		pxp->ra_last = blkoffset;
+		pxp->ra_until = blkoffset;
+		return;
+	}
+	pxp->ra_last = blkoffset;
+
+	if(stride <= bufsz)
+	{
+		const off_t window = (off_t)pxp->ra_pages * (off_t)pxp->blksz;
+		const off_t start = blkoffset + bufsz;
+		if(pxp->ra_until < start + window / 2)
+		{
+			const off_t from = (pxp->ra_until > start ? pxp->ra_until : start);
+			(void) posix_fadvise(nciop->fd, from, start + window - from,
+				POSIX_FADV_WILLNEED);
+			pxp->ra_until = start + window;
+		}
+	}
+	else
+	{
+		off_t next = blkoffset + stride;
+		size_t i;
+		for(i = 0; i < pxp->ra_pages; i++, next += stride)
+		{
+			if(next < pxp->ra_until)
+				continue;
+			(void) posix_fadvise(nciop->fd, next, bufsz, POSIX_FADV_WILLNEED);
+		}
+		pxp->ra_until = next;
+	}
+#else
+	NC_UNUSED(nciop);
+	NC_UNUSED(pxp);
+	NC_UNUSED(blkoffset);
+#endif
+}
+
+static px_pool *
+px_pool_new(size_t blksz, size_t npages)
+{
+	px_pool *pool = (px_pool *) calloc(1, sizeof(px_pool));
+	size_t i;
+
+	if(pool == NULL)
+		return NULL;
+	pool->blksz = blksz;
+	pool->npages = npages;
+	for(pool->nbuckets = 1; pool->nbuckets < npages; pool->nbuckets *= 2)
+		continue;
+	pool->buckets = (long *) malloc(pool->nbuckets * sizeof(long));
+	pool->pages = (px_page *) calloc(npages, sizeof(px_page));
+	if(pool->buckets == NULL || pool->pages == NULL)
+	{
+		free(pool->buckets);
+		free(pool->pages);
+		free(pool);
+		return NULL;
+	}
+	for(i = 0; i < pool->nbuckets; i++)
+		pool->buckets[i] = -1;
+	return pool;
+}
+
+static void
+px_pool_free(px_pool *pool)
+{
+	size_t i;
+
+	if(pool == NULL)
+		return;
+	for(i = 0; i < pool->nused; i++)
+		free(pool->pages[i].base);
+	free(pool->pages);
+	free(pool->buckets);
+	free(pool);
+}
+
+static size_t
+px_pool_bucket(const px_pool *pool, off_t offset)
+{
+	return (size_t)(offset / (off_t)pool->blksz) & (pool->nbuckets - 1);
+}
+
+/* Index of the page at offset, or -1 if it is not in the pool. */
+static long
+px_pool_find(const px_pool *pool, off_t offset)
+{
+	long i;
+
+	for(i = pool->buckets[px_pool_bucket(pool, offset)]; i >= 0;
+			i = pool->pages[i].next)
+	{
+		if(pool->pages[i].offset == offset)
+			return i;
+	}
+	return -1;
+}
+
+/* Find room in the pool for the page at offset, which is not in it,
+   evicting the least recently used page (and writing it out if it
+   is dirty) if the pool is full.
+
+   nciop - pointer to ncio struct.
+   pool - the pool.
+   offset - file offset of the page.
+   posp - pointer to current position in file.
+   idxp - pointer that gets the index of the page.
+*/
+static int
+px_pool_slot(ncio *const nciop, px_pool *pool, off_t offset,
+	off_t *posp, long *idxp)
+{
+	px_page *pg;
+	long i;
+	long *lp;
+
+	assert(px_pool_find(pool, offset) < 0);
+	if(pool->nused < pool->npages)
+	{
+		i = (long)pool->nused;
+		pg = &pool->pages[i];
+		pg->base = malloc(pool->blksz);
+		if(pg->base == NULL)
+			return ENOMEM;
+		pool->nused++;
+	}
+	else
+	{
+		size_t j;
+		i = 0;
+		for(j = 1; j < pool->nused; j++)
+		{
+			if(pool->pages[j].lru < pool->pages[i].lru)
+				i = (long)j;
+		}
+		pg = &pool->pages[i];
+		if(pg->dirty)
+		{
+			int status = px_pgout(nciop, pg->offset, pg->cnt,
+				pg->base, posp);
+			if(status != NC_NOERR)
+				return status;
+			pool->writebacks++;
+		}
+		/* unlink from its hash chain */
+		for(lp = &pool->buckets[px_pool_bucket(pool, pg->offset)];
+				*lp != i; lp = &pool->pages[*lp].next)
+			continue;
+		*lp = pg->next;
+		pool->evictions++;
+	}
+	pg->offset = offset;
+	pg->cnt = 0;
+	pg->dirty = 0;
+	pg->lru = ++pool->clock;
+	lp = &pool->buckets[px_pool_bucket(pool, offset)];
+	pg->next = *lp;
+	*lp = i;
+	*idxp = i;
+	return NC_NOERR;
+}
+
+static int
+px_page_cmp(const void *a, const void *b)
+{
+	const px_page *pa = *(const px_page *const *)a;
+	const px_page *pb = *(const px_page *const *)b;
+	return (pa->offset > pb->offset) - (pa->offset < pb->offset);
+}
+
+/* Write out the dirty pages of the pool, in file order. If
+   invalidate is set, the pool is emptied as well. */
+static int
+px_pool_flush(ncio *const nciop, px_pool *pool, off_t *posp,
+	int invalidate)
+{
+	px_page **dirty;
+	size_t i, ndirty = 0;
+	int status = NC_NOERR;
+
+	if(pool == NULL || pool->nused == 0)
+		return NC_NOERR;
+	dirty = (px_page **) malloc(pool->nused * sizeof(px_page *));
+	if(dirty == NULL)
+		return ENOMEM;
+	for(i = 0; i < pool->nused; i++)
+	{
+		if(pool->pages[i].dirty)
+			dirty[ndirty++] = &pool->pages[i];
+	}
+	qsort(dirty, ndirty, sizeof(px_page *), px_page_cmp);
+	for(i = 0; i < ndirty; i++)
+	{
+		status = px_pgout(nciop, dirty[i]->offset, dirty[i]->cnt,
+			dirty[i]->base, posp);
+		if(status != NC_NOERR)
+			break;
+		dirty[i]->dirty = 0;
+		pool->writebacks++;
+	}
+	free(dirty);
+	if(status == NC_NOERR && invalidate)
+	{
+		for(i = 0; i < pool->nused; i++)
+			free(pool->pages[i].base);
+		pool->nused = 0;
+		for(i = 0; i < pool->nbuckets; i++)
+			pool->buckets[i] = -1;
+	}
+	return status;
+}
+
+/* Read in a page of data, like px_pgin(), taking the pages that are
+   in the pool from there. Runs of pages that are not are read with
+   one call and then added to the pool.
+
+   The offset and extent are multiples of the page size, which is
+   how px_get() always asks for them.
+*/
+static int
+px_pool_pgin(ncio *const nciop,
+	off_t const offset, const size_t extent,
+	void *const vp, size_t *nreadp, off_t *posp)
+{
+	px_pool *const pool = ((ncio_px *)nciop->pvt)->pool;
+	size_t blksz, done = 0, nread = 0;
+	int status;
+
+	if(pool == NULL)
+		return px_pgin(nciop, offset, extent, vp, nreadp, posp);
+
+	blksz = pool->blksz;
+	assert(offset % (off_t)blksz == 0 && extent % blksz == 0);
+	while(done < extent)
+	{
+		char *const cp = (char *)vp + done;
+		const off_t pgoff = offset + (off_t)done;
+		long idx = px_pool_find(pool, pgoff);
+
+		if(idx >= 0)
+		{
+			px_page *const pg = &pool->pages[idx];
+			(void) memcpy(cp, pg->base, pg->cnt);
+			(void) memset(cp + pg->cnt, 0, blksz - pg->cnt);
+			if(pg->cnt > 0)
+				nread = done + pg->cnt;
+			pg->lru = ++pool->clock;
+			pool->hits++;
+			done += blksz;
+		}
+		else
+		{
+			size_t run = blksz, got, i;
+
+			while(done + run < extent
+				 && px_pool_find(pool, pgoff + (off_t)run) < 0)
+				run += blksz;
+			status = px_pgin(nciop, pgoff, run, cp, &got, posp);
+			if(status != NC_NOERR)
+				return status;
+			pool->misses += run / blksz;
+			if(got > 0)
+				nread = done + got;
+			/* keep the pages that hold data */
+			for(i = 0; i < got; i += blksz)
+			{
+				status = px_pool_slot(nciop, pool, pgoff + (off_t)i,
+					posp, &idx);
+				if(status != NC_NOERR)
+					return status;
+				pool->pages[idx].cnt = MIN(got - i, blksz);
+				(void) memcpy(pool->pages[idx].base, cp + i,
+					pool->pages[idx].cnt);
+			}
+			done += run;
+		}
+	}
+	*nreadp = nread;
+	return NC_NOERR;
+}
+
+/* Write out a page of data, like px_pgout(), into the pool. Whole
+   pages are kept there until they are evicted or the file is
+   synced; a part of a page that is not in the pool is written
+   straight to the file.
+*/
+static int
+px_pool_pgout(ncio *const nciop,
+	off_t const offset, const size_t extent,
+	void *const vp, off_t *posp)
+{
+	px_pool *const pool = ((ncio_px *)nciop->pvt)->pool;
+	size_t done, n;
+	int status;
+
+	if(pool == NULL)
+		return px_pgout(nciop, offset, extent, vp, posp);
+
+	assert(offset % (off_t)pool->blksz == 0);
+	for(done = 0; done < extent; done += n)
+	{
+		const off_t pgoff = offset + (off_t)done;
+		long idx = px_pool_find(pool, pgoff);
+		px_page *pg;
+
+		n = MIN(extent - done, pool->blksz);
+		if(idx < 0)
+		{
+			if(n < pool->blksz)
+			{
+				status = px_pgout(nciop, pgoff, n,
+					(char *)vp + done, posp);
+				if(status != NC_NOERR)
+					return status;
+				continue;
+			}
+			status = px_pool_slot(nciop, pool, pgoff, posp, &idx);
+			if(status != NC_NOERR)
+				return status;
+		}
+		pg = &pool->pages[idx];
+		(void) memcpy(pg->base, (char *)vp + done, n);
+		if(pg->cnt < n)
+			pg->cnt = n;
+		pg->dirty = 1;
+		pg->lru = ++pool->clock;
+	}
+	return NC_NOERR;
+}
+
 
 /*ARGSUSED*/
 /* This function indicates the file region starting at offset may be
@@ -541,6 +1051,7 @@ px_get(ncio *const nciop, ncio_px *const pxp,
 
 	if(2 * pxp->blksz < blkextent)
 		return E2BIG; /* TODO: temporary kludge */
+	px_readahead(nciop, pxp, blkoffset);
 	if(pxp->bf_offset == OFF_NONE)
 	{
 		/* Uninitialized */
@@ -566,7 +1077,7 @@ px_get(ncio *const nciop, ncio_px *const pxp,
 			void *const middle =
 			 	(void *)((char *)pxp->bf_base + pxp->blksz);
 			assert(pxp->bf_extent == pxp->blksz);
-			status = px_pgin(nciop,
+			status = px_pool_pgin(nciop,
 				 pxp->bf_offset + (off_t)pxp->blksz,
 				 pxp->blksz,
 				 middle,
@@ -602,7 +1113,7 @@ px_get(ncio *const nciop, ncio_px *const pxp,
 			{
 				/* page out lower half */
 				assert(pxp->bf_refcount <= 0);
-				status = px_pgout(nciop,
+				status = px_pool_pgout(nciop,
 					pxp->bf_offset,
 					pxp->blksz,
 					pxp->bf_base,
@@ -621,7 +1132,7 @@ px_get(ncio *const nciop, ncio_px *const pxp,
 			if(fIsSet(pxp->bf_rflags, RGN_MODIFIED))
 			{
 				assert(pxp->bf_refcount <= 0);
-				status = px_pgout(nciop,
+				status = px_pool_pgout(nciop,
 					pxp->bf_offset,
 					pxp->blksz,
 					pxp->bf_base,
@@ -638,7 +1149,7 @@ px_get(ncio *const nciop, ncio_px *const pxp,
 			/* page in upper */
 			void *const middle =
 			 	(void *)((char *)pxp->bf_base + pxp->blksz);
-			status = px_pgin(nciop,
+			status = px_pool_pgin(nciop,
 				 pxp->bf_offset + (off_t)pxp->blksz,
 				 pxp->blksz,
 				 middle,
@@ -667,7 +1178,7 @@ px_get(ncio *const nciop, ncio_px *const pxp,
 			{
 				/* page out upper half */
 				assert(pxp->bf_refcount <= 0);
-				status = px_pgout(nciop,
+				status = px_pool_pgout(nciop,
 					pxp->bf_offset + (off_t)pxp->blksz,
 					pxp->bf_cnt - pxp->blksz,
 					middle,
@@ -685,7 +1196,7 @@ px_get(ncio *const nciop, ncio_px *const pxp,
 			upper_cnt = pxp->bf_cnt;
 		}
 		/* read page below into lower half */
-		status = px_pgin(nciop,
+		status = px_pool_pgin(nciop,
 			 blkoffset,
 			 pxp->blksz,
 			 pxp->bf_base,
@@ -711,7 +1222,7 @@ px_get(ncio *const nciop, ncio_px *const pxp,
 	if(fIsSet(pxp->bf_rflags, RGN_MODIFIED))
 	{
 		assert(pxp->bf_refcount <= 0);
-		status = px_pgout(nciop,
+		status = px_pool_pgout(nciop,
 			pxp->bf_offset,
 			pxp->bf_cnt,
 			pxp->bf_base,
@@ -722,7 +1233,7 @@ px_get(ncio *const nciop, ncio_px *const pxp,
 	}
 
 pgin:
-	status = px_pgin(nciop,
+	status = px_pool_pgin(nciop,
 		 blkoffset,
 		 blkextent,
 		 pxp->bf_base,
@@ -794,6 +1305,87 @@ ncio_px_get(ncio *const nciop,
 }
 
 
+/* Copy nbytes from "from" to "to" straight through the file, for
+   moves larger than the buffer. The buffer and the page pool are
+   written out and emptied first, since the copy goes around them.
+
+   The copy is done in pieces of up to MOVE_BUFSIZE, from the end
+   when moving up so that overlapping ranges are safe. Where the
+   pieces do not overlap copy_file_range() lets the kernel do the
+   copy; otherwise, or if it fails, each piece is read and written.
+*/
+static int
+px_move_direct(ncio *const nciop, ncio_px *const pxp, off_t to, off_t from,
+	size_t nbytes)
+{
+	const size_t piece = MIN(nbytes, MOVE_BUFSIZE);
+	size_t done = 0;
+	char *buf = NULL;
+	int status = NC_NOERR;
+
+	assert(pxp->bf_refcount <= 0);
+	if(fIsSet(pxp->bf_rflags, RGN_MODIFIED))
+	{
+		status = px_pool_pgout(nciop, pxp->bf_offset, pxp->bf_cnt,
+			pxp->bf_base, &pxp->pos);
+		if(status != NC_NOERR)
+			return status;
+	}
+	pxp->bf_offset = OFF_NONE;
+	pxp->bf_cnt = 0;
+	pxp->bf_rflags = 0;
+	status = px_pool_flush(nciop, pxp->pool, &pxp->pos, 1);
+	if(status != NC_NOERR)
+		return status;
+	if(pxp->slave != NULL)
+	{
+		/* now stale */
+		free(pxp->slave->bf_base);
+		free(pxp->slave);
+		pxp->slave = NULL;
+	}
+
+	while(done < nbytes)
+	{
+		const size_t n = MIN(nbytes - done, piece);
+		/* the piece to copy next */
+		const off_t src = (to > from ? from + (off_t)(nbytes - done - n)
+					     : from + (off_t)done);
+		const off_t dst = src + (to - from);
+		size_t nread;
+
+#ifdef HAVE_COPY_FILE_RANGE
+		if((to > from ? to - from : from - to) >= (off_t)n)
+		{
+			loff_t in = src, out = dst;
+			size_t left = n;
+			ssize_t got = 0;
+			while(left > 0
+			      && (got = copy_file_range(nciop->fd, &in, nciop->fd,
+							&out, left, 0)) > 0)
+				left -= (size_t)got;
+			if(left == 0)
+			{
+				done += n;
+				continue;
+			}
+			/* fall back to read and write for the rest */
+		}
+#endif
+		if(buf == NULL && (buf = (char *) malloc(piece)) == NULL)
+			return ENOMEM;
+		status = px_pgin(nciop, src, n, buf, &nread, &pxp->pos);
+		if(status != NC_NOERR)
+			break;
+		status = px_pgout(nciop, dst, n, buf, &pxp->pos);
+		if(status != NC_NOERR)
+			break;
+		done += n;
+	}
+	free(buf);
+	return status;
+}
+
 /* ARGSUSED */
 static int
 px_double_buffer(ncio *const nciop, off_t to, off_t from,
@@ -833,6 +1425,8 @@ fprintf(stderr, "\tdouble_buffr %ld %ld %ld\n",
 		pxp->slave->bf_rflags = 0;
 		pxp->slave->bf_refcount = 0;
 		pxp->slave->slave = NULL;
+		pxp->slave->ra_pages = 0;
+		pxp->slave->pool = NULL;
 	}
 
 	pxp->slave->pos = pxp->pos;
@@ -907,6 +1501,9 @@ ncio_px_move(ncio *const nciop, off_t to, off_t from,
 fprintf(stderr, "ncio_px_move %ld %ld %ld %ld %ld\n",
 		 (long)to, (long)from, (long)nbytes, (long)lower, (long)extent);
 #endif
+	if(extent > 2 * pxp->blksz)
+		return px_move_direct(nciop, pxp, to, from, nbytes);
+
 	if(extent > pxp->blksz)
 	{
 		size_t remaining = nbytes;
@@ -983,12 +1580,13 @@ ncio_px_sync(ncio *const nciop)
 	if(fIsSet(pxp->bf_rflags, RGN_MODIFIED))
 	{
 		assert(pxp->bf_refcount <= 0);
-		status = px_pgout(nciop, pxp->bf_offset,
+		status = px_pool_pgout(nciop, pxp->bf_offset,
 			pxp->bf_cnt,
 			pxp->bf_base, &pxp->pos);
 		if(status != NC_NOERR)
 			return status;
 		pxp->bf_rflags = 0;
+		status = px_pool_flush(nciop, pxp->pool, &pxp->pos, 0);
 	}
 	else if (!fIsSet(pxp->bf_rflags, RGN_WRITE))
 	{
@@ -998,7 +1596,10 @@ ncio_px_sync(ncio *const nciop)
 	     */
 	    pxp->bf_offset = OFF_NONE;
 	    pxp->bf_cnt = 0;
+	    status = px_pool_flush(nciop, pxp->pool, &pxp->pos, 1);
 	}
+	else
+	    status = px_pool_flush(nciop, pxp->pool, &pxp->pos, 0);
 	return status;
 }
 
@@ -1032,6 +1633,9 @@ ncio_px_freepvt(void *const pvt)
 		pxp->bf_extent = 0;
 		pxp->bf_offset = OFF_NONE;
 	}
+
+	px_pool_free(pxp->pool);
+	pxp->pool = NULL;
 }
 
 
@@ -1064,6 +1668,37 @@ ncio_px_init2(ncio *const nciop, size_t *sizehintp, int isNew)
 
 	pxp->blksz = *sizehintp;
 
+	{
+		const char *ra = getenv(READAHEAD_ENV);
+		if(ra == NULL)
+			ra = NC_rclookup(READAHEAD_RC, NULL, NULL);
+		if(ra != NULL)
+		{
+			long n = strtol(ra, NULL, 10);
+			if(n > 0)
+				pxp->ra_pages = (size_t)MIN(n, READAHEAD_MAX);
+		}
+	}
+
+	{
+		const char *pc = getenv(PAGECACHE_ENV);
+		long n = PAGECACHE_DEFAULT;
+		if(pc == NULL)
+			pc = NC_rclookup(PAGECACHE_RC, NULL, NULL);
+		if(pc != NULL)
+			n = strtol(pc, NULL, 10);
+		if(n > 0)
+		{
+			size_t npages = (size_t)MIN(n, PAGECACHE_MAX);
+			npages = MIN(npages, PAGECACHE_MAXBYTES / pxp->blksz);
+			if(npages == 0)
+				npages = 1;
+			pxp->pool = px_pool_new(pxp->blksz, npages);
+			if(pxp->pool == NULL)
+				return ENOMEM;
+		}
+	}
+
 	assert(pxp->bf_base == NULL);
 
 	/* this is separate allocation because it may grow */
@@ -1084,6 +1719,19 @@ ncio_px_init2(ncio *const nciop, size_t *sizehintp, int isNew)
 }
 
 
+/* Read the region (offset, extent) straight into buf, with one read
+   when the system allows. For POSIX systems, without NC_SHARE. */
+#ifdef PX_READ
+static int
+ncio_px_read(ncio *nciop, off_t offset, size_t extent, void *buf)
+{
+	ncio_px *const pxp = (ncio_px *)nciop->pvt;
+
+	return px_read(nciop, offset, extent, buf, &pxp->pos);
+}
+#endif
+
+
 /* This is the first of a two-part initialization of the ncio struct.
    Here the rel, get, move, sync, and free function pointers are set
    to their POSIX non-NC_SHARE functions (ncio_px_*).
@@ -1102,6 +1750,11 @@ ncio_px_init(ncio *const nciop)
 	*((ncio_filesizefunc **)&nciop->filesize) = ncio_px_filesize; /* cast away const */
 	*((ncio_pad_lengthfunc **)&nciop->pad_length) = ncio_px_pad_length; /* cast away const */
 	*((ncio_closefunc **)&nciop->close) = ncio_px_close; /* cast away const */
+#ifdef PX_READ
+	*((ncio_readfunc **)&nciop->read) = ncio_px_read; /* cast away const */
+#else
+	*((ncio_readfunc **)&nciop->read) = NULL; /* cast away const */
+#endif
 
 	pxp->blksz = 0;
 	pxp->pos = -1;
@@ -1111,6 +1764,11 @@ ncio_px_init(ncio *const nciop)
 	pxp->bf_refcount = 0;
 	pxp->bf_base = NULL;
 	pxp->slave = NULL;
+	pxp->ra_pages = 0;
+	pxp->ra_last = OFF_NONE;
+	pxp->ra_stride = 0;
+	pxp->ra_until = 0;
+	pxp->pool = NULL;
 
 }
 
@@ -1462,6 +2120,19 @@ ncio_spx_init2(ncio *const nciop, const size_t *const sizehintp)
 }
 
 
+/* Read the region (offset, extent) straight into buf. For POSIX
+   systems, with NC_SHARE. */
+#ifdef PX_READ
+static int
+ncio_spx_read(ncio *nciop, off_t offset, size_t extent, void *buf)
+{
+	ncio_spx *const pxp = (ncio_spx *)nciop->pvt;
+
+	return px_read(nciop, offset, extent, buf, &pxp->pos);
+}
+#endif
+
+
 /* First half of init for ncio_spx struct, setting the rel, get, move,
    sync, and free function pointers to the NC_SHARE versions of these
    functions (i.e. the ncio_spx_* functions).
@@ -1479,6 +2150,11 @@ ncio_spx_init(ncio *const nciop)
 	*((ncio_filesizefunc **)&nciop->filesize) = ncio_px_filesize; /* cast away const */
 	*((ncio_pad_lengthfunc **)&nciop->pad_length) = ncio_px_pad_length; /* cast away const */
 	*((ncio_closefunc **)&nciop->close) = ncio_spx_close; /* cast away const */
+#ifdef PX_READ
+	*((ncio_readfunc **)&nciop->read) = ncio_spx_read; /* cast away const */
+#else
+	*((ncio_readfunc **)&nciop->read) = NULL; /* cast away const */
+#endif
 
 	pxp->pos = -1;
 	pxp->bf_offset = OFF_NONE;
@@ -1896,6 +2572,13 @@ ncio_px_close(ncio *nciop, int doUnlink)
 	    status = nciop->sync(nciop);
 	    (void) close(nciop->fd);
 	}
+	{
+	    const px_pool *pool = ((ncio_px *)nciop->pvt)->pool;
+	    if(pool != NULL)
+		nclog(NCLOGNOTE, "%s: page pool hits=%llu misses=%llu evictions=%llu writebacks=%llu",
+		      nciop->path, pool->hits, pool->misses, pool->evictions,
+		      pool->writebacks);
+	}
 	if(doUnlink)
 		(void) unlink(nciop->path);
 	ncio_px_free(nciop);
@@ -34,10 +34,12 @@ dnl
 
 static int
 readNCv(const NC3_INFO* ncp, const NC_var* varp, const size_t* start,
-        const size_t nelems, void* value, const nc_type memtype);
+        const size_t nelems, const off_t xstep, void* value,
+        const nc_type memtype);
 static int
 writeNCv(NC3_INFO* ncp, const NC_var* varp, const size_t* start,
-         const size_t nelems, const void* value, const nc_type memtype);
+         const size_t nelems, const off_t xstep, const void* value,
+         const nc_type memtype);
 
 
 /* #define ODEBUG 1 */
@@ -131,28 +133,33 @@ NCFILL(ulonglong, ulonglong, X_SIZEOF_ULONGLONG, NC_FILL_UINT64)
 
 
 /*
- * Fill the external space for variable 'varp' values at 'recno' with
- * the appropriate value. If 'varp' is not a record variable, fill the
- * whole thing.  For the special case when 'varp' is the only record
- * variable and it is of type byte, char, or short, varsize should be
- * ncp->recsize, otherwise it should be varp->len.
- * Formerly
-xdr_NC_fill()
+ * Size of the buffer of encoded fill values written out by
+ * fill_NC_var, and the largest record NCvnrecs builds a fill image of.
  */
-int
-fill_NC_var(NC3_INFO* ncp, const NC_var *varp, long long varsize, size_t recno)
+#define NC_FILL_BUFSIZE ((size_t)64 * 1024)
+#define NC_FILL_RECMAX ((size_t)4 * 1024 * 1024)
+
+/*
+ * Put the fill value of 'varp', in external representation, into
+ * the 'bufsz' bytes at 'buf'; 'bufsz' is a multiple of varp->xsz.
+ * NFILL values are encoded, then copied over the rest of the buffer
+ * in doubling steps.
+ */
+static int
+NC_fill_pattern(const NC_var *varp, void *buf, size_t bufsz)
 {
 	char xfillp[NFILL * X_SIZEOF_DOUBLE];
 	const size_t step = varp->xsz;
 	const size_t nelems = sizeof(xfillp)/step;
 	const size_t xsz = varp->xsz * nelems;
 	NC_attr **attrpp = NULL;
-	off_t offset;
-	long long remaining = varsize;
+	size_t done;
 
 	void *xp;
 	int status = NC_NOERR;
 
+	assert(bufsz % step == 0);
+
 	/*
 	 * Set up fill value
 	 */
@@ -233,26 +240,37 @@ fill_NC_var(NC3_INFO* ncp, const NC_var *varp, long long varsize, size_t recno)
 	}
 
 	/*
-	 * copyout:
 	 * xfillp now contains 'nelems' elements of the fill value
-	 * in external representation.
-	 */
-
-	/*
-	 * Copy it out.
+	 * in external representation; spread them over buf.
 	 */
-
-	offset = varp->begin;
-	if(IS_RECVAR(varp))
+	done = MIN(bufsz, xsz);
+	(void) memcpy(buf, xfillp, done);
+	while(done < bufsz)
 	{
-		offset += (off_t)(ncp->recsize * recno);
+		const size_t n = MIN(done, bufsz - done);
+		(void) memcpy((char *)buf + done, buf, n);
+		done += n;
 	}
+	return NC_NOERR;
+}
+
+/*
+ * Write 'nbytes' at 'offset' by repeating the 'patsz' bytes at
+ * 'pattern', a chunk at a time.
+ */
+static int
+NC_fill_region(NC3_INFO* ncp, off_t offset, long long nbytes,
+	const void *pattern, size_t patsz)
+{
+	size_t phase = 0;	/* where in the pattern the next byte is */
+	int status = NC_NOERR;
+	void *xp;
 
-	assert(remaining > 0);
+	assert(nbytes > 0);
 	for(;;)
 	{
-		const size_t chunksz = MIN(remaining, ncp->chunk);
-		size_t ii;
+		const size_t chunksz = MIN(nbytes, ncp->chunk);
+		size_t done = 0;
 
 		status = ncio_get(ncp->nciop, offset, chunksz,
 				 RGN_WRITE, &xp);
@@ -261,25 +279,15 @@ fill_NC_var(NC3_INFO* ncp, const NC_var *varp, long long varsize, size_t recno)
 			return status;
 		}
 
-		/*
-		 * fill the chunksz buffer in units  of xsz
-		 */
-		for(ii = 0; ii < chunksz/xsz; ii++)
-		{
-			(void) memcpy(xp, xfillp, xsz);
-			xp = (char *)xp + xsz;
-		}
-		/*
-		 * Deal with any remainder
-		 */
+		while(done < chunksz)
 		{
-			const size_t rem = chunksz % xsz;
-			if(rem != 0)
-			{
-				(void) memcpy(xp, xfillp, rem);
-				/* xp = (char *)xp + xsz; */
-			}
-
+			const size_t n = MIN(chunksz - done, patsz - phase);
+			(void) memcpy((char *)xp + done,
+				(const char *)pattern + phase, n);
+			done += n;
+			phase += n;
+			if(phase == patsz)
+				phase = 0;
 		}
 
 		status = ncio_rel(ncp->nciop, offset, RGN_MODIFIED);
@@ -289,8 +297,8 @@ fill_NC_var(NC3_INFO* ncp, const NC_var *varp, long long varsize, size_t recno)
 			break;
 		}
 
-		remaining -= chunksz;
-		if(remaining == 0)
+		nbytes -= chunksz;
+		if(nbytes == 0)
 			break;	/* normal loop exit */
 		offset += chunksz;
 
@@ -298,6 +306,50 @@ fill_NC_var(NC3_INFO* ncp, const NC_var *varp, long long varsize, size_t recno)
 
 	return status;
 }
+
+/*
+ * Fill the external space for variable 'varp' values at 'recno' with
+ * the appropriate value. If 'varp' is not a record variable, fill the
+ * whole thing.  For the special case when 'varp' is the only record
+ * variable and it is of type byte, char, or short, varsize should be
+ * ncp->recsize, otherwise it should be varp->len.
+ * Formerly
+xdr_NC_fill()
+ */
+int
+fill_NC_var(NC3_INFO* ncp, const NC_var *varp, long long varsize, size_t recno)
+{
+	/* enough whole values to cover varsize, up to NC_FILL_BUFSIZE */
+	const size_t patsz = varsize < (long long)NC_FILL_BUFSIZE
+		? _RNDUP((size_t)varsize, varp->xsz)
+		: NC_FILL_BUFSIZE - NC_FILL_BUFSIZE % varp->xsz;
+	void *pattern;
+	off_t offset;
+	int status = NC_NOERR;
+
+	assert(varsize > 0);
+	pattern = malloc(patsz);
+	if(pattern == NULL)
+		return NC_ENOMEM;
+	status = NC_fill_pattern(varp, pattern, patsz);
+	if(status != NC_NOERR)
+		goto done;
+
+	/*
+	 * Copy it out.
+	 */
+
+	offset = varp->begin;
+	if(IS_RECVAR(varp))
+	{
+		offset += (off_t)(ncp->recsize * recno);
+	}
+
+	status = NC_fill_region(ncp, offset, varsize, pattern, patsz);
+done:
+	free(pattern);
+	return status;
+}
 /* End fill */
 
 
@@ -341,6 +393,56 @@ NCfillspecialrecord(NC3_INFO* ncp, const NC_var *varp, size_t recno)
 }
 
 
+/*
+ * Add records cur_nrecs up to numrecs containing the fill values, in
+ * one pass over the file: an image of one record with the fill
+ * values of all the record variables is built, and repeated over all
+ * the new records. The caller makes sure a record is no larger than
+ * NC_FILL_RECMAX.
+ */
+static int
+NCfillrecords(NC3_INFO* ncp, size_t cur_nrecs, size_t numrecs)
+{
+	NC_var **vpp = (NC_var **)ncp->vars.value;
+	NC_var *const *const end = &vpp[ncp->vars.nelems];
+	char *image;
+	int status = NC_NOERR;
+
+	assert(ncp->recsize > 0 && ncp->recsize <= NC_FILL_RECMAX);
+	image = (char *) calloc(1, ncp->recsize);
+	if(image == NULL)
+		return NC_ENOMEM;
+
+	for( /*NADA*/; vpp < end; vpp++)
+	{
+		const NC_var *const varp = *vpp;
+		/* with one record variable there is no record padding */
+		const size_t varsize = (ncp->recsize < varp->len
+					? ncp->recsize : varp->len);
+		if(!IS_RECVAR(varp) || varsize == 0)
+			continue;
+		assert(varp->begin >= ncp->begin_rec
+		       && varp->begin - ncp->begin_rec + (off_t)varsize
+			  <= (off_t)ncp->recsize);
+		status = NC_fill_pattern(varp,
+			image + (varp->begin - ncp->begin_rec),
+			varsize);
+		if(status != NC_NOERR)
+			goto done;
+	}
+
+	status = NC_fill_region(ncp,
+		ncp->begin_rec + (off_t)(ncp->recsize * cur_nrecs),
+		(long long)ncp->recsize * (long long)(numrecs - cur_nrecs),
+		image, ncp->recsize);
+	if(status == NC_NOERR)
+		NC_increase_numrecs(ncp, numrecs);
+done:
+	free(image);
+	return status;
+}
+
+
 /*
  * It is advantageous to
  * #define TOUCH_LAST
@@ -437,7 +539,15 @@ NCvnrecs(NC3_INFO* ncp, size_t numrecs)
 			}
 		    }
 
-		    if (numrecvars != 1) { /* usual case */
+		    if(ncp->recsize > 0 && ncp->recsize <= NC_FILL_RECMAX)
+		    {
+			/* Fill all the new records at once */
+			status = NCfillrecords(ncp, NC_get_numrecs(ncp),
+				numrecs);
+			if(status != NC_NOERR)
+				goto common_return;
+		    }
+		    else if (numrecvars != 1) { /* usual case */
 			/* Fill each record out to numrecs */
 			while((cur_nrecs = NC_get_numrecs(ncp)) < numrecs)
 			    {
@@ -624,9 +734,71 @@ NC_varoffset(const NC3_INFO* ncp, const NC_var *varp, const size_t *coord)
 }
 
 
+/*
+ * Number of items gathered or scattered per conversion call
+ * when the external items are not contiguous.
+ */
+#define NGATHER 512
+
+/*
+ * Return the number of 'xsz'-sized items, 'xstep' bytes apart, that
+ * can be covered by a single ncio_get() of at most ncp->chunk bytes.
+ * Always at least one, at most 'nelems'.
+ */
+static size_t
+NCstridespan(const NC3_INFO* ncp, size_t xsz, off_t xstep, size_t nelems)
+{
+	size_t nspan;
+
+	if(ncp->chunk <= xsz || (size_t)xstep >= ncp->chunk)
+		return 1;
+	nspan = (ncp->chunk - xsz) / (size_t)xstep + 1;
+	return MIN(nspan, nelems);
+}
+
+/*
+ * Get the region (offset, extent) of the file for reading.
+ * Normally this is ncio_get(); with NC_PREAD the region is read
+ * with ncio_read() into *bufp, of size *bufszp, grown as needed and
+ * freed by the caller, so that reads by several threads may overlap.
+ */
+static int
+NC_getregion(const NC3_INFO* ncp, off_t offset, size_t extent,
+	void **bufp, size_t *bufszp, const void **xpp)
+{
+	int status;
+
+	if(!fIsSet(ncp->state, NC_PREAD))
+		return ncio_get(ncp->nciop, offset, extent,
+				 0, (void **)xpp);	/* cast away const */
+	if(extent > *bufszp)
+	{
+		void *buf = realloc(*bufp, extent);
+		if(buf == NULL)
+			return NC_ENOMEM;
+		*bufp = buf;
+		*bufszp = extent;
+	}
+	status = ncio_read(ncp->nciop, offset, extent, *bufp);
+	if(status == NC_NOERR)
+		*xpp = *bufp;
+	return status;
+}
+
+/* Release a region got by NC_getregion(). */
+static void
+NC_relregion(const NC3_INFO* ncp, off_t offset)
+{
+	if(!fIsSet(ncp->state, NC_PREAD))
+		(void) ncio_rel(ncp->nciop, offset, 0);
+}
+
+
 dnl
-dnl Output 'nelems' items of contiguous data of type "Type"
+dnl Output 'nelems' items of data of type "Type"
 dnl for variable 'varp' at 'start'.
+dnl Successive external items are 'xstep' bytes apart;
+dnl xstep == varp->xsz means the items are contiguous.
 dnl "Xtype" had better match 'varp->type'.
 dnl---
 dnl
@@ -636,7 +808,8 @@ define(`PUTNCVX',dnl
 `dnl
 static int
 putNCvx_$1_$2(NC3_INFO* ncp, const NC_var *varp,
-		 const size_t *start, size_t nelems, const $2 *value)
+		 const size_t *start, size_t nelems, off_t xstep,
+		 const $2 *value)
 {
 	off_t offset = NC_varoffset(ncp, varp, start);
 	size_t remaining = varp->xsz * nelems;
@@ -656,6 +829,9 @@ putNCvx_$1_$2(NC3_INFO* ncp, const NC_var *varp,
         status = NC3_inq_var_fill(varp, fillp);
 #endif
 
+	if(xstep != (off_t)varp->xsz)
+		goto strided;
+
 	for(;;)
 	{
 		size_t extent = MIN(remaining, ncp->chunk);
@@ -683,6 +859,49 @@ putNCvx_$1_$2(NC3_INFO* ncp, const NC_var *varp,
 		value += nput;
 
 	}
+	goto done;
+
+strided:
+	/*
+	 * Encode up to NGATHER items into a contiguous buffer, then
+	 * scatter them into as large a region of the file as fits in
+	 * one ncio_get().
+	 */
+	while(nelems > 0)
+	{
+		char xbuf[NGATHER * X_SIZEOF_DOUBLE];
+		size_t nspan = NCstridespan(ncp, varp->xsz, xstep, nelems);
+		size_t extent = (nspan - 1) * (size_t)xstep + varp->xsz;
+		size_t ii;
+
+		int lstatus = ncio_get(ncp->nciop, offset, extent,
+				 RGN_WRITE, &xp);
+		if(lstatus != NC_NOERR)
+			return lstatus;
+
+		for(ii = 0; ii < nspan; )
+		{
+			size_t nput = MIN(nspan - ii, NGATHER);
+			void *bp = xbuf;
+			size_t jj;
+
+			lstatus = ncx_putn_$1_$2(&bp, nput, value ifelse(`$1',`char',,`,fillp'));
+			if(lstatus != NC_NOERR && status == NC_NOERR)
+				status = lstatus;
+			for(jj = 0; jj < nput; jj++, ii++)
+				(void) memcpy((char *)xp + ii * (size_t)xstep,
+					xbuf + jj * varp->xsz, varp->xsz);
+			value += nput;
+		}
+
+		(void) ncio_rel(ncp->nciop, offset,
+				 RGN_MODIFIED);
+
+		nelems -= nspan;
+		offset += (off_t)nspan * xstep;
+	}
+
+done:
 #ifdef ERANGE_FILL
         free(fillp);
 #endif
@@ -803,6 +1022,9 @@ PUTNCVX(ulonglong, ushort)
 PUTNCVX(ulonglong, uint)
 PUTNCVX(ulonglong, ulonglong)
 
+dnl
+dnl Input 'nelems' items of data of type "Type"
+dnl for variable 'varp' at 'start', 'xstep' bytes apart.
 dnl
 dnl GETNCVX(XType, Type)
 dnl
@@ -810,33 +1032,42 @@ define(`GETNCVX',dnl
 `dnl
 static int
 getNCvx_$1_$2(const NC3_INFO* ncp, const NC_var *varp,
-		 const size_t *start, size_t nelems, $2 *value)
+		 const size_t *start, size_t nelems, off_t xstep,
+		 $2 *value)
 {
 	off_t offset = NC_varoffset(ncp, varp, start);
 	size_t remaining = varp->xsz * nelems;
 	int status = NC_NOERR;
 	const void *xp;
+	void *buf = NULL;
+	size_t bufsz = 0;
 
 	if(nelems == 0)
 		return NC_NOERR;
 
 	assert(value != NULL);
 
+	if(xstep != (off_t)varp->xsz)
+		goto strided;
+
 	for(;;)
 	{
 		size_t extent = MIN(remaining, ncp->chunk);
 		size_t nget = ncx_howmany(varp->type, extent);
 
-		int lstatus = ncio_get(ncp->nciop, offset, extent,
-				 0, (void **)&xp);	/* cast away const */
+		int lstatus = NC_getregion(ncp, offset, extent,
+				 &buf, &bufsz, &xp);
 		if(lstatus != NC_NOERR)
-			return lstatus;
+		{
+			status = lstatus;
+			break;
+		}
 
 		lstatus = ncx_getn_$1_$2(&xp, nget, value);
 		if(lstatus != NC_NOERR && status == NC_NOERR)
 			status = lstatus;
 
-		(void) ncio_rel(ncp->nciop, offset, 0);
+		NC_relregion(ncp, offset);
 
 		remaining -= extent;
 		if(remaining == 0)
@@ -844,7 +1075,52 @@ getNCvx_$1_$2(const NC3_INFO* ncp, const NC_var *varp,
 		offset += (off_t)extent;
 		value += nget;
 	}
+	goto done;
 
+strided:
+	/*
+	 * Fault in as large a region as fits in one ncio_get(), then
+	 * gather up to NGATHER items at a time into a contiguous
+	 * buffer and convert them in one call.
+	 */
+	while(nelems > 0)
+	{
+		char xbuf[NGATHER * X_SIZEOF_DOUBLE];
+		size_t nspan = NCstridespan(ncp, varp->xsz, xstep, nelems);
+		size_t extent = (nspan - 1) * (size_t)xstep + varp->xsz;
+		size_t ii;
+
+		int lstatus = NC_getregion(ncp, offset, extent,
+				 &buf, &bufsz, &xp);
+		if(lstatus != NC_NOERR)
+		{
+			status = lstatus;
+			break;
+		}
+
+		for(ii = 0; ii < nspan; )
+		{
+			size_t nget = MIN(nspan - ii, NGATHER);
+			const void *bp = xbuf;
+			size_t jj;
+
+			for(jj = 0; jj < nget; jj++, ii++)
+				(void) memcpy(xbuf + jj * varp->xsz,
+					(const char *)xp + ii * (size_t)xstep, varp->xsz);
+			lstatus = ncx_getn_$1_$2(&bp, nget, value);
+			if(lstatus != NC_NOERR && status == NC_NOERR)
+				status = lstatus;
+			value += nget;
+		}
+
+		NC_relregion(ncp, offset);
+
+		nelems -= nspan;
+		offset += (off_t)nspan * xstep;
+	}
+
+done:
+	free(buf);
 	return status;
 }
 ')dnl
@@ -1133,326 +1409,327 @@ ifelse($1, text,dnl
 
 static int
 readNCv(const NC3_INFO* ncp, const NC_var* varp, const size_t* start,
-        const size_t nelems, void* value, const nc_type memtype)
+        const size_t nelems, const off_t xstep, void* value,
+        const nc_type memtype)
 {
     int status = NC_NOERR;
     switch (CASE(varp->type,memtype)) {
 
     case CASE(NC_CHAR,NC_CHAR):
     case CASE(NC_CHAR,NC_UBYTE):
-    return getNCvx_schar_schar(ncp,varp,start,nelems,(signed char*)value);
+    return getNCvx_schar_schar(ncp,varp,start,nelems,xstep,(signed char*)value);
     break;
     case CASE(NC_BYTE,NC_BYTE):
-        return getNCvx_schar_schar(ncp,varp,start,nelems, (schar*)value);
+        return getNCvx_schar_schar(ncp,varp,start,nelems,xstep,(schar*)value);
 	break;
     case CASE(NC_BYTE,NC_UBYTE):
         if (fIsSet(ncp->flags,NC_64BIT_DATA))
-            return getNCvx_schar_uchar(ncp,varp,start,nelems,(unsigned char*)value);
+            return getNCvx_schar_uchar(ncp,varp,start,nelems,xstep,(unsigned char*)value);
         else
             /* for CDF-1 and CDF-2, NC_BYTE is treated the same type as uchar memtype */
-            return getNCvx_uchar_uchar(ncp,varp,start,nelems,(unsigned char*)value);
+            return getNCvx_uchar_uchar(ncp,varp,start,nelems,xstep,(unsigned char*)value);
 	break;
     case CASE(NC_BYTE,NC_SHORT):
-        return getNCvx_schar_short(ncp,varp,start,nelems,(short*)value);
+        return getNCvx_schar_short(ncp,varp,start,nelems,xstep,(short*)value);
 	break;
     case CASE(NC_BYTE,NC_INT):
-        return getNCvx_schar_int(ncp,varp,start,nelems,(int*)value);
+        return getNCvx_schar_int(ncp,varp,start,nelems,xstep,(int*)value);
 	break;
     case CASE(NC_BYTE,NC_FLOAT):
-        return getNCvx_schar_float(ncp,varp,start,nelems,(float*)value);
+        return getNCvx_schar_float(ncp,varp,start,nelems,xstep,(float*)value);
 	break;
     case CASE(NC_BYTE,NC_DOUBLE):
-        return getNCvx_schar_double(ncp,varp,start,nelems,(double *)value);
+        return getNCvx_schar_double(ncp,varp,start,nelems,xstep,(double *)value);
 	break;
     case CASE(NC_BYTE,NC_INT64):
-        return getNCvx_schar_longlong(ncp,varp,start,nelems,(long long*)value);
+        return getNCvx_schar_longlong(ncp,varp,start,nelems,xstep,(long long*)value);
 	break;
     case CASE(NC_BYTE,NC_UINT):
-        return getNCvx_schar_uint(ncp,varp,start,nelems,(unsigned int*)value);
+        return getNCvx_schar_uint(ncp,varp,start,nelems,xstep,(unsigned int*)value);
 	break;
     case CASE(NC_BYTE,NC_UINT64):
-        return getNCvx_schar_ulonglong(ncp,varp,start,nelems,(unsigned long long*)value);
+        return getNCvx_schar_ulonglong(ncp,varp,start,nelems,xstep,(unsigned long long*)value);
     	break;
     case CASE(NC_BYTE,NC_USHORT):
-        return getNCvx_schar_ushort(ncp,varp,start,nelems,(unsigned short*)value);
+        return getNCvx_schar_ushort(ncp,varp,start,nelems,xstep,(unsigned short*)value);
 	break;
     case CASE(NC_SHORT,NC_BYTE):
-        return getNCvx_short_schar(ncp,varp,start,nelems,(schar*)value);
+        return getNCvx_short_schar(ncp,varp,start,nelems,xstep,(schar*)value);
 	break;
     case CASE(NC_SHORT,NC_UBYTE):
-        return getNCvx_short_uchar(ncp,varp,start,nelems,(unsigned char*)value);
+        return getNCvx_short_uchar(ncp,varp,start,nelems,xstep,(unsigned char*)value);
 	break;
     case CASE(NC_SHORT,NC_SHORT):
-        return getNCvx_short_short(ncp,varp,start,nelems,(short*)value);
+        return getNCvx_short_short(ncp,varp,start,nelems,xstep,(short*)value);
 	break;
     case CASE(NC_SHORT,NC_INT):
-        return getNCvx_short_int(ncp,varp,start,nelems,(int*)value);
+        return getNCvx_short_int(ncp,varp,start,nelems,xstep,(int*)value);
 	break;
    case CASE(NC_SHORT,NC_FLOAT):
-        return getNCvx_short_float(ncp,varp,start,nelems,(float*)value);
+        return getNCvx_short_float(ncp,varp,start,nelems,xstep,(float*)value);
 	break;
     case CASE(NC_SHORT,NC_DOUBLE):
-        return getNCvx_short_double(ncp,varp,start,nelems,(double*)value);
+        return getNCvx_short_double(ncp,varp,start,nelems,xstep,(double*)value);
 	break;
     case CASE(NC_SHORT,NC_INT64):
-        return getNCvx_short_longlong(ncp,varp,start,nelems,(long long*)value);
+        return getNCvx_short_longlong(ncp,varp,start,nelems,xstep,(long long*)value);
    	break;
     case CASE(NC_SHORT,NC_UINT):
-        return getNCvx_short_uint(ncp,varp,start,nelems,(unsigned int*)value);
+        return getNCvx_short_uint(ncp,varp,start,nelems,xstep,(unsigned int*)value);
     	break;
     case CASE(NC_SHORT,NC_UINT64):
-        return getNCvx_short_ulonglong(ncp,varp,start,nelems,(unsigned long long*)value);
+        return getNCvx_short_ulonglong(ncp,varp,start,nelems,xstep,(unsigned long long*)value);
 	break;
     case CASE(NC_SHORT,NC_USHORT):
-        return getNCvx_short_ushort(ncp,varp,start,nelems,(unsigned short*)value);
+        return getNCvx_short_ushort(ncp,varp,start,nelems,xstep,(unsigned short*)value);
 	break;
 
     case CASE(NC_INT,NC_BYTE):
-        return getNCvx_int_schar(ncp,varp,start,nelems,(schar*)value);
+        return getNCvx_int_schar(ncp,varp,start,nelems,xstep,(schar*)value);
 	break;
     case CASE(NC_INT,NC_UBYTE):
-        return getNCvx_int_uchar(ncp,varp,start,nelems,(unsigned char*)value);
+        return getNCvx_int_uchar(ncp,varp,start,nelems,xstep,(unsigned char*)value);
 	break;
     case CASE(NC_INT,NC_SHORT):
-        return getNCvx_int_short(ncp,varp,start,nelems,(short*)value);
+        return getNCvx_int_short(ncp,varp,start,nelems,xstep,(short*)value);
 	break;
     case CASE(NC_INT,NC_INT):
-        return getNCvx_int_int(ncp,varp,start,nelems,(int*)value);
+        return getNCvx_int_int(ncp,varp,start,nelems,xstep,(int*)value);
 	break;
     case CASE(NC_INT,NC_FLOAT):
-        return getNCvx_int_float(ncp,varp,start,nelems,(float*)value);
+        return getNCvx_int_float(ncp,varp,start,nelems,xstep,(float*)value);
 	break;
     case CASE(NC_INT,NC_DOUBLE):
-        return getNCvx_int_double(ncp,varp,start,nelems,(double*)value);
+        return getNCvx_int_double(ncp,varp,start,nelems,xstep,(double*)value);
 	break;
     case CASE(NC_INT,NC_INT64):
-        return getNCvx_int_longlong(ncp,varp,start,nelems,(long long*)value);
+        return getNCvx_int_longlong(ncp,varp,start,nelems,xstep,(long long*)value);
 	break;
     case CASE(NC_INT,NC_UINT):
-        return getNCvx_int_uint(ncp,varp,start,nelems,(unsigned int*)value);
+        return getNCvx_int_uint(ncp,varp,start,nelems,xstep,(unsigned int*)value);
 	break;
     case CASE(NC_INT,NC_UINT64):
-        return getNCvx_int_ulonglong(ncp,varp,start,nelems,(unsigned long long*)value);
+        return getNCvx_int_ulonglong(ncp,varp,start,nelems,xstep,(unsigned long long*)value);
 	break;
     case CASE(NC_INT,NC_USHORT):
-        return getNCvx_int_ushort(ncp,varp,start,nelems,(unsigned short*)value);
+        return getNCvx_int_ushort(ncp,varp,start,nelems,xstep,(unsigned short*)value);
 	break;
 
     case CASE(NC_FLOAT,NC_BYTE):
-        return getNCvx_float_schar(ncp,varp,start,nelems,(schar*)value);
+        return getNCvx_float_schar(ncp,varp,start,nelems,xstep,(schar*)value);
 	break;
     case CASE(NC_FLOAT,NC_UBYTE):
-        return getNCvx_float_uchar(ncp,varp,start,nelems,(unsigned char*)value);
+        return getNCvx_float_uchar(ncp,varp,start,nelems,xstep,(unsigned char*)value);
 	break;
     case CASE(NC_FLOAT,NC_SHORT):
-        return getNCvx_float_short(ncp,varp,start,nelems,(short*)value);
+        return getNCvx_float_short(ncp,varp,start,nelems,xstep,(short*)value);
 	break;
     case CASE(NC_FLOAT,NC_INT):
-        return getNCvx_float_int(ncp,varp,start,nelems,(int*)value);
+        return getNCvx_float_int(ncp,varp,start,nelems,xstep,(int*)value);
 	break;
     case CASE(NC_FLOAT,NC_FLOAT):
-        return getNCvx_float_float(ncp,varp,start,nelems,(float*)value);
+        return getNCvx_float_float(ncp,varp,start,nelems,xstep,(float*)value);
 	break;
     case CASE(NC_FLOAT,NC_DOUBLE):
-        return getNCvx_float_double(ncp,varp,start,nelems,(double*)value);
+        return getNCvx_float_double(ncp,varp,start,nelems,xstep,(double*)value);
 	break;
     case CASE(NC_FLOAT,NC_INT64):
-        return getNCvx_float_longlong(ncp,varp,start,nelems,(long long*)value);
+        return getNCvx_float_longlong(ncp,varp,start,nelems,xstep,(long long*)value);
 	break;
     case CASE(NC_FLOAT,NC_UINT):
-        return getNCvx_float_uint(ncp,varp,start,nelems,(unsigned int*)value);
+        return getNCvx_float_uint(ncp,varp,start,nelems,xstep,(unsigned int*)value);
 	break;
     case CASE(NC_FLOAT,NC_UINT64):
-        return getNCvx_float_ulonglong(ncp,varp,start,nelems,(unsigned long long*)value);
+        return getNCvx_float_ulonglong(ncp,varp,start,nelems,xstep,(unsigned long long*)value);
 	break;
     case CASE(NC_FLOAT,NC_USHORT):
-        return getNCvx_float_ushort(ncp,varp,start,nelems,(unsigned short*)value);
+        return getNCvx_float_ushort(ncp,varp,start,nelems,xstep,(unsigned short*)value);
 	break;
 
     case CASE(NC_DOUBLE,NC_BYTE):
-        return getNCvx_double_schar(ncp,varp,start,nelems,(schar*)value);
+        return getNCvx_double_schar(ncp,varp,start,nelems,xstep,(schar*)value);
 	break;
     case CASE(NC_DOUBLE,NC_UBYTE):
-        return getNCvx_double_uchar(ncp,varp,start,nelems,(unsigned char*)value);
+        return getNCvx_double_uchar(ncp,varp,start,nelems,xstep,(unsigned char*)value);
 	break;
     case CASE(NC_DOUBLE,NC_SHORT):
-        return getNCvx_double_short(ncp,varp,start,nelems,(short*)value);
+        return getNCvx_double_short(ncp,varp,start,nelems,xstep,(short*)value);
 	break;
     case CASE(NC_DOUBLE,NC_INT):
-        return getNCvx_double_int(ncp,varp,start,nelems,(int*)value);
+        return getNCvx_double_int(ncp,varp,start,nelems,xstep,(int*)value);
 	break;
     case CASE(NC_DOUBLE,NC_FLOAT):
-        return getNCvx_double_float(ncp,varp,start,nelems,(float*)value);
+        return getNCvx_double_float(ncp,varp,start,nelems,xstep,(float*)value);
 	break;
     case CASE(NC_DOUBLE,NC_DOUBLE):
-        return getNCvx_double_double(ncp,varp,start,nelems,(double*)value);
+        return getNCvx_double_double(ncp,varp,start,nelems,xstep,(double*)value);
 	break;
     case CASE(NC_DOUBLE,NC_INT64):
-        return getNCvx_double_longlong(ncp,varp,start,nelems,(long long*)value);
+        return getNCvx_double_longlong(ncp,varp,start,nelems,xstep,(long long*)value);
 	break;
     case CASE(NC_DOUBLE,NC_UINT):
-        return getNCvx_double_uint(ncp,varp,start,nelems,(unsigned int*)value);
+        return getNCvx_double_uint(ncp,varp,start,nelems,xstep,(unsigned int*)value);
 	break;
     case CASE(NC_DOUBLE,NC_UINT64):
-        return getNCvx_double_ulonglong(ncp,varp,start,nelems,(unsigned long long*)value);
+        return getNCvx_double_ulonglong(ncp,varp,start,nelems,xstep,(unsigned long long*)value);
 	break;
     case CASE(NC_DOUBLE,NC_USHORT):
-        return getNCvx_double_ushort(ncp,varp,start,nelems,(unsigned short*)value);
+        return getNCvx_double_ushort(ncp,varp,start,nelems,xstep,(unsigned short*)value);
 	break;
 
     case CASE(NC_UBYTE,NC_UBYTE):
-        return getNCvx_uchar_uchar(ncp,varp,start,nelems,(unsigned char*)value);
+        return getNCvx_uchar_uchar(ncp,varp,start,nelems,xstep,(unsigned char*)value);
 	break;
     case CASE(NC_UBYTE,NC_BYTE):
-        return getNCvx_uchar_schar(ncp,varp,start,nelems,(schar*)value);
+        return getNCvx_uchar_schar(ncp,varp,start,nelems,xstep,(schar*)value);
 	break;
     case CASE(NC_UBYTE,NC_SHORT):
-        return getNCvx_uchar_short(ncp,varp,start,nelems,(short*)value);
+        return getNCvx_uchar_short(ncp,varp,start,nelems,xstep,(short*)value);
 	break;
     case CASE(NC_UBYTE,NC_INT):
-        return getNCvx_uchar_int(ncp,varp,start,nelems,(int*)value);
+        return getNCvx_uchar_int(ncp,varp,start,nelems,xstep,(int*)value);
 	break;
     case CASE(NC_UBYTE,NC_FLOAT):
-        return getNCvx_uchar_float(ncp,varp,start,nelems,(float*)value);
+        return getNCvx_uchar_float(ncp,varp,start,nelems,xstep,(float*)value);
 	break;
     case CASE(NC_UBYTE,NC_DOUBLE):
-        return getNCvx_uchar_double(ncp,varp,start,nelems,(double *)value);
+        return getNCvx_uchar_double(ncp,varp,start,nelems,xstep,(double *)value);
 	break;
     case CASE(NC_UBYTE,NC_INT64):
-        return getNCvx_uchar_longlong(ncp,varp,start,nelems,(long long*)value);
+        return getNCvx_uchar_longlong(ncp,varp,start,nelems,xstep,(long long*)value);
 	break;
     case CASE(NC_UBYTE,NC_UINT):
-        return getNCvx_uchar_uint(ncp,varp,start,nelems,(unsigned int*)value);
+        return getNCvx_uchar_uint(ncp,varp,start,nelems,xstep,(unsigned int*)value);
 	break;
     case CASE(NC_UBYTE,NC_UINT64):
-        return getNCvx_uchar_ulonglong(ncp,varp,start,nelems,(unsigned long long*)value);
+        return getNCvx_uchar_ulonglong(ncp,varp,start,nelems,xstep,(unsigned long long*)value);
 	break;
     case CASE(NC_UBYTE,NC_USHORT):
-        return getNCvx_uchar_ushort(ncp,varp,start,nelems,(unsigned short*)value);
+        return getNCvx_uchar_ushort(ncp,varp,start,nelems,xstep,(unsigned short*)value);
 	break;
 
     case CASE(NC_USHORT,NC_BYTE):
-        return getNCvx_ushort_schar(ncp,varp,start,nelems,(schar*)value);
+        return getNCvx_ushort_schar(ncp,varp,start,nelems,xstep,(schar*)value);
 	break;
     case CASE(NC_USHORT,NC_UBYTE):
-        return getNCvx_ushort_uchar(ncp,varp,start,nelems,(unsigned char*)value);
+        return getNCvx_ushort_uchar(ncp,varp,start,nelems,xstep,(unsigned char*)value);
 	break;
     case CASE(NC_USHORT,NC_SHORT):
-        return getNCvx_ushort_short(ncp,varp,start,nelems,(short*)value);
+        return getNCvx_ushort_short(ncp,varp,start,nelems,xstep,(short*)value);
 	break;
     case CASE(NC_USHORT,NC_INT):
-        return getNCvx_ushort_int(ncp,varp,start,nelems,(int*)value);
+        return getNCvx_ushort_int(ncp,varp,start,nelems,xstep,(int*)value);
 	break;
     case CASE(NC_USHORT,NC_FLOAT):
-        return getNCvx_ushort_float(ncp,varp,start,nelems,(float*)value);
+        return getNCvx_ushort_float(ncp,varp,start,nelems,xstep,(float*)value);
 	break;
     case CASE(NC_USHORT,NC_DOUBLE):
-        return getNCvx_ushort_double(ncp,varp,start,nelems,(double*)value);
+        return getNCvx_ushort_double(ncp,varp,start,nelems,xstep,(double*)value);
 	break;
     case CASE(NC_USHORT,NC_INT64):
-        return getNCvx_ushort_longlong(ncp,varp,start,nelems,(long long*)value);
+        return getNCvx_ushort_longlong(ncp,varp,start,nelems,xstep,(long long*)value);
 	break;
     case CASE(NC_USHORT,NC_UINT):
-        return getNCvx_ushort_uint(ncp,varp,start,nelems,(unsigned int*)value);
+        return getNCvx_ushort_uint(ncp,varp,start,nelems,xstep,(unsigned int*)value);
 	break;
     case CASE(NC_USHORT,NC_UINT64):
-        return getNCvx_ushort_ulonglong(ncp,varp,start,nelems,(unsigned long long*)value);
+        return getNCvx_ushort_ulonglong(ncp,varp,start,nelems,xstep,(unsigned long long*)value);
 	break;
     case CASE(NC_USHORT,NC_USHORT):
-        return getNCvx_ushort_ushort(ncp,varp,start,nelems,(unsigned short*)value);
+        return getNCvx_ushort_ushort(ncp,varp,start,nelems,xstep,(unsigned short*)value);
 	break;
 
     case CASE(NC_UINT,NC_BYTE):
-        return getNCvx_uint_schar(ncp,varp,start,nelems,(schar*)value);
+        return getNCvx_uint_schar(ncp,varp,start,nelems,xstep,(schar*)value);
 	break;
     case CASE(NC_UINT,NC_UBYTE):
-        return getNCvx_uint_uchar(ncp,varp,start,nelems,(unsigned char*)value);
+        return getNCvx_uint_uchar(ncp,varp,start,nelems,xstep,(unsigned char*)value);
 	break;
     case CASE(NC_UINT,NC_SHORT):
-        return getNCvx_uint_short(ncp,varp,start,nelems,(short*)value);
+        return getNCvx_uint_short(ncp,varp,start,nelems,xstep,(short*)value);
 	break;
     case CASE(NC_UINT,NC_INT):
-        return getNCvx_uint_int(ncp,varp,start,nelems,(int*)value);
+        return getNCvx_uint_int(ncp,varp,start,nelems,xstep,(int*)value);
 	break;
     case CASE(NC_UINT,NC_FLOAT):
-        return getNCvx_uint_float(ncp,varp,start,nelems,(float*)value);
+        return getNCvx_uint_float(ncp,varp,start,nelems,xstep,(float*)value);
 	break;
     case CASE(NC_UINT,NC_DOUBLE):
-        return getNCvx_uint_double(ncp,varp,start,nelems,(double*)value);
+        return getNCvx_uint_double(ncp,varp,start,nelems,xstep,(double*)value);
 	break;
     case CASE(NC_UINT,NC_INT64):
-        return getNCvx_uint_longlong(ncp,varp,start,nelems,(long long*)value);
+        return getNCvx_uint_longlong(ncp,varp,start,nelems,xstep,(long long*)value);
 	break;
     case CASE(NC_UINT,NC_UINT):
-        return getNCvx_uint_uint(ncp,varp,start,nelems,(unsigned int*)value);
+        return getNCvx_uint_uint(ncp,varp,start,nelems,xstep,(unsigned int*)value);
 	break;
     case CASE(NC_UINT,NC_UINT64):
-        return getNCvx_uint_ulonglong(ncp,varp,start,nelems,(unsigned long long*)value);
+        return getNCvx_uint_ulonglong(ncp,varp,start,nelems,xstep,(unsigned long long*)value);
 	break;
     case CASE(NC_UINT,NC_USHORT):
-        return getNCvx_uint_ushort(ncp,varp,start,nelems,(unsigned short*)value);
+        return getNCvx_uint_ushort(ncp,varp,start,nelems,xstep,(unsigned short*)value);
 	break;
 
     case CASE(NC_INT64,NC_BYTE):
-        return getNCvx_longlong_schar(ncp,varp,start,nelems,(schar*)value);
+        return getNCvx_longlong_schar(ncp,varp,start,nelems,xstep,(schar*)value);
 	break;
     case CASE(NC_INT64,NC_UBYTE):
-        return getNCvx_longlong_uchar(ncp,varp,start,nelems,(unsigned char*)value);
+        return getNCvx_longlong_uchar(ncp,varp,start,nelems,xstep,(unsigned char*)value);
 	break;
     case CASE(NC_INT64,NC_SHORT):
-        return getNCvx_longlong_short(ncp,varp,start,nelems,(short*)value);
+        return getNCvx_longlong_short(ncp,varp,start,nelems,xstep,(short*)value);
 	break;
     case CASE(NC_INT64,NC_INT):
-        return getNCvx_longlong_int(ncp,varp,start,nelems,(int*)value);
+        return getNCvx_longlong_int(ncp,varp,start,nelems,xstep,(int*)value);
 	break;
     case CASE(NC_INT64,NC_FLOAT):
-        return getNCvx_longlong_float(ncp,varp,start,nelems,(float*)value);
+        return getNCvx_longlong_float(ncp,varp,start,nelems,xstep,(float*)value);
 	break;
     case CASE(NC_INT64,NC_DOUBLE):
-        return getNCvx_longlong_double(ncp,varp,start,nelems,(double*)value);
+        return getNCvx_longlong_double(ncp,varp,start,nelems,xstep,(double*)value);
 	break;
     case CASE(NC_INT64,NC_INT64):
-        return getNCvx_longlong_longlong(ncp,varp,start,nelems,(long long*)value);
+        return getNCvx_longlong_longlong(ncp,varp,start,nelems,xstep,(long long*)value);
 	break;
     case CASE(NC_INT64,NC_UINT):
-        return getNCvx_longlong_uint(ncp,varp,start,nelems,(unsigned int*)value);
+        return getNCvx_longlong_uint(ncp,varp,start,nelems,xstep,(unsigned int*)value);
 	break;
     case CASE(NC_INT64,NC_UINT64):
-        return getNCvx_longlong_ulonglong(ncp,varp,start,nelems,(unsigned long long*)value);
+        return getNCvx_longlong_ulonglong(ncp,varp,start,nelems,xstep,(unsigned long long*)value);
 	break;
     case CASE(NC_INT64,NC_USHORT):
-        return getNCvx_longlong_ushort(ncp,varp,start,nelems,(unsigned short*)value);
+        return getNCvx_longlong_ushort(ncp,varp,start,nelems,xstep,(unsigned short*)value);
 	break;
 
     case CASE(NC_UINT64,NC_BYTE):
-        return getNCvx_ulonglong_schar(ncp,varp,start,nelems,(schar*)value);
+        return getNCvx_ulonglong_schar(ncp,varp,start,nelems,xstep,(schar*)value);
 	break;
     case CASE(NC_UINT64,NC_UBYTE):
-        return getNCvx_ulonglong_uchar(ncp,varp,start,nelems,(unsigned char*)value);
+        return getNCvx_ulonglong_uchar(ncp,varp,start,nelems,xstep,(unsigned char*)value);
 	break;
     case CASE(NC_UINT64,NC_SHORT):
-        return getNCvx_ulonglong_short(ncp,varp,start,nelems,(short*)value);
+        return getNCvx_ulonglong_short(ncp,varp,start,nelems,xstep,(short*)value);
 	break;
     case CASE(NC_UINT64,NC_INT):
-        return getNCvx_ulonglong_int(ncp,varp,start,nelems,(int*)value);
+        return getNCvx_ulonglong_int(ncp,varp,start,nelems,xstep,(int*)value);
 	break;
     case CASE(NC_UINT64,NC_FLOAT):
-        return getNCvx_ulonglong_float(ncp,varp,start,nelems,(float*)value);
+        return getNCvx_ulonglong_float(ncp,varp,start,nelems,xstep,(float*)value);
 	break;
     case CASE(NC_UINT64,NC_DOUBLE):
-        return getNCvx_ulonglong_double(ncp,varp,start,nelems,(double*)value);
+        return getNCvx_ulonglong_double(ncp,varp,start,nelems,xstep,(double*)value);
 	break;
     case CASE(NC_UINT64,NC_INT64):
-        return getNCvx_ulonglong_longlong(ncp,varp,start,nelems,(long long*)value);
+        return getNCvx_ulonglong_longlong(ncp,varp,start,nelems,xstep,(long long*)value);
 	break;
     case CASE(NC_UINT64,NC_UINT):
-        return getNCvx_ulonglong_uint(ncp,varp,start,nelems,(unsigned int*)value);
+        return getNCvx_ulonglong_uint(ncp,varp,start,nelems,xstep,(unsigned int*)value);
 	break;
     case CASE(NC_UINT64,NC_UINT64):
-        return getNCvx_ulonglong_ulonglong(ncp,varp,start,nelems,(unsigned long long*)value);
+        return getNCvx_ulonglong_ulonglong(ncp,varp,start,nelems,xstep,(unsigned long long*)value);
 	break;
     case CASE(NC_UINT64,NC_USHORT):
-        return getNCvx_ulonglong_ushort(ncp,varp,start,nelems,(unsigned short*)value);
+        return getNCvx_ulonglong_ushort(ncp,varp,start,nelems,xstep,(unsigned short*)value);
 	break;
 
     default:
@@ -1465,318 +1742,319 @@ readNCv(const NC3_INFO* ncp, const NC_var* varp, const size_t* start,
 
 static int
 writeNCv(NC3_INFO* ncp, const NC_var* varp, const size_t* start,
-         const size_t nelems, const void* value, const nc_type memtype)
+         const size_t nelems, const off_t xstep, const void* value,
+         const nc_type memtype)
 {
     int status = NC_NOERR;
     switch (CASE(varp->type,memtype)) {
 
     case CASE(NC_CHAR,NC_CHAR):
     case CASE(NC_CHAR,NC_UBYTE):
-        return putNCvx_char_char(ncp,varp,start,nelems,(char*)value);
+        return putNCvx_char_char(ncp,varp,start,nelems,xstep,(char*)value);
 	break;
     case CASE(NC_BYTE,NC_BYTE):
-        return putNCvx_schar_schar(ncp,varp,start,nelems,(schar*)value);
+        return putNCvx_schar_schar(ncp,varp,start,nelems,xstep,(schar*)value);
 	break;
     case CASE(NC_BYTE,NC_UBYTE):
         if (fIsSet(ncp->flags,NC_64BIT_DATA))
-            return putNCvx_schar_uchar(ncp,varp,start,nelems,(unsigned char*)value);
+            return putNCvx_schar_uchar(ncp,varp,start,nelems,xstep,(unsigned char*)value);
         else
             /* for CDF-1 and CDF-2, NC_BYTE is treated the same type as uchar memtype */
-            return putNCvx_uchar_uchar(ncp,varp,start,nelems,(unsigned char*)value);
+            return putNCvx_uchar_uchar(ncp,varp,start,nelems,xstep,(unsigned char*)value);
 	break;
     case CASE(NC_BYTE,NC_SHORT):
-        return putNCvx_schar_short(ncp,varp,start,nelems,(short*)value);
+        return putNCvx_schar_short(ncp,varp,start,nelems,xstep,(short*)value);
 	break;
     case CASE(NC_BYTE,NC_INT):
-        return putNCvx_schar_int(ncp,varp,start,nelems,(int*)value);
+        return putNCvx_schar_int(ncp,varp,start,nelems,xstep,(int*)value);
 	break;
     case CASE(NC_BYTE,NC_FLOAT):
-        return putNCvx_schar_float(ncp,varp,start,nelems,(float*)value);
+        return putNCvx_schar_float(ncp,varp,start,nelems,xstep,(float*)value);
 	break;
     case CASE(NC_BYTE,NC_DOUBLE):
-        return putNCvx_schar_double(ncp,varp,start,nelems,(double *)value);
+        return putNCvx_schar_double(ncp,varp,start,nelems,xstep,(double *)value);
 	break;
     case CASE(NC_BYTE,NC_INT64):
-        return putNCvx_schar_longlong(ncp,varp,start,nelems,(long long*)value);
+        return putNCvx_schar_longlong(ncp,varp,start,nelems,xstep,(long long*)value);
 	break;
     case CASE(NC_BYTE,NC_UINT):
-        return putNCvx_schar_uint(ncp,varp,start,nelems,(unsigned int*)value);
+        return putNCvx_schar_uint(ncp,varp,start,nelems,xstep,(unsigned int*)value);
 	break;
     case CASE(NC_BYTE,NC_UINT64):
-        return putNCvx_schar_ulonglong(ncp,varp,start,nelems,(unsigned long long*)value);
+        return putNCvx_schar_ulonglong(ncp,varp,start,nelems,xstep,(unsigned long long*)value);
 	break;
     case CASE(NC_BYTE,NC_USHORT):
-        return putNCvx_schar_ushort(ncp,varp,start,nelems,(unsigned short*)value);
+        return putNCvx_schar_ushort(ncp,varp,start,nelems,xstep,(unsigned short*)value);
 	break;
     case CASE(NC_SHORT,NC_BYTE):
-        return putNCvx_short_schar(ncp,varp,start,nelems,(schar*)value);
+        return putNCvx_short_schar(ncp,varp,start,nelems,xstep,(schar*)value);
 	break;
     case CASE(NC_SHORT,NC_UBYTE):
-        return putNCvx_short_uchar(ncp,varp,start,nelems,(unsigned char*)value);
+        return putNCvx_short_uchar(ncp,varp,start,nelems,xstep,(unsigned char*)value);
 	break;
     case CASE(NC_SHORT,NC_SHORT):
-        return putNCvx_short_short(ncp,varp,start,nelems,(short*)value);
+        return putNCvx_short_short(ncp,varp,start,nelems,xstep,(short*)value);
 	break;
     case CASE(NC_SHORT,NC_INT):
-        return putNCvx_short_int(ncp,varp,start,nelems,(int*)value);
+        return putNCvx_short_int(ncp,varp,start,nelems,xstep,(int*)value);
 	break;
     case CASE(NC_SHORT,NC_FLOAT):
-        return putNCvx_short_float(ncp,varp,start,nelems,(float*)value);
+        return putNCvx_short_float(ncp,varp,start,nelems,xstep,(float*)value);
 	break;
     case CASE(NC_SHORT,NC_DOUBLE):
-        return putNCvx_short_double(ncp,varp,start,nelems,(double*)value);
+        return putNCvx_short_double(ncp,varp,start,nelems,xstep,(double*)value);
 	break;
     case CASE(NC_SHORT,NC_INT64):
-        return putNCvx_short_longlong(ncp,varp,start,nelems,(long long*)value);
+        return putNCvx_short_longlong(ncp,varp,start,nelems,xstep,(long long*)value);
 	break;
     case CASE(NC_SHORT,NC_UINT):
-        return putNCvx_short_uint(ncp,varp,start,nelems,(unsigned int*)value);
+        return putNCvx_short_uint(ncp,varp,start,nelems,xstep,(unsigned int*)value);
 	break;
     case CASE(NC_SHORT,NC_UINT64):
-        return putNCvx_short_ulonglong(ncp,varp,start,nelems,(unsigned long long*)value);
+        return putNCvx_short_ulonglong(ncp,varp,start,nelems,xstep,(unsigned long long*)value);
 	break;
     case CASE(NC_SHORT,NC_USHORT):
-        return putNCvx_short_ushort(ncp,varp,start,nelems,(unsigned short*)value);
+        return putNCvx_short_ushort(ncp,varp,start,nelems,xstep,(unsigned short*)value);
 	break;
     case CASE(NC_INT,NC_BYTE):
-        return putNCvx_int_schar(ncp,varp,start,nelems,(schar*)value);
+        return putNCvx_int_schar(ncp,varp,start,nelems,xstep,(schar*)value);
 	break;
     case CASE(NC_INT,NC_UBYTE):
-        return putNCvx_int_uchar(ncp,varp,start,nelems,(unsigned char*)value);
+        return putNCvx_int_uchar(ncp,varp,start,nelems,xstep,(unsigned char*)value);
 	break;
     case CASE(NC_INT,NC_SHORT):
-        return putNCvx_int_short(ncp,varp,start,nelems,(short*)value);
+        return putNCvx_int_short(ncp,varp,start,nelems,xstep,(short*)value);
 	break;
     case CASE(NC_INT,NC_INT):
-        return putNCvx_int_int(ncp,varp,start,nelems,(int*)value);
+        return putNCvx_int_int(ncp,varp,start,nelems,xstep,(int*)value);
 	break;
     case CASE(NC_INT,NC_FLOAT):
-        return putNCvx_int_float(ncp,varp,start,nelems,(float*)value);
+        return putNCvx_int_float(ncp,varp,start,nelems,xstep,(float*)value);
 	break;
     case CASE(NC_INT,NC_DOUBLE):
-        return putNCvx_int_double(ncp,varp,start,nelems,(double*)value);
+        return putNCvx_int_double(ncp,varp,start,nelems,xstep,(double*)value);
 	break;
     case CASE(NC_INT,NC_INT64):
-        return putNCvx_int_longlong(ncp,varp,start,nelems,(long long*)value);
+        return putNCvx_int_longlong(ncp,varp,start,nelems,xstep,(long long*)value);
 	break;
     case CASE(NC_INT,NC_UINT):
-        return putNCvx_int_uint(ncp,varp,start,nelems,(unsigned int*)value);
+        return putNCvx_int_uint(ncp,varp,start,nelems,xstep,(unsigned int*)value);
 	break;
     case CASE(NC_INT,NC_UINT64):
-        return putNCvx_int_ulonglong(ncp,varp,start,nelems,(unsigned long long*)value);
+        return putNCvx_int_ulonglong(ncp,varp,start,nelems,xstep,(unsigned long long*)value);
 	break;
     case CASE(NC_INT,NC_USHORT):
-        return putNCvx_int_ushort(ncp,varp,start,nelems,(unsigned short*)value);
+        return putNCvx_int_ushort(ncp,varp,start,nelems,xstep,(unsigned short*)value);
 	break;
     case CASE(NC_FLOAT,NC_BYTE):
-        return putNCvx_float_schar(ncp,varp,start,nelems,(schar*)value);
+        return putNCvx_float_schar(ncp,varp,start,nelems,xstep,(schar*)value);
 	break;
     case CASE(NC_FLOAT,NC_UBYTE):
-        return putNCvx_float_uchar(ncp,varp,start,nelems,(unsigned char*)value);
+        return putNCvx_float_uchar(ncp,varp,start,nelems,xstep,(unsigned char*)value);
 	break;
     case CASE(NC_FLOAT,NC_SHORT):
-        return putNCvx_float_short(ncp,varp,start,nelems,(short*)value);
+        return putNCvx_float_short(ncp,varp,start,nelems,xstep,(short*)value);
 	break;
     case CASE(NC_FLOAT,NC_INT):
-        return putNCvx_float_int(ncp,varp,start,nelems,(int*)value);
+        return putNCvx_float_int(ncp,varp,start,nelems,xstep,(int*)value);
 	break;
     case CASE(NC_FLOAT,NC_FLOAT):
-        return putNCvx_float_float(ncp,varp,start,nelems,(float*)value);
+        return putNCvx_float_float(ncp,varp,start,nelems,xstep,(float*)value);
 	break;
     case CASE(NC_FLOAT,NC_DOUBLE):
-        return putNCvx_float_double(ncp,varp,start,nelems,(double*)value);
+        return putNCvx_float_double(ncp,varp,start,nelems,xstep,(double*)value);
 	break;
     case CASE(NC_FLOAT,NC_INT64):
-        return putNCvx_float_longlong(ncp,varp,start,nelems,(long long*)value);
+        return putNCvx_float_longlong(ncp,varp,start,nelems,xstep,(long long*)value);
 	break;
     case CASE(NC_FLOAT,NC_UINT):
-        return putNCvx_float_uint(ncp,varp,start,nelems,(unsigned int*)value);
+        return putNCvx_float_uint(ncp,varp,start,nelems,xstep,(unsigned int*)value);
 	break;
     case CASE(NC_FLOAT,NC_UINT64):
-        return putNCvx_float_ulonglong(ncp,varp,start,nelems,(unsigned long long*)value);
+        return putNCvx_float_ulonglong(ncp,varp,start,nelems,xstep,(unsigned long long*)value);
 	break;
     case CASE(NC_FLOAT,NC_USHORT):
-        return putNCvx_float_ushort(ncp,varp,start,nelems,(unsigned short*)value);
+        return putNCvx_float_ushort(ncp,varp,start,nelems,xstep,(unsigned short*)value);
 	break;
     case CASE(NC_DOUBLE,NC_BYTE):
-        return putNCvx_double_schar(ncp,varp,start,nelems,(schar*)value);
+        return putNCvx_double_schar(ncp,varp,start,nelems,xstep,(schar*)value);
 	break;
     case CASE(NC_DOUBLE,NC_UBYTE):
-        return putNCvx_double_uchar(ncp,varp,start,nelems,(unsigned char*)value);
+        return putNCvx_double_uchar(ncp,varp,start,nelems,xstep,(unsigned char*)value);
 	break;
     case CASE(NC_DOUBLE,NC_SHORT):
-        return putNCvx_double_short(ncp,varp,start,nelems,(short*)value);
+        return putNCvx_double_short(ncp,varp,start,nelems,xstep,(short*)value);
 	break;
     case CASE(NC_DOUBLE,NC_INT):
-        return putNCvx_double_int(ncp,varp,start,nelems,(int*)value);
+        return putNCvx_double_int(ncp,varp,start,nelems,xstep,(int*)value);
 	break;
     case CASE(NC_DOUBLE,NC_FLOAT):
-        return putNCvx_double_float(ncp,varp,start,nelems,(float*)value);
+        return putNCvx_double_float(ncp,varp,start,nelems,xstep,(float*)value);
 	break;
     case CASE(NC_DOUBLE,NC_DOUBLE):
-        return putNCvx_double_double(ncp,varp,start,nelems,(double*)value);
+        return putNCvx_double_double(ncp,varp,start,nelems,xstep,(double*)value);
 	break;
     case CASE(NC_DOUBLE,NC_INT64):
-        return putNCvx_double_longlong(ncp,varp,start,nelems,(long long*)value);
+        return putNCvx_double_longlong(ncp,varp,start,nelems,xstep,(long long*)value);
 	break;
     case CASE(NC_DOUBLE,NC_UINT):
-        return putNCvx_double_uint(ncp,varp,start,nelems,(unsigned int*)value);
+        return putNCvx_double_uint(ncp,varp,start,nelems,xstep,(unsigned int*)value);
 	break;
     case CASE(NC_DOUBLE,NC_UINT64):
-        return putNCvx_double_ulonglong(ncp,varp,start,nelems,(unsigned long long*)value);
+        return putNCvx_double_ulonglong(ncp,varp,start,nelems,xstep,(unsigned long long*)value);
 	break;
     case CASE(NC_DOUBLE,NC_USHORT):
-        return putNCvx_double_ushort(ncp,varp,start,nelems,(unsigned short*)value);
+        return putNCvx_double_ushort(ncp,varp,start,nelems,xstep,(unsigned short*)value);
 	break;
     case CASE(NC_UBYTE,NC_UBYTE):
-        return putNCvx_uchar_uchar(ncp,varp,start,nelems,(unsigned char*)value);
+        return putNCvx_uchar_uchar(ncp,varp,start,nelems,xstep,(unsigned char*)value);
 	break;
     case CASE(NC_UBYTE,NC_BYTE):
-        return putNCvx_uchar_schar(ncp,varp,start,nelems,(schar*)value);
+        return putNCvx_uchar_schar(ncp,varp,start,nelems,xstep,(schar*)value);
 	break;
     case CASE(NC_UBYTE,NC_SHORT):
-        return putNCvx_uchar_short(ncp,varp,start,nelems,(short*)value);
+        return putNCvx_uchar_short(ncp,varp,start,nelems,xstep,(short*)value);
 	break;
     case CASE(NC_UBYTE,NC_INT):
-        return putNCvx_uchar_int(ncp,varp,start,nelems,(int*)value);
+        return putNCvx_uchar_int(ncp,varp,start,nelems,xstep,(int*)value);
 	break;
     case CASE(NC_UBYTE,NC_FLOAT):
-        return putNCvx_uchar_float(ncp,varp,start,nelems,(float*)value);
+        return putNCvx_uchar_float(ncp,varp,start,nelems,xstep,(float*)value);
 	break;
     case CASE(NC_UBYTE,NC_DOUBLE):
-        return putNCvx_uchar_double(ncp,varp,start,nelems,(double *)value);
+        return putNCvx_uchar_double(ncp,varp,start,nelems,xstep,(double *)value);
 	break;
     case CASE(NC_UBYTE,NC_INT64):
-        return putNCvx_uchar_longlong(ncp,varp,start,nelems,(long long*)value);
+        return putNCvx_uchar_longlong(ncp,varp,start,nelems,xstep,(long long*)value);
 	break;
     case CASE(NC_UBYTE,NC_UINT):
-        return putNCvx_uchar_uint(ncp,varp,start,nelems,(unsigned int*)value);
+        return putNCvx_uchar_uint(ncp,varp,start,nelems,xstep,(unsigned int*)value);
 	break;
     case CASE(NC_UBYTE,NC_UINT64):
-        return putNCvx_uchar_ulonglong(ncp,varp,start,nelems,(unsigned long long*)value);
+        return putNCvx_uchar_ulonglong(ncp,varp,start,nelems,xstep,(unsigned long long*)value);
 	break;
     case CASE(NC_UBYTE,NC_USHORT):
-        return putNCvx_uchar_ushort(ncp,varp,start,nelems,(unsigned short*)value);
+        return putNCvx_uchar_ushort(ncp,varp,start,nelems,xstep,(unsigned short*)value);
 	break;
     case CASE(NC_USHORT,NC_BYTE):
-        return putNCvx_ushort_schar(ncp,varp,start,nelems,(schar*)value);
+        return putNCvx_ushort_schar(ncp,varp,start,nelems,xstep,(schar*)value);
 	break;
     case CASE(NC_USHORT,NC_UBYTE):
-        return putNCvx_ushort_uchar(ncp,varp,start,nelems,(unsigned char*)value);
+        return putNCvx_ushort_uchar(ncp,varp,start,nelems,xstep,(unsigned char*)value);
 	break;
     case CASE(NC_USHORT,NC_SHORT):
-        return putNCvx_ushort_short(ncp,varp,start,nelems,(short*)value);
+        return putNCvx_ushort_short(ncp,varp,start,nelems,xstep,(short*)value);
 	break;
     case CASE(NC_USHORT,NC_INT):
-        return putNCvx_ushort_int(ncp,varp,start,nelems,(int*)value);
+        return putNCvx_ushort_int(ncp,varp,start,nelems,xstep,(int*)value);
 	break;
     case CASE(NC_USHORT,NC_FLOAT):
-        return putNCvx_ushort_float(ncp,varp,start,nelems,(float*)value);
+        return putNCvx_ushort_float(ncp,varp,start,nelems,xstep,(float*)value);
 	break;
     case CASE(NC_USHORT,NC_DOUBLE):
-        return putNCvx_ushort_double(ncp,varp,start,nelems,(double*)value);
+        return putNCvx_ushort_double(ncp,varp,start,nelems,xstep,(double*)value);
 	break;
     case CASE(NC_USHORT,NC_INT64):
-        return putNCvx_ushort_longlong(ncp,varp,start,nelems,(long long*)value);
+        return putNCvx_ushort_longlong(ncp,varp,start,nelems,xstep,(long long*)value);
 	break;
     case CASE(NC_USHORT,NC_UINT):
-        return putNCvx_ushort_uint(ncp,varp,start,nelems,(unsigned int*)value);
+        return putNCvx_ushort_uint(ncp,varp,start,nelems,xstep,(unsigned int*)value);
 	break;
     case CASE(NC_USHORT,NC_UINT64):
-        return putNCvx_ushort_ulonglong(ncp,varp,start,nelems,(unsigned long long*)value);
+        return putNCvx_ushort_ulonglong(ncp,varp,start,nelems,xstep,(unsigned long long*)value);
 	break;
     case CASE(NC_USHORT,NC_USHORT):
-        return putNCvx_ushort_ushort(ncp,varp,start,nelems,(unsigned short*)value);
+        return putNCvx_ushort_ushort(ncp,varp,start,nelems,xstep,(unsigned short*)value);
 	break;
     case CASE(NC_UINT,NC_BYTE):
-        return putNCvx_uint_schar(ncp,varp,start,nelems,(schar*)value);
+        return putNCvx_uint_schar(ncp,varp,start,nelems,xstep,(schar*)value);
 	break;
     case CASE(NC_UINT,NC_UBYTE):
-        return putNCvx_uint_uchar(ncp,varp,start,nelems,(unsigned char*)value);
+        return putNCvx_uint_uchar(ncp,varp,start,nelems,xstep,(unsigned char*)value);
 	break;
     case CASE(NC_UINT,NC_SHORT):
-        return putNCvx_uint_short(ncp,varp,start,nelems,(short*)value);
+        return putNCvx_uint_short(ncp,varp,start,nelems,xstep,(short*)value);
 	break;
     case CASE(NC_UINT,NC_INT):
-        return putNCvx_uint_int(ncp,varp,start,nelems,(int*)value);
+        return putNCvx_uint_int(ncp,varp,start,nelems,xstep,(int*)value);
 	break;
     case CASE(NC_UINT,NC_FLOAT):
-        return putNCvx_uint_float(ncp,varp,start,nelems,(float*)value);
+        return putNCvx_uint_float(ncp,varp,start,nelems,xstep,(float*)value);
 	break;
     case CASE(NC_UINT,NC_DOUBLE):
-        return putNCvx_uint_double(ncp,varp,start,nelems,(double*)value);
+        return putNCvx_uint_double(ncp,varp,start,nelems,xstep,(double*)value);
 	break;
     case CASE(NC_UINT,NC_INT64):
-        return putNCvx_uint_longlong(ncp,varp,start,nelems,(long long*)value);
+        return putNCvx_uint_longlong(ncp,varp,start,nelems,xstep,(long long*)value);
 	break;
     case CASE(NC_UINT,NC_UINT):
-        return putNCvx_uint_uint(ncp,varp,start,nelems,(unsigned int*)value);
+        return putNCvx_uint_uint(ncp,varp,start,nelems,xstep,(unsigned int*)value);
 	break;
     case CASE(NC_UINT,NC_UINT64):
-        return putNCvx_uint_ulonglong(ncp,varp,start,nelems,(unsigned long long*)value);
+        return putNCvx_uint_ulonglong(ncp,varp,start,nelems,xstep,(unsigned long long*)value);
 	break;
     case CASE(NC_UINT,NC_USHORT):
-        return putNCvx_uint_ushort(ncp,varp,start,nelems,(unsigned short*)value);
+        return putNCvx_uint_ushort(ncp,varp,start,nelems,xstep,(unsigned short*)value);
 	break;
     case CASE(NC_INT64,NC_BYTE):
-        return putNCvx_longlong_schar(ncp,varp,start,nelems,(schar*)value);
+        return putNCvx_longlong_schar(ncp,varp,start,nelems,xstep,(schar*)value);
 	break;
     case CASE(NC_INT64,NC_UBYTE):
-        return putNCvx_longlong_uchar(ncp,varp,start,nelems,(unsigned char*)value);
+        return putNCvx_longlong_uchar(ncp,varp,start,nelems,xstep,(unsigned char*)value);
 	break;
     case CASE(NC_INT64,NC_SHORT):
-        return putNCvx_longlong_short(ncp,varp,start,nelems,(short*)value);
+        return putNCvx_longlong_short(ncp,varp,start,nelems,xstep,(short*)value);
 	break;
     case CASE(NC_INT64,NC_INT):
-        return putNCvx_longlong_int(ncp,varp,start,nelems,(int*)value);
+        return putNCvx_longlong_int(ncp,varp,start,nelems,xstep,(int*)value);
 	break;
     case CASE(NC_INT64,NC_FLOAT):
-        return putNCvx_longlong_float(ncp,varp,start,nelems,(float*)value);
+        return putNCvx_longlong_float(ncp,varp,start,nelems,xstep,(float*)value);
 	break;
     case CASE(NC_INT64,NC_DOUBLE):
-        return putNCvx_longlong_double(ncp,varp,start,nelems,(double*)value);
+        return putNCvx_longlong_double(ncp,varp,start,nelems,xstep,(double*)value);
 	break;
     case CASE(NC_INT64,NC_INT64):
-        return putNCvx_longlong_longlong(ncp,varp,start,nelems,(long long*)value);
+        return putNCvx_longlong_longlong(ncp,varp,start,nelems,xstep,(long long*)value);
 	break;
     case CASE(NC_INT64,NC_UINT):
-        return putNCvx_longlong_uint(ncp,varp,start,nelems,(unsigned int*)value);
+        return putNCvx_longlong_uint(ncp,varp,start,nelems,xstep,(unsigned int*)value);
 	break;
     case CASE(NC_INT64,NC_UINT64):
-        return putNCvx_longlong_ulonglong(ncp,varp,start,nelems,(unsigned long long*)value);
+        return putNCvx_longlong_ulonglong(ncp,varp,start,nelems,xstep,(unsigned long long*)value);
 	break;
     case CASE(NC_INT64,NC_USHORT):
-        return putNCvx_longlong_ushort(ncp,varp,start,nelems,(unsigned short*)value);
+        return putNCvx_longlong_ushort(ncp,varp,start,nelems,xstep,(unsigned short*)value);
 	break;
     case CASE(NC_UINT64,NC_BYTE):
-        return putNCvx_ulonglong_schar(ncp,varp,start,nelems,(schar*)value);
+        return putNCvx_ulonglong_schar(ncp,varp,start,nelems,xstep,(schar*)value);
 	break;
     case CASE(NC_UINT64,NC_UBYTE):
-        return putNCvx_ulonglong_uchar(ncp,varp,start,nelems,(unsigned char*)value);
+        return putNCvx_ulonglong_uchar(ncp,varp,start,nelems,xstep,(unsigned char*)value);
 	break;
     case CASE(NC_UINT64,NC_SHORT):
-        return putNCvx_ulonglong_short(ncp,varp,start,nelems,(short*)value);
+        return putNCvx_ulonglong_short(ncp,varp,start,nelems,xstep,(short*)value);
 	break;
     case CASE(NC_UINT64,NC_INT):
-        return putNCvx_ulonglong_int(ncp,varp,start,nelems,(int*)value);
+        return putNCvx_ulonglong_int(ncp,varp,start,nelems,xstep,(int*)value);
 	break;
     case CASE(NC_UINT64,NC_FLOAT):
-        return putNCvx_ulonglong_float(ncp,varp,start,nelems,(float*)value);
+        return putNCvx_ulonglong_float(ncp,varp,start,nelems,xstep,(float*)value);
 	break;
     case CASE(NC_UINT64,NC_DOUBLE):
-        return putNCvx_ulonglong_double(ncp,varp,start,nelems,(double*)value);
+        return putNCvx_ulonglong_double(ncp,varp,start,nelems,xstep,(double*)value);
 	break;
     case CASE(NC_UINT64,NC_INT64):
-        return putNCvx_ulonglong_longlong(ncp,varp,start,nelems,(long long*)value);
+        return putNCvx_ulonglong_longlong(ncp,varp,start,nelems,xstep,(long long*)value);
 	break;
     case CASE(NC_UINT64,NC_UINT):
-        return putNCvx_ulonglong_uint(ncp,varp,start,nelems,(unsigned int*)value);
+        return putNCvx_ulonglong_uint(ncp,varp,start,nelems,xstep,(unsigned int*)value);
 	break;
     case CASE(NC_UINT64,NC_UINT64):
-        return putNCvx_ulonglong_ulonglong(ncp,varp,start,nelems,(unsigned long long*)value);
+        return putNCvx_ulonglong_ulonglong(ncp,varp,start,nelems,xstep,(unsigned long long*)value);
 	break;
     case CASE(NC_UINT64,NC_USHORT):
-        return putNCvx_ulonglong_ushort(ncp,varp,start,nelems,(unsigned short*)value);
+        return putNCvx_ulonglong_ushort(ncp,varp,start,nelems,xstep,(unsigned short*)value);
 	break;
 
     default:
@@ -1850,7 +2128,7 @@ NC3_get_vara(int ncid, int varid,
 
     if(varp->ndims == 0) /* scalar variable */
     {
-        return( readNCv(nc3, varp, start, 1, (void*)value, memtype) );
+        return( readNCv(nc3, varp, start, 1, (off_t)varp->xsz, (void*)value, memtype) );
     }
 
     if(IS_RECVAR(varp))
@@ -1860,7 +2138,7 @@ NC3_get_vara(int ncid, int varid,
         if(varp->ndims == 1 && nc3->recsize <= varp->len)
         {
             /* one dimensional && the only record variable  */
-            return( readNCv(nc3, varp, start, *edges, (void*)value, memtype) );
+            return( readNCv(nc3, varp, start, *edges, (off_t)varp->xsz, (void*)value, memtype) );
         }
     }
 
@@ -1872,7 +2150,7 @@ NC3_get_vara(int ncid, int varid,
 
     if(ii == -1)
     {
-        return( readNCv(nc3, varp, start, iocount, (void*)value, memtype) );
+        return( readNCv(nc3, varp, start, iocount, (off_t)varp->xsz, (void*)value, memtype) );
     }
 
     assert(ii >= 0);
@@ -1891,7 +2169,7 @@ NC3_get_vara(int ncid, int varid,
     /* ripple counter */
     while(*coord < *upper)
     {
-        const int lstatus = readNCv(nc3, varp, coord, iocount, (void*)value, memtype);
+        const int lstatus = readNCv(nc3, varp, coord, iocount, (off_t)varp->xsz, (void*)value, memtype);
 	if(lstatus != NC_NOERR)
         {
             if(lstatus != NC_ERANGE)
@@ -1980,7 +2258,7 @@ NC3_put_vara(int ncid, int varid,
 
     if(varp->ndims == 0) /* scalar variable */
     {
-        return( writeNCv(nc3, varp, start, 1, (void*)value, memtype) );
+        return( writeNCv(nc3, varp, start, 1, (off_t)varp->xsz, (void*)value, memtype) );
     }
 
     if(IS_RECVAR(varp))
@@ -1993,7 +2271,7 @@ NC3_put_vara(int ncid, int varid,
             && nc3->recsize <= varp->len)
         {
             /* one dimensional && the only record variable  */
-            return( writeNCv(nc3, varp, start, *edges, (void*)value, memtype) );
+            return( writeNCv(nc3, varp, start, *edges, (off_t)varp->xsz, (void*)value, memtype) );
         }
     }
 
@@ -2005,7 +2283,7 @@ NC3_put_vara(int ncid, int varid,
 
     if(ii == -1)
     {
-        return( writeNCv(nc3, varp, start, iocount, (void*)value, memtype) );
+        return( writeNCv(nc3, varp, start, iocount, (off_t)varp->xsz, (void*)value, memtype) );
     }
 
     assert(ii >= 0);
@@ -2024,7 +2302,7 @@ NC3_put_vara(int ncid, int varid,
     /* ripple counter */
     while(*coord < *upper)
     {
-        const int lstatus = writeNCv(nc3, varp, coord, iocount, (void*)value, memtype);
+        const int lstatus = writeNCv(nc3, varp, coord, iocount, (off_t)varp->xsz, (void*)value, memtype);
         if(lstatus != NC_NOERR)
         {
             if(lstatus != NC_ERANGE)
@@ -2047,3 +2325,265 @@ NC3_put_vara(int ncid, int varid,
 
     return status;
 }
+
+/*
+ * Check 'stride' for the variable and compute in 'extents' the number
+ * of indices spanned along each dimension by 'edges' and 'stride',
+ * so that the usual coordinate and edge checks can be applied.
+ * Sets *isunitp if every stride is one.
+ */
+static int
+NCstrideck(const NC_var *varp, const size_t *edges, const ptrdiff_t *stride,
+	size_t *extents, int *isunitp)
+{
+	size_t ii;
+
+	*isunitp = 1;
+	for(ii = 0; ii < varp->ndims; ii++)
+	{
+		/* cast needed for braindead systems with signed size_t */
+		if(stride[ii] <= 0 || (unsigned long) stride[ii] >= X_INT_MAX)
+			return NC_ESTRIDE;
+		if(stride[ii] != 1)
+			*isunitp = 0;
+		extents[ii] = (edges[ii] == 0 ? 0
+			: (edges[ii] - 1) * (size_t)stride[ii] + 1);
+	}
+	return NC_NOERR;
+}
+
+
+/*
+ * Byte distance in the file between successive elements along the
+ * innermost dimension, given the stride along that dimension.
+ */
+static off_t
+NCstridestep(const NC3_INFO* ncp, const NC_var *varp, const ptrdiff_t *stride)
+{
+	const ptrdiff_t step = stride[varp->ndims - 1];
+
+	if(varp->ndims == 1 && IS_RECVAR(varp))
+		return (off_t)step * (off_t)ncp->recsize;
+	return (off_t)step * (off_t)varp->xsz;
+}
+
+
+/*
+ * Advance 'coord' to the start of the next run along the innermost
+ * dimension. Returns zero when the walk is complete.
+ */
+static int
+NCstridenext(const NC_var *varp, const size_t *start, const size_t *edges,
+	const ptrdiff_t *stride, size_t *coord)
+{
+	int ii;
+
+	for(ii = (int)varp->ndims - 2; ii >= 0; ii--)
+	{
+		coord[ii] += (size_t)stride[ii];
+		if(coord[ii] < start[ii] + edges[ii] * (size_t)stride[ii])
+			return 1;
+		coord[ii] = start[ii];
+	}
+	return 0;
+}
+
+
+/*
+ * Strided access is done one run along the innermost dimension at a
+ * time. Each run is transferred by readNCv()/writeNCv() with the
+ * file distance between its elements, so a run costs a few page
+ * sized ncio_get() calls rather than one dispatch call per element.
+ */
+int
+NC3_get_vars(int ncid, int varid,
+	    const size_t *start, const size_t *edges,
+	    const ptrdiff_t *stride,
+            void *value0,
+	    nc_type memtype)
+{
+    int status = NC_NOERR;
+    NC* nc;
+    NC3_INFO* nc3;
+    NC_var *varp;
+    int isunit;
+    size_t ii;
+    size_t memtypelen;
+    size_t runlen;
+    off_t xstep;
+    signed char* value = (signed char*) value0; /* legally allow ptr arithmetic */
+    size_t extents[NC_MAX_VAR_DIMS];
+    size_t coord[NC_MAX_VAR_DIMS];
+
+    if(stride == NULL || edges == NULL)
+        return NC3_get_vara(ncid, varid, start, edges, value0, memtype);
+
+    status = NC_check_id(ncid, &nc);
+    if(status != NC_NOERR)
+        return status;
+    nc3 = NC3_DATA(nc);
+
+    if(NC_indef(nc3))
+        return NC_EINDEFINE;
+
+    status = NC_lookupvar(nc3, varid, &varp);
+    if(status != NC_NOERR)
+        return status;
+
+    if(memtype == NC_NAT) memtype=varp->type;
+
+    if(memtype == NC_CHAR && varp->type != NC_CHAR)
+        return NC_ECHAR;
+    else if(memtype != NC_CHAR && varp->type == NC_CHAR)
+        return NC_ECHAR;
+
+    if(varp->ndims == 0) /* scalar variable */
+        return NC3_get_vara(ncid, varid, start, edges, value0, memtype);
+
+    status = NCcoordck(nc3, varp, start);
+    if(status != NC_NOERR)
+        return status;
+
+    status = NCstrideck(varp, edges, stride, extents, &isunit);
+    if(status != NC_NOERR)
+        return status;
+
+    if(isunit)
+        return NC3_get_vara(ncid, varid, start, edges, value0, memtype);
+
+    status = NCedgeck(nc3, varp, start, extents);
+    if(status != NC_NOERR)
+        return status;
+
+    if(IS_RECVAR(varp) && *start + *extents > NC_get_numrecs(nc3))
+        return NC_EEDGE;
+
+    for(ii = 0; ii < varp->ndims; ii++)
+        if(edges[ii] == 0)
+            return NC_NOERR; /* cannot read anything */
+
+    memtypelen = (size_t)nctypelen(memtype);
+    runlen = edges[varp->ndims - 1];
+    xstep = NCstridestep(nc3, varp, stride);
+
+    (void) memcpy(coord, start, varp->ndims * sizeof(size_t));
+
+    do {
+        const int lstatus = readNCv(nc3, varp, coord, runlen, xstep, (void*)value, memtype);
+	if(lstatus != NC_NOERR)
+        {
+            if(lstatus != NC_ERANGE)
+            {
+                status = lstatus;
+                /* fatal for the loop */
+                break;
+            }
+            /* else NC_ERANGE, not fatal for the loop */
+            if(status == NC_NOERR)
+                status = lstatus;
+        }
+        value += (runlen * memtypelen);
+    } while(NCstridenext(varp, start, edges, stride, coord));
+
+    return status;
+}
+
+int
+NC3_put_vars(int ncid, int varid,
+	    const size_t *start, const size_t *edges,
+	    const ptrdiff_t *stride,
+            const void *value0,
+	    nc_type memtype)
+{
+    int status = NC_NOERR;
+    NC *nc;
+    NC3_INFO* nc3;
+    NC_var *varp;
+    int isunit;
+    size_t ii;
+    size_t memtypelen;
+    size_t runlen;
+    off_t xstep;
+    signed char* value = (signed char*) value0; /* legally allow ptr arithmetic */
+    size_t extents[NC_MAX_VAR_DIMS];
+    size_t coord[NC_MAX_VAR_DIMS];
+
+    if(stride == NULL || edges == NULL)
+        return NC3_put_vara(ncid, varid, start, edges, value0, memtype);
+
+    status = NC_check_id(ncid, &nc);
+    if(status != NC_NOERR)
+        return status;
+    nc3 = NC3_DATA(nc);
+
+    if(NC_readonly(nc3))
+        return NC_EPERM;
+
+    if(NC_indef(nc3))
+        return NC_EINDEFINE;
+
+    status = NC_lookupvar(nc3, varid, &varp);
+    if(status != NC_NOERR)
+       return status; /*invalid varid */
+
+    if(memtype == NC_NAT) memtype=varp->type;
+
+    if(memtype == NC_CHAR && varp->type != NC_CHAR)
+        return NC_ECHAR;
+    else if(memtype != NC_CHAR && varp->type == NC_CHAR)
+        return NC_ECHAR;
+
+    if(varp->ndims == 0) /* scalar variable */
+        return NC3_put_vara(ncid, varid, start, edges, value0, memtype);
+
+    status = NCcoordck(nc3, varp, start);
+    if(status != NC_NOERR)
+        return status;
+
+    status = NCstrideck(varp, edges, stride, extents, &isunit);
+    if(status != NC_NOERR)
+        return status;
+
+    if(isunit)
+        return NC3_put_vara(ncid, varid, start, edges, value0, memtype);
+
+    status = NCedgeck(nc3, varp, start, extents);
+    if(status != NC_NOERR)
+        return status;
+
+    for(ii = 0; ii < varp->ndims; ii++)
+        if(edges[ii] == 0)
+            return NC_NOERR; /* cannot write anything */
+
+    if(IS_RECVAR(varp))
+    {
+        status = NCvnrecs(nc3, *start + *extents);
+        if(status != NC_NOERR)
+            return status;
+    }
+
+    memtypelen = (size_t)nctypelen(memtype);
+    runlen = edges[varp->ndims - 1];
+    xstep = NCstridestep(nc3, varp, stride);
+
+    (void) memcpy(coord, start, varp->ndims * sizeof(size_t));
+
+    do {
+        const int lstatus = writeNCv(nc3, varp, coord, runlen, xstep, (void*)value, memtype);
+        if(lstatus != NC_NOERR)
+        {
+            if(lstatus != NC_ERANGE)
+            {
+                status = lstatus;
+                /* fatal for the loop */
+                break;
+            }
+            /* else NC_ERANGE, not fatal for the loop */
+            if(status == NC_NOERR)
+                status = lstatus;
+        }
+        value += (runlen * memtypelen);
+    } while(NCstridenext(varp, start, edges, stride, coord));
+
+    return status;
+}
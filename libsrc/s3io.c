@@ -92,6 +92,7 @@ s3io_new(const char* path, int ioflags, ncio** nciopp, NCS3IO** hpp)
     *((ncio_filesizefunc**)&nciop->filesize) = s3io_filesize;
     *((ncio_pad_lengthfunc**)&nciop->pad_length) = s3io_pad_length;
     *((ncio_closefunc**)&nciop->close) = s3io_close;
+    *((ncio_readfunc**)&nciop->read) = NULL;
 
     s3io = (NCS3IO*)calloc(1,sizeof(NCS3IO));
     if(s3io == NULL) {status = NC_ENOMEM; goto fail;}
@@ -38,6 +38,10 @@ static const schar ncmagic[] = {'C', 'D', 'F', 0x02};
 static const schar ncmagic1[] = {'C', 'D', 'F', 0x01};
 static const schar ncmagic5[] = {'C', 'D', 'F', 0x05};
 
+/* How much of the file nc_get_NC() reads first, if the header size is
+ * not yet known. */
+#define NC_HDR_FIRSTREAD ((size_t)64 * 1024)
+
 /*
  * v1hs == "Version 1 Header Stream"
  *
@@ -46,6 +50,12 @@ static const schar ncmagic5[] = {'C', 'D', 'F', 0x05};
  * So, we don't know how much to get() on
  * the initial read. We build a stream, 'v1hs'
  * on top of ncio to do the header get.
+ *
+ * When reading a file header the stream instead keeps its own copy of
+ * the header, read with ncio_read() and doubled in size whenever more
+ * is wanted, so that a large header takes a few reads rather than one
+ * per chunk. Attributes can be decoded later from the copy, see
+ * NC_loadattrs().
  */
 typedef struct v1hs {
 	ncio *nciop;
@@ -53,6 +63,7 @@ typedef struct v1hs {
 	size_t extent;	/* argument to nciop->get() */
 	int flags;	/* set to RGN_WRITE for write */
         int version;    /* format variant: NC_FORMAT_CLASSIC, NC_FORMAT_64BIT_OFFSET or NC_FORMAT_CDF5 */
+	int copy;	/* base is our copy of the header, see above */
 	void *base;	/* beginning of current buffer */
 	void *pos;	/* current position in buffer */
 	void *end;	/* end of current buffer = base + extent */
@@ -77,6 +88,46 @@ rel_v1hs(v1hs *gsp)
 }
 
 
+/*
+ * Read more of the header into the stream's copy, so that 'extent'
+ * bytes are available at gsp->pos. Also used for the first read.
+ */
+static int
+grow_v1hs(v1hs *gsp, size_t extent)
+{
+	int status;
+	off_t filesize;
+	const size_t have = gsp->extent;
+	const size_t used = (size_t)((char *)gsp->pos - (char *)gsp->base);
+	size_t want = 2 * have;
+	void *base;
+
+	if(want < used + extent)
+		want = used + extent;
+
+	status = ncio_filesize(gsp->nciop, &filesize);
+	if(status)
+		return status;
+	if(extent > SIZE_MAX - used
+		|| (off_t)(used + extent) > filesize - gsp->offset)
+		return NC_ENOTNC; /* header runs past the end of the file */
+	if((off_t)want > filesize - gsp->offset)
+		want = (size_t)(filesize - gsp->offset);
+	want = _RNDUP(want, X_ALIGN);
+
+	base = realloc(gsp->base, want);
+	if(base == NULL)
+		return NC_ENOMEM;
+	status = ncio_read(gsp->nciop, gsp->offset + (off_t)have,
+			want - have, (char *)base + have);
+	gsp->base = base;
+	gsp->pos = (char *)base + used;
+	gsp->end = (char *)base + want;
+	gsp->extent = want;
+	return status;
+}
+
+
 /*
  * Release the current chunk and get the next one.
  * Also used for initialization when gsp->base == NULL.
@@ -86,6 +137,11 @@ fault_v1hs(v1hs *gsp, size_t extent)
 {
 	int status;
 
+	if(gsp->copy)
+		return grow_v1hs(gsp, extent);
+	if(gsp->nciop == NULL)
+		return NC_ENOTNC;	/* decoding from memory, ran off the end */
+
 	if(gsp->base != NULL)
 	{
 		const ptrdiff_t incr = (char *)gsp->pos - (char *)gsp->base;
@@ -796,6 +852,8 @@ ncx_len_NC_attrarray(const NC_attrarray *ncap, int version)
 	xlen += (version == 5) ? X_SIZEOF_INT64 : X_SIZEOF_SIZE_T; /* count */
 	if(ncap == NULL)
 		return xlen;
+	if(ncap->xattrs != NULL)
+		return ncap->xlen;	/* not decoded, as in the header */
 	/* else */
 	{
 		const NC_attr **app = (const NC_attr **)ncap->value;
@@ -820,6 +878,26 @@ v1h_put_NC_attrarray(v1hs *psp, const NC_attrarray *ncap)
 
 	assert(psp != NULL);
 
+	if(ncap != NULL && ncap->xattrs != NULL)
+	{
+		/* Never decoded: write it back as it was read */
+		const char *xp = (const char *)ncap->xattrs;
+		size_t remaining = ncap->xlen;
+		assert(ncap->version == psp->version);
+		do {
+			const size_t nbytes = MIN(psp->extent, remaining);
+
+			status = check_v1hs(psp, nbytes);
+			if(status != NC_NOERR)
+				return status;
+			(void) memcpy(psp->pos, xp, nbytes);
+			psp->pos = (void *)((char *)psp->pos + nbytes);
+			xp += nbytes;
+			remaining -= nbytes;
+		} while(remaining != 0);
+		return NC_NOERR;
+	}
+
 	if(ncap == NULL
 #if 1
 		/* Backward:
@@ -867,6 +945,80 @@ v1h_put_NC_attrarray(v1hs *psp, const NC_attrarray *ncap)
 }
 
 
+/*
+ * Step over a NC_attrarray in the header, noting where it is so that
+ * NC_loadattrs() can decode it when it is first used. Until the whole
+ * header is read, ncap->xattrs holds the array's offset in the header,
+ * as the copy of the header may move while it grows.
+ */
+static int
+v1h_skip_NC_attrarray(v1hs *gsp, NC_attrarray *ncap)
+{
+	int status;
+	NCtype type = NC_UNSPECIFIED;
+	const size_t start = (size_t)((char *)gsp->pos - (char *)gsp->base);
+	size_t nelems;
+	size_t i;
+
+	assert(gsp != NULL && gsp->pos != NULL);
+	assert(ncap != NULL);
+	assert(ncap->value == NULL && ncap->xattrs == NULL);
+
+	status = v1h_get_NCtype(gsp, &type);
+    if(status != NC_NOERR)
+		return status;
+	status = v1h_get_size_t(gsp, &nelems);
+    if(status != NC_NOERR)
+		return status;
+
+	if(nelems == 0)
+        return NC_NOERR;
+	/* else */
+	if(type != NC_ATTRIBUTE)
+		return EINVAL;
+
+	for(i = 0; i < nelems; i++)
+	{
+		size_t nchars, count, xsz, len;
+		nc_type atype;
+
+		status = v1h_get_size_t(gsp, &nchars);
+		if(status != NC_NOERR)
+			return status;
+		if(nchars > SIZE_MAX - X_ALIGN)
+			return NC_ERANGE;
+		xsz = _RNDUP(nchars, X_ALIGN);
+		status = check_v1hs(gsp, xsz);
+		if(status != NC_NOERR)
+			return status;
+		gsp->pos = (char *)gsp->pos + xsz;
+
+		status = v1h_get_nc_type(gsp, &atype);
+		if(status != NC_NOERR)
+			return status;
+		if(atype == NC_STRING)
+			return NC_EINVAL;
+		status = v1h_get_size_t(gsp, &count);
+		if(status != NC_NOERR)
+			return status;
+		len = ncmpix_len_nctype(atype);
+		if(count > (SIZE_MAX - X_ALIGN) / len)
+			return NC_ERANGE;
+		xsz = _RNDUP(count * len, X_ALIGN);
+		status = check_v1hs(gsp, xsz);
+		if(status != NC_NOERR)
+			return status;
+		gsp->pos = (char *)gsp->pos + xsz;
+	}
+
+	ncap->nelems = nelems;
+	ncap->xattrs = (const void *)(uintptr_t)start;
+	ncap->xlen = (size_t)((char *)gsp->pos - (char *)gsp->base) - start;
+	ncap->version = gsp->version;
+	return NC_NOERR;
+}
+
+
 /* Read a NC_attrarray from the header */
 static int
 v1h_get_NC_attrarray(v1hs *gsp, NC_attrarray *ncap)
@@ -914,6 +1066,45 @@ v1h_get_NC_attrarray(v1hs *gsp, NC_attrarray *ncap)
     return NC_NOERR;
 }
 
+/*
+ * Decode the attributes left in the header image by
+ * v1h_skip_NC_attrarray(), if that has not been done yet.
+ */
+int
+NC_loadattrs(NC_attrarray *ncap)
+{
+	int status;
+	v1hs gs;
+	NC_attrarray pending;
+
+	assert(ncap != NULL);
+	if(ncap->xattrs == NULL)
+		return NC_NOERR;
+
+	gs.nciop = NULL;
+	gs.offset = 0;
+	gs.extent = ncap->xlen;
+	gs.flags = 0;
+	gs.version = ncap->version;
+	gs.copy = 0;
+	gs.base = (void *)ncap->xattrs;
+	gs.pos = gs.base;
+	gs.end = (char *)gs.base + gs.extent;
+
+	pending = *ncap;
+	ncap->xattrs = NULL;
+	ncap->nelems = 0;
+	status = v1h_get_NC_attrarray(&gs, ncap);
+	if(status != NC_NOERR)
+	{
+		*ncap = pending;	/* leave it to fail the same way next time */
+		return status;
+	}
+	assert(ncap->nelems == pending.nelems);
+	assert(gs.pos == gs.end);
+	return NC_NOERR;
+}
+
 /* End NC_attr */
 /* Begin NC_var */
 
@@ -1062,7 +1253,7 @@ v1h_get_NC_var(v1hs *gsp, NC_var **varpp)
         if(status != NC_NOERR)
 		goto unwind_alloc;
 	}
-	status = v1h_get_NC_attrarray(gsp, &varp->attrs);
+	status = v1h_skip_NC_attrarray(gsp, &varp->attrs);
     if(status != NC_NOERR)
 		goto unwind_alloc;
 	status = v1h_get_nc_type(gsp, &varp->type);
@@ -1352,6 +1543,7 @@ ncx_put_NC(const NC3_INFO* ncp, void **xpp, off_t offset, size_t extent)
 
 	ps.nciop = ncp->nciop;
 	ps.flags = RGN_WRITE;
+	ps.copy = 0;
 
 	if (ncp->flags & NC_64BIT_DATA)
 	  ps.version = 5;
@@ -1454,41 +1646,39 @@ nc_get_NC(NC3_INFO* ncp)
 	gs.extent = 0;
 	gs.flags = 0;
 	gs.version = 0;
+	gs.copy = 1;
 	gs.base = NULL;
 	gs.pos = gs.base;
 
+	/* Drop the header copy left by an earlier read */
+	free(ncp->xhdr);
+	ncp->xhdr = NULL;
+
 	{
 		/*
-		 * Come up with a reasonable stream read size.
+		 * Come up with a reasonable first read size: the size of
+		 * the header when it is known, else NC_HDR_FIRSTREAD.
+		 * The stream reads more as needed.
 		 */
 	        off_t filesize;
 		size_t extent = ncp->xsz;
 
-		if(extent <= ((fIsSet(ncp->flags, NC_64BIT_DATA))?MIN_NC5_XSZ:MIN_NC3_XSZ))
-		{
-		        status = ncio_filesize(ncp->nciop, &filesize);
-			if(status)
-			    return status;
-			if(filesize < sizeof(ncmagic)) { /* too small, not netcdf */
+		status = ncio_filesize(ncp->nciop, &filesize);
+		if(status)
+		    return status;
+		if(filesize < sizeof(ncmagic)) { /* too small, not netcdf */
 
-			    status = NC_ENOTNC;
-			    return status;
-			}
-			/* first time read */
-			extent = ncp->chunk;
-			/* Protection for when ncp->chunk is huge;
-			 * no need to read hugely. */
-	      		if(extent > 4096)
-				extent = 4096;
-			if(extent > filesize)
-			        extent = (size_t)filesize;
+		    status = NC_ENOTNC;
+		    return status;
 		}
-		else if(extent > ncp->chunk)
-		    extent = ncp->chunk;
+		if(extent <= ((fIsSet(ncp->flags, NC_64BIT_DATA))?MIN_NC5_XSZ:MIN_NC3_XSZ))
+			extent = NC_HDR_FIRSTREAD;
+		if(extent > filesize)
+		        extent = (size_t)filesize;
 
 		/*
-		 * Invalidate the I/O buffers to force a read of the header
-		 * region.
+		 * Flush the I/O buffers, as the header is read
+		 * around them.
 		 */
 		status = ncio_sync(gs.nciop);
 		if(status)
@@ -1496,7 +1686,7 @@ nc_get_NC(NC3_INFO* ncp)
 
 		status = fault_v1hs(&gs, extent);
 		if(status)
-			return status;
+			goto unwind_get;
 	}
 
 	/* get the header from the stream gs */
@@ -1506,6 +1696,11 @@ nc_get_NC(NC3_INFO* ncp)
 		schar magic[sizeof(ncmagic)];
 		(void) memset(magic, 0, sizeof(magic));
 
+		/* room for the magic number and numrecs */
+		status = check_v1hs(&gs, sizeof(magic) + X_SIZEOF_INT64);
+		if(status != NC_NOERR)
+			goto unwind_get;
+
 		status = ncx_getn_schar_schar(
 			(const void **)(&gs.pos), sizeof(magic), magic);
         if(status != NC_NOERR)
@@ -1557,7 +1752,7 @@ nc_get_NC(NC3_INFO* ncp)
     if(status != NC_NOERR)
 		goto unwind_get;
 
-	status = v1h_get_NC_attrarray(&gs, &ncp->attrs);
+	status = v1h_skip_NC_attrarray(&gs, &ncp->attrs);
     if(status != NC_NOERR)
 		goto unwind_get;
 
@@ -1565,6 +1760,29 @@ nc_get_NC(NC3_INFO* ncp)
     if(status != NC_NOERR)
 		goto unwind_get;
 
+	/* Now the copy of the header stays put, point the attributes
+	 * still to be decoded into it. */
+	{
+		size_t i;
+		int keep = 0;
+		for(i = 0; i <= ncp->vars.nelems; i++)
+		{
+			NC_attrarray *ncap = (i == ncp->vars.nelems)
+				? &ncp->attrs : &ncp->vars.value[i]->attrs;
+			if(ncap->xattrs != NULL)
+			{
+				ncap->xattrs = (char *)gs.base
+					+ (uintptr_t)ncap->xattrs;
+				keep = 1;
+			}
+		}
+		if(keep)
+		{
+			ncp->xhdr = gs.base;
+			gs.base = NULL;
+		}
+	}
+
 	ncp->xsz = ncx_len_NC(ncp, (gs.version == 1) ? 4 : 8);
 
 	status = NC_computeshapes(ncp);
@@ -1580,6 +1798,14 @@ nc_get_NC(NC3_INFO* ncp)
 		goto unwind_get;
 
 unwind_get:
-	(void) rel_v1hs(&gs);
+	if(status != NC_NOERR && ncp->xhdr == NULL)
+	{
+		/* forget attributes left in the copy of the header */
+		size_t i;
+		for(i = 0; i < ncp->vars.nelems; i++)
+			free_NC_attrarrayV0(&ncp->vars.value[i]->attrs);
+		free_NC_attrarrayV0(&ncp->attrs);
+	}
+	free(gs.base);
 	return status;
 }
@@ -0,0 +1,213 @@
+/* Copyright 2018, University Corporation for Atmospheric
+ * Research. See the COPYRIGHT file for copying and redistribution
+ * conditions.*/
+/**
+ * @file
+ * @internal Vectorized kernels for the common cases of
+ * nc4_convert_type() and for the BitGroom and BitRound quantizers.
+ *
+ * The loops are written so that the compiler can vectorize them:
+ * range errors are or-ed into a local flag instead of counted
+ * through a pointer, and quantization tests the bit pattern
+ * of each value rather than branching on it. See ncsimd.h.
+ *
+ * Each kernel must produce exactly the same results, including
+ * range errors, as the corresponding loop of nc4_convert_type().
+ */
+
+#include "config.h"
+#include "nc4internal.h"
+#include "ncsimd.h"
+
+/* Conversion without range checks. */
+#define CONVERT(name, stype, dtype) \
+NC_SIMD_CLONES static int \
+name(const void *src, void *dest, size_t len) \
+{ \
+    const stype *s = (const stype *)src; \
+    dtype *d = (dtype *)dest; \
+    size_t i; \
+    NC_SIMD_LOOP \
+    for (i = 0; i < len; i++) \
+        d[i] = (dtype)s[i]; \
+    return 0; \
+}
+
+/* Conversion with a range check; v is the source value, converted
+ * to ctype for the comparisons. */
+#define CONVERT_CHECKED(name, stype, dtype, ctype, lo, hi) \
+NC_SIMD_CLONES static int \
+name(const void *src, void *dest, size_t len) \
+{ \
+    const stype *s = (const stype *)src; \
+    dtype *d = (dtype *)dest; \
+    int err = 0; \
+    size_t i; \
+    NC_SIMD_LOOP_ERR \
+    for (i = 0; i < len; i++) \
+    { \
+        stype v = s[i]; \
+        err |= ((ctype)v > (ctype)(hi)) | ((ctype)v < (ctype)(lo)); \
+        d[i] = (dtype)v; \
+    } \
+    return err; \
+}
+
+CONVERT(convert_short_int, short, int)
+CONVERT(convert_short_float, short, float)
+CONVERT(convert_short_double, short, double)
+CONVERT_CHECKED(convert_int_short, int, short, int, X_SHORT_MIN, X_SHORT_MAX)
+CONVERT(convert_int_float, int, float)
+CONVERT(convert_int_double, int, double)
+CONVERT_CHECKED(convert_float_short, float, short, float, X_SHORT_MIN, X_SHORT_MAX)
+CONVERT_CHECKED(convert_float_int, float, int, double, X_INT_MIN, X_INT_MAX)
+CONVERT(convert_float_double, float, double)
+CONVERT_CHECKED(convert_double_short, double, short, double, X_SHORT_MIN, X_SHORT_MAX)
+CONVERT_CHECKED(convert_double_int, double, int, double, X_INT_MIN, X_INT_MAX)
+CONVERT_CHECKED(convert_double_float, double, float, double, X_FLOAT_MIN, X_FLOAT_MAX)
+
+/**
+ * @internal Find the vectorized kernel for a conversion.
+ *
+ * @param src_type Type of data to convert.
+ * @param dest_type Type to convert it to.
+ *
+ * @return The kernel, or NULL if there is none for this pair of
+ * types. A kernel returns non-zero if any value was out of range.
+ */
+NC4convertkernel
+nc4_find_convert_kernel(nc_type src_type, nc_type dest_type)
+{
+    switch (src_type)
+    {
+    case NC_SHORT:
+        switch (dest_type)
+        {
+        case NC_INT: return convert_short_int;
+        case NC_FLOAT: return convert_short_float;
+        case NC_DOUBLE: return convert_short_double;
+        default: break;
+        }
+        break;
+    case NC_INT:
+        switch (dest_type)
+        {
+        case NC_SHORT: return convert_int_short;
+        case NC_FLOAT: return convert_int_float;
+        case NC_DOUBLE: return convert_int_double;
+        default: break;
+        }
+        break;
+    case NC_FLOAT:
+        switch (dest_type)
+        {
+        case NC_SHORT: return convert_float_short;
+        case NC_INT: return convert_float_int;
+        case NC_DOUBLE: return convert_float_double;
+        default: break;
+        }
+        break;
+    case NC_DOUBLE:
+        switch (dest_type)
+        {
+        case NC_SHORT: return convert_double_short;
+        case NC_INT: return convert_double_int;
+        case NC_FLOAT: return convert_double_float;
+        default: break;
+        }
+        break;
+    default:
+        break;
+    }
+    return NULL;
+}
+
+/* Quantize a value unless it is the fill value, +/- zero, or NaN;
+ * the tests are done on the bit pattern, which is equivalent since
+ * zero and NaN are the only values whose float and bit equality
+ * differ. */
+#define QUANTIZABLE32(v, fill) \
+    ((((v) & 0x7fffffffU) != 0) & (((v) & 0x7fffffffU) <= 0x7f800000U) & ((v) != (fill)))
+#define QUANTIZABLE64(v, fill) \
+    ((((v) & 0x7fffffffffffffffULL) != 0) & \
+     (((v) & 0x7fffffffffffffffULL) <= 0x7ff0000000000000ULL) & ((v) != (fill)))
+
+/**
+ * @internal BitGroom floats in place: alternately shave (and with
+ * zro) and set (or with one) the low bits.
+ *
+ * @param u The data, as unsigned ints.
+ * @param len Number of values.
+ * @param fill Bit pattern of the fill value.
+ * @param zro Shave mask.
+ * @param one Set mask.
+ */
+NC_SIMD_CLONES void
+nc4_bitgroom_float(unsigned int *u, size_t len, unsigned int fill,
+                   unsigned int zro, unsigned int one)
+{
+    size_t i;
+    NC_SIMD_LOOP
+    for (i = 0; i < len; i++)
+    {
+        unsigned int v = u[i];
+        unsigned int q = (i & 1) ? (v | one) : (v & zro);
+        u[i] = QUANTIZABLE32(v, fill) ? q : v;
+    }
+}
+
+/**
+ * @internal BitGroom doubles in place; see nc4_bitgroom_float().
+ */
+NC_SIMD_CLONES void
+nc4_bitgroom_double(unsigned long long *u, size_t len, unsigned long long fill,
+                    unsigned long long zro, unsigned long long one)
+{
+    size_t i;
+    NC_SIMD_LOOP
+    for (i = 0; i < len; i++)
+    {
+        unsigned long long v = u[i];
+        unsigned long long q = (i & 1) ? (v | one) : (v & zro);
+        u[i] = QUANTIZABLE64(v, fill) ? q : v;
+    }
+}
+
+/**
+ * @internal BitRound floats in place: add half of the last kept
+ * bit, then shave.
+ *
+ * @param u The data, as unsigned ints.
+ * @param len Number of values.
+ * @param fill Bit pattern of the fill value.
+ * @param zro Shave mask.
+ * @param hshv Half of the last kept bit.
+ */
+NC_SIMD_CLONES void
+nc4_bitround_float(unsigned int *u, size_t len, unsigned int fill,
+                   unsigned int zro, unsigned int hshv)
+{
+    size_t i;
+    NC_SIMD_LOOP
+    for (i = 0; i < len; i++)
+    {
+        unsigned int v = u[i];
+        u[i] = QUANTIZABLE32(v, fill) ? ((v + hshv) & zro) : v;
+    }
+}
+
+/**
+ * @internal BitRound doubles in place; see nc4_bitround_float().
+ */
+NC_SIMD_CLONES void
+nc4_bitround_double(unsigned long long *u, size_t len, unsigned long long fill,
+                    unsigned long long zro, unsigned long long hshv)
+{
+    size_t i;
+    NC_SIMD_LOOP
+    for (i = 0; i < len; i++)
+    {
+        unsigned long long v = u[i];
+        u[i] = QUANTIZABLE64(v, fill) ? ((v + hshv) & zro) : v;
+    }
+}
@@ -456,6 +456,10 @@ nc4_find_nc_grp_h5(int ncid, NC **nc, NC_GRP_INFO_T **grp, NC_FILE_INFO_T **h5)
     if (!(my_grp = nclistget(my_h5->allgroups,index)))
         return NC_EBADID;
 
+    /* Read the group's metadata, if that was put off at open. */
+    if ((retval = nc4_read_deferred_grp(my_grp)))
+        return retval;
+
     /* Return pointers to caller, if desired. */
     if (nc)
         *nc = my_nc;
@@ -467,6 +471,26 @@ nc4_find_nc_grp_h5(int ncid, NC **nc, NC_GRP_INFO_T **grp, NC_FILE_INFO_T **h5)
     return NC_NOERR;
 }
 
+/**
+ * @internal Read the dims, vars and types of a group whose metadata
+ * was not read when the file was opened (see NC_LAZY_GROUPS). Its
+ * child groups are added, also unread. Does nothing for a group that
+ * has been read.
+ *
+ * @param grp Pointer to group info struct.
+ *
+ * @return ::NC_NOERR No error.
+ * @return ::NC_EHDFERR HDF5 error.
+ */
+int
+nc4_read_deferred_grp(NC_GRP_INFO_T *grp)
+{
+    assert(grp && grp->nc4_info);
+    if (!grp->meta_deferred || !grp->nc4_info->read_grp)
+        return NC_NOERR;
+    return grp->nc4_info->read_grp(grp);
+}
+
 /**
  * @internal Given an ncid and varid, get pointers to the group and var
  * metadata.
@@ -589,6 +613,7 @@ nc4_rec_find_named_type(NC_GRP_INFO_T *start_grp, char *name)
     for(size_t i=0;i<ncindexsize(start_grp->children);i++) {
         g = (NC_GRP_INFO_T*)ncindexith(start_grp->children,i);
         if(g == NULL) continue;
+        if (nc4_read_deferred_grp(g)) continue;
         if ((res = nc4_rec_find_named_type(g, name)))
             return res;
     }
@@ -495,7 +495,6 @@ nc4_convert_type(const void *src, void *dest, const nc_type src_type,
     double mss_val_cmp_dbl; /* Missing value for comparison to double precision values */
     double val_dbl; /* [frc] Copy of input value to avoid indirection */
     float mss_val_cmp_flt; /* Missing value for comparison to single precision values */
-    float val_flt; /* [frc] Copy of input value to avoid indirection */
     int bit_xpl_nbr_zro; /* [nbr] Number of explicit bits to zero */
     int dgt_nbr; /* [nbr] Number of digits before decimal point */
     int qnt_pwr; /* [nbr] Power of two in quantization mask: qnt_msk = 2^qnt_pwr */
@@ -509,8 +508,11 @@ nc4_convert_type(const void *src, void *dest, const nc_type src_type,
     unsigned long long int msk_f64_u64_zro;
     unsigned long long int msk_f64_u64_one;
     unsigned long long int msk_f64_u64_hshv;
+    unsigned int fill_u32; /* Bits of the fill value */
+    unsigned long long int fill_u64;
     unsigned short prc_bnr_xpl_rqr; /* [nbr] Explicitly represented binary digits required to retain */
     ptr_unn op1; /* I/O [frc] Values to quantize */
+    NC4convertkernel kernel;
     
     char *cp, *cp1;
     float *fp, *fp1;
@@ -633,8 +635,13 @@ nc4_convert_type(const void *src, void *dest, const nc_type src_type,
        NC_BYTE. This is because Lord Voldemort cast a nofilleramous spell
        at Harry Potter, but it bounced off his scar and hit the netcdf-4
        code.
+
+       The most common conversions between short, int, float and
+       double are done by vectorized kernels in nc4convert.c.
     */
-    switch (src_type)
+    if ((kernel = nc4_find_convert_kernel(src_type, dest_type)))
+        *range_error = kernel(src, dest, len);
+    else switch (src_type)
     {
     case NC_CHAR:
         switch (dest_type)
@@ -1388,29 +1395,20 @@ nc4_convert_type(const void *src, void *dest, const nc_type src_type,
     {
         if (dest_type == NC_FLOAT)
         {
-            /* BitGroom: alternately shave and set LSBs */
+            /* BitGroom: alternately shave and set LSBs. _FillValue,
+             * +/- zero, and NaN are not quantized. */
             op1.fp = (float *)dest;
-            u32_ptr = op1.ui32p;
-	    /* Do not quantize _FillValue, +/- zero, or NaN */
-            for (idx = 0L; idx < len; idx += 2L)
-	        if ((val_flt=op1.fp[idx]) != mss_val_cmp_flt && val_flt != 0.0f && !isnan(val_flt))
-                    u32_ptr[idx] &= msk_f32_u32_zro;
-            for (idx = 1L; idx < len; idx += 2L)
-	        if ((val_flt=op1.fp[idx]) != mss_val_cmp_flt && val_flt != 0.0f && !isnan(val_flt))
-                    u32_ptr[idx] |= msk_f32_u32_one;
+            memcpy(&fill_u32, &mss_val_cmp_flt, sizeof(fill_u32));
+            nc4_bitgroom_float(op1.ui32p, len, fill_u32, msk_f32_u32_zro,
+                               msk_f32_u32_one);
         }
         else
         {
             /* BitGroom: alternately shave and set LSBs. */
             op1.dp = (double *)dest;
-            u64_ptr = op1.ui64p;
-	    /* Do not quantize _FillValue, +/- zero, or NaN */
-            for (idx = 0L; idx < len; idx += 2L)
-	        if ((val_dbl=op1.dp[idx]) != mss_val_cmp_dbl && val_dbl != 0.0 && !isnan(val_dbl))
-                    u64_ptr[idx] &= msk_f64_u64_zro;
-            for (idx = 1L; idx < len; idx += 2L)
-	        if ((val_dbl=op1.dp[idx]) != mss_val_cmp_dbl && val_dbl != 0.0 && !isnan(val_dbl))
-                    u64_ptr[idx] |= msk_f64_u64_one;
+            memcpy(&fill_u64, &mss_val_cmp_dbl, sizeof(fill_u64));
+            nc4_bitgroom_double(op1.ui64p, len, fill_u64, msk_f64_u64_zro,
+                                msk_f64_u64_one);
         }
     } /* endif BitGroom */
 
@@ -1418,29 +1416,21 @@ nc4_convert_type(const void *src, void *dest, const nc_type src_type,
       {
         if (dest_type == NC_FLOAT)
 	  {
-            /* BitRound: Quantize to user-specified NSB with IEEE-rounding */
+            /* BitRound: Quantize to user-specified NSB with
+             * IEEE-rounding: add 1 to the MSB of LSBs, carry 1 to
+             * mantissa or even exponent, then shave it. */
             op1.fp = (float *)dest;
-            u32_ptr = op1.ui32p;
-            for (idx = 0L; idx < len; idx++){
-	      /* Do not quantize _FillValue, +/- zero, or NaN */
-	      if ((val_flt=op1.fp[idx]) != mss_val_cmp_flt && val_flt != 0.0f && !isnan(val_flt)){
-		u32_ptr[idx] += msk_f32_u32_hshv; /* Add 1 to the MSB of LSBs, carry 1 to mantissa or even exponent */
-		u32_ptr[idx] &= msk_f32_u32_zro; /* Shave it */
-	      }
-	    }
+            memcpy(&fill_u32, &mss_val_cmp_flt, sizeof(fill_u32));
+            nc4_bitround_float(op1.ui32p, len, fill_u32, msk_f32_u32_zro,
+                               msk_f32_u32_hshv);
 	  }
         else
 	  {
             /* BitRound: Quantize to user-specified NSB with IEEE-rounding */
             op1.dp = (double *)dest;
-            u64_ptr = op1.ui64p;
-            for (idx = 0L; idx < len; idx++){
-	      /* Do not quantize _FillValue, +/- zero, or NaN */
-	      if ((val_dbl=op1.dp[idx]) != mss_val_cmp_dbl && val_dbl != 0.0 && !isnan(val_dbl)){
-		u64_ptr[idx] += msk_f64_u64_hshv; /* Add 1 to the MSB of LSBs, carry 1 to mantissa or even exponent */
-		u64_ptr[idx] &= msk_f64_u64_zro; /* Shave it */
-	      }
-	    }
+            memcpy(&fill_u64, &mss_val_cmp_dbl, sizeof(fill_u64));
+            nc4_bitround_double(op1.ui64p, len, fill_u64, msk_f64_u64_zro,
+                                msk_f64_u64_hshv);
 	  }
       } /* endif BitRound */
     
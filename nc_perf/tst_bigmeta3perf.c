@@ -0,0 +1,114 @@
+/* This is part of the netCDF package. Copyright 2018 University
+   Corporation for Atmospheric Research/Unidata See COPYRIGHT file for
+   conditions of use.
+
+   This program times opening a classic format file with a very large
+   header, in the manner of bigmeta.c and openbigmeta.c for netCDF-4:
+   many variables, each with many attributes. The header is read by
+   nc_open, then the attributes of every variable are read. The number
+   of variables and of attributes per variable may be given as the
+   first and second arguments.
+*/
+
+#include <nc_tests.h>
+#include "err_macros.h"
+#include <time.h>
+#include <sys/time.h>
+
+#define FILE_NAME "tst_bigmeta3perf.nc"
+#define DEFAULT_NVARS 50000
+#define DEFAULT_NVARATTRS 10
+#define NDIMS 100
+#define NOPENS 3
+
+/* Prototype from tst_utils.c. */
+int nc4_timeval_subtract(struct timeval *result, struct timeval *x,
+                         struct timeval *y);
+
+static long long
+elapsed(struct timeval *start_time)
+{
+   struct timeval end_time, diff_time;
+   gettimeofday(&end_time, NULL);
+   if (nc4_timeval_subtract(&diff_time, &end_time, start_time)) return -1;
+   return (long long)diff_time.tv_sec * MILLION + diff_time.tv_usec;
+}
+
+int
+main(int argc, char **argv)
+{
+   int nvars = DEFAULT_NVARS, nvarattrs = DEFAULT_NVARATTRS;
+   int ncid, dimids[NDIMS], varid, v, a, i, value;
+   char name[NC_MAX_NAME + 1];
+   struct timeval start_time;
+   long long us;
+   size_t len;
+
+   if (argc > 1)
+      nvars = atoi(argv[1]);
+   if (argc > 2)
+      nvarattrs = atoi(argv[2]);
+
+   printf("\n*** Timing open of a classic format file with %d variables"
+          " and %d attributes.\n", nvars, nvars * nvarattrs);
+   gettimeofday(&start_time, NULL);
+   if (nc_create(FILE_NAME, NC_CLOBBER | NC_64BIT_OFFSET, &ncid)) ERR;
+   if (nc_set_fill(ncid, NC_NOFILL, NULL)) ERR;
+   for (i = 0; i < NDIMS; i++)
+   {
+      snprintf(name, sizeof(name), "d%d", i);
+      if (nc_def_dim(ncid, name, (size_t)(i % 4) + 1, &dimids[i])) ERR;
+   }
+   for (v = 0; v < nvars; v++)
+   {
+      snprintf(name, sizeof(name), "v%d", v);
+      if (nc_def_var(ncid, name, NC_INT, 2, &dimids[v % (NDIMS - 1)],
+                     &varid)) ERR;
+      for (a = 0; a < nvarattrs; a++)
+      {
+         snprintf(name, sizeof(name), "a%d", a);
+         value = v + a;
+         if (nc_put_att_int(ncid, varid, name, NC_INT, 1, &value)) ERR;
+      }
+   }
+   if (nc_put_att_text(ncid, NC_GLOBAL, "title", 5, "big!!")) ERR;
+   if (nc_close(ncid)) ERR;
+   us = elapsed(&start_time);
+   printf("%-28s %10.3f s\n", "create", (double)us / MILLION);
+
+   for (i = 0; i < NOPENS; i++)
+   {
+      gettimeofday(&start_time, NULL);
+      if (nc_open(FILE_NAME, NC_NOWRITE, &ncid)) ERR;
+      us = elapsed(&start_time);
+      printf("%-28s %10.3f s\n", "open", (double)us / MILLION);
+      if (nc_close(ncid)) ERR;
+   }
+
+   /* Open and read every attribute. */
+   gettimeofday(&start_time, NULL);
+   if (nc_open(FILE_NAME, NC_NOWRITE, &ncid)) ERR;
+   for (v = 0; v < nvars; v++)
+      for (a = 0; a < nvarattrs; a++)
+      {
+         snprintf(name, sizeof(name), "a%d", a);
+         if (nc_inq_attlen(ncid, v, name, &len)) ERR;
+         if (len != 1) ERR;
+         if (nc_get_att_int(ncid, v, name, &value)) ERR;
+         if (value != v + a) ERR;
+      }
+   if (nc_close(ncid)) ERR;
+   us = elapsed(&start_time);
+   printf("%-28s %10.3f s\n", "open and read attributes",
+          (double)us / MILLION);
+
+   /* Open for writing, as files are when records are added. */
+   gettimeofday(&start_time, NULL);
+   if (nc_open(FILE_NAME, NC_WRITE, &ncid)) ERR;
+   if (nc_close(ncid)) ERR;
+   us = elapsed(&start_time);
+   printf("%-28s %10.3f s\n", "open for writing and close",
+          (double)us / MILLION);
+   SUMMARIZE_ERR;
+   FINAL_RESULTS;
+}
@@ -0,0 +1,141 @@
+/* This is part of the netCDF package. Copyright 2018 University
+   Corporation for Atmospheric Research/Unidata See COPYRIGHT file for
+   conditions of use.
+
+   This program times the in-memory type conversions and quantization
+   done by nc4_convert_type() and reports the throughput, in GB/s of
+   data read and written, for each pair of types.
+*/
+
+#include <nc_tests.h>
+#include "err_macros.h"
+#include "nc4internal.h"
+#include <time.h>
+#include <sys/time.h>
+
+#define LEN (1 << 22)
+#define NREPS 10
+#define NTYPES 4
+
+/* Prototype from tst_utils.c. */
+int nc4_timeval_subtract(struct timeval *result, struct timeval *x,
+                         struct timeval *y);
+
+static double src[LEN];
+static double dest[LEN];
+
+static const nc_type types[NTYPES] = {NC_SHORT, NC_INT, NC_FLOAT, NC_DOUBLE};
+
+static long long
+elapsed(struct timeval *start_time)
+{
+   struct timeval end_time, diff_time;
+   gettimeofday(&end_time, NULL);
+   if (nc4_timeval_subtract(&diff_time, &end_time, start_time)) return -1;
+   return (long long)diff_time.tv_sec * MILLION + diff_time.tv_usec;
+}
+
+/* Fill src with LEN values of type xtype that fit in a short. */
+static void
+fill(nc_type xtype)
+{
+   size_t i;
+   for (i = 0; i < LEN; i++)
+   {
+      int v = (int)(i % 60000) - 30000;
+      switch (xtype)
+      {
+      case NC_SHORT: ((short *)src)[i] = (short)v; break;
+      case NC_INT: ((int *)src)[i] = v; break;
+      case NC_FLOAT: ((float *)src)[i] = (float)v + 0.25f; break;
+      default: ((double *)src)[i] = (double)v + 0.25; break;
+      }
+   }
+}
+
+/* Value i of buf, which holds values of type xtype. */
+static double
+value(nc_type xtype, const void *buf, size_t i)
+{
+   switch (xtype)
+   {
+   case NC_SHORT: return ((const short *)buf)[i];
+   case NC_INT: return ((const int *)buf)[i];
+   case NC_FLOAT: return ((const float *)buf)[i];
+   default: return ((const double *)buf)[i];
+   }
+}
+
+/* The value v would have after conversion to xtype. */
+static double
+cast(nc_type xtype, double v)
+{
+   switch (xtype)
+   {
+   case NC_SHORT: return (short)v;
+   case NC_INT: return (int)v;
+   case NC_FLOAT: return (float)v;
+   default: return v;
+   }
+}
+
+/* Time NREPS conversions from src to dest and print the rate. */
+static int
+run(const char *label, nc_type src_type, nc_type dest_type, int quantize_mode,
+    int nsd)
+{
+   struct timeval start_time;
+   size_t src_len, dest_len;
+   long long us;
+   int range_error, r;
+
+   if (nc4_get_typelen_mem(NULL, src_type, &src_len)) ERR;
+   if (nc4_get_typelen_mem(NULL, dest_type, &dest_len)) ERR;
+
+   gettimeofday(&start_time, NULL);
+   for (r = 0; r < NREPS; r++)
+      if (nc4_convert_type(src, dest, src_type, dest_type, LEN, &range_error,
+                           NULL, 0, quantize_mode, nsd)) ERR;
+   us = elapsed(&start_time);
+   if (range_error) ERR;
+
+   printf("%-16s %8.3f GB/s\n", label,
+          (double)((src_len + dest_len) * LEN * NREPS) / (us > 0 ? (double)us : 1.0) / 1e3);
+   return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+   static const char *names[NTYPES] = {"short", "int", "float", "double"};
+   int s, d;
+
+   printf("\n*** Timing conversion of %d values.\n", LEN);
+   for (s = 0; s < NTYPES; s++)
+   {
+      fill(types[s]);
+      for (d = 0; d < NTYPES; d++)
+      {
+         char label[NC_MAX_NAME + 1];
+         size_t i;
+
+         if (s == d) continue;
+         snprintf(label, sizeof(label), "%s->%s", names[s], names[d]);
+         if (run(label, types[s], types[d], NC_NOQUANTIZE, 0)) ERR;
+
+         /* Check the result against a plain cast. */
+         for (i = 0; i < LEN; i++)
+            if (value(types[d], dest, i) != cast(types[d], value(types[s], src, i))) ERR;
+      }
+   }
+   SUMMARIZE_ERR;
+
+   printf("*** Timing quantization.\n");
+   fill(NC_DOUBLE);
+   if (run("bitgroom float", NC_DOUBLE, NC_FLOAT, NC_QUANTIZE_BITGROOM, 3)) ERR;
+   if (run("bitgroom double", NC_DOUBLE, NC_DOUBLE, NC_QUANTIZE_BITGROOM, 3)) ERR;
+   if (run("bitround float", NC_DOUBLE, NC_FLOAT, NC_QUANTIZE_BITROUND, 10)) ERR;
+   if (run("bitround double", NC_DOUBLE, NC_DOUBLE, NC_QUANTIZE_BITROUND, 10)) ERR;
+   SUMMARIZE_ERR;
+   FINAL_RESULTS;
+}
@@ -0,0 +1,114 @@
+/* This is part of the netCDF package. Copyright 2018 University
+   Corporation for Atmospheric Research/Unidata See COPYRIGHT file for
+   conditions of use.
+
+   This program times writing fill values to classic format files:
+   filling a large fixed size variable at nc_enddef, filling records
+   as they are added one at a time, and filling many records at once
+   by writing past the end of the record dimension. Each case is also
+   run in NOFILL mode for comparison.
+*/
+
+#include <nc_tests.h>
+#include "err_macros.h"
+#include <time.h>
+#include <sys/time.h>
+
+#define FILE_NAME "tst_fillperf.nc"
+#define NFIX (64 * 1024 * 1024) /* floats in the fixed size variable */
+#define NRECVARS 4
+#define NX 1000 /* values per record of each record variable */
+#define NREC 20000
+
+/* Prototype from tst_utils.c. */
+int nc4_timeval_subtract(struct timeval *result, struct timeval *x,
+                         struct timeval *y);
+
+static long long
+elapsed(struct timeval *start_time)
+{
+   struct timeval end_time, diff_time;
+   gettimeofday(&end_time, NULL);
+   if (nc4_timeval_subtract(&diff_time, &end_time, start_time)) return -1;
+   return (long long)diff_time.tv_sec * MILLION + diff_time.tv_usec;
+}
+
+static void
+report(const char *label, int fillmode, long long us, double mb)
+{
+   printf("%-22s %-7s %8.3f s %10.1f MiB/s\n", label,
+          fillmode == NC_FILL ? "fill" : "nofill", (double)us / MILLION,
+          mb / ((double)(us > 0 ? us : 1) / MILLION));
+}
+
+static int
+run(int fillmode)
+{
+   int ncid, dimids[3], varids[NRECVARS], fixid, v, old;
+   size_t start[2] = {0, 0}, count[2] = {1, 1};
+   float one = 1.0f, got;
+   struct timeval start_time;
+   size_t r;
+
+   /* Fixed size variable, filled at nc_enddef. */
+   gettimeofday(&start_time, NULL);
+   if (nc_create(FILE_NAME, NC_CLOBBER | NC_64BIT_OFFSET, &ncid)) ERR;
+   if (nc_set_fill(ncid, fillmode, &old)) ERR;
+   if (nc_def_dim(ncid, "n", NFIX, &dimids[2])) ERR;
+   if (nc_def_var(ncid, "fix", NC_FLOAT, 1, &dimids[2], &fixid)) ERR;
+   if (nc_enddef(ncid)) ERR;
+   if (nc_close(ncid)) ERR;
+   report("fixed size variable", fillmode, elapsed(&start_time),
+          (double)NFIX * sizeof(float) / (1024 * 1024));
+
+   if (nc_create(FILE_NAME, NC_CLOBBER | NC_64BIT_OFFSET, &ncid)) ERR;
+   if (nc_set_fill(ncid, fillmode, &old)) ERR;
+   if (nc_def_dim(ncid, "time", NC_UNLIMITED, &dimids[0])) ERR;
+   if (nc_def_dim(ncid, "x", NX, &dimids[1])) ERR;
+   for (v = 0; v < NRECVARS; v++)
+   {
+      char name[NC_MAX_NAME + 1];
+      snprintf(name, sizeof(name), "var%d", v);
+      if (nc_def_var(ncid, name, NC_FLOAT, 2, dimids, &varids[v])) ERR;
+   }
+   if (nc_enddef(ncid)) ERR;
+
+   /* Records added one at a time, by writing one value of each. */
+   gettimeofday(&start_time, NULL);
+   for (r = 0; r < NREC; r++)
+   {
+      start[0] = r;
+      if (nc_put_vara_float(ncid, varids[0], start, count, &one)) ERR;
+   }
+   if (nc_sync(ncid)) ERR;
+   report("one record at a time", fillmode, elapsed(&start_time),
+          (double)NREC * NRECVARS * NX * sizeof(float) / (1024 * 1024));
+
+   /* Many records at once. */
+   gettimeofday(&start_time, NULL);
+   start[0] = 2 * NREC - 1;
+   if (nc_put_vara_float(ncid, varids[NRECVARS - 1], start, count, &one)) ERR;
+   if (nc_sync(ncid)) ERR;
+   report("many records at once", fillmode, elapsed(&start_time),
+          (double)NREC * NRECVARS * NX * sizeof(float) / (1024 * 1024));
+
+   if (fillmode == NC_FILL)
+   {
+      start[0] = NREC + 1;
+      start[1] = NX - 1;
+      if (nc_get_vara_float(ncid, varids[1], start, count, &got)) ERR;
+      if (got != NC_FILL_FLOAT) ERR;
+   }
+   if (nc_close(ncid)) ERR;
+   return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+   printf("\n*** Timing fill of classic format files.\n");
+   if (run(NC_FILL)) ERR;
+   if (run(NC_NOFILL)) ERR;
+   SUMMARIZE_ERR;
+   FINAL_RESULTS;
+}
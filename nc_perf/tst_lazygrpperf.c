@@ -0,0 +1,168 @@
+/* This is part of the netCDF package. Copyright 2018 University
+   Corporation for Atmospheric Research/Unidata See COPYRIGHT file for
+   conditions of use.
+
+   This program times opening a netCDF-4 file with many groups, nested
+   two deep, each with a few dims and variables, and reading one
+   variable in one group. This is done with an ordinary open, which
+   reads the metadata of every group, and with NC_LAZY_GROUPS, which
+   reads only the groups used. Reading every group after a lazy open
+   is also timed. This is done for an HDF5 file and, when enabled, an
+   NCZarr directory store. The number of top level groups and of
+   subgroups in each may be given as the first and second arguments.
+*/
+
+#include <nc_tests.h>
+#include "err_macros.h"
+#include <time.h>
+#include <sys/time.h>
+
+#define FILE_NAME "tst_lazygrpperf.nc"
+#define NCZARR_URL "file://tst_lazygrpperf.file#mode=nczarr,file"
+#define DEFAULT_NGRPS 40
+#define DEFAULT_NSUBGRPS 25
+#define NVARS 4
+#define NX 10
+#define NOPENS 3
+
+/* Prototype from tst_utils.c. */
+int nc4_timeval_subtract(struct timeval *result, struct timeval *x,
+                         struct timeval *y);
+
+static long long
+elapsed(struct timeval *start_time)
+{
+   struct timeval end_time, diff_time;
+   gettimeofday(&end_time, NULL);
+   if (nc4_timeval_subtract(&diff_time, &end_time, start_time)) return -1;
+   return (long long)diff_time.tv_sec * MILLION + diff_time.tv_usec;
+}
+
+/* Open the file, read variable v0 of group /g<g>/s<s>, close it. */
+static int
+read_one(const char *path, int mode, int g, int s)
+{
+   int ncid, grpid, varid, data[NX], i;
+   char grpname[NC_MAX_NAME + 1];
+
+   snprintf(grpname, sizeof(grpname), "/g%d/s%d", g, s);
+   if (nc_open(path, mode, &ncid)) ERR;
+   if (nc_inq_grp_full_ncid(ncid, grpname, &grpid)) ERR;
+   if (nc_inq_varid(grpid, "v0", &varid)) ERR;
+   if (nc_get_var_int(grpid, varid, data)) ERR;
+   for (i = 0; i < NX; i++)
+      if (data[i] != g * 1000 + s + i) ERR;
+   if (nc_close(ncid)) ERR;
+   return 0;
+}
+
+/* Open the file and count the variables in every group. */
+static int
+read_all(const char *path, int mode, int ngrps, int nsubgrps)
+{
+   int ncid, numgrps, *grpids, *subids, nvars, total = 0, g, s;
+
+   if (!(grpids = malloc((size_t)ngrps * sizeof(int)))) ERR;
+   if (!(subids = malloc((size_t)nsubgrps * sizeof(int)))) ERR;
+   if (nc_open(path, mode, &ncid)) ERR;
+   if (nc_inq_grps(ncid, &numgrps, grpids)) ERR;
+   if (numgrps != ngrps) ERR;
+   for (g = 0; g < ngrps; g++)
+   {
+      if (nc_inq_grps(grpids[g], &numgrps, subids)) ERR;
+      if (numgrps != nsubgrps) ERR;
+      for (s = 0; s < nsubgrps; s++)
+      {
+         if (nc_inq_nvars(subids[s], &nvars)) ERR;
+         total += nvars;
+      }
+   }
+   if (total != ngrps * nsubgrps * NVARS) ERR;
+   if (nc_close(ncid)) ERR;
+   free(grpids);
+   free(subids);
+   return 0;
+}
+
+/* Create the file and time the opens. */
+static int
+run(const char *label, const char *path, int ngrps, int nsubgrps)
+{
+   int ncid, grpid, subid, dimid, varid, g, s, v, i, data[NX];
+   char name[NC_MAX_NAME + 1];
+   struct timeval start_time;
+   long long us;
+
+   printf("%s, %d groups:\n", label, ngrps * (nsubgrps + 1));
+   gettimeofday(&start_time, NULL);
+   if (nc_create(path, NC_CLOBBER | NC_NETCDF4, &ncid)) ERR;
+   for (g = 0; g < ngrps; g++)
+   {
+      snprintf(name, sizeof(name), "g%d", g);
+      if (nc_def_grp(ncid, name, &grpid)) ERR;
+      for (s = 0; s < nsubgrps; s++)
+      {
+         snprintf(name, sizeof(name), "s%d", s);
+         if (nc_def_grp(grpid, name, &subid)) ERR;
+         if (nc_def_dim(subid, "x", NX, &dimid)) ERR;
+         for (v = 0; v < NVARS; v++)
+         {
+            snprintf(name, sizeof(name), "v%d", v);
+            if (nc_def_var(subid, name, NC_INT, 1, &dimid, &varid)) ERR;
+         }
+         for (i = 0; i < NX; i++)
+            data[i] = g * 1000 + s + i;
+         if (nc_put_var_int(subid, 0, data)) ERR;
+      }
+   }
+   if (nc_close(ncid)) ERR;
+   us = elapsed(&start_time);
+   printf("%-36s %10.3f s\n", "create", (double)us / MILLION);
+
+   for (i = 0; i < NOPENS; i++)
+   {
+      gettimeofday(&start_time, NULL);
+      if (read_one(path, NC_NOWRITE, ngrps - 1, nsubgrps - 1)) ERR;
+      us = elapsed(&start_time);
+      printf("%-36s %10.3f s\n", "open and read one var", (double)us / MILLION);
+   }
+   for (i = 0; i < NOPENS; i++)
+   {
+      gettimeofday(&start_time, NULL);
+      if (read_one(path, NC_NOWRITE | NC_LAZY_GROUPS, ngrps - 1, nsubgrps - 1)) ERR;
+      us = elapsed(&start_time);
+      printf("%-36s %10.3f s\n", "lazy open and read one var",
+             (double)us / MILLION);
+   }
+
+   gettimeofday(&start_time, NULL);
+   if (read_all(path, NC_NOWRITE, ngrps, nsubgrps)) ERR;
+   us = elapsed(&start_time);
+   printf("%-36s %10.3f s\n", "open and visit all groups", (double)us / MILLION);
+   gettimeofday(&start_time, NULL);
+   if (read_all(path, NC_NOWRITE | NC_LAZY_GROUPS, ngrps, nsubgrps)) ERR;
+   us = elapsed(&start_time);
+   printf("%-36s %10.3f s\n", "lazy open and visit all groups",
+          (double)us / MILLION);
+   return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+   int ngrps = DEFAULT_NGRPS, nsubgrps = DEFAULT_NSUBGRPS;
+
+   if (argc > 1)
+      ngrps = atoi(argv[1]);
+   if (argc > 2)
+      nsubgrps = atoi(argv[2]);
+
+   printf("\n*** Timing open of netCDF-4 files with many groups.\n");
+   if (run("HDF5", FILE_NAME, ngrps, nsubgrps)) ERR;
+#ifdef NETCDF_ENABLE_NCZARR
+   /* Creating an NCZarr store is slow; use a quarter of the groups. */
+   if (run("NCZarr", NCZARR_URL, (ngrps + 3) / 4, nsubgrps)) ERR;
+#endif
+   SUMMARIZE_ERR;
+   FINAL_RESULTS;
+}
@@ -0,0 +1,228 @@
+/* This is part of the netCDF package. Copyright 2018 University
+   Corporation for Atmospheric Research/Unidata See COPYRIGHT file for
+   conditions of use.
+
+   This program times the classic format external data conversions
+   (ncx_getn_* and ncx_putn_*) for short, int, float and double, and
+   compares them with an element by element byte swap and conversion
+   like the one they used before they were vectorized. The results of
+   the two are checked to be identical.
+*/
+
+#include <nc_tests.h>
+#include "err_macros.h"
+#include <time.h>
+#include <sys/time.h>
+#include <stdint.h>
+
+#define LEN (1 << 22)
+#define NREPS 10
+
+/* Prototype from tst_utils.c. */
+int nc4_timeval_subtract(struct timeval *result, struct timeval *x,
+                         struct timeval *y);
+
+/* Prototypes from libsrc/ncx.h. */
+#define NCX_PROTOS(xtype, itype) \
+int ncx_getn_##xtype##_##itype(const void **xpp, size_t nelems, itype *tp); \
+int ncx_putn_##xtype##_##itype(void **xpp, size_t nelems, const itype *tp, void *fillp);
+NCX_PROTOS(short, int)
+NCX_PROTOS(short, float)
+NCX_PROTOS(short, double)
+NCX_PROTOS(int, short)
+NCX_PROTOS(int, float)
+NCX_PROTOS(int, double)
+NCX_PROTOS(float, short)
+NCX_PROTOS(float, int)
+NCX_PROTOS(float, double)
+NCX_PROTOS(double, short)
+NCX_PROTOS(double, int)
+NCX_PROTOS(double, float)
+int ncx_getn_short_short(const void **xpp, size_t nelems, short *tp);
+
+static char xbuf[LEN * 8], xref[LEN * 8];
+static double mem[LEN], memref[LEN];
+
+static long long
+elapsed(struct timeval *start_time)
+{
+   struct timeval end_time, diff_time;
+   gettimeofday(&end_time, NULL);
+   if (nc4_timeval_subtract(&diff_time, &end_time, start_time)) return -1;
+   return (long long)diff_time.tv_sec * MILLION + diff_time.tv_usec;
+}
+
+/* Big-endian load and store of n byte values. */
+static uint64_t
+load(const char *p, int n)
+{
+   uint64_t v = 0;
+   int b;
+   for (b = 0; b < n; b++)
+      v = (v << 8) | (unsigned char)p[b];
+   return v;
+}
+
+static void
+store(char *p, int n, uint64_t v)
+{
+   int b;
+   for (b = n - 1; b >= 0; b--, v >>= 8)
+      p[b] = (char)(v & 0xff);
+}
+
+/* Element by element reference conversions, with the range check
+ * the ncx element functions do. */
+#define REF_GETN(xtype, itype, utype, lo, hi) \
+static int \
+ref_getn_##xtype##_##itype(const char *xp, size_t n, itype *tp) \
+{ \
+   size_t i; \
+   int status = NC_NOERR; \
+   for (i = 0; i < n; i++, xp += sizeof(utype)) \
+   { \
+      utype u = (utype)load(xp, sizeof(utype)); \
+      xtype v; \
+      memcpy(&v, &u, sizeof(v)); \
+      if ((double)v > (hi) || (double)v < (lo)) status = NC_ERANGE; \
+      tp[i] = (itype)v; \
+   } \
+   return status; \
+}
+
+#define REF_PUTN(xtype, itype, utype, lo, hi) \
+static int \
+ref_putn_##xtype##_##itype(char *xp, size_t n, const itype *tp) \
+{ \
+   size_t i; \
+   int status = NC_NOERR; \
+   for (i = 0; i < n; i++, xp += sizeof(utype)) \
+   { \
+      xtype v = (xtype)tp[i]; \
+      utype u; \
+      if ((double)tp[i] > (hi) || (double)tp[i] < (lo)) status = NC_ERANGE; \
+      memcpy(&u, &v, sizeof(u)); \
+      store(xp, sizeof(utype), u); \
+   } \
+   return status; \
+}
+
+#define SMAX 32767.0
+#define SMIN -32768.0
+#define IMAX 2147483647.0
+#define IMIN -2147483648.0
+#define FMAX 3.402823466e+38
+#define NONE 1e308
+
+REF_GETN(short, int, uint16_t, -NONE, NONE)
+REF_GETN(short, float, uint16_t, -NONE, NONE)
+REF_GETN(short, double, uint16_t, -NONE, NONE)
+REF_GETN(int, short, uint32_t, SMIN, SMAX)
+REF_GETN(int, float, uint32_t, -NONE, NONE)
+REF_GETN(int, double, uint32_t, -NONE, NONE)
+REF_GETN(float, short, uint32_t, SMIN, SMAX)
+REF_GETN(float, int, uint32_t, IMIN, IMAX)
+REF_GETN(float, double, uint32_t, -NONE, NONE)
+REF_GETN(double, short, uint64_t, SMIN, SMAX)
+REF_GETN(double, int, uint64_t, IMIN, IMAX)
+REF_GETN(double, float, uint64_t, -FMAX, FMAX)
+
+REF_PUTN(short, int, uint16_t, SMIN, SMAX)
+REF_PUTN(short, float, uint16_t, SMIN, SMAX)
+REF_PUTN(short, double, uint16_t, SMIN, SMAX)
+REF_PUTN(int, short, uint32_t, -NONE, NONE)
+REF_PUTN(int, float, uint32_t, IMIN, IMAX)
+REF_PUTN(int, double, uint32_t, IMIN, IMAX)
+REF_PUTN(float, short, uint32_t, -NONE, NONE)
+REF_PUTN(float, int, uint32_t, -NONE, NONE)
+REF_PUTN(float, double, uint32_t, -FMAX, FMAX)
+REF_PUTN(double, short, uint64_t, -NONE, NONE)
+REF_PUTN(double, int, uint64_t, -NONE, NONE)
+REF_PUTN(double, float, uint64_t, -NONE, NONE)
+
+static void
+report(const char *label, size_t bytes, long long us, long long ref_us)
+{
+   printf("%-18s %8.3f GB/s  element-wise %8.3f GB/s\n", label,
+          (double)bytes * NREPS / (us > 0 ? (double)us : 1.0) / 1e3,
+          (double)bytes * NREPS / (ref_us > 0 ? (double)ref_us : 1.0) / 1e3);
+}
+
+/* Time the native to external conversion, then the conversion
+ * back, against the reference, and check they agree. */
+#define RUN(xtype, itype) \
+{ \
+   itype *tp = (itype *)mem, *tpref = (itype *)memref; \
+   struct timeval start_time; \
+   long long us, ref_us; \
+   size_t i; \
+   int r; \
+   void *xp; \
+   const void *cxp; \
+   \
+   for (i = 0; i < LEN; i++) \
+      tp[i] = (itype)((int)(i % 60000) - 30000); \
+   gettimeofday(&start_time, NULL); \
+   for (r = 0; r < NREPS; r++) \
+   { \
+      xp = xbuf; \
+      if (ncx_putn_##xtype##_##itype(&xp, LEN, tp, NULL)) ERR; \
+   } \
+   us = elapsed(&start_time); \
+   gettimeofday(&start_time, NULL); \
+   for (r = 0; r < NREPS; r++) \
+      if (ref_putn_##xtype##_##itype(xref, LEN, tp)) ERR; \
+   ref_us = elapsed(&start_time); \
+   if (memcmp(xbuf, xref, LEN * sizeof(xtype))) ERR; \
+   report("put " #itype "->" #xtype, LEN * (sizeof(xtype) + sizeof(itype)), us, ref_us); \
+   \
+   gettimeofday(&start_time, NULL); \
+   for (r = 0; r < NREPS; r++) \
+   { \
+      cxp = xbuf; \
+      if (ncx_getn_##xtype##_##itype(&cxp, LEN, tp)) ERR; \
+   } \
+   us = elapsed(&start_time); \
+   gettimeofday(&start_time, NULL); \
+   for (r = 0; r < NREPS; r++) \
+      if (ref_getn_##xtype##_##itype(xbuf, LEN, tpref)) ERR; \
+   ref_us = elapsed(&start_time); \
+   if (memcmp(tp, tpref, LEN * sizeof(itype))) ERR; \
+   report("get " #xtype "->" #itype, LEN * (sizeof(xtype) + sizeof(itype)), us, ref_us); \
+}
+
+int
+main(int argc, char **argv)
+{
+   printf("\n*** Timing classic format conversion of %d values.\n", LEN);
+   RUN(short, int)
+   RUN(short, float)
+   RUN(short, double)
+   RUN(int, short)
+   RUN(int, float)
+   RUN(int, double)
+   RUN(float, short)
+   RUN(float, int)
+   RUN(float, double)
+   RUN(double, short)
+   RUN(double, int)
+   RUN(double, float)
+   SUMMARIZE_ERR;
+
+   printf("*** checking out of range values...");
+   {
+      double d[4] = {1.0, 1e10, -2.0, 0.5};
+      short s[4];
+      void *xp = xbuf;
+      const void *cxp = xbuf;
+
+      /* One value out of range falls back to the element functions,
+       * which still convert the others. */
+      if (ncx_putn_short_double(&xp, 4, d, NULL) != NC_ERANGE) ERR;
+      if ((char *)xp != xbuf + 8) ERR;
+      if (ncx_getn_short_short(&cxp, 4, s)) ERR;
+      if (s[0] != 1 || s[2] != -2 || s[3] != 0) ERR;
+   }
+   SUMMARIZE_ERR;
+   FINAL_RESULTS;
+}
@@ -0,0 +1,139 @@
+/* This is part of the netCDF package. Copyright 2018 University
+   Corporation for Atmospheric Research/Unidata See COPYRIGHT file for
+   conditions of use.
+
+   This program times nc_enddef on a large classic format file when
+   the data has to be moved: after growing the header, after adding a
+   record variable (which changes the record size) and after adding
+   a fixed size variable. The file size in MiB may be given as the
+   first argument.
+*/
+
+#include <nc_tests.h>
+#include "err_macros.h"
+#include <time.h>
+#include <sys/time.h>
+
+#define FILE_NAME "tst_redefperf.nc"
+#define DEFAULT_MB 256
+#define NVARS 4
+#define NX 4096 /* floats per record of each variable */
+
+/* Prototype from tst_utils.c. */
+int nc4_timeval_subtract(struct timeval *result, struct timeval *x,
+                         struct timeval *y);
+
+static float data[NX];
+
+static long long
+elapsed(struct timeval *start_time)
+{
+   struct timeval end_time, diff_time;
+   gettimeofday(&end_time, NULL);
+   if (nc4_timeval_subtract(&diff_time, &end_time, start_time)) return -1;
+   return (long long)diff_time.tv_sec * MILLION + diff_time.tv_usec;
+}
+
+/* Value of variable v at (rec, x). */
+static float
+val(int v, size_t rec, size_t x)
+{
+   return (float)(v * 1000 + (int)(rec % 1000)) + (float)x / NX;
+}
+
+/* Check the first, middle and last records of each variable. */
+static int
+check(int ncid, size_t nrecs)
+{
+   size_t recs[3];
+   size_t start[2] = {0, 0}, count[2] = {1, NX};
+   int v, r;
+   size_t x;
+
+   recs[0] = 0;
+   recs[1] = nrecs / 2;
+   recs[2] = nrecs - 1;
+   for (v = 0; v < NVARS; v++)
+      for (r = 0; r < 3; r++)
+      {
+         start[0] = recs[r];
+         if (nc_get_vara_float(ncid, v, start, count, data)) ERR;
+         for (x = 0; x < NX; x++)
+            if (data[x] != val(v, recs[r], x)) ERR;
+      }
+   return 0;
+}
+
+/* Time one redef/enddef that moves the data. */
+static int
+time_redef(int ncid, size_t nrecs, const char *label, int what)
+{
+   struct timeval start_time;
+   long long us;
+   int dimids[2] = {0, 1};
+   int varid;
+   double mb = (double)nrecs * NVARS * NX * sizeof(float) / (1024 * 1024);
+
+   gettimeofday(&start_time, NULL);
+   if (nc_redef(ncid)) ERR;
+   switch (what)
+   {
+   case 0:
+      if (nc_put_att_text(ncid, NC_GLOBAL, label, strlen(label), label)) ERR;
+      break;
+   case 1:
+      if (nc_def_var(ncid, "newrec", NC_SHORT, 2, dimids, &varid)) ERR;
+      break;
+   default:
+      if (nc_def_var(ncid, "newfix", NC_DOUBLE, 1, &dimids[1], &varid)) ERR;
+      break;
+   }
+   if (nc_enddef(ncid)) ERR;
+   if (nc_sync(ncid)) ERR;
+   us = elapsed(&start_time);
+   printf("%-24s %10.3f s %10.1f MiB/s\n", label, (double)us / MILLION,
+          mb / ((double)(us > 0 ? us : 1) / MILLION));
+   return check(ncid, nrecs);
+}
+
+int
+main(int argc, char **argv)
+{
+   int ncid, dimids[2], varid, v;
+   size_t start[2] = {0, 0}, count[2] = {1, NX};
+   size_t mb = DEFAULT_MB, nrecs, r, x;
+
+   if (argc > 1)
+      mb = (size_t)atol(argv[1]);
+   nrecs = mb * 1024 * 1024 / (NVARS * NX * sizeof(float));
+   if (nrecs < 1) nrecs = 1;
+
+   printf("\n*** Timing nc_enddef on a %zu MiB file of %zu records.\n", mb, nrecs);
+   if (nc_set_default_format(NC_FORMAT_64BIT_OFFSET, NULL)) ERR;
+   if (nc_create(FILE_NAME, NC_CLOBBER, &ncid)) ERR;
+   if (nc_def_dim(ncid, "time", NC_UNLIMITED, &dimids[0])) ERR;
+   if (nc_def_dim(ncid, "x", NX, &dimids[1])) ERR;
+   for (v = 0; v < NVARS; v++)
+   {
+      char name[NC_MAX_NAME + 1];
+      snprintf(name, sizeof(name), "var%d", v);
+      if (nc_def_var(ncid, name, NC_FLOAT, 2, dimids, &varid)) ERR;
+   }
+   if (nc_enddef(ncid)) ERR;
+   for (r = 0; r < nrecs; r++)
+      for (v = 0; v < NVARS; v++)
+      {
+         start[0] = r;
+         for (x = 0; x < NX; x++)
+            data[x] = val(v, r, x);
+         if (nc_put_vara_float(ncid, v, start, count, data)) ERR;
+      }
+   if (nc_sync(ncid)) ERR;
+
+   if (time_redef(ncid, nrecs, "grow header", 0)) ERR;
+   if (time_redef(ncid, nrecs, "add record variable", 1)) ERR;
+   if (time_redef(ncid, nrecs, "add fixed size variable", 2)) ERR;
+   if (nc_close(ncid)) ERR;
+   SUMMARIZE_ERR;
+   FINAL_RESULTS;
+}
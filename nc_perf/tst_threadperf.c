@@ -0,0 +1,195 @@
+/* This is part of the netCDF package. Copyright 2018 University
+   Corporation for Atmospheric Research/Unidata See COPYRIGHT file for
+   conditions of use.
+
+   This program stresses and times a thread-safe build
+   (NETCDF_ENABLE_THREADSAFE) with 1, 2 and 4 threads sharing a fixed
+   amount of work: each thread opening, reading and closing different
+   classic format files; threads reading different variables of one
+   classic format file opened once; and, when enabled, threads reading
+   different variables of one NCZarr file. All data read is checked.
+*/
+
+#include <nc_tests.h>
+#include "err_macros.h"
+#include <time.h>
+#include <sys/time.h>
+#include <pthread.h>
+
+#define NFILES 4
+#define NVARS 8
+#define NX (256 * 1024) /* ints in each variable */
+#define NZCHUNK (32 * 1024)
+#define NREPS 4
+#define MAXTHREADS 4
+#define NCZARR_URL "file://tst_threadperf.file#mode=nczarr,file"
+
+/* Prototype from tst_utils.c. */
+int nc4_timeval_subtract(struct timeval *result, struct timeval *x,
+                         struct timeval *y);
+
+/* The work shared among the threads. */
+struct Work {
+   int nthreads;
+   int which;    /* this thread */
+   int ncid;     /* the one file, or -1 to open a file per item */
+   int nczarr;
+   int errs;
+};
+
+static long long
+elapsed(struct timeval *start_time)
+{
+   struct timeval end_time, diff_time;
+   gettimeofday(&end_time, NULL);
+   if (nc4_timeval_subtract(&diff_time, &end_time, start_time)) return -1;
+   return (long long)diff_time.tv_sec * MILLION + diff_time.tv_usec;
+}
+
+static int
+value(int f, int v, size_t i)
+{
+   return f * 1000000 + v * 10000 + (int)(i % 10000);
+}
+
+static void
+file_name(int f, char *name, size_t len)
+{
+   snprintf(name, len, "tst_threadperf_%d.nc", f);
+}
+
+static int
+write_file(const char *path, int f, int nczarr)
+{
+   int ncid, dimid, varid, v, *data;
+   char name[NC_MAX_NAME + 1];
+   size_t i, chunk = NZCHUNK;
+
+   if (!(data = malloc(NX * sizeof(int)))) ERR;
+   if (nc_create(path, nczarr ? NC_CLOBBER | NC_NETCDF4 : NC_CLOBBER | NC_64BIT_OFFSET,
+                 &ncid)) ERR;
+   if (nc_def_dim(ncid, "x", NX, &dimid)) ERR;
+   for (v = 0; v < NVARS; v++)
+   {
+      snprintf(name, sizeof(name), "v%d", v);
+      if (nc_def_var(ncid, name, NC_INT, 1, &dimid, &varid)) ERR;
+      if (nczarr && nc_def_var_chunking(ncid, varid, NC_CHUNKED, &chunk)) ERR;
+   }
+   if (nc_enddef(ncid)) ERR;
+   for (v = 0; v < NVARS; v++)
+   {
+      for (i = 0; i < NX; i++)
+         data[i] = value(f, v, i);
+      if (nc_put_var_int(ncid, v, data)) ERR;
+   }
+   if (nc_close(ncid)) ERR;
+   free(data);
+   return 0;
+}
+
+/* Read and check variable v of file f, open as ncid. */
+static int
+read_var(int ncid, int f, int v, int *data)
+{
+   size_t i;
+
+   if (nc_get_var_int(ncid, v, data)) return 1;
+   for (i = 0; i < NX; i++)
+      if (data[i] != value(f, v, i)) return 1;
+   return 0;
+}
+
+static void *
+worker(void *arg)
+{
+   struct Work *w = (struct Work *)arg;
+   char path[NC_MAX_NAME + 1];
+   int *data, item, ncid;
+
+   if (!(data = malloc(NX * sizeof(int)))) {w->errs++; return NULL;}
+   if (w->ncid < 0)
+   {
+      /* Each item opens, reads and closes one file. */
+      for (item = w->which; item < NFILES * NREPS; item += w->nthreads)
+      {
+         int f = item % NFILES, v;
+         file_name(f, path, sizeof(path));
+         if (nc_open(path, NC_NOWRITE, &ncid)) {w->errs++; break;}
+         for (v = 0; v < NVARS; v++)
+            w->errs += read_var(ncid, f, v, data);
+         if (nc_close(ncid)) w->errs++;
+      }
+   }
+   else
+   {
+      /* Each item reads one variable of the shared file. */
+      for (item = w->which; item < NVARS * NREPS; item += w->nthreads)
+         w->errs += read_var(w->ncid, 0, item % NVARS, data);
+   }
+   free(data);
+   return NULL;
+}
+
+static int
+run(const char *label, int ncid)
+{
+   pthread_t threads[MAXTHREADS];
+   struct Work work[MAXTHREADS];
+   struct timeval start_time;
+   long long us, us1 = 0;
+   int nthreads, t;
+
+   for (nthreads = 1; nthreads <= MAXTHREADS; nthreads *= 2)
+   {
+      gettimeofday(&start_time, NULL);
+      for (t = 0; t < nthreads; t++)
+      {
+         work[t].nthreads = nthreads;
+         work[t].which = t;
+         work[t].ncid = ncid;
+         work[t].errs = 0;
+         if (pthread_create(&threads[t], NULL, worker, &work[t])) ERR;
+      }
+      for (t = 0; t < nthreads; t++)
+      {
+         if (pthread_join(threads[t], NULL)) ERR;
+         if (work[t].errs) ERR;
+      }
+      us = elapsed(&start_time);
+      if (nthreads == 1)
+         us1 = us;
+      printf("%-32s %d threads %8.3f s  speedup %5.2f\n", label, nthreads,
+             (double)us / MILLION, (double)us1 / (double)(us > 0 ? us : 1));
+   }
+   return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+   char path[NC_MAX_NAME + 1];
+   int f, ncid;
+
+   printf("\n*** Timing reads from several threads.\n");
+   for (f = 0; f < NFILES; f++)
+   {
+      file_name(f, path, sizeof(path));
+      if (write_file(path, f, 0)) ERR;
+   }
+
+   if (run("different classic files", -1)) ERR;
+
+   file_name(0, path, sizeof(path));
+   if (nc_open(path, NC_NOWRITE, &ncid)) ERR;
+   if (run("variables of one classic file", ncid)) ERR;
+   if (nc_close(ncid)) ERR;
+
+#ifdef NETCDF_ENABLE_NCZARR
+   if (write_file(NCZARR_URL, 0, 1)) ERR;
+   if (nc_open(NCZARR_URL, NC_NOWRITE, &ncid)) ERR;
+   if (run("variables of one NCZarr file", ncid)) ERR;
+   if (nc_close(ncid)) ERR;
+#endif
+   SUMMARIZE_ERR;
+   FINAL_RESULTS;
+}
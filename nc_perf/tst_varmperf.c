@@ -0,0 +1,120 @@
+/* This is part of the netCDF package. Copyright 2018 University
+   Corporation for Atmospheric Research/Unidata See COPYRIGHT file for
+   conditions of use.
+
+   This program times transposing reads and writes with
+   nc_get_varm/nc_put_varm against plain nc_get_vara, and against the
+   element-wise NCDEFAULT_get_varm() fallback, for classic and (when
+   enabled) NCZarr files.
+*/
+
+#include <nc_tests.h>
+#include "err_macros.h"
+#include "ncdispatch.h"
+#include <time.h>
+#include <sys/time.h>
+
+#define NDIMS 2
+#define NY 1024
+#define NX 1024
+#define NCZARR_URL "file://tst_varmperf.file#mode=nczarr,file"
+
+/* Prototype from tst_utils.c. */
+int nc4_timeval_subtract(struct timeval *result, struct timeval *x,
+                         struct timeval *y);
+
+static float data[NY * NX];
+static float data_in[NY * NX];
+
+static long long
+elapsed(struct timeval *start_time)
+{
+   struct timeval end_time, diff_time;
+   gettimeofday(&end_time, NULL);
+   if (nc4_timeval_subtract(&diff_time, &end_time, start_time)) return -1;
+   return (long long)diff_time.tv_sec * MILLION + diff_time.tv_usec;
+}
+
+/* Check that data_in holds the transpose of data. */
+static int
+check_transpose(void)
+{
+   size_t y, x;
+   for (y = 0; y < NY; y++)
+      for (x = 0; x < NX; x++)
+         if (data_in[x * NY + y] != data[y * NX + x]) return 1;
+   return 0;
+}
+
+static int
+run(const char *label, const char *path, int cmode)
+{
+   int ncid, varid, dimids[NDIMS];
+   size_t start[NDIMS] = {0, 0}, count[NDIMS] = {NY, NX};
+   ptrdiff_t stride[NDIMS] = {1, 1}, imap[NDIMS] = {1, NY};
+   struct timeval start_time;
+   long long t_vara, t_varm, t_default, t_putvarm;
+   size_t i;
+
+   for (i = 0; i < NY * NX; i++)
+      data[i] = (float)i;
+
+   if (nc_create(path, cmode, &ncid)) ERR;
+   if (nc_def_dim(ncid, "y", NY, &dimids[0])) ERR;
+   if (nc_def_dim(ncid, "x", NX, &dimids[1])) ERR;
+   if (nc_def_var(ncid, "v", NC_FLOAT, NDIMS, dimids, &varid)) ERR;
+   if (nc_enddef(ncid)) ERR;
+
+   /* Write the transposed array with put_varm; the file then holds
+    * data in natural order. */
+   for (i = 0; i < NY * NX; i++)
+   {
+      size_t y = i / NX, x = i % NX;
+      data_in[x * NY + y] = data[i];
+   }
+   gettimeofday(&start_time, NULL);
+   if (nc_put_varm_float(ncid, varid, start, count, stride, imap, data_in)) ERR;
+   t_putvarm = elapsed(&start_time);
+   if (nc_close(ncid)) ERR;
+
+   if (nc_open(path, NC_NOWRITE, &ncid)) ERR;
+   if (nc_inq_varid(ncid, "v", &varid)) ERR;
+
+   gettimeofday(&start_time, NULL);
+   if (nc_get_vara_float(ncid, varid, start, count, data_in)) ERR;
+   t_vara = elapsed(&start_time);
+   if (memcmp(data, data_in, sizeof(data))) ERR;
+
+   memset(data_in, 0, sizeof(data_in));
+   gettimeofday(&start_time, NULL);
+   if (nc_get_varm_float(ncid, varid, start, count, stride, imap, data_in)) ERR;
+   t_varm = elapsed(&start_time);
+   if (check_transpose()) ERR;
+
+   memset(data_in, 0, sizeof(data_in));
+   gettimeofday(&start_time, NULL);
+   if (NCDEFAULT_get_varm(ncid, varid, start, count, stride, imap, data_in, NC_FLOAT)) ERR;
+   t_default = elapsed(&start_time);
+   if (check_transpose()) ERR;
+
+   if (nc_close(ncid)) ERR;
+
+   printf("%-8s vara %8lld us  varm %8lld us  default varm %10lld us  put varm %8lld us\n",
+          label, t_vara, t_varm, t_default, t_putvarm);
+   return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+   printf("\n*** Timing %dx%d transposed float reads.\n", NY, NX);
+   printf("*** testing classic format...\n");
+   if (run("classic", "tst_varmperf.nc", NC_CLOBBER)) ERR;
+   SUMMARIZE_ERR;
+#ifdef NETCDF_ENABLE_NCZARR
+   printf("*** testing NCZarr format...\n");
+   if (run("nczarr", NCZARR_URL, NC_CLOBBER | NC_NETCDF4)) ERR;
+   SUMMARIZE_ERR;
+#endif
+   FINAL_RESULTS;
+}
@@ -0,0 +1,159 @@
+/*
+  Copyright 2018, UCAR/Unidata
+  See COPYRIGHT file for copying and redistribution conditions.
+
+  This is part of netCDF.
+
+  Test the attributes of classic format files opened with a header
+  too big for the first read, whose attributes are only decoded when
+  they are first used: read them, rename a variable in data mode so
+  the header is written with attributes still undecoded, change them
+  in define mode, and reread the header with NC_SHARE.
+*/
+
+#include <config.h>
+#include <nc_tests.h>
+#include "err_macros.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <netcdf.h>
+
+#define FILE_NAME "tst_hdrattrs.nc"
+#define NVARS 2000
+#define NATTS 5
+#define BIGLEN 100000
+
+/* Check the attributes of variable v. */
+static int
+check_var(int ncid, int v, int natts)
+{
+   char name[NC_MAX_NAME + 1];
+   int a, value, n;
+
+   if (nc_inq_varnatts(ncid, v, &n)) ERR;
+   if (n != natts) ERR;
+   for (a = 0; a < NATTS; a++)
+   {
+      snprintf(name, sizeof(name), "att%d", a);
+      if (nc_get_att_int(ncid, v, name, &value)) ERR;
+      if (value != v * 100 + a) ERR;
+   }
+   return 0;
+}
+
+static int
+check_file(int ncid, int renamed, int extra)
+{
+   char *big, name[NC_MAX_NAME + 1];
+   size_t len;
+   int v, a, varid;
+
+   if (!(big = malloc(BIGLEN))) ERR;
+   if (nc_get_att_text(ncid, NC_GLOBAL, "big", big)) ERR;
+   for (len = 0; len < BIGLEN; len++)
+      if (big[len] != 'a' + (char)(len % 26)) ERR;
+   free(big);
+
+   /* Start at the back, so that most variables are left undecoded
+    * until they are reached. */
+   for (v = NVARS; v-- > 0;)
+      if (check_var(ncid, v, NATTS + (v == 1 && extra))) ERR;
+   if (nc_inq_varid(ncid, renamed ? "w0" : "v0", &varid)) ERR;
+   if (varid != 0) ERR;
+   if (extra)
+   {
+      if (nc_inq_attname(ncid, 1, NATTS, name)) ERR;
+      if (strcmp(name, "extra")) ERR;
+      if (nc_inq_att(ncid, 1, "att2", NULL, &len)) ERR;
+      if (len != 1) ERR;
+   }
+   for (a = 0; a < NATTS; a++)
+   {
+      int value;
+      snprintf(name, sizeof(name), "att%d", a);
+      if (nc_get_att_int(ncid, NVARS - 1, name, &value)) ERR;
+   }
+   return 0;
+}
+
+static int
+run(int format)
+{
+   int ncid, dimid, varid, v, a, value;
+   char name[NC_MAX_NAME + 1], *big;
+   size_t i;
+
+   if (nc_set_default_format(format, NULL)) ERR;
+   if (nc_create(FILE_NAME, NC_CLOBBER, &ncid)) ERR;
+   if (nc_def_dim(ncid, "x", 3, &dimid)) ERR;
+   if (!(big = malloc(BIGLEN))) ERR;
+   for (i = 0; i < BIGLEN; i++)
+      big[i] = 'a' + (char)(i % 26);
+   if (nc_put_att_text(ncid, NC_GLOBAL, "big", BIGLEN, big)) ERR;
+   free(big);
+   for (v = 0; v < NVARS; v++)
+   {
+      snprintf(name, sizeof(name), "v%d", v);
+      if (nc_def_var(ncid, name, NC_INT, 1, &dimid, &varid)) ERR;
+      for (a = 0; a < NATTS; a++)
+      {
+         snprintf(name, sizeof(name), "att%d", a);
+         value = v * 100 + a;
+         if (nc_put_att_int(ncid, varid, name, NC_INT, 1, &value)) ERR;
+      }
+   }
+   if (nc_close(ncid)) ERR;
+
+   /* Read everything. */
+   if (nc_open(FILE_NAME, NC_NOWRITE, &ncid)) ERR;
+   if (check_file(ncid, 0, 0)) ERR;
+   if (nc_close(ncid)) ERR;
+
+   /* Rewrite the header in data mode before anything is decoded. */
+   if (nc_open(FILE_NAME, NC_WRITE, &ncid)) ERR;
+   if (nc_rename_var(ncid, 0, "w0")) ERR;
+   if (nc_close(ncid)) ERR;
+   if (nc_open(FILE_NAME, NC_NOWRITE, &ncid)) ERR;
+   if (check_file(ncid, 1, 0)) ERR;
+   if (nc_close(ncid)) ERR;
+
+   /* Change attributes in define mode. */
+   if (nc_open(FILE_NAME, NC_WRITE, &ncid)) ERR;
+   if (nc_redef(ncid)) ERR;
+   if (nc_put_att_int(ncid, 1, "extra", NC_INT, 1, &value)) ERR;
+   if (nc_del_att(ncid, 2, "att4")) ERR;
+   if (nc_put_att_int(ncid, 2, "att4", NC_INT, 1, &value)) ERR;
+   value = 2 * 100 + 4;
+   if (nc_put_att_int(ncid, 2, "att4", NC_INT, 1, &value)) ERR;
+   if (nc_enddef(ncid)) ERR;
+   if (check_file(ncid, 1, 1)) ERR;
+   if (nc_close(ncid)) ERR;
+
+   /* Reread the header with NC_SHARE. */
+   if (nc_open(FILE_NAME, NC_SHARE, &ncid)) ERR;
+   if (nc_sync(ncid)) ERR;
+   if (check_file(ncid, 1, 1)) ERR;
+   if (nc_close(ncid)) ERR;
+   return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+   int formats[] = {NC_FORMAT_CLASSIC, NC_FORMAT_64BIT_OFFSET, NC_FORMAT_CDF5};
+   int nformats = sizeof(formats) / sizeof(formats[0]);
+   int f;
+
+   printf("\n*** Testing attributes of classic format files with big headers.\n");
+   for (f = 0; f < nformats; f++)
+   {
+#ifndef NETCDF_ENABLE_CDF5
+      if (formats[f] == NC_FORMAT_CDF5) continue;
+#endif
+      printf("*** testing format %d...", formats[f]);
+      if (run(formats[f])) ERR;
+      SUMMARIZE_ERR;
+   }
+   FINAL_RESULTS;
+}
@@ -0,0 +1,471 @@
+/*
+  Copyright 2018, UCAR/Unidata
+  See COPYRIGHT file for copying and redistribution conditions.
+
+  This is part of netCDF.
+
+  Test the block cache of byte-range (#mode=bytes) access. Files are
+  served by a minimal HTTP server running in a child process, which
+  counts the range requests it answers. A classic file is read with
+  the block cache turned off, with the defaults, and with small blocks
+  and a small cache; the data must be the same each time and the
+  cache must save most of the requests. The same is done for a
+  netCDF-4 file, and the vector reads of the cache are checked on
+  their own.
+*/
+
+#include <config.h>
+#include <nc_tests.h>
+#include "err_macros.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netcdf.h>
+#include "ncbytes.h"
+#include "nclist.h"
+#include "nchttp.h"
+#ifdef USE_HDF5
+#include <hdf5.h>
+#include "H5FDhttp.h"
+#endif
+
+#define FILE_NAME "tst_httpcache.nc"
+#define FILE_NAME4 "tst_httpcache4.nc"
+#define NREC 500
+#define NX 64
+#define NATTS 100
+
+/* Value stored at (rec, x). */
+#define VAL(r,x) ((int)(r) * 1000 + (int)(x))
+
+static volatile int *ngets = NULL; /* shared with the server */
+
+/* Read a whole file into memory */
+static char *
+slurp(const char *path, size_t *lenp)
+{
+   FILE *f;
+   char *content = NULL;
+   long len;
+
+   if ((f = fopen(path, "rb")) == NULL) return NULL;
+   if (fseek(f, 0, SEEK_END) == 0 && (len = ftell(f)) >= 0
+       && fseek(f, 0, SEEK_SET) == 0
+       && (content = malloc((size_t)len + 1)) != NULL
+       && fread(content, 1, (size_t)len, f) == (size_t)len)
+      *lenp = (size_t)len;
+   else
+   {
+      free(content);
+      content = NULL;
+   }
+   fclose(f);
+   return content;
+}
+
+static int
+create_file(void)
+{
+   int ncid, dimids[2], fixid, uid, vid, i;
+   size_t start[2] = {0, 0}, count[2] = {1, NX};
+   double u[NX];
+   int v[NX];
+   char name[32];
+
+   if (nc_create(FILE_NAME, NC_CLOBBER, &ncid)) ERR;
+   if (nc_def_dim(ncid, "rec", NC_UNLIMITED, &dimids[0])) ERR;
+   if (nc_def_dim(ncid, "x", NX, &dimids[1])) ERR;
+   /* Enough attributes that the header spans several small blocks */
+   for (i = 0; i < NATTS; i++)
+   {
+      snprintf(name, sizeof(name), "attribute_%d", i);
+      if (nc_put_att_text(ncid, NC_GLOBAL, name, strlen(name), name)) ERR;
+   }
+   if (nc_def_var(ncid, "fix", NC_INT, 1, &dimids[1], &fixid)) ERR;
+   if (nc_def_var(ncid, "u", NC_DOUBLE, 2, dimids, &uid)) ERR;
+   if (nc_def_var(ncid, "v", NC_INT, 2, dimids, &vid)) ERR;
+   if (nc_enddef(ncid)) ERR;
+   for (i = 0; i < NX; i++)
+      v[i] = -i;
+   if (nc_put_var_int(ncid, fixid, v)) ERR;
+   for (start[0] = 0; start[0] < NREC; start[0]++)
+   {
+      for (i = 0; i < NX; i++)
+      {
+         u[i] = VAL(start[0], i) + 0.5;
+         v[i] = VAL(start[0], i);
+      }
+      if (nc_put_vara_double(ncid, uid, start, count, u)) ERR;
+      if (nc_put_vara_int(ncid, vid, start, count, v)) ERR;
+   }
+   if (nc_close(ncid)) ERR;
+   return 0;
+}
+
+/* Answer one HEAD or GET request for a file in the current directory */
+static int
+respond(int fd, const char *req)
+{
+   char head[256], path[256], *content, *range;
+   size_t contentlen = 0, headlen;
+   long long lo, hi;
+   int isget = (strncmp(req, "GET ", 4) == 0);
+   int ok;
+
+   if (sscanf(req, "%*s /%255s", path) != 1
+       || (content = slurp(path, &contentlen)) == NULL)
+   {
+      const char *notfound = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+      return write(fd, notfound, strlen(notfound)) == (ssize_t)strlen(notfound);
+   }
+   lo = 0;
+   hi = (long long)contentlen - 1;
+   if ((range = strstr(req, "\nRange: bytes=")) != NULL
+       || (range = strstr(req, "\nrange: bytes=")) != NULL)
+   {
+      sscanf(range + strlen("\nRange: bytes="), "%lld-%lld", &lo, &hi);
+      if (hi >= (long long)contentlen) hi = (long long)contentlen - 1;
+      snprintf(head, sizeof(head), "HTTP/1.1 206 Partial Content\r\n"
+               "Content-Range: bytes %lld-%lld/%lld\r\n"
+               "Content-Length: %lld\r\n\r\n",
+               lo, hi, (long long)contentlen, hi - lo + 1);
+   }
+   else
+      snprintf(head, sizeof(head), "HTTP/1.1 200 OK\r\n"
+               "Accept-Ranges: bytes\r\n"
+               "Content-Length: %lld\r\n\r\n", (long long)contentlen);
+   headlen = strlen(head);
+   ok = (write(fd, head, headlen) == (ssize_t)headlen);
+   if (ok && isget)
+   {
+      __sync_fetch_and_add(ngets, 1);
+      ok = (write(fd, content + lo, (size_t)(hi - lo + 1)) == (ssize_t)(hi - lo + 1));
+   }
+   free(content);
+   return ok;
+}
+
+/* Answer requests on one connection until it closes */
+static void
+serve(int fd)
+{
+   char req[4096];
+   size_t have = 0, used;
+   char *end;
+   ssize_t n;
+
+   for (;;)
+   {
+      req[have] = '\0';
+      while ((end = strstr(req, "\r\n\r\n")) == NULL)
+      {
+         if (have >= sizeof(req) - 1) return;
+         if ((n = read(fd, req + have, sizeof(req) - 1 - have)) <= 0) return;
+         have += (size_t)n;
+         req[have] = '\0';
+      }
+      *end = '\0';
+      if (!respond(fd, req)) return;
+      /* Keep anything after this request */
+      used = (size_t)(end + 4 - req);
+      memmove(req, req + used, have - used);
+      have -= used;
+   }
+}
+
+/* Start the server in a child process; returns its pid */
+static pid_t
+start_server(int *portp)
+{
+   struct sockaddr_in addr;
+   socklen_t addrlen = sizeof(addr);
+   int lfd, one = 1;
+   pid_t pid;
+
+   if ((lfd = socket(AF_INET, SOCK_STREAM, 0)) < 0) return -1;
+   setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+   memset(&addr, 0, sizeof(addr));
+   addr.sin_family = AF_INET;
+   addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+   addr.sin_port = 0;
+   if (bind(lfd, (struct sockaddr *)&addr, sizeof(addr))
+       || getsockname(lfd, (struct sockaddr *)&addr, &addrlen)
+       || listen(lfd, 16))
+      return -1;
+   *portp = ntohs(addr.sin_port);
+   if ((pid = fork()) != 0)
+   {
+      close(lfd);
+      return pid;
+   }
+   /* Server: one process per connection */
+   signal(SIGCHLD, SIG_IGN);
+   for (;;)
+   {
+      int fd = accept(lfd, NULL, NULL);
+      if (fd < 0) continue;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+      if (fork() == 0)
+      {
+         close(lfd);
+         serve(fd);
+         _exit(0);
+      }
+      close(fd);
+   }
+}
+
+/* Read everything back through url; returns the number of GETs */
+static int
+check_url(const char *url, const char *blocksize, const char *blocks,
+          const char *readahead)
+{
+   int ncid, fixid, uid, vid, natts;
+   size_t start[2] = {0, 0}, count[2] = {1, NX};
+   double u[NX];
+   static int v[NREC][NX];
+   int before = *ngets;
+   size_t r, x;
+
+   if (nc_rc_set("NETCDF.HTTP.BLOCKSIZE", blocksize)) ERR;
+   if (nc_rc_set("NETCDF.HTTP.BLOCKCACHE", blocks)) ERR;
+   if (nc_rc_set("NETCDF.HTTP.READAHEAD", readahead)) ERR;
+   if (nc_open(url, NC_NOWRITE, &ncid)) ERR;
+   if (nc_inq_natts(ncid, &natts)) ERR;
+   if (natts != NATTS) ERR;
+   if (nc_inq_varid(ncid, "fix", &fixid)) ERR;
+   if (nc_inq_varid(ncid, "u", &uid)) ERR;
+   if (nc_inq_varid(ncid, "v", &vid)) ERR;
+
+   if (nc_get_var_int(ncid, fixid, v[0])) ERR;
+   for (x = 0; x < NX; x++)
+      if (v[0][x] != -(int)x) ERR;
+
+   /* A record scan, then the whole of the other record variable */
+   for (r = 0; r < NREC; r++)
+   {
+      start[0] = r;
+      if (nc_get_vara_double(ncid, uid, start, count, u)) ERR;
+      for (x = 0; x < NX; x++)
+         if (u[x] != VAL(r, x) + 0.5) ERR;
+   }
+   if (nc_get_var_int(ncid, vid, v[0])) ERR;
+   for (r = 0; r < NREC; r++)
+      for (x = 0; x < NX; x++)
+         if (v[r][x] != VAL(r, x)) ERR;
+   if (nc_close(ncid)) ERR;
+   return *ngets - before;
+}
+
+#ifdef USE_HDF5
+#define NGRPS 8
+#define NVARS 6
+#define NY 100
+
+static int
+create_file4(void)
+{
+   int ncid, grpid, dimids[2], varid, g, i, j;
+   size_t chunks[2] = {10, NX};
+   static int data[NY][NX];
+   char name[32];
+
+   if (nc_create(FILE_NAME4, NC_CLOBBER | NC_NETCDF4, &ncid)) ERR;
+   if (nc_def_dim(ncid, "y", NY, &dimids[0])) ERR;
+   if (nc_def_dim(ncid, "x", NX, &dimids[1])) ERR;
+   for (g = 0; g < NGRPS; g++)
+   {
+      snprintf(name, sizeof(name), "g%d", g);
+      if (nc_def_grp(ncid, name, &grpid)) ERR;
+      for (i = 0; i < NVARS; i++)
+      {
+         snprintf(name, sizeof(name), "v%d", i);
+         if (nc_def_var(grpid, name, NC_INT, 2, dimids, &varid)) ERR;
+         if (nc_def_var_chunking(grpid, varid, NC_CHUNKED, chunks)) ERR;
+         if (nc_put_att_text(grpid, varid, "units", strlen(name), name)) ERR;
+         if (nc_put_att_int(grpid, varid, "group", NC_INT, 1, &g)) ERR;
+      }
+   }
+   if (nc_enddef(ncid)) ERR;
+   for (g = 0; g < NGRPS; g++)
+   {
+      snprintf(name, sizeof(name), "g%d", g);
+      if (nc_inq_grp_ncid(ncid, name, &grpid)) ERR;
+      for (i = 0; i < NVARS; i++)
+      {
+         for (j = 0; j < NY * NX; j++)
+            data[j / NX][j % NX] = g * 100000 + i * 10000 + j;
+         if (nc_put_var_int(grpid, i, data[0])) ERR;
+      }
+   }
+   if (nc_close(ncid)) ERR;
+   return 0;
+}
+
+/* Read everything back through url; returns the number of GETs */
+static int
+check_url4(const char *url, const char *blocksize, const char *blocks,
+           const char *readahead)
+{
+   int ncid, grpid, g, i, j, ngrps, nvars;
+   static int data[NY][NX];
+   int before = *ngets;
+   char name[32];
+
+   if (nc_rc_set("NETCDF.HTTP.BLOCKSIZE", blocksize)) ERR;
+   if (nc_rc_set("NETCDF.HTTP.BLOCKCACHE", blocks)) ERR;
+   if (nc_rc_set("NETCDF.HTTP.READAHEAD", readahead)) ERR;
+   if (nc_open(url, NC_NOWRITE, &ncid)) ERR;
+   if (nc_inq_grps(ncid, &ngrps, NULL)) ERR;
+   if (ngrps != NGRPS) ERR;
+   for (g = 0; g < NGRPS; g++)
+   {
+      snprintf(name, sizeof(name), "g%d", g);
+      if (nc_inq_grp_ncid(ncid, name, &grpid)) ERR;
+      if (nc_inq_nvars(grpid, &nvars)) ERR;
+      if (nvars != NVARS) ERR;
+      for (i = 0; i < NVARS; i++)
+      {
+         if (nc_get_var_int(grpid, i, data[0])) ERR;
+         for (j = 0; j < NY * NX; j++)
+            if (data[j / NX][j % NX] != g * 100000 + i * 10000 + j) ERR;
+      }
+   }
+   if (nc_close(ncid)) ERR;
+   return *ngets - before;
+}
+#endif
+
+/* Read scattered pieces of a file with one vector read and compare
+   them with the file itself; returns the number of requests */
+static int
+check_readv(const char *url, const char *blocks)
+{
+   NC_HTTP_STATE *state = NULL;
+   NC_HTTP_CACHE *cache = NULL;
+   NC_HTTP_STATS stats;
+   long long len = 0;
+   size_t contentlen = 0;
+   char *content;
+   /* Out of order, overlapping, sharing blocks, and past the end */
+   size64_t starts[] = {70000, 100, 0, 5000, 5100, 200000, 0};
+   size64_t counts[] = {3000, 1000, 8, 100, 100, 5000, 0};
+   char bufs[7][5000];
+   void *bufp[7];
+   int i, n = 7;
+
+   if ((content = slurp(FILE_NAME, &contentlen)) == NULL) ERR;
+   starts[5] = contentlen - 1000; /* runs 4000 bytes past the end */
+   if (nc_rc_set("NETCDF.HTTP.BLOCKSIZE", "4096")) ERR;
+   if (nc_rc_set("NETCDF.HTTP.BLOCKCACHE", blocks)) ERR;
+   if (nc_http_open(url, &state)) ERR;
+   if (nc_http_size(state, &len)) ERR;
+   if (len != (long long)contentlen) ERR;
+   if (nc_http_cache_open(state, len, NULL, &cache)) ERR;
+   for (i = 0; i < n; i++)
+   {
+      memset(bufs[i], 0x5a, sizeof(bufs[i]));
+      bufp[i] = bufs[i];
+   }
+   if (nc_http_cache_readv(cache, (size_t)n, starts, counts, bufp)) ERR;
+   for (i = 0; i < n; i++)
+   {
+      size64_t k;
+      for (k = 0; k < counts[i]; k++)
+      {
+         char expected = (starts[i] + k < contentlen ? content[starts[i] + k] : 0);
+         if (bufs[i][k] != expected) ERR;
+      }
+   }
+   nc_http_cache_stats(cache, &stats);
+   nc_http_cache_close(cache);
+   nc_http_close(state);
+   free(content);
+   return (int)stats.requests;
+}
+
+int
+main(int argc, char **argv)
+{
+   char url[256];
+   int port = 0, nocache, cached;
+   pid_t server;
+
+   printf("\n*** Testing the HTTP byte-range block cache.\n");
+   printf("*** creating and serving test files...");
+   if (create_file()) ERR;
+#ifdef USE_HDF5
+   if (create_file4()) ERR;
+#endif
+   ngets = mmap(NULL, sizeof(int), PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+   if (ngets == MAP_FAILED) ERR;
+   *ngets = 0;
+   if ((server = start_server(&port)) < 0) ERR;
+   snprintf(url, sizeof(url), "http://127.0.0.1:%d/%s#mode=bytes", port, FILE_NAME);
+   SUMMARIZE_ERR;
+
+   printf("*** reading without the block cache...");
+   nocache = check_url(url, "65536", "0", "0");
+   SUMMARIZE_ERR;
+
+   printf("*** reading with the default block cache...");
+   cached = check_url(url, "65536", "64", "4");
+   printf("%d requests, %d without the cache...", cached, nocache);
+   /* The record scan alone took NREC requests without the cache */
+   if (nocache < NREC) ERR;
+   if (cached > 10) ERR;
+   SUMMARIZE_ERR;
+
+   printf("*** reading with small blocks and a small cache...");
+   check_url(url, "1000", "8", "2");
+   check_url(url, "4096", "3", "0");
+   SUMMARIZE_ERR;
+
+   printf("*** vector reads with and without the cache...");
+   snprintf(url, sizeof(url), "http://127.0.0.1:%d/%s", port, FILE_NAME);
+   /* The pieces need blocks 0-1, 17 and the last blocks of the file */
+   if (check_readv(url, "64") != 3) ERR;
+   /* The pieces in the first few kilobytes are close enough to merge */
+   if (check_readv(url, "0") != 3) ERR;
+   SUMMARIZE_ERR;
+
+#ifdef USE_HDF5
+   {
+      H5FD_http_stats_t stats;
+
+      printf("*** reading a netCDF-4 file without the page cache...");
+      snprintf(url, sizeof(url), "http://127.0.0.1:%d/%s#mode=bytes", port, FILE_NAME4);
+      nocache = check_url4(url, "65536", "0", "0");
+      SUMMARIZE_ERR;
+
+      printf("*** reading a netCDF-4 file with the default page cache...");
+      if (H5FD_http_get_stats(NULL, 1) < 0) ERR;
+      cached = check_url4(url, "65536", "64", "4");
+      if (H5FD_http_get_stats(&stats, 0) < 0) ERR;
+      printf("%d requests, %d without the cache...", cached, nocache);
+      if (cached * 4 > nocache) ERR;
+      /* All but the format check are made by the driver */
+      if (stats.requests + 1 != (unsigned long long)cached) ERR;
+      if (stats.hits == 0 || stats.hits < stats.misses) ERR;
+      SUMMARIZE_ERR;
+
+      printf("*** reading a netCDF-4 file with small pages and a small cache...");
+      check_url4(url, "1000", "8", "2");
+      SUMMARIZE_ERR;
+   }
+#endif
+
+   kill(server, SIGTERM);
+   waitpid(server, NULL, 0);
+   FINAL_RESULTS;
+}
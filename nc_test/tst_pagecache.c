@@ -0,0 +1,144 @@
+/*
+  Copyright 2018, UCAR/Unidata
+  See COPYRIGHT file for copying and redistribution conditions.
+
+  This is part of netCDF.
+
+  Test classic format files with different sizes of page pool
+  (NETCDF.PAGECACHE). Two variables are written and read
+  alternately, the file is reopened for writing and grown with
+  nc_redef so that the data is moved, and the results are checked
+  each time. The file is opened with a small chunksize hint so the
+  variables span many pages.
+*/
+
+#include <config.h>
+#include <nc_tests.h>
+#include "err_macros.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <netcdf.h>
+
+#define FILE_NAME "tst_pagecache.nc"
+#define NREC 20
+#define NX 700
+#define CHUNKSIZE 512
+
+/* Value stored at (rec, x) of variable v. */
+#define VAL(v,r,x) ((int)((size_t)(v) * 1000000 + (size_t)(r) * 1000 + (size_t)(x)))
+
+/* Read u and v alternately, a row at a time, and check them. */
+static int
+check_vars(int ncid, int nvars)
+{
+   int varid, v;
+   size_t start[2] = {0, 0}, count[2] = {1, NX};
+   int data[NX];
+   size_t r, x;
+
+   for (r = 0; r < NREC; r++)
+      for (v = 0; v < nvars; v++)
+      {
+         start[0] = r;
+         if (nc_inq_varid(ncid, v ? "v" : "u", &varid)) ERR;
+         if (nc_get_vara_int(ncid, varid, start, count, data)) ERR;
+         for (x = 0; x < NX; x++)
+            if (data[x] != VAL(v, r, x)) ERR;
+      }
+   return 0;
+}
+
+static int
+run(const char *pages, int isrec)
+{
+   int ncid, dimids[2], varids[2], tid;
+   size_t chunksize = CHUNKSIZE;
+   size_t start[2] = {0, 0}, count[2] = {1, NX};
+   int data[NX];
+   size_t r, x;
+   int v;
+
+   if (nc_rc_set("NETCDF.PAGECACHE", pages)) ERR;
+
+   /* Write u and v alternately. */
+   if (nc__create(FILE_NAME, NC_CLOBBER, 0, &chunksize, &ncid)) ERR;
+   if (isrec)
+   {
+      if (nc_def_dim(ncid, "time", NC_UNLIMITED, &dimids[0])) ERR;
+   }
+   else
+   {
+      if (nc_def_dim(ncid, "time", NREC, &dimids[0])) ERR;
+   }
+   if (nc_def_dim(ncid, "x", NX, &dimids[1])) ERR;
+   if (nc_def_var(ncid, "u", NC_INT, 2, dimids, &varids[0])) ERR;
+   if (nc_def_var(ncid, "v", NC_INT, 2, dimids, &varids[1])) ERR;
+   if (nc_enddef(ncid)) ERR;
+   for (r = 0; r < NREC; r++)
+      for (v = 0; v < 2; v++)
+      {
+         start[0] = r;
+         for (x = 0; x < NX; x++)
+            data[x] = VAL(v, r, x);
+         if (nc_put_vara_int(ncid, varids[v], start, count, data)) ERR;
+      }
+   if (check_vars(ncid, 2)) ERR;
+   if (nc_sync(ncid)) ERR;
+   if (check_vars(ncid, 2)) ERR;
+   if (nc_close(ncid)) ERR;
+
+   /* Read them back alternately. */
+   if (nc__open(FILE_NAME, NC_NOWRITE, &chunksize, &ncid)) ERR;
+   if (check_vars(ncid, 2)) ERR;
+   if (nc_close(ncid)) ERR;
+
+   /* Grow the header and add a variable, which moves the data. */
+   if (nc__open(FILE_NAME, NC_WRITE, &chunksize, &ncid)) ERR;
+   if (check_vars(ncid, 2)) ERR;
+   if (nc_redef(ncid)) ERR;
+   if (nc_put_att_text(ncid, NC_GLOBAL, "title", 1000 - 1,
+                       "a long title, repeated to push the data along the file")) ERR;
+   if (nc_def_var(ncid, "t", NC_INT, 1, dimids, &tid)) ERR;
+   if (nc_enddef(ncid)) ERR;
+   if (check_vars(ncid, 2)) ERR;
+   for (r = 0; r < NREC; r++)
+   {
+      int t = (int)r;
+      start[0] = r;
+      if (nc_put_var1_int(ncid, tid, start, &t)) ERR;
+   }
+   if (nc_close(ncid)) ERR;
+
+   if (nc__open(FILE_NAME, NC_NOWRITE, &chunksize, &ncid)) ERR;
+   if (check_vars(ncid, 2)) ERR;
+   for (r = 0; r < NREC; r++)
+   {
+      int t;
+      start[0] = r;
+      if (nc_get_var1_int(ncid, tid, start, &t)) ERR;
+      if (t != (int)r) ERR;
+   }
+   if (nc_close(ncid)) ERR;
+   return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+   const char *sizes[] = {"0", "1", "2", "16", "1000"};
+   int nsizes = sizeof(sizes) / sizeof(sizes[0]);
+   int s;
+
+   printf("\n*** Testing the classic format page pool.\n");
+   for (s = 0; s < nsizes; s++)
+   {
+      printf("*** testing %s pages, fixed size variables...", sizes[s]);
+      if (run(sizes[s], 0)) ERR;
+      SUMMARIZE_ERR;
+      printf("*** testing %s pages, record variables...", sizes[s]);
+      if (run(sizes[s], 1)) ERR;
+      SUMMARIZE_ERR;
+   }
+   FINAL_RESULTS;
+}
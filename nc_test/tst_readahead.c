@@ -0,0 +1,116 @@
+/*
+  Copyright 2018, UCAR/Unidata
+  See COPYRIGHT file for copying and redistribution conditions.
+
+  This is part of netCDF.
+
+  Test that classic format files read the same with read-ahead
+  (NETCDF.READAHEAD) turned on. The file is opened with a small
+  chunksize hint so that reading a variable straight through and
+  reading a record variable record by record both cross many pages.
+*/
+
+#include <config.h>
+#include <nc_tests.h>
+#include "err_macros.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <netcdf.h>
+
+#define FILE_NAME "tst_readahead.nc"
+#define NREC 50
+#define NX 1000
+#define CHUNKSIZE 512
+
+/* Value stored at (rec, x). */
+#define VAL(r,x) ((int)((r) * 10000 + (x)))
+
+static int
+check_file(const char *pages)
+{
+   int ncid, fixid, recid;
+   size_t chunksize = CHUNKSIZE;
+   size_t start[2] = {0, 0}, count[2] = {1, NX};
+   int data[NX];
+   size_t r, x;
+
+   if (nc_rc_set("NETCDF.READAHEAD", pages)) ERR;
+   if (nc__open(FILE_NAME, NC_NOWRITE, &chunksize, &ncid)) ERR;
+   if (nc_inq_varid(ncid, "fix", &fixid)) ERR;
+   if (nc_inq_varid(ncid, "rec", &recid)) ERR;
+
+   /* Read the fixed variable front to back, a piece at a time. */
+   for (x = 0; x < NX; x += 100)
+   {
+      start[1] = x;
+      count[1] = 100;
+      if (nc_get_vara_int(ncid, fixid, &start[1], &count[1], data)) ERR;
+      for (r = 0; r < 100; r++)
+         if (data[r] != VAL(0, x + r)) ERR;
+   }
+
+   /* Read the record variable one record at a time. */
+   start[1] = 0;
+   count[1] = NX;
+   for (r = 0; r < NREC; r++)
+   {
+      start[0] = r;
+      if (nc_get_vara_int(ncid, recid, start, count, data)) ERR;
+      for (x = 0; x < NX; x++)
+         if (data[x] != VAL(r, x)) ERR;
+   }
+
+   /* And backwards, which is not sequential. */
+   for (r = NREC; r-- > 0;)
+   {
+      start[0] = r;
+      if (nc_get_vara_int(ncid, recid, start, count, data)) ERR;
+      if (data[NX - 1] != VAL(r, NX - 1)) ERR;
+   }
+   if (nc_close(ncid)) ERR;
+   return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+   int ncid, dimids[2], fixid, recid, rec2id;
+   size_t start[2] = {0, 0}, count[2] = {1, NX};
+   int data[NX];
+   size_t r, x;
+
+   printf("\n*** Testing read-ahead of classic format files.\n");
+   printf("*** creating test file...");
+   if (nc_create(FILE_NAME, NC_CLOBBER, &ncid)) ERR;
+   if (nc_def_dim(ncid, "time", NC_UNLIMITED, &dimids[0])) ERR;
+   if (nc_def_dim(ncid, "x", NX, &dimids[1])) ERR;
+   if (nc_def_var(ncid, "fix", NC_INT, 1, &dimids[1], &fixid)) ERR;
+   if (nc_def_var(ncid, "rec", NC_INT, 2, dimids, &recid)) ERR;
+   /* A second record variable, so the records are not contiguous. */
+   if (nc_def_var(ncid, "rec2", NC_INT, 2, dimids, &rec2id)) ERR;
+   if (nc_enddef(ncid)) ERR;
+   for (x = 0; x < NX; x++)
+      data[x] = VAL(0, x);
+   if (nc_put_var_int(ncid, fixid, data)) ERR;
+   for (r = 0; r < NREC; r++)
+   {
+      start[0] = r;
+      for (x = 0; x < NX; x++)
+         data[x] = VAL(r, x);
+      if (nc_put_vara_int(ncid, recid, start, count, data)) ERR;
+      if (nc_put_vara_int(ncid, rec2id, start, count, data)) ERR;
+   }
+   if (nc_close(ncid)) ERR;
+   SUMMARIZE_ERR;
+
+   printf("*** reading without read-ahead...");
+   if (check_file("0")) ERR;
+   SUMMARIZE_ERR;
+
+   printf("*** reading with read-ahead...");
+   if (check_file("4")) ERR;
+   if (check_file("64")) ERR;
+   SUMMARIZE_ERR;
+   FINAL_RESULTS;
+}
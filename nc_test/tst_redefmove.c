@@ -0,0 +1,148 @@
+/*
+  Copyright 2018, UCAR/Unidata
+  See COPYRIGHT file for copying and redistribution conditions.
+
+  This is part of netCDF.
+
+  Test that the data of classic format files survives being moved
+  by nc_enddef: growing the header, adding fixed size and record
+  variables, and changing the alignment, with and without NC_SHARE
+  and NC_DISKLESS.
+*/
+
+#include <config.h>
+#include <nc_tests.h>
+#include "err_macros.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <netcdf.h>
+
+#define FILE_NAME "tst_redefmove.nc"
+#define NREC 30
+#define NX 3001
+#define NFIX 50000
+
+/* Value stored at (rec, x) of variable v. */
+#define VAL(v,r,x) ((int)((size_t)(v) * 10000000 + (size_t)(r) * 10000 + (size_t)(x)))
+
+static int
+check(int ncid)
+{
+   int varid, v;
+   size_t start[2] = {0, 0}, count[2] = {1, NX};
+   int *data;
+   size_t r, x;
+
+   if (!(data = malloc(NFIX * sizeof(int)))) ERR;
+   if (nc_inq_varid(ncid, "fix", &varid)) ERR;
+   if (nc_get_var_int(ncid, varid, data)) ERR;
+   for (x = 0; x < NFIX; x++)
+      if (data[x] != VAL(9, 0, x)) ERR;
+   for (v = 0; v < 2; v++)
+   {
+      if (nc_inq_varid(ncid, v ? "v" : "u", &varid)) ERR;
+      for (r = 0; r < NREC; r++)
+      {
+         start[0] = r;
+         if (nc_get_vara_int(ncid, varid, start, count, data)) ERR;
+         for (x = 0; x < NX; x++)
+            if (data[x] != VAL(v, r, x)) ERR;
+      }
+   }
+   free(data);
+   return 0;
+}
+
+static int
+run(int format, int mode)
+{
+   int ncid, dimids[2], varids[3], varid;
+   size_t start[2] = {0, 0}, count[2] = {1, NX};
+   int *data;
+   size_t r, x;
+   int v;
+
+   if (nc_set_default_format(format, NULL)) ERR;
+   if (!(data = malloc(NFIX * sizeof(int)))) ERR;
+
+   if (nc_create(FILE_NAME, NC_CLOBBER | mode, &ncid)) ERR;
+   if (nc_def_dim(ncid, "time", NC_UNLIMITED, &dimids[0])) ERR;
+   if (nc_def_dim(ncid, "x", NX, &dimids[1])) ERR;
+   if (nc_def_dim(ncid, "nfix", NFIX, &varid)) ERR;
+   if (nc_def_var(ncid, "fix", NC_INT, 1, &varid, &varids[2])) ERR;
+   if (nc_def_var(ncid, "u", NC_INT, 2, dimids, &varids[0])) ERR;
+   if (nc_def_var(ncid, "v", NC_INT, 2, dimids, &varids[1])) ERR;
+   if (nc_enddef(ncid)) ERR;
+   for (x = 0; x < NFIX; x++)
+      data[x] = VAL(9, 0, x);
+   if (nc_put_var_int(ncid, varids[2], data)) ERR;
+   for (r = 0; r < NREC; r++)
+      for (v = 0; v < 2; v++)
+      {
+         start[0] = r;
+         for (x = 0; x < NX; x++)
+            data[x] = VAL(v, r, x);
+         if (nc_put_vara_int(ncid, varids[v], start, count, data)) ERR;
+      }
+   free(data);
+
+   /* Grow the header: all the data moves by the same amount. */
+   if (nc_redef(ncid)) ERR;
+   if (nc_put_att_text(ncid, NC_GLOBAL, "history", 40, "0123456789012345678901234567890123456789")) ERR;
+   if (nc_enddef(ncid)) ERR;
+   if (check(ncid)) ERR;
+
+   /* Add a fixed size variable: the records move. */
+   if (nc_redef(ncid)) ERR;
+   if (nc_def_var(ncid, "fix2", NC_DOUBLE, 1, &dimids[1], &varid)) ERR;
+   if (nc_enddef(ncid)) ERR;
+   if (check(ncid)) ERR;
+
+   /* Add a record variable: the record size grows. */
+   if (nc_redef(ncid)) ERR;
+   if (nc_def_var(ncid, "w", NC_SHORT, 2, dimids, &varid)) ERR;
+   if (nc_enddef(ncid)) ERR;
+   if (check(ncid)) ERR;
+
+   /* Grow the header and change the alignment of the data. */
+   if (nc_redef(ncid)) ERR;
+   if (nc_put_att_text(ncid, NC_GLOBAL, "title", 3, "abc")) ERR;
+   if (nc__enddef(ncid, 1000, 512, 3000, 4096)) ERR;
+   if (check(ncid)) ERR;
+   if (nc_close(ncid)) ERR;
+
+   if (!(mode & NC_DISKLESS))
+   {
+      if (nc_open(FILE_NAME, NC_NOWRITE, &ncid)) ERR;
+      if (check(ncid)) ERR;
+      if (nc_close(ncid)) ERR;
+   }
+   return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+   int formats[] = {NC_FORMAT_CLASSIC, NC_FORMAT_64BIT_OFFSET, NC_FORMAT_CDF5};
+   int nformats = sizeof(formats) / sizeof(formats[0]);
+   int f;
+
+   printf("\n*** Testing data moved by nc_enddef.\n");
+   for (f = 0; f < nformats; f++)
+   {
+#ifndef NETCDF_ENABLE_CDF5
+      if (formats[f] == NC_FORMAT_CDF5) continue;
+#endif
+      printf("*** testing format %d...", formats[f]);
+      if (run(formats[f], 0)) ERR;
+      SUMMARIZE_ERR;
+      printf("*** testing format %d with NC_SHARE...", formats[f]);
+      if (run(formats[f], NC_SHARE)) ERR;
+      SUMMARIZE_ERR;
+      printf("*** testing format %d with NC_DISKLESS...", formats[f]);
+      if (run(formats[f], NC_DISKLESS)) ERR;
+      SUMMARIZE_ERR;
+   }
+   FINAL_RESULTS;
+}
@@ -0,0 +1,223 @@
+/*
+  Copyright 2018, UCAR/Unidata
+  See COPYRIGHT file for copying and redistribution conditions.
+
+  This is part of netCDF.
+
+  Test strided reads and writes (nc_get_vars/nc_put_vars) of fixed
+  and record variables in the classic formats. The file is opened
+  with a small chunksize hint so that a strided run spans several
+  ncio regions.
+*/
+
+#include <config.h>
+#include <nc_tests.h>
+#include "err_macros.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <netcdf.h>
+
+#define FILE_NAME "tst_strided3.nc"
+#define NREC 7
+#define NY 9
+#define NX 131
+#define CHUNKSIZE 256
+
+/* Value stored at (rec, y, x). */
+#define VAL(r,y,x) ((int)((r) * 10000 + (y) * 1000 + (x)))
+
+static int
+check_vars(int ncid, int varid, int isrec, const size_t *start,
+           const size_t *count, const ptrdiff_t *stride)
+{
+   double *data;
+   size_t nrec = isrec ? count[0] : 1;
+   size_t n = nrec * count[1] * count[2];
+   size_t r, y, x, i = 0;
+   int off = isrec ? 0 : 1;
+
+   if (!(data = malloc(n * sizeof(double)))) ERR;
+   if (nc_get_vars_double(ncid, varid, start + off, count + off,
+                          stride + off, data)) ERR;
+   for (r = 0; r < nrec; r++)
+      for (y = 0; y < count[1]; y++)
+         for (x = 0; x < count[2]; x++, i++)
+         {
+            size_t rr = isrec ? start[0] + r * (size_t)stride[0] : 0;
+            size_t yy = start[1] + y * (size_t)stride[1];
+            size_t xx = start[2] + x * (size_t)stride[2];
+            if (data[i] != (double)VAL(rr, yy, xx)) ERR;
+         }
+   free(data);
+   return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+   int formats[] = {NC_FORMAT_CLASSIC, NC_FORMAT_64BIT_OFFSET, NC_FORMAT_CDF5};
+   int nformats = sizeof(formats) / sizeof(formats[0]);
+   int f;
+
+   printf("\n*** Testing strided access to classic format variables.\n");
+   for (f = 0; f < nformats; f++)
+   {
+      int ncid, dimids[3], fixid, recid, rec1id;
+      size_t chunksize = CHUNKSIZE;
+      int *buf;
+      size_t r, y, x;
+
+#ifndef NETCDF_ENABLE_CDF5
+      if (formats[f] == NC_FORMAT_CDF5) continue;
+#endif
+      printf("*** testing format %d...", formats[f]);
+      if (nc_set_default_format(formats[f], NULL)) ERR;
+
+      /* Write the file with nc_put_vara. */
+      if (nc_create(FILE_NAME, NC_CLOBBER, &ncid)) ERR;
+      if (nc_def_dim(ncid, "time", NC_UNLIMITED, &dimids[0])) ERR;
+      if (nc_def_dim(ncid, "y", NY, &dimids[1])) ERR;
+      if (nc_def_dim(ncid, "x", NX, &dimids[2])) ERR;
+      if (nc_def_var(ncid, "fix", NC_INT, 2, &dimids[1], &fixid)) ERR;
+      if (nc_def_var(ncid, "rec", NC_INT, 3, dimids, &recid)) ERR;
+      if (nc_def_var(ncid, "rec1", NC_SHORT, 1, dimids, &rec1id)) ERR;
+      if (nc_enddef(ncid)) ERR;
+
+      if (!(buf = malloc(NREC * NY * NX * sizeof(int)))) ERR;
+      for (r = 0; r < NREC; r++)
+         for (y = 0; y < NY; y++)
+            for (x = 0; x < NX; x++)
+               buf[(r * NY + y) * NX + x] = VAL(r, y, x);
+      {
+         size_t start[3] = {0, 0, 0}, count[3] = {NREC, NY, NX};
+         short s[NREC];
+         if (nc_put_vara_int(ncid, fixid, start + 1, count + 1, buf)) ERR;
+         if (nc_put_vara_int(ncid, recid, start, count, buf)) ERR;
+         for (r = 0; r < NREC; r++)
+            s[r] = (short)VAL(r, 0, 0);
+         if (nc_put_vara_short(ncid, rec1id, start, count, s)) ERR;
+      }
+      if (nc_close(ncid)) ERR;
+
+      /* Read back with various strides. */
+      if (nc__open(FILE_NAME, NC_NOWRITE, &chunksize, &ncid)) ERR;
+      {
+         size_t start[3] = {0, 0, 0}, count[3] = {NREC, NY, NX};
+         ptrdiff_t stride[3] = {1, 1, 1};
+
+         /* Every 4th point along x, every 2nd row and record. */
+         stride[0] = 2; stride[1] = 2; stride[2] = 4;
+         count[0] = 4; count[1] = 5; count[2] = 33;
+         if (check_vars(ncid, fixid, 0, start, count, stride)) ERR;
+         if (check_vars(ncid, recid, 1, start, count, stride)) ERR;
+
+         /* Stride along x wider than the chunksize hint. */
+         start[0] = 1; start[1] = 1; start[2] = 3;
+         stride[0] = 3; stride[1] = 7; stride[2] = 100;
+         count[0] = 2; count[1] = 2; count[2] = 2;
+         if (check_vars(ncid, fixid, 0, start, count, stride)) ERR;
+         if (check_vars(ncid, recid, 1, start, count, stride)) ERR;
+
+         /* Contiguous runs along x, strided outer dimensions. */
+         start[0] = 0; start[1] = 0; start[2] = 5;
+         stride[0] = 3; stride[1] = 4; stride[2] = 1;
+         count[0] = 3; count[1] = 3; count[2] = 100;
+         if (check_vars(ncid, fixid, 0, start, count, stride)) ERR;
+         if (check_vars(ncid, recid, 1, start, count, stride)) ERR;
+
+         /* One-dimensional record variable. */
+         {
+            size_t s1 = 1, c1 = 3;
+            ptrdiff_t st1 = 2;
+            short s[3];
+            if (nc_get_vars_short(ncid, rec1id, &s1, &c1, &st1, s)) ERR;
+            for (r = 0; r < c1; r++)
+               if (s[r] != (short)VAL(s1 + r * (size_t)st1, 0, 0)) ERR;
+
+            /* Last strided index beyond the number of records. */
+            c1 = 4;
+            if (nc_get_vars_short(ncid, rec1id, &s1, &c1, &st1, s) != NC_EEDGE) ERR;
+         }
+
+         /* Last strided index beyond the dimension length. */
+         start[0] = 0; start[1] = 0; start[2] = 0;
+         stride[0] = 1; stride[1] = 1; stride[2] = 2;
+         count[0] = 1; count[1] = 1; count[2] = NX / 2 + 2;
+         {
+            double d[NX];
+            if (nc_get_vars_double(ncid, fixid, start + 1, count + 1,
+                                   stride + 1, d) != NC_EEDGE) ERR;
+            stride[2] = 0;
+            if (nc_get_vars_double(ncid, fixid, start + 1, count + 1,
+                                   stride + 1, d) != NC_ESTRIDE) ERR;
+         }
+      }
+      if (nc_close(ncid)) ERR;
+
+      /* Overwrite every 3rd x of every other row with negated values,
+       * then check that only those elements changed. */
+      if (nc__open(FILE_NAME, NC_WRITE, &chunksize, &ncid)) ERR;
+      {
+         size_t start[3] = {1, 1, 2}, count[3] = {3, 4, 43};
+         ptrdiff_t stride[3] = {2, 2, 3};
+         int *data, *back;
+         size_t all[3] = {NREC + 2, NY, NX}, zero[3] = {0, 0, 0};
+         size_t i = 0;
+
+         if (!(data = malloc(count[0] * count[1] * count[2] * sizeof(int)))) ERR;
+         for (y = 0; y < count[1]; y++)
+            for (x = 0; x < count[2]; x++)
+               data[i++] = -VAL(0, start[1] + y * (size_t)stride[1],
+                                start[2] + x * (size_t)stride[2]);
+         if (nc_put_vars_int(ncid, fixid, start + 1, count + 1, stride + 1, data)) ERR;
+
+         /* This one extends the record dimension. */
+         start[0] = 5;
+         i = 0;
+         for (r = 0; r < count[0]; r++)
+            for (y = 0; y < count[1]; y++)
+               for (x = 0; x < count[2]; x++)
+                  data[i++] = -VAL(start[0] + r * (size_t)stride[0],
+                                   start[1] + y * (size_t)stride[1],
+                                   start[2] + x * (size_t)stride[2]);
+         if (nc_put_vars_int(ncid, recid, start, count, stride, data)) ERR;
+         if (nc_sync(ncid)) ERR;
+
+         {
+            size_t nrecs;
+            if (nc_inq_dimlen(ncid, dimids[0], &nrecs)) ERR;
+            if (nrecs != start[0] + (count[0] - 1) * (size_t)stride[0] + 1) ERR;
+            all[0] = nrecs;
+         }
+
+         if (!(back = malloc(all[0] * NY * NX * sizeof(int)))) ERR;
+         if (nc_get_vara_int(ncid, fixid, zero + 1, all + 1, back)) ERR;
+         for (y = 0; y < NY; y++)
+            for (x = 0; x < NX; x++)
+            {
+               int hit = (y >= 1 && (y - 1) % 2 == 0 && (y - 1) / 2 < count[1] &&
+                          x >= 2 && (x - 2) % 3 == 0 && (x - 2) / 3 < count[2]);
+               int expect = hit ? -VAL(0, y, x) : VAL(0, y, x);
+               if (back[y * NX + x] != expect) ERR;
+            }
+         if (nc_get_vara_int(ncid, recid, zero, all, back)) ERR;
+         for (r = 0; r < NREC; r++)
+            for (y = 0; y < NY; y++)
+               for (x = 0; x < NX; x++)
+               {
+                  int hit = (r >= 5 && (r - 5) % 2 == 0 &&
+                             y >= 1 && (y - 1) % 2 == 0 && (y - 1) / 2 < count[1] &&
+                             x >= 2 && (x - 2) % 3 == 0 && (x - 2) / 3 < count[2]);
+                  int expect = hit ? -VAL(r, y, x) : VAL(r, y, x);
+                  if (back[(r * NY + y) * NX + x] != expect) ERR;
+               }
+         free(back);
+         free(data);
+      }
+      if (nc_close(ncid)) ERR;
+      free(buf);
+      SUMMARIZE_ERR;
+   }
+   FINAL_RESULTS;
+}
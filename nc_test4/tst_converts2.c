@@ -222,5 +222,35 @@ main(int argc, char **argv)
       if (nc_close(ncid)) ERR;
    }
    SUMMARIZE_ERR;
+   printf ("*** Testing float to int conversions at the limits...");
+   {
+#define NEDGE 4
+      /* The floats on either side of X_INT_MAX and X_INT_MIN. The
+       * range check must be done in double: in float, X_INT_MAX
+       * rounds up to 2^31, which would then not be out of range. */
+      float edge[NEDGE] = {2147483520.0f, 2147483648.0f,
+                           -2147483648.0f, -2147483904.0f};
+      int inrange[NEDGE] = {1, 0, 1, 0};
+      int dimid, iedge[NEDGE];
+      size_t i;
+
+      if (nc_create(FILE_NAME, NC_NETCDF4, &ncid)) ERR;
+      if (nc_def_dim(ncid, DIM_NAME, NEDGE, &dimid)) ERR;
+      if (nc_def_var(ncid, VAR_NAME, NC_FLOAT, 1, &dimid, &varid)) ERR;
+      if (nc_put_var_float(ncid, varid, edge)) ERR;
+      if (nc_close(ncid)) ERR;
+
+      if (nc_open(FILE_NAME, NC_NOWRITE, &ncid)) ERR;
+      for (i = 0; i < NEDGE; i++)
+      {
+         int ret = nc_get_var1_int(ncid, varid, &i, &int_in);
+         if (inrange[i] ? ret != NC_NOERR : ret != NC_ERANGE) ERR;
+         if (inrange[i] && int_in != (int)edge[i]) ERR;
+      }
+      if (nc_get_var_int(ncid, varid, iedge) != NC_ERANGE) ERR;
+      if (iedge[0] != 2147483520 || iedge[2] != -2147483647 - 1) ERR;
+      if (nc_close(ncid)) ERR;
+   }
+   SUMMARIZE_ERR;
    FINAL_RESULTS;
 }
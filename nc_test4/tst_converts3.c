@@ -0,0 +1,170 @@
+/* This is part of the netCDF package.
+   Copyright 2018 University Corporation for Atmospheric Research/Unidata
+   See COPYRIGHT file for conditions of use.
+
+   Test reads and writes with type conversion that are large enough
+   to be done a strip at a time.
+*/
+
+#include <nc_tests.h>
+#include "err_macros.h"
+#include "netcdf.h"
+#include <math.h>
+
+#define FILE_NAME "tst_converts3.nc"
+#define NY 1000
+#define NX 2000
+#define NC 600000
+#define NREC 300
+#define NREC2 400
+
+/* Value stored at (y, x), fits in a short. */
+#define VAL(y,x) ((int)(((y) * 7 + (x) * 3) % 30000) - 15000)
+
+int
+main(int argc, char **argv)
+{
+   int ncid, dimids[4], sid, cid, bid, rid, r2id, qid;
+   size_t chunks[2] = {64, 250};
+   size_t y, x;
+   int *ibuf;
+   float *fbuf;
+   double *dbuf;
+
+   if (!(ibuf = malloc(NY * NX * sizeof(int)))) ERR;
+   if (!(fbuf = malloc(NY * NX * sizeof(float)))) ERR;
+   if (!(dbuf = malloc(NY * NX * sizeof(double)))) ERR;
+
+   printf("\n*** Testing large netcdf-4 data conversions.\n");
+   printf("*** writing with conversion...");
+   {
+      size_t start[2] = {0, 0}, count[2] = {NY, NX};
+      signed char b[NREC2];
+
+      if (nc_create(FILE_NAME, NC_NETCDF4|NC_CLOBBER, &ncid)) ERR;
+      if (nc_def_dim(ncid, "y", NY, &dimids[0])) ERR;
+      if (nc_def_dim(ncid, "x", NX, &dimids[1])) ERR;
+      if (nc_def_dim(ncid, "c", NC, &dimids[2])) ERR;
+      if (nc_def_dim(ncid, "time", NC_UNLIMITED, &dimids[3])) ERR;
+      if (nc_def_var(ncid, "s", NC_SHORT, 2, dimids, &sid)) ERR;
+      if (nc_def_var_chunking(ncid, sid, NC_CHUNKED, chunks)) ERR;
+      if (nc_def_var(ncid, "c", NC_FLOAT, 1, &dimids[2], &cid)) ERR;
+      if (nc_def_var_chunking(ncid, cid, NC_CONTIGUOUS, NULL)) ERR;
+      if (nc_def_var(ncid, "b", NC_BYTE, 2, dimids, &bid)) ERR;
+      {
+         int rdimids[2] = {dimids[3], dimids[1]};
+         if (nc_def_var(ncid, "r", NC_SHORT, 2, rdimids, &rid)) ERR;
+      }
+      if (nc_def_var(ncid, "r2", NC_BYTE, 1, &dimids[3], &r2id)) ERR;
+      if (nc_def_var(ncid, "q", NC_FLOAT, 2, dimids, &qid)) ERR;
+      if (nc_def_var_quantize(ncid, qid, NC_QUANTIZE_BITGROOM, 3)) ERR;
+      if (nc_enddef(ncid)) ERR;
+
+      /* int -> short */
+      for (y = 0; y < NY; y++)
+         for (x = 0; x < NX; x++)
+            ibuf[y * NX + x] = VAL(y, x);
+      if (nc_put_vara_int(ncid, sid, start, count, ibuf)) ERR;
+
+      /* double -> float, contiguous */
+      for (x = 0; x < NC; x++)
+         dbuf[x] = (double)x * 0.5;
+      if (nc_put_var_double(ncid, cid, dbuf)) ERR;
+
+      /* int -> byte, with one value out of range at the very end. */
+      for (y = 0; y < NY * NX; y++)
+         ibuf[y] = (int)(y % 200) - 100;
+      ibuf[NY * NX - 1] = 1000;
+      if (nc_put_vara_int(ncid, bid, start, count, ibuf) != NC_ERANGE) ERR;
+
+      /* int -> short, record variable. */
+      count[0] = NREC;
+      for (y = 0; y < NREC; y++)
+         for (x = 0; x < NX; x++)
+            ibuf[y * NX + x] = VAL(y, x);
+      if (nc_put_vara_int(ncid, rid, start, count, ibuf)) ERR;
+      for (y = 0; y < NREC2; y++)
+         b[y] = (signed char)y;
+      count[0] = NREC2;
+      if (nc_put_vara_schar(ncid, r2id, start, count, b)) ERR;
+
+      /* double -> float with quantization. */
+      for (y = 0; y < NY * NX; y++)
+         dbuf[y] = 1.0 + (double)y * 0.001;
+      if (nc_put_var_double(ncid, qid, dbuf)) ERR;
+      if (nc_close(ncid)) ERR;
+   }
+   SUMMARIZE_ERR;
+
+   printf("*** reading with conversion...");
+   {
+      size_t start[2] = {0, 0}, count[2] = {NY, NX};
+      ptrdiff_t stride[2] = {2, 1};
+
+      if (nc_open(FILE_NAME, NC_NOWRITE, &ncid)) ERR;
+
+      /* short -> float, then double */
+      if (nc_get_vara_float(ncid, sid, start, count, fbuf)) ERR;
+      for (y = 0; y < NY; y++)
+         for (x = 0; x < NX; x++)
+            if (fbuf[y * NX + x] != (float)VAL(y, x)) ERR;
+      if (nc_get_vara_double(ncid, sid, start, count, dbuf)) ERR;
+      for (y = 0; y < NY; y++)
+         for (x = 0; x < NX; x++)
+            if (dbuf[y * NX + x] != (double)VAL(y, x)) ERR;
+
+      /* Start off a chunk boundary, every other row. */
+      start[0] = 5; start[1] = 0;
+      count[0] = (NY - 5 + 1) / 2; count[1] = NX;
+      if (nc_get_vars_int(ncid, sid, start, count, stride, ibuf)) ERR;
+      for (y = 0; y < count[0]; y++)
+         for (x = 0; x < NX; x++)
+            if (ibuf[y * NX + x] != VAL(start[0] + y * 2, x)) ERR;
+
+      /* Start off a chunk boundary, all rows. */
+      start[0] = 37; count[0] = NY - 37;
+      if (nc_get_vara_double(ncid, sid, start, count, dbuf)) ERR;
+      for (y = 0; y < count[0]; y++)
+         for (x = 0; x < NX; x++)
+            if (dbuf[y * NX + x] != (double)VAL(start[0] + y, x)) ERR;
+
+      /* float -> double, contiguous */
+      if (nc_get_var_double(ncid, cid, dbuf)) ERR;
+      for (x = 0; x < NC; x++)
+         if (dbuf[x] != (double)x * 0.5) ERR;
+
+      /* byte -> int; the out of range value was stored as a byte. */
+      start[0] = 0; count[0] = NY;
+      if (nc_get_vara_int(ncid, bid, start, count, ibuf)) ERR;
+      for (y = 0; y < NY * NX - 1; y++)
+         if (ibuf[y] != (int)(y % 200) - 100) ERR;
+
+      /* short -> byte has range errors. */
+      if (nc_get_vara_schar(ncid, sid, start, count, (signed char *)ibuf) != NC_ERANGE) ERR;
+
+      /* short -> int, past the end of the record variable. */
+      count[0] = NREC2;
+      {
+         int *rbuf;
+         if (!(rbuf = malloc(NREC2 * NX * sizeof(int)))) ERR;
+         if (nc_get_vara_int(ncid, rid, start, count, rbuf)) ERR;
+         for (y = 0; y < NREC2; y++)
+            for (x = 0; x < NX; x++)
+               if (rbuf[y * NX + x] != (y < NREC ? VAL(y, x) : NC_FILL_SHORT)) ERR;
+         free(rbuf);
+      }
+
+      /* float -> double with quantized values. */
+      start[0] = 0; count[0] = NY;
+      if (nc_get_vara_double(ncid, qid, start, count, dbuf)) ERR;
+      for (y = 0; y < NY * NX; y++)
+         if (fabs(dbuf[y] - (1.0 + (double)y * 0.001)) > 1e-3 * (1.0 + (double)y * 0.001)) ERR;
+
+      if (nc_close(ncid)) ERR;
+   }
+   SUMMARIZE_ERR;
+   free(ibuf);
+   free(fbuf);
+   free(dbuf);
+   FINAL_RESULTS;
+}
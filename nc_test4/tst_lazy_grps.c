@@ -0,0 +1,184 @@
+/* This is part of the netCDF package.
+   Copyright 2018 University Corporation for Atmospheric Research/Unidata
+   See COPYRIGHT file for conditions of use.
+
+   Test opening a file with NC_LAZY_GROUPS, which reads the metadata
+   of each group when the group is first used. Everything found must
+   match an ordinary open of the same file.
+*/
+
+#include <config.h>
+#include <nc_tests.h>
+#include "err_macros.h"
+#include "netcdf.h"
+
+#ifdef TESTNCZARR
+#define FILE_NAME "file://tmp_lazy_grps.file#mode=nczarr,file"
+#else
+#define FILE_NAME "tst_lazy_grps.nc"
+#endif
+#define NX 4
+#define NY 3
+#define NREC_V 2
+#define NREC_W 5
+#define CLOUD "cloud_type"
+
+/* Create a file with a nested group holding more records of the
+ * unlimited dim than the root group does, and (but for NCZarr, which
+ * has no user defined types) a type defined in a group. */
+static int
+create_file(void)
+{
+    int ncid, grpa, grpb, grpc, dimids[3], varid, typeid, i;
+    int v[NREC_V][NX][NY], w[NREC_W];
+    unsigned char e[NX] = {0, 1, 1, 0};
+#ifndef TESTNCZARR
+    unsigned char clear = 0, cloudy = 1;
+#endif
+    size_t start[3] = {0, 0, 0}, count[3] = {NREC_V, NX, NY};
+
+    for (i = 0; i < NREC_V * NX * NY; i++)
+        ((int *)v)[i] = i;
+    for (i = 0; i < NREC_W; i++)
+        w[i] = 100 + i;
+
+    if (nc_create(FILE_NAME, NC_NETCDF4|NC_CLOBBER, &ncid)) ERR;
+    if (nc_def_dim(ncid, "time", NC_UNLIMITED, &dimids[0])) ERR;
+    if (nc_def_dim(ncid, "x", NX, &dimids[1])) ERR;
+    if (nc_def_var(ncid, "x", NC_INT, 1, &dimids[1], &varid)) ERR;
+    if (nc_def_grp(ncid, "a", &grpa)) ERR;
+    if (nc_def_dim(grpa, "y", NY, &dimids[2])) ERR;
+    if (nc_def_var(grpa, "v", NC_INT, 3, dimids, &varid)) ERR;
+    if (nc_put_vara_int(grpa, varid, start, count, &v[0][0][0])) ERR;
+    if (nc_def_grp(grpa, "b", &grpb)) ERR;
+    if (nc_def_var(grpb, "w", NC_INT, 1, dimids, &varid)) ERR;
+    count[0] = NREC_W;
+    if (nc_put_vara_int(grpb, varid, start, count, w)) ERR;
+    if (nc_def_grp(ncid, "c", &grpc)) ERR;
+#ifdef TESTNCZARR
+    typeid = NC_UBYTE;
+#else
+    if (nc_def_enum(grpc, NC_UBYTE, CLOUD, &typeid)) ERR;
+    if (nc_insert_enum(grpc, typeid, "clear", &clear)) ERR;
+    if (nc_insert_enum(grpc, typeid, "cloudy", &cloudy)) ERR;
+#endif
+    if (nc_def_var(grpc, "e", typeid, 1, &dimids[1], &varid)) ERR;
+    if (nc_put_var(grpc, varid, e)) ERR;
+    if (nc_close(ncid)) ERR;
+    return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+    printf("\n*** Testing lazily read groups.\n");
+    if (create_file()) ERR;
+
+    printf("*** testing that groups are found...");
+    {
+        int ncid, numgrps, grpids[2], grpb, ndims, nvars;
+        char name[NC_MAX_NAME + 1];
+
+        if (nc_open(FILE_NAME, NC_NOWRITE|NC_LAZY_GROUPS, &ncid)) ERR;
+        if (nc_inq_grps(ncid, &numgrps, grpids)) ERR;
+        if (numgrps != 2) ERR;
+        if (nc_inq_grpname(grpids[0], name)) ERR;
+        if (strcmp(name, "a")) ERR;
+        if (nc_inq(grpids[0], &ndims, &nvars, NULL, NULL)) ERR;
+        if (ndims != 1 || nvars != 1) ERR;
+        if (nc_inq_grp_full_ncid(ncid, "/a/b", &grpb)) ERR;
+        if (nc_inq_grpname_full(grpb, NULL, name)) ERR;
+        if (strcmp(name, "/a/b")) ERR;
+        if (nc_inq_nvars(grpb, &nvars)) ERR;
+        if (nvars != 1) ERR;
+        if (nc_close(ncid)) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("*** testing that dims and data match an ordinary open...");
+    {
+        int ncid, lncid, grp, lgrp, varid, lvarid, dimids[3], ldimids[3];
+        int ndims, w[NREC_W], v[NREC_V][NX][NY], i;
+        size_t len;
+
+        if (nc_open(FILE_NAME, NC_NOWRITE, &ncid)) ERR;
+        if (nc_open(FILE_NAME, NC_NOWRITE|NC_LAZY_GROUPS, &lncid)) ERR;
+
+        /* Read the deepest group first. */
+        if (nc_inq_grp_full_ncid(lncid, "/a/b", &lgrp)) ERR;
+        if (nc_inq_varid(lgrp, "w", &lvarid)) ERR;
+        if (nc_get_var_int(lgrp, lvarid, w)) ERR;
+        for (i = 0; i < NREC_W; i++)
+            if (w[i] != 100 + i) ERR;
+
+        if (nc_inq_grp_full_ncid(ncid, "/a", &grp)) ERR;
+        if (nc_inq_grp_full_ncid(lncid, "/a", &lgrp)) ERR;
+        if (nc_inq_varid(grp, "v", &varid)) ERR;
+        if (nc_inq_varid(lgrp, "v", &lvarid)) ERR;
+        if (nc_inq_var(grp, varid, NULL, NULL, &ndims, dimids, NULL)) ERR;
+        if (nc_inq_var(lgrp, lvarid, NULL, NULL, &ndims, ldimids, NULL)) ERR;
+        if (ndims != 3) ERR;
+        for (i = 0; i < ndims; i++)
+            if (dimids[i] != ldimids[i]) ERR;
+        if (nc_inq_dimlen(lgrp, ldimids[2], &len)) ERR;
+        if (len != NY) ERR;
+        if (nc_get_var_int(lgrp, lvarid, &v[0][0][0])) ERR;
+        for (i = 0; i < NREC_V * NX * NY; i++)
+            if (((int *)v)[i] != i) ERR;
+        if (nc_close(lncid)) ERR;
+
+        /* The unlimited dim is as long as its longest var, which is
+         * in a group not yet read. */
+        if (nc_open(FILE_NAME, NC_NOWRITE|NC_LAZY_GROUPS, &lncid)) ERR;
+        if (nc_inq_dimlen(lncid, 0, &len)) ERR;
+        if (len != NREC_W) ERR;
+        if (nc_inq_dimlen(ncid, 0, &len)) ERR;
+        if (len != NREC_W) ERR;
+        if (nc_close(lncid)) ERR;
+        if (nc_close(ncid)) ERR;
+    }
+    SUMMARIZE_ERR;
+#ifndef TESTNCZARR
+    printf("*** testing types in groups not yet read...");
+    {
+        int ncid, grp, varid;
+        nc_type typeid, vartype;
+        unsigned char e[NX];
+        char name[NC_MAX_NAME + 1];
+
+        if (nc_open(FILE_NAME, NC_NOWRITE|NC_LAZY_GROUPS, &ncid)) ERR;
+        if (nc_inq_typeid(ncid, "/c/" CLOUD, &typeid)) ERR;
+        if (nc_inq_typeid(ncid, CLOUD, &typeid)) ERR;
+        if (nc_inq_grp_full_ncid(ncid, "/c", &grp)) ERR;
+        if (nc_inq_varid(grp, "e", &varid)) ERR;
+        if (nc_inq_vartype(grp, varid, &vartype)) ERR;
+        if (vartype != typeid) ERR;
+        if (nc_inq_enum_ident(grp, typeid, 1, name)) ERR;
+        if (strcmp(name, "cloudy")) ERR;
+        if (nc_get_var(grp, varid, e)) ERR;
+        if (e[0] != 0 || e[1] != 1 || e[2] != 1 || e[3] != 0) ERR;
+        if (nc_close(ncid)) ERR;
+    }
+    SUMMARIZE_ERR;
+#endif
+    printf("*** testing that NC_LAZY_GROUPS is ignored with NC_WRITE...");
+    {
+        int ncid, grp, dimid, varid;
+        size_t len;
+
+        if (nc_open(FILE_NAME, NC_WRITE|NC_LAZY_GROUPS, &ncid)) ERR;
+        if (nc_inq_grp_full_ncid(ncid, "/a/b", &grp)) ERR;
+        if (nc_def_dim(grp, "z", 2, &dimid)) ERR;
+        if (nc_def_var(grp, "zv", NC_INT, 1, &dimid, &varid)) ERR;
+        if (nc_close(ncid)) ERR;
+
+        if (nc_open(FILE_NAME, NC_NOWRITE|NC_LAZY_GROUPS, &ncid)) ERR;
+        if (nc_inq_grp_full_ncid(ncid, "/a/b", &grp)) ERR;
+        if (nc_inq_dimid(grp, "z", &dimid)) ERR;
+        if (nc_inq_dimlen(grp, dimid, &len)) ERR;
+        if (len != 2) ERR;
+        if (nc_inq_varid(grp, "w", &varid)) ERR;
+        if (nc_close(ncid)) ERR;
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
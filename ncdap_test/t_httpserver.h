@@ -0,0 +1,211 @@
+/*! \file
+
+Copyright 2018 University Corporation for Atmospheric Research/Unidata.
+
+See \ref copyright file for more info.
+
+A minimal HTTP server for tests, running in a child process. It
+serves the files of one directory, sends ETag and Last-Modified
+headers, answers conditional requests, and counts what it sends in
+memory shared with the test. The test must define BASETIME, the
+Last-Modified time of version 0 of the files.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+/* Shared with the server */
+static struct Counts {
+    int requests;
+    int bodies; /* 200 responses */
+    int notmodified; /* 304 responses */
+    int version; /* of the served files */
+    int noetag; /* send only Last-Modified */
+    int chunk; /* if not 0, write bodies in pieces of this size */
+} *counts = NULL;
+
+static pid_t server = 0;
+
+/* Read a whole file into memory */
+static char*
+slurp(const char* path, size_t* lenp)
+{
+    FILE* f;
+    char* content = NULL;
+    long len;
+
+    if((f = fopen(path,"rb")) == NULL) return NULL;
+    if(fseek(f,0,SEEK_END) == 0 && (len = ftell(f)) >= 0
+       && fseek(f,0,SEEK_SET) == 0
+       && (content = malloc((size_t)len+1)) != NULL
+       && fread(content,1,(size_t)len,f) == (size_t)len)
+        *lenp = (size_t)len;
+    else {
+        free(content);
+        content = NULL;
+    }
+    fclose(f);
+    return content;
+}
+
+/* Does the request carry the header with this value? */
+static int
+hasheader(const char* req, const char* name, const char* value)
+{
+    const char* p = strstr(req,name);
+    size_t len = strlen(value);
+    if(p == NULL) return 0;
+    p += strlen(name);
+    while(*p == ' ') p++;
+    return strncmp(p,value,len) == 0 && (p[len] == '\r' || p[len] == '\0');
+}
+
+/* Answer one GET for a file of the current directory */
+static int
+respond(int fd, const char* req)
+{
+    char head[512], path[1024], etag[32], lastmod[64], etagline[64];
+    char* content = NULL;
+    char* q;
+    size_t len = 0, headlen;
+    time_t t = BASETIME + 86400 * (time_t)counts->version;
+    struct tm tm;
+    int ok;
+
+    __sync_fetch_and_add(&counts->requests,1);
+    if(sscanf(req,"%*s /%1023s",path) != 1) return 0;
+    if((q = strchr(path,'?')) != NULL) *q = '\0';
+    snprintf(etag,sizeof(etag),"\"v%d\"",counts->version);
+    gmtime_r(&t,&tm);
+    strftime(lastmod,sizeof(lastmod),"%a, %d %b %Y %H:%M:%S GMT",&tm);
+    if(counts->noetag)
+        etagline[0] = '\0';
+    else
+        snprintf(etagline,sizeof(etagline),"ETag: %s\r\n",etag);
+    if(counts->noetag ? hasheader(req,"\nIf-Modified-Since:",lastmod)
+                      : hasheader(req,"\nIf-None-Match:",etag)) {
+        __sync_fetch_and_add(&counts->notmodified,1);
+        snprintf(head,sizeof(head),"HTTP/1.1 304 Not Modified\r\n%s\r\n",etagline);
+        headlen = strlen(head);
+        return write(fd,head,headlen) == (ssize_t)headlen;
+    }
+    if((content = slurp(path,&len)) == NULL) {
+        const char* notfound = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+        return write(fd,notfound,strlen(notfound)) == (ssize_t)strlen(notfound);
+    }
+    __sync_fetch_and_add(&counts->bodies,1);
+    snprintf(head,sizeof(head),"HTTP/1.1 200 OK\r\nContent-Length: %lu\r\n%sLast-Modified: %s\r\n\r\n",
+             (unsigned long)len,etagline,lastmod);
+    headlen = strlen(head);
+    ok = (write(fd,head,headlen) == (ssize_t)headlen);
+    if(counts->chunk == 0)
+        ok = ok && write(fd,content,len) == (ssize_t)len;
+    else {
+        /* Dribble the body out */
+        size_t off;
+        for(off=0;ok && off<len;off+=(size_t)counts->chunk) {
+            size_t n = len - off;
+            if(n > (size_t)counts->chunk) n = (size_t)counts->chunk;
+            ok = (write(fd,content+off,n) == (ssize_t)n);
+            usleep(1000);
+        }
+    }
+    free(content);
+    return ok;
+}
+
+/* Answer requests on one connection until it closes */
+static void
+serve(int fd)
+{
+    char req[8192];
+    size_t have = 0, used;
+    char* end;
+    ssize_t n;
+
+    for(;;) {
+        req[have] = '\0';
+        while((end = strstr(req,"\r\n\r\n")) == NULL) {
+            if(have >= sizeof(req)-1) return;
+            if((n = read(fd,req+have,sizeof(req)-1-have)) <= 0) return;
+            have += (size_t)n;
+            req[have] = '\0';
+        }
+        end[2] = '\0'; /* keep the last CRLF for hasheader */
+        if(!respond(fd,req)) return;
+        used = (size_t)(end+4-req);
+        memmove(req,req+used,have-used);
+        have -= used;
+    }
+}
+
+/* Start the server for dir in a child process; returns its pid */
+static pid_t
+start_server(const char* dir, int* portp)
+{
+    struct sockaddr_in addr;
+    socklen_t addrlen = sizeof(addr);
+    int lfd, one = 1;
+    pid_t pid, parent;
+
+    counts = mmap(NULL,sizeof(struct Counts),PROT_READ|PROT_WRITE,MAP_SHARED|MAP_ANONYMOUS,-1,0);
+    if(counts == MAP_FAILED) return -1;
+    memset(counts,0,sizeof(struct Counts));
+    if((lfd = socket(AF_INET,SOCK_STREAM,0)) < 0) return -1;
+    setsockopt(lfd,SOL_SOCKET,SO_REUSEADDR,&one,sizeof(one));
+    memset(&addr,0,sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    if(bind(lfd,(struct sockaddr*)&addr,sizeof(addr))
+       || getsockname(lfd,(struct sockaddr*)&addr,&addrlen)
+       || listen(lfd,16))
+        return -1;
+    *portp = ntohs(addr.sin_port);
+    parent = getpid();
+    if((pid = fork()) != 0) {
+        close(lfd);
+        return pid;
+    }
+    /* Server: one process per connection; it outlives the test by
+       at most a second should the test die */
+    if(chdir(dir) != 0) _exit(1);
+    signal(SIGCHLD,SIG_IGN);
+    for(;;) {
+        struct pollfd pfd;
+        int fd;
+        pfd.fd = lfd;
+        pfd.events = POLLIN;
+        if(poll(&pfd,1,1000) <= 0) {
+            if(getppid() != parent) _exit(0);
+            continue;
+        }
+        if((fd = accept(lfd,NULL,NULL)) < 0) continue;
+        if(fork() == 0) {
+            close(lfd);
+            serve(fd);
+            _exit(0);
+        }
+        close(fd);
+    }
+}
+
+static void
+stop_server(void)
+{
+    if(server <= 0) return;
+    kill(server,SIGTERM);
+    waitpid(server,NULL,0);
+    server = 0;
+}
@@ -0,0 +1,100 @@
+/*! \file
+
+Copyright 2018 University Corporation for Atmospheric Research/Unidata.
+
+See \ref copyright file for more info.
+
+Test decoding DataDDS responses while they are being received
+(#fetch=stream), with the response kept in memory and on disk. The
+datasets are served by the server of t_httpserver.h, which writes
+the responses out in small pieces, and every variable must read the
+same as through a file:// url.
+*/
+
+#include "config.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "netcdf.h"
+#include "t_srcdir.h"
+
+#define ERRCODE 2
+#define ERR(e) {printf("Error: line %d: %s\n", __LINE__, nc_strerror(e)); stop_server(); exit(ERRCODE);}
+#define FAIL(msg) {printf("*** FAIL: line %d: %s\n", __LINE__, (msg)); stop_server(); exit(1);}
+
+#define BASETIME 1700000000
+#define CHUNK 1000
+
+#include "t_httpserver.h"
+
+static const char* datasets[] = {
+"test.06", "test.03", "test.07", "test.SwathFile", "Drifters", "fnoc1.nc", NULL
+};
+
+static const char* fetches[] = {"#fetch=stream", "#fetch=disk,stream", NULL};
+
+/* Read every variable of url; returns the values end to end */
+static char*
+readall(const char* url, size_t* sizep)
+{
+    int ncid, nvars, varid, retval;
+    char* all = NULL;
+    size_t size = 0;
+
+    if((retval = nc_open(url,NC_NOWRITE,&ncid))) ERR(retval);
+    if((retval = nc_inq_nvars(ncid,&nvars))) ERR(retval);
+    for(varid=0;varid<nvars;varid++) {
+        int ndims, dimids[NC_MAX_VAR_DIMS], i;
+        nc_type xtype;
+        size_t typesize, len = 1;
+        if((retval = nc_inq_var(ncid,varid,NULL,&xtype,&ndims,dimids,NULL))) ERR(retval);
+        if((retval = nc_inq_type(ncid,xtype,NULL,&typesize))) ERR(retval);
+        for(i=0;i<ndims;i++) {
+            size_t dimlen;
+            if((retval = nc_inq_dimlen(ncid,dimids[i],&dimlen))) ERR(retval);
+            len *= dimlen;
+        }
+        len *= typesize;
+        if((all = realloc(all,size+len+1)) == NULL) FAIL("out of memory");
+        if(len > 0 && (retval = nc_get_var(ncid,varid,all+size))) ERR(retval);
+        size += len;
+    }
+    if((retval = nc_close(ncid))) ERR(retval);
+    *sizep = size;
+    return all;
+}
+
+int
+main()
+{
+    char datadir[4000], url[4096], streamurl[4200];
+    const char** dataset;
+    const char** fetch;
+    int port;
+
+    snprintf(datadir,sizeof(datadir),"%s/ncdap_test/testdata3",gettopsrcdir());
+    if((server = start_server(datadir,&port)) < 0) FAIL("cannot start server");
+    counts->chunk = CHUNK;
+
+    for(dataset=datasets;*dataset;dataset++) {
+        char* expected;
+        size_t expectedsize;
+        snprintf(url,sizeof(url),"file://%s/%s",datadir,*dataset);
+        expected = readall(url,&expectedsize);
+        for(fetch=fetches;*fetch;fetch++) {
+            char* values;
+            size_t size;
+            snprintf(streamurl,sizeof(streamurl),"http://127.0.0.1:%d/%s%s",port,*dataset,*fetch);
+            printf("*** %s\n",streamurl);
+            values = readall(streamurl,&size);
+            if(size != expectedsize || memcmp(values,expected,size) != 0)
+                FAIL("wrong data");
+            free(values);
+        }
+        free(expected);
+    }
+
+    stop_server();
+    printf("*** PASS\n");
+    return 0;
+}
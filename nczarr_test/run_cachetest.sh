@@ -31,6 +31,12 @@ ${execdir}/test_writecaching
 
 echo "*** read cache"
 ${execdir}/test_readcaching
+
+echo "*** write cache with write-behind"
+NCZARR_THREADS=4 ${execdir}/test_writecaching
+
+echo "*** read cache with prefetch"
+NCZARR_THREADS=4 ${execdir}/test_readcaching
 }
 
 testcase file
@@ -0,0 +1,32 @@
+#!/bin/sh
+
+if test "x$srcdir" = x ; then srcdir=`pwd`; fi
+. ../test_common.sh
+
+. "$srcdir/test_nczarr.sh"
+
+set -e
+
+s3isolate "testdir_chunkbuffers"
+THISDIR=`pwd`
+cd $ISOPATH
+
+# This shell script tests that the chunk cache and the filter chain
+# reuse their buffers, with and without worker threads
+
+testcase() {
+zext=$1
+
+echo "*** Test: reuse chunk buffers with zmap=$zext"
+fileargs tmp_chunkbuffers
+deletemap $zext $file
+${execdir}/test_chunkbuffers "$fileurl"
+
+echo "*** Test: reuse chunk buffers with worker threads with zmap=$zext"
+deletemap $zext $file
+NCZARR_THREADS=4 ${execdir}/test_chunkbuffers "$fileurl"
+}
+
+testcase file
+if test "x$FEATURE_NCZARR_ZIP" = xyes ; then testcase zip; fi
+if test "x$FEATURE_S3TESTS" = xyes ; then testcase s3; fi
@@ -124,5 +124,9 @@ testcases() {
 }
 
 testcases file
+# Repeat with chunks fetched and decoded by a worker pool
+NCZARR_THREADS=4; export NCZARR_THREADS
+testcases file
+unset NCZARR_THREADS
 if test "x$FEATURE_NCZARR_ZIP" = xyes ; then testcases zip; fi
 if test "x$FEATURE_S3TESTS" = xyes ; then testcases s3; fi
@@ -0,0 +1,52 @@
+#!/bin/sh
+
+if test "x$srcdir" = x ; then srcdir=`pwd`; fi
+. ../test_common.sh
+
+. "$srcdir/test_nczarr.sh"
+
+set -e
+
+isolate "testdir_consolidated"
+THISDIR=`pwd`
+cd $ISOPATH
+
+# This shell script tests support for:
+# writing and reading consolidated metadata (.zmetadata)
+
+testcase() {
+zext=$1
+
+echo "*** Test: consolidated metadata is written by default"
+fileargs tmp_consolidated "mode=nczarr,$zext"
+deletemap $zext $file
+${NCGEN} -4 -b -o "$fileurl" $srcdir/ref_groups_regular.cdl
+test -f $file/.zmetadata
+${NCDUMP} -n tmp_groups_regular "$fileurl" > tmp_consolidated.cdl
+${NCDUMP} -n tmp_groups_regular "${fileurl},noconsolidated" > tmp_noconsolidated.cdl
+diff -b tmp_consolidated.cdl tmp_noconsolidated.cdl
+
+echo "*** Test: consolidated metadata is not written when disabled"
+fileargs tmp_noconsolidated "mode=nczarr,$zext,noconsolidated"
+deletemap $zext $file
+${NCGEN} -4 -b -o "$fileurl" $srcdir/ref_groups_regular.cdl
+test ! -f $file/.zmetadata
+fileargs tmp_noconsolidated_env "mode=nczarr,$zext"
+deletemap $zext $file
+NCZARR_CONSOLIDATED=0 ${NCGEN} -4 -b -o "$fileurl" $srcdir/ref_groups_regular.cdl
+test ! -f $file/.zmetadata
+${NCDUMP} -n tmp_groups_regular "$fileurl" > tmp_notconsolidated.cdl
+diff -b tmp_consolidated.cdl tmp_notconsolidated.cdl
+
+echo "*** Test: invalid consolidated metadata is ignored unless requested"
+fileargs tmp_consolidated "mode=nczarr,$zext"
+echo '{"metadata": {}, "zarr_consolidated_format": 1}' > $file/.zmetadata
+${NCDUMP} -n tmp_groups_regular "$fileurl" > tmp_badconsolidated.cdl
+diff -b tmp_consolidated.cdl tmp_badconsolidated.cdl
+if ${NCDUMP} -h "${fileurl},consolidated" > /dev/null 2>&1 ; then
+  echo "*** Fail: invalid .zmetadata accepted with mode=consolidated"
+  exit 1
+fi
+}
+
+testcase file
@@ -17,7 +17,9 @@ testfiltererror() {
     cp -r ${srcdir}/ref_data.zarr .
     chmod -R 755 ./ref_data.zarr
     codec='faultycodecname'
+    # The consolidated .zmetadata is read in place of .zarray, so change both
     sed -i.bak 's/blosc/'${codec}'/g' ref_data.zarr/data/.zarray && rm ref_data.zarr/data/.zarray.bak
+    sed -i.bak 's/blosc/'${codec}'/g' ref_data.zarr/.zmetadata && rm ref_data.zarr/.zmetadata.bak
     (${NCDUMP} -v data -L0  "file://ref_data.zarr#mode=zarr" \
         2>&1 || true )  \
         | grep -o "Variable .* has unsupported codec: (${codec})"
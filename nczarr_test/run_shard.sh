@@ -0,0 +1,51 @@
+#!/bin/sh
+
+if test "x$srcdir" = x ; then srcdir=`pwd`; fi
+. ../test_common.sh
+
+. "$srcdir/test_nczarr.sh"
+
+set -e
+
+s3isolate "testdir_shard"
+THISDIR=`pwd`
+cd $ISOPATH
+
+# This shell script tests support for:
+# sharded chunk storage (the _nczarr_shards attribute)
+
+testcase() {
+zext=$1
+
+echo "*** Test: write and rewrite a sharded variable with zmap=$zext"
+fileargs tmp_shard "mode=zarr,$zext"
+plainurl="$fileurl"
+fileargs tmp_shard
+deletemap $zext $file
+${execdir}/test_shard "$fileurl" "$plainurl"
+if test "x$zext" = xfile ; then
+  # 20x12 with 4x3 chunks is 5x4 chunks, stored as 3x2 shards of 2x3 chunks
+  nobjs=`ls $file/v | wc -l`
+  test $nobjs -eq 6
+  # Plain Zarr readers are stopped by the shard codec
+  grep -q '"compressor": {"id": "nczarr_shard"' $file/v/.zarray
+fi
+
+echo "*** Test: the shard shape survives ncdump and ncgen with zmap=$zext"
+${NCDUMP} -s -n tmp_shard "$fileurl" > tmp_shard_$zext.txt
+sclean tmp_shard_$zext.txt tmp_shard_$zext.cdl
+fileargs tmp_shard_copy
+deletemap $zext $file
+${NCGEN} -4 -b -o "$fileurl" tmp_shard_$zext.cdl
+${NCDUMP} -s -n tmp_shard "$fileurl" > tmp_shard_copy_$zext.txt
+sclean tmp_shard_copy_$zext.txt tmp_shard_copy_$zext.cdl
+diff -b tmp_shard_$zext.cdl tmp_shard_copy_$zext.cdl
+if test "x$zext" = xfile ; then
+  nobjs=`ls $file/v | wc -l`
+  test $nobjs -eq 6
+fi
+}
+
+testcase file
+if test "x$FEATURE_NCZARR_ZIP" = xyes ; then testcase zip; fi
+if test "x$FEATURE_S3TESTS" = xyes ; then testcase s3; fi
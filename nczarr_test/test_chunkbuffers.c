@@ -0,0 +1,107 @@
+/* This is part of the netCDF package.
+   Copyright 2018 University Corporation for Atmospheric Research/Unidata
+   See COPYRIGHT file for conditions of use.
+
+   Test that the chunk cache reuses its buffers: once the cache
+   is warm, reading a shuffled and deflated variable through a
+   cache too small to hold it allocates no chunk sized buffers.
+*/
+
+#include "zincludes.h"
+#include "zcache.h"
+
+#define ERR(r) {fprintf(stderr,"fail: line %d: (%d) %s\n",__LINE__,(r),nc_strerror((r))); exit(1);}
+#define FAIL(msg) {fprintf(stderr,"fail: line %d: %s\n",__LINE__,(msg)); exit(1);}
+
+#define NX 96
+#define NY 256
+#define CX 8
+#define NCACHED 4 /* chunks the cache can hold */
+#define NPASSES 3
+
+static int data[NX][NY];
+
+/* Read the variable, one chunk or all of it at a time */
+static void
+readall(int ncid, int varid, int whole)
+{
+    int ret, i, j;
+
+    memset(data,0,sizeof(data));
+    if(whole) {
+        if((ret = nc_get_var_int(ncid,varid,&data[0][0]))) ERR(ret);
+    } else {
+        for(i=0;i<NX;i+=CX) {
+            size_t start[2] = {(size_t)i,0}, count[2] = {CX,NY};
+            if((ret = nc_get_vara_int(ncid,varid,start,count,&data[i][0]))) ERR(ret);
+        }
+    }
+    for(i=0;i<NX;i++) {
+        for(j=0;j<NY;j++) {
+            if(data[i][j] != i*NY+j) {
+                fprintf(stderr,"fail: data[%d][%d] = %d, expected %d\n",i,j,data[i][j],i*NY+j);
+                exit(1);
+            }
+        }
+    }
+}
+
+static void
+check(const char* url, int whole)
+{
+    int ret, ncid, varid, pass;
+    NCZBufferStats stats;
+
+    if((ret = nc_open(url,NC_NOWRITE,&ncid))) ERR(ret);
+    if((ret = nc_inq_varid(ncid,"v",&varid))) ERR(ret);
+    /* Warm up */
+    readall(ncid,varid,whole);
+    NCZ_buffer_stats(NULL,1);
+    for(pass=0;pass<NPASSES;pass++)
+        readall(ncid,varid,whole);
+    NCZ_buffer_stats(&stats,1);
+    printf("%s: allocs=%llu reuses=%llu filterallocs=%llu\n",(whole?"whole":"chunks"),
+           stats.allocs,stats.reuses,stats.filterallocs);
+    if(stats.allocs != 0) FAIL("steady state reads allocated buffers");
+    if(stats.filterallocs != 0) FAIL("filters allocated buffers");
+    /* Every chunk is read again on each pass and needs a buffer */
+    if(stats.reuses < NPASSES*(NX/CX)) FAIL("buffers were not reused");
+    if((ret = nc_close(ncid))) ERR(ret);
+}
+
+int
+main(int argc, char **argv)
+{
+    int ret, ncid, dimids[2], varid, i, j;
+    size_t chunks[2] = {CX,NY};
+    const char* url = NULL;
+
+    if(argc < 2) {
+	fprintf(stderr,"Usage: test_chunkbuffers <url>\n");
+	exit(1);
+    }
+    url = argv[1];
+    /* Make every cache too small to hold the variable */
+    if((ret = nc_set_chunk_cache(NCACHED*CX*NY*sizeof(int),NCACHED,0.5))) ERR(ret);
+
+    printf("*** Testing reuse of chunk buffers...\n");
+    if((ret = nc_create(url,NC_NETCDF4|NC_CLOBBER,&ncid))) ERR(ret);
+    if((ret = nc_def_dim(ncid,"x",NX,&dimids[0]))) ERR(ret);
+    if((ret = nc_def_dim(ncid,"y",NY,&dimids[1]))) ERR(ret);
+    if((ret = nc_def_var(ncid,"v",NC_INT,2,dimids,&varid))) ERR(ret);
+    if((ret = nc_def_var_chunking(ncid,varid,NC_CHUNKED,chunks))) ERR(ret);
+    if((ret = nc_def_var_deflate(ncid,varid,1,1,5))) ERR(ret);
+    if((ret = nc_enddef(ncid))) ERR(ret);
+    for(i=0;i<NX;i++)
+        for(j=0;j<NY;j++)
+            data[i][j] = i*NY+j;
+    /* Write it twice, so that evicted chunks are written and reread */
+    if((ret = nc_put_var_int(ncid,varid,&data[0][0]))) ERR(ret);
+    if((ret = nc_put_var_int(ncid,varid,&data[0][0]))) ERR(ret);
+    if((ret = nc_close(ncid))) ERR(ret);
+
+    check(url,0);
+    check(url,1);
+    printf("*** passed\n");
+    return 0;
+}
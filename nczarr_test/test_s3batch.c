@@ -0,0 +1,301 @@
+/* This is part of the netCDF package.
+   Copyright 2018 University Corporation for Atmospheric Research/Unidata
+   See COPYRIGHT file for conditions of use.
+
+   Test the batched S3 transfers (nczmap_writemany and
+   nczmap_readmany over the S3 map) against a minimal S3-compatible
+   server on the loopback interface. The server keeps the objects as
+   files under the current directory, answers each request after a
+   short delay, and records how many requests were in progress at
+   once in memory shared with the test.
+*/
+
+#include "ut_includes.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define ERR(e) {fprintf(stderr,"fail: line %d: (%d) %s\n",__LINE__,(e),nc_strerror(e)); stop_server(); exit(1);}
+#define FAIL(msg) {fprintf(stderr,"fail: line %d: %s\n",__LINE__,(msg)); stop_server(); exit(1);}
+
+#define ROOTDIR "tmp_s3batch"
+#define NOBJECTS 40 /* more than one batch of NC_S3_MAXCONNECTIONS */
+#define DELAY 20000 /* microseconds before each response */
+
+/* Shared with the server */
+static struct Counts {
+    int gets;
+    int puts;
+    int active; /* requests being answered */
+    int maxactive;
+} *counts = NULL;
+
+static pid_t server = 0;
+
+static void
+stop_server(void)
+{
+    if(server <= 0) return;
+    kill(-server,SIGTERM); /* the connections too */
+    waitpid(server,NULL,0);
+    server = 0;
+}
+
+/* Find a header of the request, ignoring case; returns its value */
+static const char*
+findheader(const char* req, const char* name)
+{
+    size_t len = strlen(name);
+    const char* p;
+    for(p=strchr(req,'\n');p!=NULL;p=strchr(p+1,'\n')) {
+        if(strncasecmp(p+1,name,len) == 0 && p[1+len] == ':') {
+            for(p+=2+len;*p == ' ';p++);
+            return p;
+        }
+    }
+    return NULL;
+}
+
+/* Create the directories leading to path */
+static void
+makeparents(char* path)
+{
+    char* p;
+    for(p=strchr(path,'/');p!=NULL;p=strchr(p+1,'/')) {
+        *p = '\0';
+        (void)mkdir(path,0755);
+        *p = '/';
+    }
+}
+
+/* Answer one request whose head is in req and whose body, if any,
+   starts at body, with have bytes of it already read */
+static int
+respond(int fd, char* req, char* body, size_t have)
+{
+    static const char* ok = "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n";
+    static const char* notfound = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+    static const char* cont = "HTTP/1.1 100 Continue\r\n\r\n";
+    char verb[16], path[1024], head[256];
+    const char* reply = ok;
+    const char* p;
+    size_t len = 0;
+    int max, good = 1;
+    FILE* f;
+
+    if(sscanf(req,"%15s /%1023s",verb,path) != 2) return 0;
+    max = __sync_add_and_fetch(&counts->active,1);
+    while(max > counts->maxactive)
+        (void)__sync_bool_compare_and_swap(&counts->maxactive,counts->maxactive,max);
+    usleep(DELAY);
+    if(strcmp(verb,"PUT") == 0) {
+        char* content;
+        __sync_fetch_and_add(&counts->puts,1);
+        if((p = findheader(req,"Content-Length")) != NULL) len = strtoul(p,NULL,10);
+        if((p = findheader(req,"Expect")) != NULL && strncasecmp(p,"100-continue",12) == 0 && have == 0)
+            good = (write(fd,cont,strlen(cont)) == (ssize_t)strlen(cont));
+        if((content = malloc(len+1)) == NULL) return 0;
+        memcpy(content,body,have);
+        while(good && have < len) {
+            ssize_t n = read(fd,content+have,len-have);
+            if(n <= 0) good = 0; else have += (size_t)n;
+        }
+        makeparents(path);
+        if(good && (f = fopen(path,"wb")) != NULL) {
+            good = (fwrite(content,1,len,f) == len);
+            fclose(f);
+        }
+        free(content);
+    } else if(strcmp(verb,"GET") == 0 && (f = fopen(path,"rb")) != NULL) {
+        char buf[4096];
+        size_t n;
+        __sync_fetch_and_add(&counts->gets,1);
+        fseek(f,0,SEEK_END);
+        len = (size_t)ftell(f);
+        fseek(f,0,SEEK_SET);
+        snprintf(head,sizeof(head),"HTTP/1.1 200 OK\r\nContent-Length: %lu\r\n\r\n",(unsigned long)len);
+        good = (write(fd,head,strlen(head)) == (ssize_t)strlen(head));
+        while(good && (n = fread(buf,1,sizeof(buf),f)) > 0)
+            good = (write(fd,buf,n) == (ssize_t)n);
+        fclose(f);
+        reply = NULL;
+    } else
+        reply = notfound;
+    if(good && reply != NULL)
+        good = (write(fd,reply,strlen(reply)) == (ssize_t)strlen(reply));
+    __sync_fetch_and_sub(&counts->active,1);
+    return good ? (int)len : -1;
+}
+
+/* Answer requests on one connection until it closes */
+static void
+serve(int fd)
+{
+    char req[8192];
+    size_t have = 0, used;
+    char* end;
+    ssize_t n;
+
+    for(;;) {
+        int bodylen;
+        size_t inbuf;
+        req[have] = '\0';
+        while((end = strstr(req,"\r\n\r\n")) == NULL) {
+            if(have >= sizeof(req)-1) return;
+            if((n = read(fd,req+have,sizeof(req)-1-have)) <= 0) return;
+            have += (size_t)n;
+            req[have] = '\0';
+        }
+        end[2] = '\0';
+        used = (size_t)(end+4-req);
+        inbuf = have - used;
+        if(strncmp(req,"PUT",3) != 0) inbuf = 0;
+        if((bodylen = respond(fd,req,end+4,inbuf)) < 0) return;
+        /* Drop the request and whatever of its body was read with it */
+        if(strncmp(req,"PUT",3) == 0) used += (inbuf < (size_t)bodylen ? inbuf : (size_t)bodylen);
+        memmove(req,req+used,have-used);
+        have -= used;
+    }
+}
+
+/* Start the server in a child process; returns its pid */
+static pid_t
+start_server(const char* dir, int* portp)
+{
+    struct sockaddr_in addr;
+    socklen_t addrlen = sizeof(addr);
+    int lfd, one = 1;
+    pid_t pid, parent;
+
+    counts = mmap(NULL,sizeof(struct Counts),PROT_READ|PROT_WRITE,MAP_SHARED|MAP_ANONYMOUS,-1,0);
+    if(counts == MAP_FAILED) return -1;
+    memset(counts,0,sizeof(struct Counts));
+    if((lfd = socket(AF_INET,SOCK_STREAM,0)) < 0) return -1;
+    setsockopt(lfd,SOL_SOCKET,SO_REUSEADDR,&one,sizeof(one));
+    memset(&addr,0,sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    if(bind(lfd,(struct sockaddr*)&addr,sizeof(addr))
+       || getsockname(lfd,(struct sockaddr*)&addr,&addrlen)
+       || listen(lfd,64))
+        return -1;
+    *portp = ntohs(addr.sin_port);
+    parent = getpid();
+    if((pid = fork()) != 0) {
+        close(lfd);
+        setpgid(pid,pid);
+        return pid;
+    }
+    /* Server: one process per connection, all in one process group;
+       it outlives the test by at most a second should the test die */
+    setpgid(0,0);
+    if(chdir(dir) != 0) _exit(1);
+    signal(SIGCHLD,SIG_IGN);
+    for(;;) {
+        struct pollfd pfd;
+        int fd;
+        pfd.fd = lfd;
+        pfd.events = POLLIN;
+        if(poll(&pfd,1,1000) <= 0) {
+            if(getppid() != parent) _exit(0);
+            continue;
+        }
+        if((fd = accept(lfd,NULL,NULL)) < 0) continue;
+        if(fork() == 0) {
+            close(lfd);
+            serve(fd);
+            _exit(0);
+        }
+        close(fd);
+    }
+}
+
+/* Object i holds i*100+1 bytes, so that some need Expect: 100-continue */
+static void
+makeobject(int i, char** contentp, size64_t* countp)
+{
+    size_t len = (size_t)i*100 + 1, j;
+    char* content = malloc(len);
+    for(j=0;j<len;j++) content[j] = (char)('a' + (i + (int)j) % 26);
+    *contentp = content;
+    *countp = len;
+}
+
+int
+main(void)
+{
+    int ret, port, i;
+    char url[256];
+    char* keys[NOBJECTS+1];
+    char* contents[NOBJECTS];
+    size64_t lens[NOBJECTS];
+    size64_t sizes[NOBJECTS+1];
+    void* got[NOBJECTS+1];
+    int stats[NOBJECTS+1];
+    NCZMAP* map = NULL;
+
+    printf("*** Testing batched S3 transfers...");
+    nc_initialize();
+    (void)mkdir(ROOTDIR,0755);
+    if((server = start_server(ROOTDIR,&port)) < 0) FAIL("cannot start server");
+    snprintf(url,sizeof(url),"http://127.0.0.1:%d/bucket/root#mode=nczarr,s3",port);
+    if((ret = nczmap_open(NCZM_S3,url,NC_WRITE,0,NULL,&map))) ERR(ret);
+
+    for(i=0;i<NOBJECTS;i++) {
+        char key[64];
+        snprintf(key,sizeof(key),"/v/%d.0",i);
+        keys[i] = strdup(key);
+        makeobject(i,&contents[i],&lens[i]);
+    }
+    keys[NOBJECTS] = strdup("/v/missing");
+
+    /* Write them all, then check what the server stored */
+    if((ret = nczmap_writemany(map,NOBJECTS,(const char**)keys,lens,(const void**)contents))) ERR(ret);
+    if(counts->puts != NOBJECTS) FAIL("wrong number of PUTs");
+    for(i=0;i<NOBJECTS;i++) {
+        char path[256];
+        struct stat st;
+        snprintf(path,sizeof(path),"%s/bucket/root%s",ROOTDIR,keys[i]);
+        if(stat(path,&st) != 0 || (size64_t)st.st_size != lens[i]) FAIL("object not stored");
+    }
+
+    /* Read them back, with one that does not exist */
+    if((ret = nczmap_readmany(map,NOBJECTS+1,(const char**)keys,sizes,got,stats))) ERR(ret);
+    if(counts->gets != NOBJECTS) FAIL("wrong number of GETs");
+    for(i=0;i<NOBJECTS;i++) {
+        if(stats[i] != NC_NOERR) ERR(stats[i]);
+        if(sizes[i] != lens[i] || memcmp(got[i],contents[i],(size_t)sizes[i]) != 0)
+            FAIL("wrong content");
+        free(got[i]);
+    }
+    if(stats[NOBJECTS] == NC_NOERR || got[NOBJECTS] != NULL) FAIL("missing object was read");
+    if(counts->maxactive < 2) FAIL("requests were not concurrent");
+
+    /* With the server gone, every request must report a failure */
+    stop_server();
+    ret = nczmap_readmany(map,NOBJECTS,(const char**)keys,sizes,got,stats);
+    if(ret == NC_NOERR) FAIL("read from a stopped server");
+    for(i=0;i<NOBJECTS;i++) {
+        if(stats[i] == NC_NOERR) FAIL("failed request has no error");
+        if(got[i] != NULL) FAIL("failed request has content");
+    }
+
+    if((ret = nczmap_close(map,0))) ERR(ret);
+    for(i=0;i<NOBJECTS;i++) {free(keys[i]); free(contents[i]);}
+    free(keys[NOBJECTS]);
+    nc_finalize();
+    printf("passed\n");
+    return 0;
+}
@@ -0,0 +1,144 @@
+/* This is part of the netCDF package.
+   Copyright 2018 University Corporation for Atmospheric Research/Unidata
+   See COPYRIGHT file for conditions of use.
+
+   Test sharded chunk storage: write a sharded variable in scattered
+   pieces through a chunk cache too small to hold it, rewrite part
+   of it, and read it back. Given a second url, for the same store
+   in pure Zarr mode, check that a reader that knows nothing of
+   sharding does not read the shards as chunks.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "netcdf.h"
+
+#define ERR(r) {fprintf(stderr,"fail: line %d: (%d) %s\n",__LINE__,(r),nc_strerror((r))); exit(1);}
+#define FAIL(msg) {fprintf(stderr,"fail: line %d: %s\n",__LINE__,(msg)); exit(1);}
+
+#define SHARDS "_nczarr_shards"
+#define NX 20
+#define NY 12
+#define CX 4
+#define CY 3
+
+static int data[NX][NY];
+
+static void
+verify(const char* url, int rewritten)
+{
+    int ret, ncid, varid, i, j;
+    int shards[2];
+    size_t len;
+
+    memset(data,0,sizeof(data));
+    if((ret = nc_open(url,NC_NOWRITE,&ncid))) ERR(ret);
+    if((ret = nc_inq_varid(ncid,"v",&varid))) ERR(ret);
+    if((ret = nc_inq_attlen(ncid,varid,SHARDS,&len))) ERR(ret);
+    if(len != 2) FAIL("shards attribute length");
+    if((ret = nc_get_att_int(ncid,varid,SHARDS,shards))) ERR(ret);
+    if(shards[0] != 2 || shards[1] != 3) FAIL("shards attribute value");
+    /* Read a single value, then everything */
+    {
+        size_t index[2] = {NX-1,NY-1};
+        int value = 0;
+        if((ret = nc_get_var1_int(ncid,varid,index,&value))) ERR(ret);
+        if(value != (NX-1)*NY+(NY-1)) FAIL("last value");
+    }
+    if((ret = nc_get_var_int(ncid,varid,&data[0][0]))) ERR(ret);
+    for(i=0;i<NX;i++) {
+        for(j=0;j<NY;j++) {
+            int expected = i*NY+j;
+            if(rewritten && i >= 5 && i < 11 && j >= 2 && j < 7) expected = -expected;
+            if(data[i][j] != expected) {
+                fprintf(stderr,"fail: data[%d][%d] = %d, expected %d\n",i,j,data[i][j],expected);
+                exit(1);
+            }
+        }
+    }
+    if((ret = nc_close(ncid))) ERR(ret);
+}
+
+/* A pure Zarr reader must either not see the variable or fail to read it */
+static void
+verifyplain(const char* url)
+{
+    int ret, ncid, varid;
+
+    if((ret = nc_open(url,NC_NOWRITE,&ncid))) ERR(ret);
+    ret = nc_inq_varid(ncid,"v",&varid);
+    if(ret == NC_NOERR) {
+        if((ret = nc_get_var_int(ncid,varid,&data[0][0])) == NC_NOERR)
+            FAIL("pure Zarr reader read a sharded variable");
+    } else if(ret != NC_ENOTVAR) ERR(ret);
+    if((ret = nc_close(ncid))) ERR(ret);
+}
+
+int
+main(int argc, char **argv)
+{
+    int ret, ncid, dimids[2], varid, i, j;
+    size_t chunks[2] = {CX,CY};
+    int shards[2] = {2,3};
+    const char* url = NULL;
+
+    if(argc < 2) {
+	fprintf(stderr,"Usage: test_shard <url> [<pure zarr url>]\n");
+	exit(1);
+    }
+    url = argv[1];
+
+    printf("*** Testing sharded chunk storage...");
+    if((ret = nc_create(url,NC_NETCDF4|NC_CLOBBER,&ncid))) ERR(ret);
+    if((ret = nc_def_dim(ncid,"x",NX,&dimids[0]))) ERR(ret);
+    if((ret = nc_def_dim(ncid,"y",NY,&dimids[1]))) ERR(ret);
+    if((ret = nc_def_var(ncid,"v",NC_INT,2,dimids,&varid))) ERR(ret);
+    if((ret = nc_def_var_chunking(ncid,varid,NC_CHUNKED,chunks))) ERR(ret);
+    /* Shards must have one positive extent per dimension */
+    if((ret = nc_put_att_int(ncid,varid,SHARDS,NC_INT,1,shards)) != NC_EINVAL) ERR(ret);
+    shards[1] = 0;
+    if((ret = nc_put_att_int(ncid,varid,SHARDS,NC_INT,2,shards)) != NC_EINVAL) ERR(ret);
+    shards[1] = 3;
+    if((ret = nc_put_att_int(ncid,varid,SHARDS,NC_INT,2,shards))) ERR(ret);
+    /* Room for only a few chunks, so shards are staged and stored piecemeal */
+    if((ret = nc_set_var_chunk_cache(ncid,varid,3*CX*CY*sizeof(int),3,0.5))) ERR(ret);
+    if((ret = nc_enddef(ncid))) ERR(ret);
+    /* Too late to change the shards */
+    if((ret = nc_put_att_int(ncid,varid,SHARDS,NC_INT,2,shards)) != NC_ELATEDEF) ERR(ret);
+
+    /* Write every other row, then the others backwards */
+    for(i=0;i<NX;i+=2) {
+        size_t start[2] = {(size_t)i,0}, count[2] = {1,NY};
+        int row[NY];
+        for(j=0;j<NY;j++) row[j] = i*NY+j;
+        if((ret = nc_put_vara_int(ncid,varid,start,count,row))) ERR(ret);
+    }
+    for(i=NX-1;i>0;i-=2) {
+        size_t start[2] = {(size_t)i,0}, count[2] = {1,NY};
+        int row[NY];
+        for(j=0;j<NY;j++) row[j] = i*NY+j;
+        if((ret = nc_put_vara_int(ncid,varid,start,count,row))) ERR(ret);
+    }
+    if((ret = nc_close(ncid))) ERR(ret);
+    verify(url,0);
+
+    /* Rewrite a block crossing shard boundaries, keeping the rest of
+       each shard */
+    if((ret = nc_open(url,NC_WRITE,&ncid))) ERR(ret);
+    if((ret = nc_inq_varid(ncid,"v",&varid))) ERR(ret);
+    {
+        size_t start[2] = {5,2}, count[2] = {6,5};
+        int block[6][5];
+        for(i=0;i<6;i++)
+            for(j=0;j<5;j++)
+                block[i][j] = -((i+5)*NY+(j+2));
+        if((ret = nc_put_vara_int(ncid,varid,start,count,&block[0][0]))) ERR(ret);
+    }
+    if((ret = nc_close(ncid))) ERR(ret);
+    verify(url,1);
+    if(argc > 2) verifyplain(argv[2]);
+    printf("passed\n");
+    return 0;
+}
@@ -258,8 +258,14 @@ writedata(void)
     if((stat=nczm_concat(DATA1,"0",&path)))
 	goto done;
 
-    if((stat = nczmap_write(map, path, totallen, data1p)))
-	goto done;
+    /* Write it as a batch of one */
+    {
+        const char* keys[1];
+        const void* contents[1];
+        keys[0] = path; contents[0] = data1p;
+        if((stat = nczmap_writemany(map, 1, keys, &totallen, contents)))
+	    goto done;
+    }
 
 done:
     /* Do not delete so we can look at it with ncdump */
@@ -278,6 +284,7 @@ readdata(void)
     size64_t i;
     size64_t chunklen, totallen;
     char* data1p = NULL; /* byte level pointer into data1 */
+    void* whole = NULL;
 
     if((stat = nczmap_open(impl,url,0,0,NULL,&map)))
 	goto done;
@@ -316,9 +323,51 @@ readdata(void)
 	}
     }
 
+    /* Read it again as a whole object */
+    if((stat = nczmap_readobj(map, path, &chunklen, &whole)))
+	goto done;
+    if(chunklen != totallen || memcmp(whole,data1,totallen) != 0) {
+	fprintf(stderr,"readobj mismatch: len=%llu should be: %llu\n",chunklen,totallen);
+	stat = NC_EINVAL;
+	goto done;
+    }
+
+    /* The file map should have opened the object only once */
+    if(impl == NCZM_FILE && getenv("NCZ_FDCACHE_SIZE") == NULL && map->stats.opens != 1) {
+	fprintf(stderr,"object opened %llu times\n",map->stats.opens);
+	stat = NC_EINVAL;
+	goto done;
+    }
+
+    /* Read it again, along with a missing object, as a batch */
+    {
+        const char* keys[2];
+        size64_t sizes[2];
+        void* contents[2] = {NULL,NULL};
+        int stats[2];
+        char* missing = NULL;
+        if((stat=nczm_concat(DATA1,"nosuchobject",&missing)))
+            goto done;
+        keys[0] = path; keys[1] = missing;
+        stat = nczmap_readmany(map, 2, keys, sizes, contents, stats);
+        if(stat == NC_NOERR
+           && (stats[0] != NC_NOERR || sizes[0] != totallen
+               || memcmp(contents[0],data1,totallen) != 0
+               || (stats[1] != NC_EEMPTY && stats[1] != NC_ENOOBJECT))) {
+            fprintf(stderr,"readmany mismatch: stats=%d,%d len=%llu should be: %llu\n",
+                    stats[0],stats[1],sizes[0],totallen);
+            stat = NC_EINVAL;
+        }
+        nullfree(contents[0]);
+        nullfree(contents[1]);
+        nullfree(missing);
+        if(stat) goto done;
+    }
+
 done:
     /* Do not delete so we can look at it with ncdump */
     (void)nczmap_close(map,0);
+    nullfree(whole);
     nullfree(path);
     return THROW(stat);
 }
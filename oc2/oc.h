@@ -63,6 +63,11 @@ Cause oc_fetch to encode query part of a URL
 */
 #define OCENCODEQUERY 4
 
+/*!\def OCSTREAM
+Cause oc_fetch to decode a DataDDS as it is received
+*/
+#define OCSTREAM 8
+
 /**************************************************/
 /* OCtype */
 
@@ -0,0 +1,562 @@
+/* Copyright 2018, UCAR/Unidata and OPeNDAP, Inc.
+   See the COPYRIGHT file for more information. */
+
+/*
+Persistent cache of DAP2 responses.
+
+Each response is kept in a file of the cache directory named for a
+hash of the url it was fetched from, which includes the .dds, .das
+or .dods suffix and the constraint, and of the credentials it was
+fetched with, so that a response is never given to a user other than
+the one it was fetched for. An entry younger than the
+maximum age is used as is; an older one is revalidated with a
+conditional request, using the ETag and Last-Modified time that came
+with it, and is used again if the server answers 304. When the
+entries grow beyond the size limit, the least recently used ones are
+removed.
+*/
+
+#include "config.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#ifdef _MSC_VER
+#include <sys/utime.h>
+#define utime _utime
+#else
+#include <utime.h>
+#endif
+#include "ncrc.h"
+#include "ncutil.h"
+#include "ncpathmgr.h"
+#include "ocinternal.h"
+#include "ocdebug.h"
+#include "ochttp.h"
+#include "occache.h"
+
+/* Each setting is taken from the environment variable or, failing
+   that, the .rc key (which may be specific to the host) when a link
+   is opened. There is no cache unless a directory is given. The size
+   is in bytes and the age in seconds; an age of 0 means that every
+   use of an entry is checked with the server. */
+#define CACHEDIR_ENV "NETCDF_DAP_CACHEDIR"
+#define CACHEDIR_RC "NETCDF.DAP.CACHEDIR"
+#define CACHESIZE_ENV "NETCDF_DAP_CACHESIZE"
+#define CACHESIZE_RC "NETCDF.DAP.CACHESIZE"
+#define CACHESIZE_DEFAULT ((size_t)256*1024*1024)
+#define CACHEAGE_ENV "NETCDF_DAP_CACHEAGE"
+#define CACHEAGE_RC "NETCDF.DAP.CACHEAGE"
+#define CACHEAGE_DEFAULT 0
+
+/* An entry file holds a header line, the url, the ETag (if any) and
+   then the response. The time of the last validation has a fixed
+   width so that it can be updated in place. */
+#define ENTRYMAGIC "OCCACHE1"
+#define ENTRYSUFFIX ".occache"
+#define VALIDATEDWIDTH 20
+
+#define COPYSIZE 8192
+
+typedef struct OCentry {
+    long long validated; /* when the server last vouched for it */
+    long lastmodified; /* -1 => unknown */
+    unsigned long long size; /* of the response */
+    char* etag; /* NULL => none */
+} OCentry;
+
+/* An entry seen while evicting */
+typedef struct OCvictim {
+    char* path;
+    unsigned long long size;
+    time_t used;
+} OCvictim;
+
+/* Forward */
+static const char* getsetting(OCstate* state, const char* envkey, const char* rckey);
+static char* makekey(OCstate* state, const char* url);
+static unsigned long long hashstring(unsigned long long hash, const char* s);
+static char* entrypath(OCdiskcache* cache, const char* key);
+static FILE* openentry(const char* path, const char* key, OCentry* entry);
+static OCerror readbody(FILE* f, const OCentry* entry, NCbytes* packet, FILE* stream, off_t* sizep);
+static void storeentry(OCdiskcache* cache, const char* path, const char* key, const OCentry* entry, NCbytes* packet, FILE* stream);
+static void revalidated(const char* path);
+static void evict(OCdiskcache* cache);
+static OCerror copystream(FILE* src, FILE* dst, unsigned long long count);
+static OCerror fetch(CURL* curl, const char* url, NCbytes* packet, FILE* stream, off_t* sizep, long* lastmodified);
+static size_t ETagCallback(char* buffer, size_t size, size_t nitems, void* data);
+
+OCerror
+occache_open(OCstate* state)
+{
+    OCdiskcache* cache = NULL;
+    const char* value = NULL;
+
+    state->diskcache = NULL;
+    if((value = getsetting(state,CACHEDIR_ENV,CACHEDIR_RC)) == NULL)
+	return OC_NOERR;
+    cache = (OCdiskcache*)ocmalloc(sizeof(OCdiskcache));
+    MEMCHECK(cache,OC_ENOMEM);
+    if((cache->dir = strdup(value)) == NULL) {
+	ocfree(cache);
+	return OCTHROW(OC_ENOMEM);
+    }
+    cache->limit = CACHESIZE_DEFAULT;
+    cache->maxage = CACHEAGE_DEFAULT;
+    if((value = getsetting(state,CACHESIZE_ENV,CACHESIZE_RC)) != NULL) {
+	unsigned long long limit;
+	if(sscanf(value,"%llu",&limit) == 1)
+	    cache->limit = (size_t)limit;
+	else
+	    nclog(NCLOGWARN,"Illegal %s value: %s",CACHESIZE_RC,value);
+    }
+    if((value = getsetting(state,CACHEAGE_ENV,CACHEAGE_RC)) != NULL) {
+	long maxage;
+	if(sscanf(value,"%ld",&maxage) == 1 && maxage >= 0)
+	    cache->maxage = maxage;
+	else
+	    nclog(NCLOGWARN,"Illegal %s value: %s",CACHEAGE_RC,value);
+    }
+    /* If the directory cannot be made, every fetch is a miss */
+    (void)NCmkdir(cache->dir,0700);
+    state->diskcache = cache;
+    return OC_NOERR;
+}
+
+void
+occache_close(OCstate* state)
+{
+    OCdiskcache* cache = state->diskcache;
+    if(cache == NULL) return;
+    ocfree(cache->dir);
+    ocfree(cache);
+    state->diskcache = NULL;
+}
+
+/*
+Fetch url into packet (or into stream if packet is NULL) through the
+cache. Answers from the cache are flagged in state->diskcache->hit.
+*/
+OCerror
+occache_fetch(OCstate* state, const char* url, NCbytes* packet,
+	      FILE* stream, off_t* sizep, long* lastmodified)
+{
+    OCerror stat = OC_NOERR;
+    OCdiskcache* cache = state->diskcache;
+    CURL* curl = state->curl;
+    char* key = NULL;
+    char* path = NULL;
+    FILE* f = NULL;
+    OCentry entry;
+    OCentry fetched;
+    struct curl_slist* headers = NULL;
+    long filetime = -1;
+    long httpcode = 0;
+
+    if(cache == NULL)
+	return OCTHROW(fetch(curl,url,packet,stream,sizep,lastmodified));
+
+    memset(&entry,0,sizeof(entry));
+    memset(&fetched,0,sizeof(fetched));
+    cache->hit = 0;
+    if((key = makekey(state,url)) == NULL || (path = entrypath(cache,key)) == NULL)
+	{stat = OC_ENOMEM; goto done;}
+    f = openentry(path,key,&entry);
+    if(f != NULL && cache->maxage > 0
+       && (long long)time(NULL) - entry.validated < cache->maxage)
+	goto hit;
+
+    /* Ask the server; only for changes if there is an entry */
+    if(f != NULL) {
+	if(entry.etag != NULL) {
+	    size_t len = strlen("If-None-Match: ")+strlen(entry.etag)+1;
+	    char* header = (char*)malloc(len);
+	    if(header == NULL) {stat = OC_ENOMEM; goto done;}
+	    snprintf(header,len,"If-None-Match: %s",entry.etag);
+	    headers = curl_slist_append(NULL,header);
+	    free(header);
+	    (void)CURLERR(curl_easy_setopt(curl,CURLOPT_HTTPHEADER,headers));
+	} else if(entry.lastmodified >= 0) {
+	    /* Not both, lest curl drop a changed response with the
+	       same time */
+	    (void)CURLERR(curl_easy_setopt(curl,CURLOPT_TIMECONDITION,(long)CURL_TIMECOND_IFMODSINCE));
+	    (void)CURLERR(curl_easy_setopt(curl,CURLOPT_TIMEVALUE,entry.lastmodified));
+	}
+    }
+    (void)CURLERR(curl_easy_setopt(curl,CURLOPT_HEADERFUNCTION,ETagCallback));
+    (void)CURLERR(curl_easy_setopt(curl,CURLOPT_HEADERDATA,(void*)&fetched.etag));
+    stat = fetch(curl,url,packet,stream,sizep,&filetime);
+    (void)CURLERR(curl_easy_setopt(curl,CURLOPT_HEADERFUNCTION,NULL));
+    (void)CURLERR(curl_easy_setopt(curl,CURLOPT_HEADERDATA,NULL));
+    (void)CURLERR(curl_easy_setopt(curl,CURLOPT_HTTPHEADER,NULL));
+    (void)CURLERR(curl_easy_setopt(curl,CURLOPT_TIMECONDITION,(long)CURL_TIMECOND_NONE));
+    if(stat != OC_NOERR) goto done;
+
+    httpcode = ocfetchhttpcode(curl);
+    if(f != NULL && entry.etag == NULL && entry.lastmodified >= 0) {
+	long unmet = 0;
+	if(curl_easy_getinfo(curl,CURLINFO_CONDITION_UNMET,&unmet) == CURLE_OK && unmet)
+	    httpcode = 304;
+    }
+    if(f != NULL && httpcode == 304) {
+	revalidated(path);
+	goto hit;
+    }
+    if(lastmodified) *lastmodified = filetime;
+    if(httpcode == 200) {
+	fetched.validated = (long long)time(NULL);
+	fetched.lastmodified = filetime;
+	if(packet != NULL)
+	    fetched.size = ncbyteslength(packet);
+	else if(sizep != NULL)
+	    fetched.size = (unsigned long long)*sizep;
+	else
+	    goto done;
+	if(f != NULL) {fclose(f); f = NULL;}
+	/* An entry that can never be used again is not worth keeping */
+	if(fetched.size <= cache->limit
+	   && (fetched.etag != NULL || fetched.lastmodified >= 0 || cache->maxage > 0))
+	    storeentry(cache,path,key,&fetched,packet,stream);
+    }
+    goto done;
+
+hit:
+    if((stat = readbody(f,&entry,packet,stream,sizep)) != OC_NOERR) goto done;
+    if(lastmodified) *lastmodified = entry.lastmodified;
+    cache->hit = 1;
+    (void)utime(path,NULL); /* most recently used */
+    if(ocdebug > 0)
+	{fprintf(stderr,"fetch from cache: %s\n",path); fflush(stderr);}
+
+done:
+    if(f != NULL) fclose(f);
+    if(headers != NULL) curl_slist_free_all(headers);
+    ocfree(entry.etag);
+    ocfree(fetched.etag);
+    ocfree(key);
+    ocfree(path);
+    return OCTHROW(stat);
+}
+
+static const char*
+getsetting(OCstate* state, const char* envkey, const char* rckey)
+{
+    const char* value = getenv(envkey);
+    if(value == NULL || *value == '\0')
+	value = NC_rclookupx(state->uri,rckey);
+    if(value != NULL && *value == '\0')
+	value = NULL;
+    return value;
+}
+
+/* The key is the url less any password; if the request carries
+   credentials (from the url, the .rc file, a netrc file, a client
+   certificate or a cookie jar), it is followed by a hash of them,
+   which is all of them that is stored. */
+static char*
+makekey(OCstate* state, const char* url)
+{
+    char* key = strdup(url);
+    char* host = NULL;
+    char* at = NULL;
+    char* colon = NULL;
+    char* identified = NULL;
+    const NCauth* auth = state->auth;
+    unsigned long long hash = 14695981039346656037ULL;
+    int anonymous = 1;
+    size_t len;
+
+    if(key == NULL) return NULL;
+    if((host = strstr(key,"://")) != NULL) {
+	host += 3;
+	at = strchr(host,'@');
+	if(at != NULL && (strchr(host,'/') == NULL || strchr(host,'/') > at)) {
+	    for(colon=host;colon < at && *colon != ':';colon++);
+	    if(colon < at) {
+		*at = '\0';
+		hash = hashstring(hash,colon);
+		anonymous = 0;
+		*at = '@';
+		memmove(colon,at,strlen(at)+1);
+	    }
+	}
+    }
+    if(auth != NULL) {
+	const char* identity[6];
+	int i;
+	identity[0] = auth->creds.user;
+	identity[1] = auth->creds.pwd;
+	identity[2] = auth->ssl.certificate;
+	identity[3] = auth->ssl.key;
+	identity[4] = auth->curlflags.netrc;
+	/* A cookie jar made for this link holds no identity yet */
+	identity[5] = (auth->curlflags.cookiejarcreated ? NULL : auth->curlflags.cookiejar);
+	for(i=0;i<6;i++) {
+	    hash = hashstring(hash,identity[i] == NULL ? "" : identity[i]);
+	    hash = hashstring(hash,"\n");
+	    if(identity[i] != NULL) anonymous = 0;
+	}
+    }
+    if(anonymous) return key;
+    len = strlen(key)+1+16+1;
+    if((identified = (char*)malloc(len)) != NULL)
+	snprintf(identified,len,"%s %016llx",key,hash);
+    free(key);
+    return identified;
+}
+
+/* FNV-1a */
+static unsigned long long
+hashstring(unsigned long long hash, const char* s)
+{
+    const unsigned char* p;
+    for(p=(const unsigned char*)s;*p;p++) {
+	hash ^= *p;
+	hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static char*
+entrypath(OCdiskcache* cache, const char* key)
+{
+    size_t len = strlen(cache->dir)+1+16+strlen(ENTRYSUFFIX)+1;
+    char* path = (char*)malloc(len);
+
+    if(path == NULL) return NULL;
+    snprintf(path,len,"%s/%016llx%s",cache->dir,
+	     hashstring(14695981039346656037ULL,key),ENTRYSUFFIX);
+    return path;
+}
+
+/* Open the entry for key, leaving it positioned at the response;
+   NULL if there is no complete entry for key. */
+static FILE*
+openentry(const char* path, const char* key, OCentry* entry)
+{
+    FILE* f = NULL;
+    char magic[16];
+    unsigned long keylen, etaglen;
+    char* stored = NULL;
+    long start, end;
+
+    memset(entry,0,sizeof(OCentry));
+    entry->lastmodified = -1;
+    if((f = NCfopen(path,"rb")) == NULL)
+	return NULL;
+    if(fscanf(f,"%15s %lld %ld %llu %lu %lu",magic,&entry->validated,
+	      &entry->lastmodified,&entry->size,&keylen,&etaglen) != 6
+       || strcmp(magic,ENTRYMAGIC) != 0
+       || fgetc(f) != '\n'
+       || keylen != strlen(key))
+	goto miss;
+    if((stored = (char*)malloc(keylen+etaglen+1)) == NULL
+       || fread(stored,1,keylen+etaglen,f) != keylen+etaglen
+       || memcmp(stored,key,keylen) != 0)
+	goto miss;
+    if(etaglen > 0) {
+	if((entry->etag = (char*)malloc(etaglen+1)) == NULL) goto miss;
+	memcpy(entry->etag,stored+keylen,etaglen);
+	entry->etag[etaglen] = '\0';
+    }
+    free(stored);
+    /* Make sure that the response is all there */
+    if((start = ftell(f)) < 0 || fseek(f,0,SEEK_END) != 0
+       || (end = ftell(f)) < 0
+       || (unsigned long long)(end - start) != entry->size
+       || fseek(f,start,SEEK_SET) != 0) {
+	stored = NULL;
+	goto miss;
+    }
+    return f;
+
+miss:
+    ocfree(stored);
+    ocfree(entry->etag);
+    entry->etag = NULL;
+    fclose(f);
+    return NULL;
+}
+
+/* Copy the response of an open entry into packet or stream */
+static OCerror
+readbody(FILE* f, const OCentry* entry, NCbytes* packet, FILE* stream, off_t* sizep)
+{
+    OCerror stat = OC_NOERR;
+    size_t size = (size_t)entry->size;
+
+    if(packet != NULL) {
+	ncbytesclear(packet);
+	if(!ncbytessetalloc(packet,(unsigned long)(size+1)))
+	    return OCTHROW(OC_ENOMEM);
+	if(fread(ncbytescontents(packet),1,size,f) != size)
+	    return OCTHROW(OC_EIO);
+	/* Null terminate as ocfetchurl does */
+	ncbytessetlength(packet,(unsigned long)size);
+	ncbytesnull(packet);
+	ncbytessetlength(packet,(unsigned long)size);
+    } else {
+	if(fseek(stream,0,SEEK_SET) != 0)
+	    return OCTHROW(OC_EIO);
+	if((stat = copystream(f,stream,entry->size)) != OC_NOERR)
+	    return OCTHROW(stat);
+    }
+    if(sizep != NULL) *sizep = (off_t)size;
+    return OCTHROW(stat);
+}
+
+/* Write an entry under a temporary name and then move it into
+   place, so that other processes see all of it or none of it. */
+static void
+storeentry(OCdiskcache* cache, const char* path, const char* key,
+	   const OCentry* entry, NCbytes* packet, FILE* stream)
+{
+    char* base = NULL;
+    char* tmp = NULL;
+    FILE* f = NULL;
+    size_t len = strlen(path)+2;
+    size_t etaglen = (entry->etag == NULL ? 0 : strlen(entry->etag));
+    int ok = 0;
+
+    if((base = (char*)malloc(len)) == NULL) return;
+    snprintf(base,len,"%s.",path);
+    if(NC_mktmp(base,&tmp) != NC_NOERR || tmp == NULL) goto done;
+    if((f = NCfopen(tmp,"wb")) == NULL) goto done;
+    ok = (fprintf(f,"%s %0*lld %ld %llu %lu %lu\n",ENTRYMAGIC,VALIDATEDWIDTH,
+		  entry->validated,entry->lastmodified,entry->size,
+		  (unsigned long)strlen(key),(unsigned long)etaglen) > 0
+	  && fwrite(key,1,strlen(key),f) == strlen(key)
+	  && fwrite((etaglen > 0 ? entry->etag : ""),1,etaglen,f) == etaglen);
+    if(ok && packet != NULL)
+	ok = (fwrite(ncbytescontents(packet),1,(size_t)entry->size,f) == (size_t)entry->size);
+    else if(ok)
+	ok = (fseek(stream,0,SEEK_SET) == 0
+	      && copystream(stream,f,entry->size) == OC_NOERR);
+    if(fclose(f) != 0) ok = 0;
+#ifdef _WIN32
+    if(ok) (void)NCremove(path);
+#endif
+    if(ok) ok = (rename(tmp,path) == 0);
+    if(!ok) (void)NCremove(tmp);
+    else evict(cache);
+done:
+    ocfree(base);
+    ocfree(tmp);
+}
+
+/* Reset the time of the last validation of an entry */
+static void
+revalidated(const char* path)
+{
+    FILE* f = NCfopen(path,"r+b");
+    if(f == NULL) return;
+    if(fseek(f,(long)strlen(ENTRYMAGIC)+1,SEEK_SET) == 0)
+	fprintf(f,"%0*lld",VALIDATEDWIDTH,(long long)time(NULL));
+    fclose(f);
+}
+
+static int
+usedorder(const void* a, const void* b)
+{
+    const OCvictim* va = *(const OCvictim**)a;
+    const OCvictim* vb = *(const OCvictim**)b;
+    return (va->used < vb->used ? -1 : (va->used > vb->used ? 1 : 0));
+}
+
+/* Remove the least recently used entries until the rest fit */
+static void
+evict(OCdiskcache* cache)
+{
+    DIR* dir = NULL;
+    struct dirent* de = NULL;
+    NClist* victims = nclistnew();
+    unsigned long long total = 0;
+    size_t suffixlen = strlen(ENTRYSUFFIX);
+    size_t i;
+
+    if((dir = NCopendir(cache->dir)) == NULL) goto done;
+    while((de = readdir(dir)) != NULL) {
+	size_t namelen = strlen(de->d_name);
+	size_t len = strlen(cache->dir)+1+namelen+1;
+	OCvictim* v = NULL;
+#ifdef _WIN32
+	struct _stat64 buf;
+#else
+	struct stat buf;
+#endif
+	if(namelen <= suffixlen || strcmp(de->d_name+namelen-suffixlen,ENTRYSUFFIX) != 0)
+	    continue;
+	if((v = (OCvictim*)calloc(1,sizeof(OCvictim))) == NULL) break;
+	if((v->path = (char*)malloc(len)) == NULL) {free(v); break;}
+	snprintf(v->path,len,"%s/%s",cache->dir,de->d_name);
+	if(NCstat(v->path,&buf) != 0) {free(v->path); free(v); continue;}
+	v->size = (unsigned long long)buf.st_size;
+	v->used = buf.st_mtime;
+	total += v->size;
+	nclistpush(victims,v);
+    }
+    NCclosedir(dir);
+    if(total > cache->limit && nclistlength(victims) > 1)
+	qsort(victims->content,nclistlength(victims),sizeof(void*),usedorder);
+    for(i=0;i<nclistlength(victims) && total > cache->limit;i++) {
+	OCvictim* v = (OCvictim*)nclistget(victims,i);
+	if(NCremove(v->path) == 0) total -= v->size;
+    }
+done:
+    for(i=0;i<nclistlength(victims);i++) {
+	OCvictim* v = (OCvictim*)nclistget(victims,i);
+	free(v->path);
+	free(v);
+    }
+    nclistfree(victims);
+}
+
+static OCerror
+copystream(FILE* src, FILE* dst, unsigned long long count)
+{
+    char buf[COPYSIZE];
+    while(count > 0) {
+	size_t n = (count < sizeof(buf) ? (size_t)count : sizeof(buf));
+	if(fread(buf,1,n,src) != n || fwrite(buf,1,n,dst) != n)
+	    return OCTHROW(OC_EIO);
+	count -= n;
+    }
+    return OC_NOERR;
+}
+
+static OCerror
+fetch(CURL* curl, const char* url, NCbytes* packet, FILE* stream,
+      off_t* sizep, long* lastmodified)
+{
+    if(packet != NULL)
+	return ocfetchurl(curl,url,packet,lastmodified);
+    return ocfetchurl_file(curl,url,stream,sizep,lastmodified);
+}
+
+/* Remember the last ETag of a response */
+static size_t
+ETagCallback(char* buffer, size_t size, size_t nitems, void* data)
+{
+    size_t realsize = size * nitems;
+    char** etagp = (char**)data;
+    char* p = buffer;
+    char* end = buffer + realsize;
+    char name[8];
+    size_t i;
+
+    for(i=0;p < end && *p != ':' && i < sizeof(name)-1;p++,i++)
+	name[i] = *p;
+    name[i] = '\0';
+    if(p == end || *p != ':' || strcasecmp(name,"ETag") != 0)
+	return realsize;
+    for(p++;p < end && (*p == ' ' || *p == '\t');p++);
+    while(end > p && (end[-1] == '\r' || end[-1] == '\n' || end[-1] == ' ' || end[-1] == '\t'))
+	end--;
+    ocfree(*etagp);
+    *etagp = NULL;
+    if(end > p && (*etagp = (char*)malloc((size_t)(end-p)+1)) != NULL) {
+	memcpy(*etagp,p,(size_t)(end-p));
+	(*etagp)[end-p] = '\0';
+    }
+    return realsize;
+}
@@ -0,0 +1,25 @@
+/* Copyright 2018, UCAR/Unidata and OPeNDAP, Inc.
+   See the COPYRIGHT file for more information. */
+
+#ifndef OCCACHE_H
+#define OCCACHE_H 1
+
+/* Persistent cache of the DDS, DAS and DataDDS responses fetched
+   by a link. Entries live in a directory that outlives the link and
+   may be shared by any number of processes. */
+typedef struct OCdiskcache {
+    char* dir;
+    size_t limit; /* total size of the entries in bytes */
+    long maxage; /* seconds an entry is used without asking the server */
+    int hit; /* last fetch was answered from the cache */
+} OCdiskcache;
+
+extern OCerror occache_open(OCstate* state);
+extern void occache_close(OCstate* state);
+
+/* Fetch url into packet or, if packet is NULL, into stream */
+extern OCerror occache_fetch(OCstate* state, const char* url,
+			     NCbytes* packet, FILE* stream, off_t* sizep,
+			     long* lastmodified);
+
+#endif /*OCCACHE_H*/
@@ -137,16 +137,23 @@ ocfetchurl(CURL* curl, const char* url, NCbytes* buf, long* filetime)
 
 fail:
 	nclog(NCLOGERR, "curl error: %s", curl_easy_strerror(cstat));
+	stat = ocfetcherror(httpcode);
+	return OCTHROW(stat);
+}
+
+/* Map the http code of a failed fetch to an error */
+OCerror
+ocfetcherror(long httpcode)
+{
 	switch (httpcode) {
-	case 400: stat = OC_EBADURL; break;
-	case 401: stat = OC_EACCESS; break;
-	case 403: stat = OC_EAUTH; break;
-	case 404: stat = OC_ENOFILE; break;
-	case 500: stat = OC_EDAPSVC; break;
-	case 200: break;
-	default: stat = OC_ECURL; break;
+	case 400: return OC_EBADURL;
+	case 401: return OC_EACCESS;
+	case 403: return OC_EAUTH;
+	case 404: return OC_ENOFILE;
+	case 500: return OC_EDAPSVC;
+	case 200: return OC_NOERR;
+	default: return OC_ECURL;
 	}
-	return OCTHROW(stat);
 }
 
 static size_t
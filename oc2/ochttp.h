@@ -11,6 +11,7 @@ extern OCerror ocfetchurl(CURL*, const char*, NCbytes*, long*);
 extern OCerror ocfetchurl_file(CURL*, const char*, FILE*, off_t*, long*);
 
 extern long ocfetchhttpcode(CURL* curl);
+extern OCerror ocfetcherror(long httpcode);
 
 extern OCerror ocfetchlastmodified(CURL* curl, char* url, long* filetime);
 
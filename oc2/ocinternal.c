@@ -32,6 +32,8 @@
 #include "occurlfunctions.h"
 #include "ochttp.h"
 #include "ocread.h"
+#include "occache.h"
+#include "ocstream.h"
 #include "dapparselex.h"
 #include "ncpathmgr.h"
 #include "ncutil.h"
@@ -133,6 +135,9 @@ ocopen(OCstate** statep, const char* url)
     /* Initialize misc info from rc file */
     stat = ocget_rcproperties(state);
 
+    /* Open any persistent response cache */
+    if((stat=occache_open(state))!= OC_NOERR) goto fail;
+
     /* Apply curl properties for this link;
        assumes state has been initialized */
     stat = ocset_curlproperties(state);
@@ -202,26 +207,26 @@ ocfetch(OCstate* state, const char* constraint, OCdxd kind, OCflags flags,
             /* Make the tmp file*/
             stat = createtempfile(state,tree);
             if(stat) {OCTHROWCHK(stat); goto fail;}
-            stat = readDATADDS(state,tree,flags);
-	    if(stat == OC_NOERR) {
-                /* Separate the DDS from data and return the dds;
-                   will modify packet */
-                stat = ocextractddsinfile(state,tree,flags);
-	    }
-	} else { /*inmemory*/
-            stat = readDATADDS(state,tree,flags);
-	    if(stat == OC_NOERR) {
-                /* Separate the DDS from data and return the dds;
-               will modify packet */
-            stat = ocextractddsinmemory(state,tree,flags);
 	}
+        stat = readDATADDS(state,tree,flags);
+	/* A streamed response has had its DDS separated already */
+	if(stat == OC_NOERR && tree->data.stream == NULL) {
+            /* Separate the DDS from data and return the dds;
+               will modify packet */
+	    if((flags & OCONDISK) != 0)
+                stat = ocextractddsinfile(state,tree,flags);
+	    else
+                stat = ocextractddsinmemory(state,tree,flags);
 	}
 	break;
     default:
 	break;
     }/*switch*/
-    /* Obtain any http code */
-    state->error.httpcode = ocfetchhttpcode(state->curl);
+    /* Obtain any http code; a response from the cache was a 200 */
+    if(state->diskcache != NULL && state->diskcache->hit)
+        state->error.httpcode = 200;
+    else
+        state->error.httpcode = ocfetchhttpcode(state->curl);
     if(stat != OC_NOERR) {
 	if(state->error.httpcode >= 400) {
 	    nclog(NCLOGWARN,"oc_open: Could not read url (%s); http error = %l",
@@ -276,7 +281,10 @@ ocfetch(OCstate* state, const char* constraint, OCdxd kind, OCflags flags,
     occomputefullnames(tree->root);
 
      if(kind == OCDATADDS) {
-	if((flags & OCONDISK) != 0) {
+	if(tree->data.stream != NULL) {
+	    /* Decode the data as it arrives */
+            tree->data.xdrs = ocstream_xxdr(tree->data.stream);
+	} else if((flags & OCONDISK) != 0) {
             tree->data.xdrs = xxdr_filecreate(tree->data.file,tree->data.bod);
 	} else {
 #ifdef OCDEBUG
@@ -303,6 +311,11 @@ fprintf(stderr,"ocfetch.datadds.memory: datasize=%lu bod=%lu\n",
 	stat = occompile(state,tree->root);
 	if(stat != OC_NOERR)
 	    goto fail;
+
+	/* Wait for the rest of a streamed response */
+	stat = ocstream_close(state,tree);
+	if(stat != OC_NOERR)
+	    goto fail;
     }
 
     /* Put root into the state->trees list */
@@ -379,6 +392,7 @@ occlose(OCstate* state)
     if(state->curl != NULL) occurlclose(state->curl);
     NC_authfree(state->auth);
     state->auth = NULL;
+    occache_close(state);
     ocfree(state);
 }
 
@@ -621,27 +635,26 @@ dataError(XXDR* xdrs, OCstate* state)
 {
     int depth=0;
     int errfound = 0;
-    off_t ckp=0,avail=0;
+    off_t ckp=0;
     int i=0;
     char* errmsg = NULL;
     char errortext[16]; /* bigger than |ERROR_TAG|*/
-    avail = xxdr_getavail(xdrs);
-    if(avail < strlen(ERROR_TAG))
-	goto done; /* assume it is ok */
     ckp = xxdr_getpos(xdrs);
-    /* Read enough characters to test for 'ERROR ' */
+    /* Read enough characters to test for 'ERROR ', but no more than
+       that, since a streamed response may still be arriving */
     errortext[0] = '\0';
-    xxdr_getbytes(xdrs,errortext,(off_t)strlen(ERROR_TAG));
+    if(!xxdr_getbytes(xdrs,errortext,(off_t)strlen(ERROR_TAG)))
+	goto done; /* assume it is ok */
     if(ocstrncmp(errortext,ERROR_TAG,strlen(ERROR_TAG)) != 0)
 	goto done; /* not an immediate error */
     /* Try to locate the whole error body */
     xxdr_setpos(xdrs,ckp);
-    for(depth=0,i=0;i<avail;i++) {
-	xxdr_getbytes(xdrs,errortext,(off_t)1);
+    for(depth=0,i=0;xxdr_getbytes(xdrs,errortext,(off_t)1);) {
+	i++;
 	if(errortext[0] == CLBRACE) depth++;
 	else if(errortext[0] == CRBRACE) {
 	    depth--;
-	    if(depth == 0) {i++; break;}
+	    if(depth == 0) break;
 	}
     }
     errmsg = (char*)malloc((size_t)i+1);
@@ -183,6 +183,7 @@ struct OCstate {
 	long idle; /* KEEPIDLE value */
 	long interval; /* KEEPINTVL value */
     } curlkeepalive; /* keepalive info */
+    struct OCdiskcache* diskcache; /* persistent response cache; NULL => none */
 };
 
 /*! OCtree holds extra state info about trees */
@@ -204,6 +205,7 @@ typedef struct OCtree
         off_t   bod;      /* offset of the beginning of packet data */
         off_t   ddslen;   /* length of ddslen (assert(ddslen <= bod)) */
         XXDR*   xdrs;		/* access either memory or file */
+        struct OCstream* stream; /* while the response is arriving (OCSTREAM) */
         OCdata* data;
     } data;
 } OCtree;
@@ -5,6 +5,7 @@
 #include "ocinternal.h"
 #include "occompile.h"
 #include "ocdebug.h"
+#include "ocstream.h"
 #include <stddef.h>
 
 static OCerror mergedas1(OCnode* dds, OCnode* das);
@@ -180,6 +181,7 @@ octree_free(OCtree* tree)
     if(tree->data.xdrs != NULL) {
         xxdr_free(tree->data.xdrs);
     }
+    ocstream_free(tree->data.stream); /* may be null */
     ocfree(tree->data.filename); /* may be null */
     if(tree->data.file != NULL) fclose(tree->data.file);
     ocfree(tree->data.memory);
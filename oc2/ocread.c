@@ -27,6 +27,8 @@
 #include "ochttp.h"
 #include "ocread.h"
 #include "occurlfunctions.h"
+#include "occache.h"
+#include "ocstream.h"
 #include "ncpathmgr.h"
 #include "ncutil.h"
 
@@ -94,7 +96,6 @@ readpacket(OCstate* state, NCURI* url, NCbytes* packet, OCdxd dxd, OCflags ocfla
    int fileprotocol = 0;
    const char* suffix = ocdxdextension(dxd);
    char* fetchurl = NULL;
-   CURL* curl = state->curl;
 
    fileprotocol = (strcmp(url->protocol,"file")==0);
 
@@ -111,7 +112,7 @@ readpacket(OCstate* state, NCURI* url, NCbytes* packet, OCdxd dxd, OCflags ocfla
 	MEMCHECK(fetchurl,OC_ENOMEM);
 	if(ocdebug > 0)
             {fprintf(stderr,"fetch url=%s\n",fetchurl); fflush(stderr);}
-        stat = ocfetchurl(curl,fetchurl,packet,lastmodified);
+        stat = occache_fetch(state,fetchurl,packet,NULL,NULL,lastmodified);
 	if(stat)
 	    oc_curl_printerror(state);
 	if(ocdebug > 0)
@@ -136,7 +137,21 @@ readDATADDS(OCstate* state, OCtree* tree, OCflags ocflags)
 #ifdef OCDEBUG
 fprintf(stderr,"readDATADDS:\n");
 #endif
-    if((ocflags & OCONDISK) == 0) {
+    /* Responses from the persistent cache are complete already */
+    if((ocflags & OCSTREAM) != 0 && state->diskcache == NULL
+       && strcmp(state->uri->protocol,"file") != 0) {
+        int flags = NCURIBASE|NCURIQUERY;
+        char* readurl = NULL;
+	if(ocflags & OCENCODEPATH)
+	    flags |= NCURIENCODEPATH;
+	if(ocflags & OCENCODEQUERY)
+	    flags |= NCURIENCODEQUERY;
+        ncurisetquery(state->uri,tree->constraint);
+        readurl = ncuribuild(state->uri,NULL,".dods",flags);
+        MEMCHECK(readurl,OC_ENOMEM);
+        stat = ocstream_open(state,tree,readurl);
+        free(readurl);
+    } else if((ocflags & OCONDISK) == 0) {
         ncurisetquery(state->uri,tree->constraint);
         stat = readpacket(state,state->uri,state->packet,OCDATADDS,ocflags,&lastmod);
         if(stat == OC_NOERR)
@@ -164,8 +179,8 @@ fprintf(stderr,"readDATADDS:\n");
             MEMCHECK(readurl,OC_ENOMEM);
             if (ocdebug > 0) 
                 {fprintf(stderr, "fetch url=%s\n", readurl);fflush(stderr);}
-            stat = ocfetchurl_file(state->curl, readurl, tree->data.file,
-                                   &tree->data.datasize, &lastmod);
+            stat = occache_fetch(state, readurl, NULL, tree->data.file,
+                                 &tree->data.datasize, &lastmod);
             if(stat == OC_NOERR)
                 state->datalastmodified = lastmod;
             if (ocdebug > 0) 
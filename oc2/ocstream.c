@@ -0,0 +1,412 @@
+/* Copyright 2018, UCAR/Unidata and OPeNDAP, Inc.
+   See the COPYRIGHT file for more information. */
+
+/*
+Decode a DataDDS while it is being received.
+
+The transfer runs under a curl multi handle that is driven only when
+more of the response is wanted: first until the DDS/data separator
+has arrived, so that the DDS can be parsed, and then by the XXDR that
+occompile reads through, which waits for each byte range it is asked
+for. The data tree is thus built while the rest of the response
+arrives, rather than after it.
+
+The whole response is still kept, in state->packet or in the
+temporary file, because the compiled tree refers to it by offset and
+later reads go back to it. With the response on disk, only a window
+starting at the decoder's position is held in memory, and what the
+decoder skips over is written to the file without being kept; going
+back before the window rereads the file.
+*/
+
+#include "config.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "ocinternal.h"
+#include "ocdebug.h"
+#include "ochttp.h"
+#include "occurlfunctions.h"
+#include "ocstream.h"
+
+/* The separators between the DDS and the data */
+#define DATAMARK "Data:"
+#define DATAMARKLEN 5
+
+struct OCstream {
+    CURL* curl; /* state->curl */
+    CURLM* multi;
+    int done; /* the transfer is over */
+    CURLcode result;
+    CURLMcode mresult;
+    NCbytes* packet; /* whole response, when in memory */
+    FILE* file; /* whole response, when on disk */
+    NCbytes* window; /* part of a response on disk */
+    off_t winstart; /* offset in the response of the window */
+    off_t received; /* bytes of the response so far */
+    off_t readpos; /* the decoder needs nothing before this */
+    off_t searched; /* no separator begins before this */
+    off_t bod; /* 0 until the separator is found */
+    off_t ddslen;
+    int sized; /* the packet was sized from the content length */
+};
+
+static size_t WriteStreamCallback(void*, size_t, size_t, void*);
+
+/* Drop the part of the window before keep */
+static void
+trimwindow(OCstream* s, off_t keep)
+{
+    size_t len = ncbyteslength(s->window);
+    size_t drop;
+
+    if(keep <= s->winstart) return;
+    drop = (size_t)(keep - s->winstart);
+    if(drop >= len) {
+	ncbytesclear(s->window);
+	s->winstart += (off_t)len;
+    } else {
+	char* content = ncbytescontents(s->window);
+	memmove(content,content+drop,len-drop);
+	ncbytessetlength(s->window,len-drop);
+	s->winstart += (off_t)drop;
+    }
+}
+
+static size_t
+WriteStreamCallback(void* ptr, size_t size, size_t nmemb, void* data)
+{
+    OCstream* s = (OCstream*)data;
+    size_t realsize = size * nmemb;
+
+    if(s->packet != NULL) {
+	NCbytes* buf = s->packet;
+#ifdef HAVE_LIBCURL_766
+	if(!s->sized) {
+	    /* Allocate the packet once if the server says how big it is */
+	    curl_off_t len = -1;
+	    s->sized = 1;
+	    if(curl_easy_getinfo(s->curl,CURLINFO_CONTENT_LENGTH_DOWNLOAD_T,&len) == CURLE_OK
+	       && len > 0)
+		(void)ncbytessetalloc(buf,(unsigned long)len+1);
+	}
+#endif
+	if(!ncbytesavail(buf,realsize))
+	    ncbytessetalloc(buf,2*ncbytesalloc(buf));
+	if(realsize > 0)
+	    ncbytesappendn(buf,ptr,realsize);
+    } else {
+	size_t skip = 0;
+	if(realsize > 0 && fwrite(ptr,1,realsize,s->file) != realsize)
+	    return 0; /* abort the transfer */
+	trimwindow(s,s->readpos);
+	/* Keep only what the decoder has not gone past */
+	if(s->readpos > s->received) {
+	    skip = (size_t)(s->readpos - s->received);
+	    if(skip > realsize) skip = realsize;
+	}
+	if(ncbyteslength(s->window) == 0)
+	    s->winstart = s->received + (off_t)skip;
+	if(realsize > skip)
+	    ncbytesappendn(s->window,(char*)ptr+skip,realsize-skip);
+    }
+    s->received += (off_t)realsize;
+#ifdef OCPROGRESS
+    nclog(NCLOGNOTE,"callback: %lu bytes",(off_t)realsize);
+#endif
+    return realsize;
+}
+
+/* Run the transfer until the response holds upto bytes or, if upto
+   is negative, until it is over; returns whether it got there */
+static int
+pump(OCstream* s, off_t upto)
+{
+    while(!s->done && (upto < 0 || s->received < upto)) {
+	int running = 0;
+	CURLMcode mstat = curl_multi_perform(s->multi,&running);
+	if(mstat == CURLM_OK && running == 0) {
+	    CURLMsg* msg;
+	    int pending;
+	    while((msg = curl_multi_info_read(s->multi,&pending)) != NULL) {
+		if(msg->msg == CURLMSG_DONE)
+		    s->result = msg->data.result;
+	    }
+	    s->done = 1;
+	} else if(mstat == CURLM_OK && (upto < 0 || s->received < upto))
+	    mstat = curl_multi_wait(s->multi,NULL,0,1000,NULL);
+	if(mstat != CURLM_OK) {
+	    nclog(NCLOGERR,"curl error: %s",curl_multi_strerror(mstat));
+	    s->mresult = mstat;
+	    s->done = 1;
+	}
+    }
+    return (upto < 0 || s->received >= upto);
+}
+
+/* Look for the separator in what has arrived; before it is found,
+   nothing has been dropped from the window */
+static int
+findbod(OCstream* s)
+{
+    NCbytes* buf = (s->packet != NULL ? s->packet : s->window);
+    const char* content = ncbytescontents(buf);
+    size_t len = ncbyteslength(buf);
+    size_t i;
+
+    if(s->bod > 0) return 1;
+    for(i=(size_t)s->searched;i+DATAMARKLEN+1 <= len;i++) {
+	if(content[i] != 'D' || memcmp(content+i,DATAMARK,DATAMARKLEN) != 0)
+	    continue;
+	if(content[i+DATAMARKLEN] == '\n') {
+	    s->ddslen = (off_t)i;
+	    s->bod = (off_t)(i+DATAMARKLEN+1);
+	    return 1;
+	}
+	if(content[i+DATAMARKLEN] == '\r') {
+	    if(i+DATAMARKLEN+2 > len)
+		break; /* wait for the next byte */
+	    if(content[i+DATAMARKLEN+1] == '\n') {
+		s->ddslen = (off_t)i;
+		s->bod = (off_t)(i+DATAMARKLEN+2);
+		return 1;
+	    }
+	}
+    }
+    s->searched = (off_t)i;
+    return 0;
+}
+
+/* Wait for the end of the transfer and report how it went */
+static OCerror
+finish(OCstate* state, OCstream* s)
+{
+    OCerror stat = OC_NOERR;
+    CURLcode cstat;
+    long filetime = -1;
+
+    (void)pump(s,-1);
+    (void)curl_multi_remove_handle(s->multi,s->curl);
+    (void)curl_multi_cleanup(s->multi);
+    s->multi = NULL;
+    cstat = s->result;
+    if(cstat == CURLE_PARTIAL_FILE) {
+	/* Log it but otherwise ignore */
+	nclog(NCLOGWARN,"curl error: %s; ignored",curl_easy_strerror(cstat));
+	cstat = CURLE_OK;
+    }
+    if(s->mresult != CURLM_OK)
+	stat = OC_ECURL;
+    else if(cstat != CURLE_OK) {
+	nclog(NCLOGERR,"curl error: %s",curl_easy_strerror(cstat));
+	stat = ocfetcherror(ocfetchhttpcode(s->curl));
+    }
+    if(stat != OC_NOERR) {
+	oc_curl_printerror(state);
+	return OCTHROW(stat);
+    }
+    if(s->file != NULL && fflush(s->file) != 0)
+	return OCTHROW(OC_EIO);
+    if(s->packet != NULL) {
+	/* Null terminate the buffer */
+	size_t len = ncbyteslength(s->packet);
+	ncbytesnull(s->packet);
+	ncbytessetlength(s->packet,len);
+    }
+    if(CURLERR(curl_easy_getinfo(s->curl,CURLINFO_FILETIME,&filetime)) == CURLE_OK)
+	state->datalastmodified = filetime;
+    if(ocdebug > 0)
+	{fprintf(stderr,"fetch complete\n"); fflush(stderr);}
+    return OCTHROW(stat);
+}
+
+OCerror
+ocstream_open(OCstate* state, OCtree* tree, const char* url)
+{
+    OCerror stat = OC_NOERR;
+    OCstream* s = NULL;
+    CURL* curl = state->curl;
+    CURLcode cstat = CURLE_OK;
+    const char* content;
+
+    s = (OCstream*)ocmalloc(sizeof(OCstream));
+    MEMCHECK(s,OC_ENOMEM);
+    memset((void*)s,0,sizeof(OCstream));
+    s->curl = curl;
+    if(tree->data.file != NULL) {
+	s->file = tree->data.file;
+	if((s->window = ncbytesnew()) == NULL)
+	    {stat = OC_ENOMEM; goto done;}
+    } else {
+	s->packet = state->packet;
+	ncbytesclear(s->packet);
+    }
+    if((s->multi = curl_multi_init()) == NULL)
+	{stat = OC_ECURL; goto done;}
+    cstat = CURLERR(curl_easy_setopt(curl,CURLOPT_URL,(void*)url));
+    if(cstat == CURLE_OK)
+	cstat = CURLERR(curl_easy_setopt(curl,CURLOPT_WRITEFUNCTION,WriteStreamCallback));
+    if(cstat == CURLE_OK)
+	cstat = CURLERR(curl_easy_setopt(curl,CURLOPT_WRITEDATA,(void*)s));
+    if(cstat == CURLE_OK)
+	cstat = CURLERR(curl_easy_setopt(curl,CURLOPT_FILETIME,(long)1));
+    if(cstat != CURLE_OK)
+	{stat = OC_ECURL; goto done;}
+    if(curl_multi_add_handle(s->multi,curl) != CURLM_OK)
+	{stat = OC_ECURL; goto done;}
+    if(ocdebug > 0)
+	{fprintf(stderr,"fetch url=%s\n",url); fflush(stderr);}
+
+    /* Wait for the DDS */
+    while(!findbod(s) && !s->done)
+	(void)pump(s,s->received+1);
+    if(s->bod == 0) {
+	/* Not a DataDDS; leave the response to the caller */
+	stat = finish(state,s);
+	tree->data.datasize = s->received;
+	goto done;
+    }
+    content = ncbytescontents(s->packet != NULL ? s->packet : s->window);
+    if((tree->text = (char*)ocmalloc((size_t)s->ddslen+1)) == NULL)
+	{stat = OC_ENOMEM; goto done;}
+    memcpy((void*)tree->text,(void*)content,(size_t)s->ddslen);
+    tree->text[s->ddslen] = '\0';
+    tree->data.bod = s->bod;
+    tree->data.ddslen = s->ddslen;
+    s->readpos = s->bod;
+    tree->data.stream = s;
+    s = NULL;
+
+done:
+    ocstream_free(s);
+    return OCTHROW(stat);
+}
+
+void
+ocstream_free(OCstream* s)
+{
+    if(s == NULL) return;
+    if(s->multi != NULL) {
+	(void)curl_multi_remove_handle(s->multi,s->curl);
+	(void)curl_multi_cleanup(s->multi);
+    }
+    ncbytesfree(s->window);
+    ocfree(s);
+}
+
+OCerror
+ocstream_close(OCstate* state, OCtree* tree)
+{
+    OCerror stat = OC_NOERR;
+    OCstream* s = tree->data.stream;
+
+    if(s == NULL) return OCTHROW(stat);
+    if((stat = finish(state,s)) != OC_NOERR) goto done;
+    if(tree->data.xdrs != NULL) xxdr_free(tree->data.xdrs);
+    tree->data.xdrs = NULL;
+    tree->data.datasize = s->received;
+    if(s->file != NULL) {
+	tree->data.xdrs = xxdr_filecreate(tree->data.file,tree->data.bod);
+    } else {
+	tree->data.memory = ncbytesextract(s->packet);
+	tree->data.xdrs = xxdr_memcreate(tree->data.memory,tree->data.datasize,tree->data.bod);
+    }
+    if(tree->data.xdrs == NULL) stat = OC_ENOMEM;
+
+done:
+    tree->data.stream = NULL;
+    ocstream_free(s);
+    return OCTHROW(stat);
+}
+
+/**************************************************/
+/* XXDR over the arriving data */
+
+/* Reread bytes that have left the window from the file */
+static int
+readback(OCstream* s, char* addr, off_t start, off_t len)
+{
+    int ok = 1;
+    if(fflush(s->file) != 0
+       || fseek(s->file,(long)start,SEEK_SET) != 0
+       || fread(addr,(size_t)len,1,s->file) != 1)
+	ok = 0;
+    /* Writes continue at the end */
+    if(fseek(s->file,0L,SEEK_END) != 0) ok = 0;
+    return ok;
+}
+
+static int
+xxdr_streamgetbytes(XXDR* xdrs, char* addr, off_t len)
+{
+    OCstream* s = (OCstream*)xdrs->data;
+    off_t start = xdrs->base + xdrs->pos;
+
+    if(len < 0) len = 0;
+    s->readpos = start;
+    if(!pump(s,start+len)) return 0;
+    xdrs->length = s->received - xdrs->base;
+    if(len > 0) {
+	if(s->packet != NULL)
+	    memcpy(addr,ncbytescontents(s->packet)+start,(size_t)len);
+	else if(start >= s->winstart)
+	    memcpy(addr,ncbytescontents(s->window)+(start - s->winstart),(size_t)len);
+	else if(!readback(s,addr,start,len))
+	    return 0;
+    }
+    xdrs->pos += len;
+    s->readpos = start + len;
+    return 1;
+}
+
+static off_t
+xxdr_streamgetpos(XXDR* xdrs)
+{
+    return xdrs->pos;
+}
+
+static off_t
+xxdr_streamgetavail(XXDR* xdrs)
+{
+    OCstream* s = (OCstream*)xdrs->data;
+    (void)pump(s,-1);
+    xdrs->length = s->received - xdrs->base;
+    return (xdrs->length - xdrs->pos);
+}
+
+static int
+xxdr_streamsetpos(XXDR* xdrs, off_t pos)
+{
+    OCstream* s = (OCstream*)xdrs->data;
+    if(pos < 0) pos = 0;
+    s->readpos = xdrs->base + pos;
+    /* Like the others, refuse to go past the end */
+    if(!pump(s,xdrs->base + pos)) return 0;
+    xdrs->length = s->received - xdrs->base;
+    xdrs->pos = pos;
+    return 1;
+}
+
+static void
+xxdr_streamfree(XXDR* xdrs)
+{
+    free(xdrs);
+}
+
+XXDR*
+ocstream_xxdr(OCstream* s)
+{
+    XXDR* xdrs = (XXDR*)calloc(1,sizeof(XXDR));
+    if(xdrs != NULL) {
+	xdrs->data = (void*)s;
+	xdrs->base = s->bod;
+	xdrs->pos = 0;
+	xdrs->length = s->received - s->bod;
+	xdrs->getbytes = xxdr_streamgetbytes;
+	xdrs->setpos = xxdr_streamsetpos;
+	xdrs->getpos = xxdr_streamgetpos;
+	xdrs->getavail = xxdr_streamgetavail;
+	xdrs->free = xxdr_streamfree;
+    }
+    return xdrs;
+}
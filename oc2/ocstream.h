@@ -0,0 +1,28 @@
+/* Copyright 2018, UCAR/Unidata and OPeNDAP, Inc.
+   See the COPYRIGHT file for more information. */
+
+#ifndef OCSTREAM_H
+#define OCSTREAM_H 1
+
+/* A DataDDS response that is still being received. The DDS is split
+   off as soon as it has arrived, and the data is decoded through an
+   XXDR that waits for the bytes it is asked for. */
+typedef struct OCstream OCstream;
+
+/* Start fetching url into tree->data.file or, if there is no file,
+   into state->packet. Returns once the DDS is in tree->text, with the
+   transfer still running in tree->data.stream; or, if the response
+   holds no DDS, with it complete, as readDATADDS would leave it. */
+extern OCerror ocstream_open(OCstate* state, OCtree* tree, const char* url);
+
+/* An XXDR over the data part of the response */
+extern XXDR* ocstream_xxdr(OCstream* stream);
+
+/* Wait for the rest of the response and switch tree->data.xdrs to
+   the complete data */
+extern OCerror ocstream_close(OCstate* state, OCtree* tree);
+
+/* Abandon the transfer */
+extern void ocstream_free(OCstream* stream);
+
+#endif /*OCSTREAM_H*/
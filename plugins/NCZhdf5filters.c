@@ -22,6 +22,8 @@ Author: Dennis Heimbigner
 #include "netcdf_json.h"
 #include "netcdf_vutils.h"
 
+#include <zlib.h>
+
 #ifdef HAVE_SZ
 #include <szlib.h>
 #include "H5Zszip.h"
@@ -38,6 +40,7 @@ Author: Dennis Heimbigner
 static int NCZ_shuffle_codec_to_hdf5(const char* codec, size_t* nparamsp, unsigned** paramsp);
 static int NCZ_shuffle_hdf5_to_codec(size_t nparams, const unsigned* params, char** codecp);
 static int NCZ_shuffle_modify_parameters(int ncid, int varid, size_t* vnparamsp, unsigned** vparamsp, size_t* wnparamsp, unsigned** wparamsp);
+static size_t NCZ_shuffle_filter_into(unsigned flags, size_t nparams, const unsigned* params, size_t nbytes, const void* src, size_t dstsize, void* dst);
 
 static int NCZ_fletcher32_codec_to_hdf5(const char* codec, size_t* nparamsp, unsigned** paramsp);
 static int NCZ_fletcher32_hdf5_to_codec(size_t nparams, const unsigned* params, char** codecp);
@@ -45,6 +48,7 @@ static int NCZ_fletcher32_modify_parameters(int ncid, int varid, size_t* vnparam
 
 static int NCZ_deflate_codec_to_hdf5(const char* codec, size_t* nparamsp, unsigned** paramsp);
 static int NCZ_deflate_hdf5_to_codec(size_t nparams, const unsigned* params, char** codecp);
+static size_t NCZ_deflate_filter_into(unsigned flags, size_t nparams, const unsigned* params, size_t nbytes, const void* src, size_t dstsize, void* dst);
 
 #ifdef HAVE_SZ
 static int NCZ_szip_codec_to_hdf5(const char* codec, size_t* nparamsp, unsigned** paramsp);
@@ -64,6 +68,7 @@ static NCZ_codec_t NCZ_shuffle_codec = {
   NCZ_shuffle_codec_to_hdf5,
   NCZ_shuffle_hdf5_to_codec,
   NCZ_shuffle_modify_parameters,
+  NCZ_shuffle_filter_into,
 };
 
 static int
@@ -130,6 +135,35 @@ done:
     return stat;
 }
 
+/* Same layout as H5Z_filter_shuffle: byte i of every element together,
+   then any bytes left over from a partial element */
+static size_t
+NCZ_shuffle_filter_into(unsigned flags, size_t nparams, const unsigned* params, size_t nbytes, const void* src, size_t dstsize, void* dst)
+{
+    const unsigned char* s = (const unsigned char*)src;
+    unsigned char* d = (unsigned char*)dst;
+    size_t typesize, nelems, i, j;
+
+    if(nparams != 1 || params[0] == 0 || dstsize < nbytes) return 0;
+    typesize = params[0];
+    nelems = nbytes / typesize;
+    if(typesize > 1 && nelems > 1) {
+        if(flags & H5Z_FLAG_REVERSE) {
+            for(j=0;j<typesize;j++)
+                for(i=0;i<nelems;i++)
+                    d[i*typesize+j] = *s++;
+        } else {
+            for(j=0;j<typesize;j++)
+                for(i=0;i<nelems;i++)
+                    *d++ = s[i*typesize+j];
+        }
+        i = nelems * typesize;
+        memcpy((unsigned char*)dst+i,(const unsigned char*)src+i,nbytes-i);
+    } else
+        memcpy(dst,src,nbytes);
+    return nbytes;
+}
+
 #if 0
 static int
 NCZ_shuffle_visible_parameters(int ncid, int varid, size_t nparamsin, const unsigned int* paramsin, size_t* nparamsp, unsigned** paramsp)
@@ -249,6 +283,7 @@ static NCZ_codec_t NCZ_zlib_codec = {/* NCZ_codec_t  codec fields */
   NCZ_deflate_codec_to_hdf5,
   NCZ_deflate_hdf5_to_codec,
   NULL, /*NCZ_deflate_modify_parameters*/
+  NCZ_deflate_filter_into,
 };
 
 static int
@@ -312,6 +347,22 @@ done:
     return stat;
 }
 
+/* Produces the same zlib streams as H5Z_filter_deflate */
+static size_t
+NCZ_deflate_filter_into(unsigned flags, size_t nparams, const unsigned* params, size_t nbytes, const void* src, size_t dstsize, void* dst)
+{
+    uLongf dstlen = (uLongf)dstsize;
+
+    if(nparams != 1 || params[0] > 9) return 0;
+    if((size_t)dstlen != dstsize || (size_t)(uLong)nbytes != nbytes) return 0;
+    if(flags & H5Z_FLAG_REVERSE) {
+        if(uncompress((Bytef*)dst,&dstlen,(const Bytef*)src,(uLong)nbytes) != Z_OK) return 0;
+    } else {
+        if(compress2((Bytef*)dst,&dstlen,(const Bytef*)src,(uLong)nbytes,(int)params[0]) != Z_OK) return 0;
+    }
+    return (size_t)dstlen;
+}
+
 /**************************************************/
 
 #ifdef HAVE_SZ
@@ -18,6 +18,9 @@
 
 #define FILE_NAME "tst_nclist.nc"
 
+/* As in nclistmgr.c, the index in the list is the ncid >> ID_SHIFT. */
+#define ID_SHIFT 16
+
 int
 main(int argc, char **argv)
 {
@@ -106,6 +109,63 @@ main(int argc, char **argv)
         if (find_in_NCList(ncid)) ERR;
     }
     SUMMARIZE_ERR;
+    printf("Testing slot reuse and finding by name...");
+    {
+#define NUM_NC 200
+        NC *ncp[NUM_NC], *dup;
+        char name[NC_MAX_NAME + 1];
+        int mode = 0;
+        int i;
+
+        for (i = 0; i < NUM_NC; i++)
+        {
+            snprintf(name, sizeof(name), "file%d.nc", i);
+            if (new_NC(NULL, name, mode, &ncp[i])) ERR;
+            if (add_to_NCList(ncp[i])) ERR;
+            if (ncp[i]->ext_ncid != (i + 1) << ID_SHIFT) ERR;
+        }
+        for (i = 0; i < NUM_NC; i++)
+        {
+            snprintf(name, sizeof(name), "file%d.nc", i);
+            if (find_in_NCList_by_name(name) != ncp[i]) ERR;
+        }
+
+        /* The lowest free slot is used next. */
+        del_from_NCList(ncp[150]);
+        del_from_NCList(ncp[7]);
+        if (find_in_NCList_by_name("file7.nc")) ERR;
+        if (find_in_NCList_by_name("file8.nc") != ncp[8]) ERR;
+        if (add_to_NCList(ncp[150])) ERR;
+        if (ncp[150]->ext_ncid != 8 << ID_SHIFT) ERR;
+        if (find_in_NCList(8 << ID_SHIFT) != ncp[150]) ERR;
+        if (find_in_NCList_by_name("file150.nc") != ncp[150]) ERR;
+
+        /* A file open twice is found by its lowest ncid. */
+        if (new_NC(NULL, "file3.nc", mode, &dup)) ERR;
+        if (add_to_NCList(dup)) ERR;
+        if (dup->ext_ncid != 151 << ID_SHIFT) ERR;
+        if (find_in_NCList_by_name("file3.nc") != ncp[3]) ERR;
+        del_from_NCList(ncp[3]);
+        if (find_in_NCList_by_name("file3.nc") != dup) ERR;
+
+        /* Moving keeps the name. */
+        if (move_in_NCList(dup, 1000)) ERR;
+        if (find_in_NCList_by_name("file3.nc") != dup) ERR;
+        if (find_in_NCList(1000 << ID_SHIFT) != dup) ERR;
+        if (add_to_NCList(ncp[3])) ERR;
+        if (ncp[3]->ext_ncid != 4 << ID_SHIFT) ERR;
+        if (find_in_NCList_by_name("file3.nc") != ncp[3]) ERR;
+
+        del_from_NCList(dup);
+        free_NC(dup);
+        del_from_NCList(ncp[7]); /* not in the list */
+        for (i = 0; i < NUM_NC; i++)
+            if (i != 7) del_from_NCList(ncp[i]);
+        for (i = 0; i < NUM_NC; i++)
+            free_NC(ncp[i]);
+        if (count_NCList()) ERR;
+    }
+    SUMMARIZE_ERR;
 #ifdef LARGE_FILE_TESTS
     /* This test is slow, only run it on large file test builds. */
     printf("Testing maxing out NC list...");